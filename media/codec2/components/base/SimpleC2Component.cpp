@@ -31,10 +31,180 @@
 #include <Codec2CommonUtils.h>
 #include <SimpleC2Component.h>
 
+#if defined(__aarch64__) || defined(__ARM_NEON__)
+#define USE_NEON 1
+#else
+#define USE_NEON 0
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define USE_X86_SIMD 1
+#else
+#define USE_X86_SIMD 0
+#endif
+
+#if USE_NEON
+#include <arm_neon.h>
+#elif USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace android {
 constexpr uint8_t kNeutralUVBitDepth8 = 128;
 constexpr uint16_t kNeutralUVBitDepth10 = 512;
 
+// The conversions below convert the bulk of each row with NEON on ARM, or with the
+// widest of SSE4.1 and AVX2 that the CPU supports on x86, and the remaining pixels
+// with the scalar code. The results are identical for 10-bit input.
+namespace {
+
+#if USE_X86_SIMD
+enum X86SimdLevel {
+    kX86Sse2,   // baseline of every Android x86 ABI
+    kX86Sse41,
+    kX86Avx2,
+};
+
+X86SimdLevel GetX86SimdLevel() {
+    static const X86SimdLevel sLevel = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return kX86Avx2;
+        } else if (__builtin_cpu_supports("sse4.1")) {
+            return kX86Sse41;
+        }
+        return kX86Sse2;
+    }();
+    return sLevel;
+}
+#endif
+
+// Converts pixels [x, width) of two rows to Y410 in blocks, and returns the first
+// pixel that is left for the caller.
+#if USE_NEON
+size_t ConvertRowsToY410_Neon(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t x, size_t width) {
+    const uint32x4_t mask = vdupq_n_u32(0x3FF);
+    const uint32x4_t alpha = vdupq_n_u32(3u << 30);
+    for (; x + 8 <= width; x += 8) {
+        uint32x4_t uv = vorrq_u32(
+                vandq_u32(vmovl_u16(vld1_u16(u + x / 2)), mask),
+                vshlq_n_u32(vandq_u32(vmovl_u16(vld1_u16(v + x / 2)), mask), 20));
+        uint32x4x2_t uv2 = vzipq_u32(uv, uv);
+        uint16x8_t y8 = vld1q_u16(yTop + x);
+        vst1q_u32(dstTop + x, vorrq_u32(vorrq_u32(alpha, uv2.val[0]),
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_low_u16(y8)), mask), 10)));
+        vst1q_u32(dstTop + x + 4, vorrq_u32(vorrq_u32(alpha, uv2.val[1]),
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_high_u16(y8)), mask), 10)));
+        y8 = vld1q_u16(yBot + x);
+        vst1q_u32(dstBot + x, vorrq_u32(vorrq_u32(alpha, uv2.val[0]),
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_low_u16(y8)), mask), 10)));
+        vst1q_u32(dstBot + x + 4, vorrq_u32(vorrq_u32(alpha, uv2.val[1]),
+                vshlq_n_u32(vandq_u32(vmovl_u16(vget_high_u16(y8)), mask), 10)));
+    }
+    return x;
+}
+#endif
+
+#if USE_X86_SIMD
+__attribute__((target("sse4.1")))
+size_t ConvertRowsToY410_Sse41(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t x, size_t width) {
+    const __m128i mask = _mm_set1_epi32(0x3FF);
+    const __m128i alpha = _mm_set1_epi32((int32_t)(3u << 30));
+    for (; x + 8 <= width; x += 8) {
+        __m128i uv = _mm_or_si128(
+                _mm_and_si128(_mm_cvtepu16_epi32(
+                        _mm_loadl_epi64((const __m128i *)(u + x / 2))), mask),
+                _mm_slli_epi32(_mm_and_si128(_mm_cvtepu16_epi32(
+                        _mm_loadl_epi64((const __m128i *)(v + x / 2))), mask), 20));
+        __m128i uvLo = _mm_or_si128(alpha, _mm_unpacklo_epi32(uv, uv));
+        __m128i uvHi = _mm_or_si128(alpha, _mm_unpackhi_epi32(uv, uv));
+        __m128i y8 = _mm_loadu_si128((const __m128i *)(yTop + x));
+        _mm_storeu_si128((__m128i *)(dstTop + x), _mm_or_si128(uvLo,
+                _mm_slli_epi32(_mm_and_si128(_mm_cvtepu16_epi32(y8), mask), 10)));
+        _mm_storeu_si128((__m128i *)(dstTop + x + 4), _mm_or_si128(uvHi,
+                _mm_slli_epi32(_mm_and_si128(_mm_cvtepu16_epi32(_mm_srli_si128(y8, 8)), mask),
+                               10)));
+        y8 = _mm_loadu_si128((const __m128i *)(yBot + x));
+        _mm_storeu_si128((__m128i *)(dstBot + x), _mm_or_si128(uvLo,
+                _mm_slli_epi32(_mm_and_si128(_mm_cvtepu16_epi32(y8), mask), 10)));
+        _mm_storeu_si128((__m128i *)(dstBot + x + 4), _mm_or_si128(uvHi,
+                _mm_slli_epi32(_mm_and_si128(_mm_cvtepu16_epi32(_mm_srli_si128(y8, 8)), mask),
+                               10)));
+    }
+    return x;
+}
+#endif
+
+size_t ConvertRowsToY410(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t width) {
+#if USE_NEON
+    return ConvertRowsToY410_Neon(dstTop, dstBot, yTop, yBot, u, v, 0, width);
+#elif USE_X86_SIMD
+    if (GetX86SimdLevel() >= kX86Sse41) {
+        return ConvertRowsToY410_Sse41(dstTop, dstBot, yTop, yBot, u, v, 0, width);
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+// Interleaves U and V of one row into P010 UV, and returns the first sample left for
+// the caller.
+size_t ConvertRowToP010UV(
+        uint16_t *dstUV, const uint16_t *srcU, const uint16_t *srcV, size_t width) {
+    size_t x = 0;
+#if USE_NEON
+    for (; x + 8 <= width; x += 8) {
+        uint16x8x2_t uv;
+        uv.val[0] = vshlq_n_u16(vld1q_u16(srcU + x), 6);
+        uv.val[1] = vshlq_n_u16(vld1q_u16(srcV + x), 6);
+        vst2q_u16(dstUV + 2 * x, uv);
+    }
+#elif USE_X86_SIMD
+    for (; x + 8 <= width; x += 8) {
+        __m128i u8 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(srcU + x)), 6);
+        __m128i v8 = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)(srcV + x)), 6);
+        _mm_storeu_si128((__m128i *)(dstUV + 2 * x), _mm_unpacklo_epi16(u8, v8));
+        _mm_storeu_si128((__m128i *)(dstUV + 2 * x + 8), _mm_unpackhi_epi16(u8, v8));
+    }
+#endif
+    return x;
+}
+
+// Splits one row of P010 UV into U and V, and returns the first sample left for the
+// caller.
+size_t ConvertRowFromP010UV(
+        uint16_t *dstU, uint16_t *dstV, const uint16_t *srcUV, size_t width) {
+    size_t x = 0;
+#if USE_NEON
+    for (; x + 8 <= width; x += 8) {
+        uint16x8x2_t uv = vld2q_u16(srcUV + 2 * x);
+        vst1q_u16(dstU + x, vshrq_n_u16(uv.val[0], 6));
+        vst1q_u16(dstV + x, vshrq_n_u16(uv.val[1], 6));
+    }
+#elif USE_X86_SIMD
+    for (; x + 8 <= width; x += 8) {
+        // 10-bit samples fit in the signed saturation of packs.
+        __m128i uv0 = _mm_srli_epi16(_mm_loadu_si128((const __m128i *)(srcUV + 2 * x)), 6);
+        __m128i uv1 = _mm_srli_epi16(_mm_loadu_si128((const __m128i *)(srcUV + 2 * x + 8)), 6);
+        _mm_storeu_si128((__m128i *)(dstU + x), _mm_packs_epi32(
+                _mm_srai_epi32(_mm_slli_epi32(uv0, 16), 16),
+                _mm_srai_epi32(_mm_slli_epi32(uv1, 16), 16)));
+        _mm_storeu_si128((__m128i *)(dstV + x), _mm_packs_epi32(
+                _mm_srai_epi32(uv0, 16), _mm_srai_epi32(uv1, 16)));
+    }
+#endif
+    return x;
+}
+
+}  // namespace
+
 void convertYUV420Planar8ToYV12(uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, const uint8_t *srcY,
                                 const uint8_t *srcU, const uint8_t *srcV, size_t srcYStride,
                                 size_t srcUStride, size_t srcVStride, size_t dstYStride,
@@ -83,8 +253,14 @@ void convertYUV420Planar16ToY410(uint32_t *dst, const uint16_t *srcY, const uint
         uint16_t *vSrc = (uint16_t *)srcV;
 
         uint32_t u01, v01, y01, y23, y45, y67, uv0, uv1;
-        size_t x = 0;
-        for (; x < width - 3; x += 4) {
+        size_t x = ConvertRowsToY410(dstTop, dstBot, ySrcTop, ySrcBot, uSrc, vSrc, width);
+        dstTop += x;
+        dstBot += x;
+        ySrcTop += x;
+        ySrcBot += x;
+        uSrc += x / 2;
+        vSrc += x / 2;
+        for (; x + 3 < width; x += 4) {
             u01 = *((uint32_t *)uSrc);
             uSrc += 2;
             v01 = *((uint32_t *)vSrc);
@@ -232,6 +408,199 @@ static const struct Coeffs GetCoeffsForAspects(const C2ColorAspectsStruct &aspec
     }
 }
 
+// Converts pixels [x, width) of two rows to RGBA1010102 in blocks, and returns the
+// first pixel that is left for the caller.
+#if USE_NEON
+inline uint32x4_t ToRGBA1010102_Neon(
+        uint16x4_t y4, int32x4_t ub, int32x4_t uvg, int32x4_t vr, const Coeffs &coeffs) {
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t max = vdupq_n_s32(1023);
+    int32x4_t yMult = vmlaq_n_s32(
+            vdupq_n_s32(512),
+            vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(y4)), vdupq_n_s32(coeffs._c16)),
+            coeffs._y);
+    int32x4_t b = vminq_s32(vmaxq_s32(vshrq_n_s32(vaddq_s32(yMult, ub), 10), zero), max);
+    int32x4_t g = vminq_s32(vmaxq_s32(vshrq_n_s32(vaddq_s32(yMult, uvg), 10), zero), max);
+    int32x4_t r = vminq_s32(vmaxq_s32(vshrq_n_s32(vaddq_s32(yMult, vr), 10), zero), max);
+    return vorrq_u32(
+            vorrq_u32(vdupq_n_u32(3u << 30), vshlq_n_u32(vreinterpretq_u32_s32(b), 20)),
+            vorrq_u32(vshlq_n_u32(vreinterpretq_u32_s32(g), 10), vreinterpretq_u32_s32(r)));
+}
+
+size_t ConvertRowsToRGBA1010102_Neon(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t x, size_t width, const Coeffs &coeffs) {
+    const int32x4_t c512 = vdupq_n_s32(512);
+    for (; x + 8 <= width; x += 8) {
+        int32x4_t u4 = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vld1_u16(u + x / 2))), c512);
+        int32x4_t v4 = vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vld1_u16(v + x / 2))), c512);
+        int32x4_t ub = vmulq_n_s32(u4, coeffs._b_u);
+        int32x4_t uvg = vmlaq_n_s32(vmulq_n_s32(u4, -coeffs._g_u), v4, -coeffs._g_v);
+        int32x4_t vr = vmulq_n_s32(v4, coeffs._r_v);
+        // each chroma sample covers two pixels
+        int32x4x2_t ub2 = vzipq_s32(ub, ub);
+        int32x4x2_t uvg2 = vzipq_s32(uvg, uvg);
+        int32x4x2_t vr2 = vzipq_s32(vr, vr);
+
+        uint16x8_t y8 = vld1q_u16(yTop + x);
+        vst1q_u32(dstTop + x, ToRGBA1010102_Neon(
+                vget_low_u16(y8), ub2.val[0], uvg2.val[0], vr2.val[0], coeffs));
+        vst1q_u32(dstTop + x + 4, ToRGBA1010102_Neon(
+                vget_high_u16(y8), ub2.val[1], uvg2.val[1], vr2.val[1], coeffs));
+        y8 = vld1q_u16(yBot + x);
+        vst1q_u32(dstBot + x, ToRGBA1010102_Neon(
+                vget_low_u16(y8), ub2.val[0], uvg2.val[0], vr2.val[0], coeffs));
+        vst1q_u32(dstBot + x + 4, ToRGBA1010102_Neon(
+                vget_high_u16(y8), ub2.val[1], uvg2.val[1], vr2.val[1], coeffs));
+    }
+    return x;
+}
+#endif
+
+#if USE_X86_SIMD
+__attribute__((target("sse4.1")))
+inline __m128i ToRGBA1010102_Sse41(
+        __m128i y, __m128i ub, __m128i uvg, __m128i vr, const Coeffs &coeffs) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max = _mm_set1_epi32(1023);
+    __m128i yMult = _mm_add_epi32(
+            _mm_mullo_epi32(_mm_sub_epi32(y, _mm_set1_epi32(coeffs._c16)),
+                            _mm_set1_epi32(coeffs._y)),
+            _mm_set1_epi32(512));
+    __m128i b = _mm_min_epi32(_mm_max_epi32(
+            _mm_srai_epi32(_mm_add_epi32(yMult, ub), 10), zero), max);
+    __m128i g = _mm_min_epi32(_mm_max_epi32(
+            _mm_srai_epi32(_mm_add_epi32(yMult, uvg), 10), zero), max);
+    __m128i r = _mm_min_epi32(_mm_max_epi32(
+            _mm_srai_epi32(_mm_add_epi32(yMult, vr), 10), zero), max);
+    return _mm_or_si128(
+            _mm_or_si128(_mm_set1_epi32((int32_t)(3u << 30)), _mm_slli_epi32(b, 20)),
+            _mm_or_si128(_mm_slli_epi32(g, 10), r));
+}
+
+__attribute__((target("sse4.1")))
+size_t ConvertRowsToRGBA1010102_Sse41(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t x, size_t width, const Coeffs &coeffs) {
+    const __m128i c512 = _mm_set1_epi32(512);
+    for (; x + 8 <= width; x += 8) {
+        __m128i u4 = _mm_sub_epi32(
+                _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(u + x / 2))), c512);
+        __m128i v4 = _mm_sub_epi32(
+                _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(v + x / 2))), c512);
+        __m128i ub = _mm_mullo_epi32(u4, _mm_set1_epi32(coeffs._b_u));
+        __m128i uvg = _mm_add_epi32(_mm_mullo_epi32(u4, _mm_set1_epi32(-coeffs._g_u)),
+                                    _mm_mullo_epi32(v4, _mm_set1_epi32(-coeffs._g_v)));
+        __m128i vr = _mm_mullo_epi32(v4, _mm_set1_epi32(coeffs._r_v));
+        // each chroma sample covers two pixels
+        __m128i ubLo = _mm_unpacklo_epi32(ub, ub);
+        __m128i ubHi = _mm_unpackhi_epi32(ub, ub);
+        __m128i uvgLo = _mm_unpacklo_epi32(uvg, uvg);
+        __m128i uvgHi = _mm_unpackhi_epi32(uvg, uvg);
+        __m128i vrLo = _mm_unpacklo_epi32(vr, vr);
+        __m128i vrHi = _mm_unpackhi_epi32(vr, vr);
+
+        __m128i y8 = _mm_loadu_si128((const __m128i *)(yTop + x));
+        _mm_storeu_si128((__m128i *)(dstTop + x), ToRGBA1010102_Sse41(
+                _mm_cvtepu16_epi32(y8), ubLo, uvgLo, vrLo, coeffs));
+        _mm_storeu_si128((__m128i *)(dstTop + x + 4), ToRGBA1010102_Sse41(
+                _mm_cvtepu16_epi32(_mm_srli_si128(y8, 8)), ubHi, uvgHi, vrHi, coeffs));
+        y8 = _mm_loadu_si128((const __m128i *)(yBot + x));
+        _mm_storeu_si128((__m128i *)(dstBot + x), ToRGBA1010102_Sse41(
+                _mm_cvtepu16_epi32(y8), ubLo, uvgLo, vrLo, coeffs));
+        _mm_storeu_si128((__m128i *)(dstBot + x + 4), ToRGBA1010102_Sse41(
+                _mm_cvtepu16_epi32(_mm_srli_si128(y8, 8)), ubHi, uvgHi, vrHi, coeffs));
+    }
+    return x;
+}
+
+__attribute__((target("avx2")))
+inline __m256i ToRGBA1010102_Avx2(
+        __m256i y, __m256i ub, __m256i uvg, __m256i vr, const Coeffs &coeffs) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi32(1023);
+    __m256i yMult = _mm256_add_epi32(
+            _mm256_mullo_epi32(_mm256_sub_epi32(y, _mm256_set1_epi32(coeffs._c16)),
+                               _mm256_set1_epi32(coeffs._y)),
+            _mm256_set1_epi32(512));
+    __m256i b = _mm256_min_epi32(_mm256_max_epi32(
+            _mm256_srai_epi32(_mm256_add_epi32(yMult, ub), 10), zero), max);
+    __m256i g = _mm256_min_epi32(_mm256_max_epi32(
+            _mm256_srai_epi32(_mm256_add_epi32(yMult, uvg), 10), zero), max);
+    __m256i r = _mm256_min_epi32(_mm256_max_epi32(
+            _mm256_srai_epi32(_mm256_add_epi32(yMult, vr), 10), zero), max);
+    return _mm256_or_si256(
+            _mm256_or_si256(_mm256_set1_epi32((int32_t)(3u << 30)), _mm256_slli_epi32(b, 20)),
+            _mm256_or_si256(_mm256_slli_epi32(g, 10), r));
+}
+
+__attribute__((target("avx2")))
+size_t ConvertRowsToRGBA1010102_Avx2(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t x, size_t width, const Coeffs &coeffs) {
+    const __m256i c512 = _mm256_set1_epi32(512);
+    // each chroma sample covers two pixels
+    const __m256i dupLo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i dupHi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    for (; x + 16 <= width; x += 16) {
+        __m256i u8 = _mm256_sub_epi32(
+                _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(u + x / 2))), c512);
+        __m256i v8 = _mm256_sub_epi32(
+                _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(v + x / 2))), c512);
+        __m256i ub = _mm256_mullo_epi32(u8, _mm256_set1_epi32(coeffs._b_u));
+        __m256i uvg = _mm256_add_epi32(
+                _mm256_mullo_epi32(u8, _mm256_set1_epi32(-coeffs._g_u)),
+                _mm256_mullo_epi32(v8, _mm256_set1_epi32(-coeffs._g_v)));
+        __m256i vr = _mm256_mullo_epi32(v8, _mm256_set1_epi32(coeffs._r_v));
+        __m256i ubLo = _mm256_permutevar8x32_epi32(ub, dupLo);
+        __m256i ubHi = _mm256_permutevar8x32_epi32(ub, dupHi);
+        __m256i uvgLo = _mm256_permutevar8x32_epi32(uvg, dupLo);
+        __m256i uvgHi = _mm256_permutevar8x32_epi32(uvg, dupHi);
+        __m256i vrLo = _mm256_permutevar8x32_epi32(vr, dupLo);
+        __m256i vrHi = _mm256_permutevar8x32_epi32(vr, dupHi);
+
+        __m256i y16 = _mm256_loadu_si256((const __m256i *)(yTop + x));
+        _mm256_storeu_si256((__m256i *)(dstTop + x), ToRGBA1010102_Avx2(
+                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(y16)),
+                ubLo, uvgLo, vrLo, coeffs));
+        _mm256_storeu_si256((__m256i *)(dstTop + x + 8), ToRGBA1010102_Avx2(
+                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(y16, 1)),
+                ubHi, uvgHi, vrHi, coeffs));
+        y16 = _mm256_loadu_si256((const __m256i *)(yBot + x));
+        _mm256_storeu_si256((__m256i *)(dstBot + x), ToRGBA1010102_Avx2(
+                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(y16)),
+                ubLo, uvgLo, vrLo, coeffs));
+        _mm256_storeu_si256((__m256i *)(dstBot + x + 8), ToRGBA1010102_Avx2(
+                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(y16, 1)),
+                ubHi, uvgHi, vrHi, coeffs));
+    }
+    return x;
+}
+#endif
+
+size_t ConvertRowsToRGBA1010102(
+        uint32_t *dstTop, uint32_t *dstBot, const uint16_t *yTop, const uint16_t *yBot,
+        const uint16_t *u, const uint16_t *v, size_t width, const Coeffs &coeffs) {
+    size_t x = 0;
+#if USE_NEON
+    x = ConvertRowsToRGBA1010102_Neon(dstTop, dstBot, yTop, yBot, u, v, x, width, coeffs);
+#elif USE_X86_SIMD
+    switch (GetX86SimdLevel()) {
+        case kX86Avx2:
+            x = ConvertRowsToRGBA1010102_Avx2(
+                    dstTop, dstBot, yTop, yBot, u, v, x, width, coeffs);
+            [[fallthrough]];
+        case kX86Sse41:
+            x = ConvertRowsToRGBA1010102_Sse41(
+                    dstTop, dstBot, yTop, yBot, u, v, x, width, coeffs);
+            break;
+        default:
+            break;
+    }
+#endif
+    return x;
+}
+
 }
 
 #define CLIP3(min, v, max) (((v) < (min)) ? (min) : (((max) > (v)) ? (v) : (max)))
@@ -262,7 +631,15 @@ void convertYUV420Planar16ToRGBA1010102(
         uint16_t *uSrc = (uint16_t *)srcU;
         uint16_t *vSrc = (uint16_t *)srcV;
 
-        for (size_t x = 0; x < width; x += 2) {
+        size_t x = ConvertRowsToRGBA1010102(
+                dstTop, dstBot, ySrcTop, ySrcBot, uSrc, vSrc, width, coeffs);
+        dstTop += x;
+        dstBot += x;
+        ySrcTop += x;
+        ySrcBot += x;
+        uSrc += x / 2;
+        vSrc += x / 2;
+        for (; x < width; x += 2) {
             int32_t u, v, y00, y01, y10, y11;
             u = *uSrc - 512;
             uSrc += 1;
@@ -405,7 +782,8 @@ void convertYUV420Planar16ToP010(uint16_t *dstY, uint16_t *dstUV, const uint16_t
     }
 
     for (size_t y = 0; y < (height + 1) / 2; ++y) {
-        for (size_t x = 0; x < (width + 1) / 2; ++x) {
+        for (size_t x = ConvertRowToP010UV(dstUV, srcU, srcV, (width + 1) / 2);
+                x < (width + 1) / 2; ++x) {
             dstUV[2 * x] = srcU[x] << 6;
             dstUV[2 * x + 1] = srcV[x] << 6;
         }
@@ -442,7 +820,8 @@ void convertP010ToYUV420Planar16(uint16_t *dstY, uint16_t *dstU, uint16_t *dstV,
     }
 
     for (size_t y = 0; y < (height + 1) / 2; ++y) {
-        for (size_t x = 0; x < (width + 1) / 2; ++x) {
+        for (size_t x = ConvertRowFromP010UV(dstU, dstV, srcUV, (width + 1) / 2);
+                x < (width + 1) / 2; ++x) {
             dstU[x] = srcUV[2 * x] >> 6;
             dstV[x] = srcUV[2 * x + 1] >> 6;
         }
@@ -462,6 +841,134 @@ static const int16_t bt2020Matrix_10bit[2][3][3] = {
     { { 230, 594, 52 }, { -125, -323, 448 }, { 448, -412, -36 } }, /* RANGE_LIMITED */
 };
 
+namespace {
+
+// Levels and weights of an RGBA1010102 to YUV conversion.
+struct RGBToYUVParams {
+    const int16_t (*weights)[3];
+    int32_t zeroLvl;
+    int32_t maxLvlLuma;
+    int32_t maxLvlChroma;
+};
+
+// Converts pixels [0, width) of one row of RGBA1010102 to Y, and to U and V at even
+// pixels if |withChroma|, in blocks. Returns the first pixel left for the caller.
+#if USE_NEON
+inline int32x4_t ToYUV_Neon(int32x4_t r, int32x4_t g, int32x4_t b, const int16_t weights[3],
+                            int32_t offset, int32_t min, int32_t max) {
+    int32x4_t yuv = vmlaq_n_s32(vmlaq_n_s32(vmlaq_n_s32(
+            vdupq_n_s32(512), r, weights[0]), g, weights[1]), b, weights[2]);
+    yuv = vaddq_s32(vshrq_n_s32(yuv, 10), vdupq_n_s32(offset));
+    return vminq_s32(vmaxq_s32(yuv, vdupq_n_s32(min)), vdupq_n_s32(max));
+}
+
+size_t ConvertRowFromRGBA1010102_Neon(
+        uint16_t *dstY, uint16_t *dstU, uint16_t *dstV, const uint32_t *src, size_t width,
+        bool withChroma, const RGBToYUVParams &params) {
+    const uint32x4_t mask = vdupq_n_u32(0x3FF);
+    const int16_t (*weights)[3] = params.weights;
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        // even pixels in val[0], odd pixels in val[1]
+        uint32x4x2_t rgba = vld2q_u32(src + x);
+        int32x4_t rEven = vreinterpretq_s32_u32(vandq_u32(rgba.val[0], mask));
+        int32x4_t gEven = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(rgba.val[0], 10), mask));
+        int32x4_t bEven = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(rgba.val[0], 20), mask));
+        int32x4_t rOdd = vreinterpretq_s32_u32(vandq_u32(rgba.val[1], mask));
+        int32x4_t gOdd = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(rgba.val[1], 10), mask));
+        int32x4_t bOdd = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(rgba.val[1], 20), mask));
+
+        uint16x4x2_t y;
+        y.val[0] = vmovn_u32(vreinterpretq_u32_s32(ToYUV_Neon(
+                rEven, gEven, bEven, weights[0], params.zeroLvl, params.zeroLvl,
+                params.maxLvlLuma)));
+        y.val[1] = vmovn_u32(vreinterpretq_u32_s32(ToYUV_Neon(
+                rOdd, gOdd, bOdd, weights[0], params.zeroLvl, params.zeroLvl,
+                params.maxLvlLuma)));
+        vst2_u16(dstY + x, y);
+        if (withChroma) {
+            vst1_u16(dstU + x / 2, vmovn_u32(vreinterpretq_u32_s32(ToYUV_Neon(
+                    rEven, gEven, bEven, weights[1], 512, params.zeroLvl,
+                    params.maxLvlChroma))));
+            vst1_u16(dstV + x / 2, vmovn_u32(vreinterpretq_u32_s32(ToYUV_Neon(
+                    rEven, gEven, bEven, weights[2], 512, params.zeroLvl,
+                    params.maxLvlChroma))));
+        }
+    }
+    return x;
+}
+#endif
+
+#if USE_X86_SIMD
+__attribute__((target("sse4.1")))
+inline __m128i ToYUV_Sse41(__m128i r, __m128i g, __m128i b, const int16_t weights[3],
+                           int32_t offset, int32_t min, int32_t max) {
+    __m128i yuv = _mm_add_epi32(
+            _mm_add_epi32(_mm_mullo_epi32(r, _mm_set1_epi32(weights[0])),
+                          _mm_mullo_epi32(g, _mm_set1_epi32(weights[1]))),
+            _mm_add_epi32(_mm_mullo_epi32(b, _mm_set1_epi32(weights[2])),
+                          _mm_set1_epi32(512)));
+    yuv = _mm_add_epi32(_mm_srai_epi32(yuv, 10), _mm_set1_epi32(offset));
+    return _mm_min_epi32(_mm_max_epi32(yuv, _mm_set1_epi32(min)), _mm_set1_epi32(max));
+}
+
+__attribute__((target("sse4.1")))
+size_t ConvertRowFromRGBA1010102_Sse41(
+        uint16_t *dstY, uint16_t *dstU, uint16_t *dstV, const uint32_t *src, size_t width,
+        bool withChroma, const RGBToYUVParams &params) {
+    const __m128i mask = _mm_set1_epi32(0x3FF);
+    const int16_t (*weights)[3] = params.weights;
+    size_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i rgba0 = _mm_loadu_si128((const __m128i *)(src + x));
+        __m128i rgba1 = _mm_loadu_si128((const __m128i *)(src + x + 4));
+        __m128i y0 = ToYUV_Sse41(
+                _mm_and_si128(rgba0, mask),
+                _mm_and_si128(_mm_srli_epi32(rgba0, 10), mask),
+                _mm_and_si128(_mm_srli_epi32(rgba0, 20), mask),
+                weights[0], params.zeroLvl, params.zeroLvl, params.maxLvlLuma);
+        __m128i y1 = ToYUV_Sse41(
+                _mm_and_si128(rgba1, mask),
+                _mm_and_si128(_mm_srli_epi32(rgba1, 10), mask),
+                _mm_and_si128(_mm_srli_epi32(rgba1, 20), mask),
+                weights[0], params.zeroLvl, params.zeroLvl, params.maxLvlLuma);
+        _mm_storeu_si128((__m128i *)(dstY + x), _mm_packus_epi32(y0, y1));
+        if (withChroma) {
+            __m128i even = _mm_castps_si128(_mm_shuffle_ps(
+                    _mm_castsi128_ps(rgba0), _mm_castsi128_ps(rgba1), _MM_SHUFFLE(2, 0, 2, 0)));
+            __m128i r = _mm_and_si128(even, mask);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(even, 10), mask);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(even, 20), mask);
+            __m128i u = ToYUV_Sse41(r, g, b, weights[1], 512, params.zeroLvl,
+                                    params.maxLvlChroma);
+            __m128i v = ToYUV_Sse41(r, g, b, weights[2], 512, params.zeroLvl,
+                                    params.maxLvlChroma);
+            _mm_storel_epi64((__m128i *)(dstU + x / 2), _mm_packus_epi32(u, u));
+            _mm_storel_epi64((__m128i *)(dstV + x / 2), _mm_packus_epi32(v, v));
+        }
+    }
+    return x;
+}
+#endif
+
+size_t ConvertRowFromRGBA1010102(
+        uint16_t *dstY, uint16_t *dstU, uint16_t *dstV, const uint32_t *src, size_t width,
+        bool withChroma, const RGBToYUVParams &params) {
+#if USE_NEON
+    return ConvertRowFromRGBA1010102_Neon(dstY, dstU, dstV, src, width, withChroma, params);
+#elif USE_X86_SIMD
+    if (GetX86SimdLevel() >= kX86Sse41) {
+        return ConvertRowFromRGBA1010102_Sse41(
+                dstY, dstU, dstV, src, width, withChroma, params);
+    }
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+}  // namespace
+
 void convertRGBA1010102ToYUV420Planar16(uint16_t* dstY, uint16_t* dstU, uint16_t* dstV,
                                         const uint32_t* srcRGBA, size_t srcRGBStride, size_t width,
                                         size_t height, C2Color::matrix_t colorMatrix,
@@ -479,8 +986,12 @@ void convertRGBA1010102ToYUV420Planar16(uint16_t* dstY, uint16_t* dstU, uint16_t
                                          ? bt709Matrix_10bit[colorRange - 1]
                                          : bt2020Matrix_10bit[colorRange - 1];
 
+    const RGBToYUVParams params = { weights, zeroLvl, maxLvlLuma, maxLvlChroma };
+
     for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
+        for (size_t x = ConvertRowFromRGBA1010102(
+                     dstY, dstU, dstV, srcRGBA, width, y % 2 == 0, params);
+                x < width; ++x) {
             b = (srcRGBA[x]  >> 20) & 0x3FF;
             g = (srcRGBA[x]  >> 10) & 0x3FF;
             r = srcRGBA[x] & 0x3FF;
@@ -513,7 +1024,7 @@ std::unique_ptr<C2Work> SimpleC2Component::WorkQueue::pop_front() {
 }
 
 void SimpleC2Component::WorkQueue::push_back(std::unique_ptr<C2Work> work) {
-    mQueue.push_back({ std::move(work), NO_DRAIN });
+    mQueue.push_back({ std::move(work), NO_DRAIN, false, nullptr });
 }
 
 bool SimpleC2Component::WorkQueue::empty() const {
@@ -529,7 +1040,39 @@ uint32_t SimpleC2Component::WorkQueue::drainMode() const {
 }
 
 void SimpleC2Component::WorkQueue::markDrain(uint32_t drainMode) {
-    mQueue.push_back({ nullptr, drainMode });
+    mQueue.push_back({ nullptr, drainMode, false, nullptr });
+}
+
+std::unique_ptr<SimpleC2Component::StagedWork> SimpleC2Component::WorkQueue::takeFrontStaged() {
+    return std::move(mQueue.front().staged);
+}
+
+bool SimpleC2Component::WorkQueue::isFrontStaged() const {
+    return mQueue.front().isStaged;
+}
+
+bool SimpleC2Component::WorkQueue::startStaging(const std::shared_ptr<C2BlockPool> &pool) {
+    if (mStaging || mQueue.empty()) {
+        return false;
+    }
+    const Entry &entry = mQueue.front();
+    // Config updates and null input buffers are handled right before process(),
+    // so such work is staged then.
+    if (!entry.work || entry.isStaged || !entry.work->input.configUpdate.empty()
+            || (!entry.work->input.buffers.empty() && !entry.work->input.buffers[0])) {
+        return false;
+    }
+    mStaging = true;
+    mStagingPool = pool;
+    return true;
+}
+
+void SimpleC2Component::WorkQueue::finishStaging(std::unique_ptr<StagedWork> staged) {
+    mQueue.front().isStaged = true;
+    mQueue.front().staged = std::move(staged);
+    mStaging = false;
+    mStagingPool.reset();
+    mStagedCond.broadcast();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -581,18 +1124,22 @@ void SimpleC2Component::WorkHandler::onMessageReceived(const sp<AMessage> &msg)
             [[fallthrough]];
         }
         case kWhatStart: {
+            thiz->updateWorkerPoolPriority();
+            thiz->setWorkerPoolRunning(true);
             mRunning = true;
             break;
         }
         case kWhatStop: {
             int32_t err = thiz->onStop();
             thiz->mOutputBlockPool.reset();
+            thiz->setWorkerPoolRunning(false);
             Reply(msg, &err);
             break;
         }
         case kWhatReset: {
             thiz->onReset();
             thiz->mOutputBlockPool.reset();
+            thiz->setWorkerPoolRunning(false);
             mRunning = false;
             Reply(msg);
             break;
@@ -600,10 +1147,15 @@ void SimpleC2Component::WorkHandler::onMessageReceived(const sp<AMessage> &msg)
         case kWhatRelease: {
             thiz->onRelease();
             thiz->mOutputBlockPool.reset();
+            thiz->setWorkerPoolRunning(false);
             mRunning = false;
             Reply(msg);
             break;
         }
+        case kWhatStage: {
+            thiz->stageFront();
+            break;
+        }
         default: {
             ALOGD("Unrecognized msg: %d", msg->what());
             break;
@@ -611,6 +1163,45 @@ void SimpleC2Component::WorkHandler::onMessageReceived(const sp<AMessage> &msg)
     }
 }
 
+const std::shared_ptr<SimpleC2WorkerPool::Client> &SimpleC2Component::getWorkerPoolClient() {
+    if (!mWorkerPoolClient) {
+        mWorkerPoolClient = SimpleC2WorkerPool::GetInstance()->createClient();
+        updateWorkerPoolPriority();
+        mWorkerPoolClient->setRunning(mWorkerPoolRunning);
+    }
+    return mWorkerPoolClient;
+}
+
+void SimpleC2Component::setWorkerPoolRunning(bool running) {
+    mWorkerPoolRunning = running;
+    if (mWorkerPoolClient) {
+        mWorkerPoolClient->setRunning(running);
+    }
+}
+
+void SimpleC2Component::updateWorkerPoolPriority() {
+    if (!mWorkerPoolClient) {
+        return;
+    }
+    C2RealTimePriorityTuning priority(0);
+    C2OperatingRateTuning operatingRate(0.f);
+    std::vector<std::unique_ptr<C2Param>> heapParams;
+    // Parameters that the component does not support are invalidated.
+    (void)mIntf->query_vb({&priority, &operatingRate}, {}, C2_DONT_BLOCK, &heapParams);
+    mWorkerPoolClient->setPriority(priority ? priority.value : 0,
+                                   operatingRate ? operatingRate.value : 0.f);
+}
+
+void SimpleC2Component::parallelFor(size_t count, const std::function<void(size_t)> &fn) {
+    getWorkerPoolClient()->parallelFor(count, fn);
+}
+
+size_t SimpleC2Component::getThreadShare() {
+    const std::shared_ptr<SimpleC2WorkerPool::Client> &client = getWorkerPoolClient();
+    updateWorkerPoolPriority();
+    return client->getThreadShare();
+}
+
 class SimpleC2Component::BlockingBlockPool : public C2BlockPool {
 public:
     BlockingBlockPool(const std::shared_ptr<C2BlockPool>& base): mBase{base} {}
@@ -657,6 +1248,11 @@ public:
         return status;
     }
 
+    // The pool without retries, which may return C2_BLOCKING.
+    const std::shared_ptr<C2BlockPool> &base() const {
+        return mBase;
+    }
+
 private:
     std::shared_ptr<C2BlockPool> mBase;
 };
@@ -685,11 +1281,77 @@ SimpleC2Component::SimpleC2Component(
 SimpleC2Component::~SimpleC2Component() {
     mLooper->unregisterHandler(mHandler->id());
     (void)mLooper->stop();
+    if (mStageLooper) {
+        mStageLooper->unregisterHandler(mStageHandler->id());
+        (void)mStageLooper->stop();
+    }
+}
+
+void SimpleC2Component::enablePipelining() {
+    if (mStageLooper) {
+        return;
+    }
+    // debug.stagefright.c2.pipelining=0 turns pipelining off, e.g. to compare throughput.
+    if (!property_get_bool("debug.stagefright.c2.pipelining", true)) {
+        return;
+    }
+    mStageLooper = new ALooper;
+    mStageLooper->setName((mIntf->getName() + "-stage").c_str());
+    mStageHandler = new WorkHandler;
+    (void)mStageLooper->registerHandler(mStageHandler);
+    mStageLooper->start(false, false, ANDROID_PRIORITY_VIDEO);
+}
+
+std::unique_ptr<SimpleC2Component::StagedWork> SimpleC2Component::onStage(
+        const std::unique_ptr<C2Work> &, const std::shared_ptr<C2BlockPool> &) {
+    return nullptr;
+}
+
+std::unique_ptr<SimpleC2Component::StagedWork> SimpleC2Component::takeStagedWork() {
+    return std::move(mStagedWork);
+}
+
+void SimpleC2Component::waitForStaging_l(Mutexed<WorkQueue>::Locked &queue) {
+    while (queue->isStaging()) {
+        queue.waitForCondition(queue->stagedCond());
+    }
+}
+
+void SimpleC2Component::stageAhead() {
+    if (!mStageHandler) {
+        return;
+    }
+    // Client calls such as flush_sm() wait for staging, and the client may only
+    // return output buffers after they return, so staging must not block on the pool.
+    bool started = mWorkQueue.lock()->startStaging(mOutputBlockPool->base());
+    if (started) {
+        (new AMessage(WorkHandler::kWhatStage, mStageHandler))->post();
+    }
+}
+
+void SimpleC2Component::stageFront() {
+    Mutexed<WorkQueue>::Locked queue(mWorkQueue);
+    if (!queue->isStaging()) {
+        return;
+    }
+    // The front work stays in the queue until staging finishes.
+    const std::unique_ptr<C2Work> &work = queue->stagingWork();
+    std::shared_ptr<C2BlockPool> pool = queue->stagingPool();
+    queue.unlock();
+
+    ALOGV("staging frame #%" PRIu64, work->input.ordinal.frameIndex.peeku());
+    std::unique_ptr<StagedWork> staged = onStage(work, pool);
+
+    queue.lock();
+    queue->finishStaging(std::move(staged));
 }
 
 c2_status_t SimpleC2Component::setListener_vb(
         const std::shared_ptr<C2Component::Listener> &listener, c2_blocking_t mayBlock) {
     mHandler->setComponent(shared_from_this());
+    if (mStageHandler) {
+        mStageHandler->setComponent(shared_from_this());
+    }
 
     Mutexed<ExecState>::Locked state(mExecState);
     if (state->mState == RUNNING) {
@@ -743,6 +1405,7 @@ c2_status_t SimpleC2Component::flush_sm(
     }
     {
         Mutexed<WorkQueue>::Locked queue(mWorkQueue);
+        waitForStaging_l(queue);
         queue->incGeneration();
         // TODO: queue->splicedBy(flushedWork, flushedWork->end());
         while (!queue->empty()) {
@@ -817,6 +1480,7 @@ c2_status_t SimpleC2Component::stop() {
     }
     {
         Mutexed<WorkQueue>::Locked queue(mWorkQueue);
+        waitForStaging_l(queue);
         queue->clear();
         queue->pending().clear();
     }
@@ -838,6 +1502,7 @@ c2_status_t SimpleC2Component::reset() {
     }
     {
         Mutexed<WorkQueue>::Locked queue(mWorkQueue);
+        waitForStaging_l(queue);
         queue->clear();
         queue->pending().clear();
     }
@@ -848,6 +1513,10 @@ c2_status_t SimpleC2Component::reset() {
 
 c2_status_t SimpleC2Component::release() {
     ALOGV("release");
+    {
+        Mutexed<WorkQueue>::Locked queue(mWorkQueue);
+        waitForStaging_l(queue);
+    }
     sp<AMessage> reply;
     (new AMessage(WorkHandler::kWhatRelease, mHandler))->postAndAwaitResponse(&reply);
     return C2_OK;
@@ -919,8 +1588,11 @@ bool SimpleC2Component::processQueue() {
     int32_t drainMode;
     bool isFlushPending = false;
     bool hasQueuedWork = false;
+    bool isStaged = false;
+    std::unique_ptr<StagedWork> staged;
     {
         Mutexed<WorkQueue>::Locked queue(mWorkQueue);
+        waitForStaging_l(queue);
         if (queue->empty()) {
             return false;
         }
@@ -928,6 +1600,8 @@ bool SimpleC2Component::processQueue() {
         generation = queue->generation();
         drainMode = queue->drainMode();
         isFlushPending = queue->popPendingFlush();
+        isStaged = queue->isFrontStaged();
+        staged = queue->takeFrontStaged();
         work = queue->pop_front();
         hasQueuedWork = !queue->empty();
     }
@@ -988,6 +1662,7 @@ bool SimpleC2Component::processQueue() {
     }
 
     if (!work) {
+        stageAhead();
         c2_status_t err = drain(drainMode, mOutputBlockPool);
         if (err != C2_OK) {
             Mutexed<ExecState>::Locked state(mExecState);
@@ -1020,7 +1695,16 @@ bool SimpleC2Component::processQueue() {
         ALOGD("Encountered null input buffer. Clearing the input buffer");
         work->input.buffers.clear();
     }
+    if (mStageHandler) {
+        if (!isStaged) {
+            staged = onStage(work, mOutputBlockPool->base());
+        }
+        // Stage the next work while this one is processed.
+        stageAhead();
+        mStagedWork = std::move(staged);
+    }
     process(work, mOutputBlockPool);
+    mStagedWork.reset();
     ALOGV("processed frame #%" PRIu64, work->input.ordinal.frameIndex.peeku());
     Mutexed<WorkQueue>::Locked queue(mWorkQueue);
     if (queue->generation() != generation) {
@@ -319,6 +319,23 @@ void SimpleInterface<void>::BaseParams::noTimeStretch() {
             .build());
 }
 
+void SimpleInterface<void>::BaseParams::addPriorityTuning() {
+    addParameter(
+            DefineParam(mRealTimePriority, C2_PARAMKEY_PRIORITY)
+            .withDefault(new C2RealTimePriorityTuning(0))
+            .withFields({ C2F(mRealTimePriority, value).any() })
+            .withSetter(Setter<C2RealTimePriorityTuning>::NonStrictValueWithNoDeps)
+            .build());
+
+    // SimpleC2WorkerPool ignores values that are not positive.
+    addParameter(
+            DefineParam(mOperatingRate, C2_PARAMKEY_OPERATING_RATE)
+            .withDefault(new C2OperatingRateTuning(0.f))
+            .withFields({ C2F(mOperatingRate, value).any() })
+            .withSetter(Setter<C2OperatingRateTuning>::NonStrictValueWithNoDeps)
+            .build());
+}
+
 /*
     Clients need to handle the following base params due to custom dependency.
 
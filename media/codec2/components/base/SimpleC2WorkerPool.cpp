@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SimpleC2WorkerPool"
+#include <log/log.h>
+#include <utils/AndroidThreads.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include <SimpleC2WorkerPool.h>
+
+namespace android {
+
+namespace {
+
+// Operating rate assumed for clients that do not set one.
+constexpr float kDefaultOperatingRate = 30.f;
+
+size_t getCpuCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (size_t)count;
+}
+
+}  // namespace
+
+// static
+std::shared_ptr<SimpleC2WorkerPool> SimpleC2WorkerPool::GetInstance() {
+    static std::mutex sLock;
+    static std::weak_ptr<SimpleC2WorkerPool> sInstance;
+
+    std::lock_guard<std::mutex> lock(sLock);
+    std::shared_ptr<SimpleC2WorkerPool> pool = sInstance.lock();
+    if (!pool) {
+        // The thread calling parallelFor() works too.
+        pool = Create(getCpuCount() - 1);
+        sInstance = pool;
+    }
+    return pool;
+}
+
+// static
+std::shared_ptr<SimpleC2WorkerPool> SimpleC2WorkerPool::Create(size_t numWorkers) {
+    std::shared_ptr<SimpleC2WorkerPool> pool(new SimpleC2WorkerPool(numWorkers));
+    pool->start();
+    return pool;
+}
+
+SimpleC2WorkerPool::SimpleC2WorkerPool(size_t numWorkers)
+    : mNumCpus(getCpuCount()),
+      mNumWorkers(numWorkers) {
+}
+
+void SimpleC2WorkerPool::start() {
+    ALOGV("starting %zu workers", mNumWorkers);
+    for (size_t i = 0; i < mNumWorkers; ++i) {
+        mWorkers.emplace_back([this] {
+            pthread_setname_np(pthread_self(), "C2WorkerPool");
+            androidSetThreadPriority(0 /* tid */, ANDROID_PRIORITY_AUDIO);
+            workerLoop();
+        });
+    }
+}
+
+SimpleC2WorkerPool::~SimpleC2WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mExiting = true;
+    }
+    mWorkCond.notify_all();
+    for (std::thread &worker : mWorkers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<SimpleC2WorkerPool::Client> SimpleC2WorkerPool::createClient() {
+    std::shared_ptr<Client> client(new Client(shared_from_this()));
+    std::lock_guard<std::mutex> lock(mLock);
+    client->mVirtualTime = mVirtualTime;
+    mClients.push_back(client.get());
+    return client;
+}
+
+std::shared_ptr<SimpleC2WorkerPool::Job> SimpleC2WorkerPool::pickJob_l() {
+    std::shared_ptr<Job> best;
+    for (auto it = mJobs.begin(); it != mJobs.end(); ) {
+        const std::shared_ptr<Job> &job = *it;
+        if (job->next.load(std::memory_order_relaxed) >= job->count) {
+            // All items are taken; the client removes the job when they complete.
+            it = mJobs.erase(it);
+            continue;
+        }
+        if (!best
+                || job->client->mPriority > best->client->mPriority
+                || (job->client->mPriority == best->client->mPriority
+                        && job->client->mVirtualTime < best->client->mVirtualTime)) {
+            best = job;
+        }
+        ++it;
+    }
+    return best;
+}
+
+// static
+bool SimpleC2WorkerPool::runItem(Job *job) {
+    const size_t index = job->next.fetch_add(1, std::memory_order_relaxed);
+    if (index >= job->count) {
+        return false;
+    }
+    (*job->fn)(index);
+    if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        { std::lock_guard<std::mutex> lock(job->doneLock); }
+        job->doneCond.notify_all();
+    }
+    return true;
+}
+
+void SimpleC2WorkerPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mLock);
+    while (true) {
+        std::shared_ptr<Job> job = pickJob_l();
+        if (!job) {
+            if (mExiting) {
+                return;
+            }
+            mWorkCond.wait(lock);
+            continue;
+        }
+        // Charge the client for the item before running it so that other workers
+        // picking a job meanwhile see the updated share.
+        Client *client = job->client;
+        mVirtualTime = client->mVirtualTime;
+        client->mVirtualTime += 1. / client->mWeight;
+        lock.unlock();
+        runItem(job.get());
+        lock.lock();
+    }
+}
+
+SimpleC2WorkerPool::Client::Client(const std::shared_ptr<SimpleC2WorkerPool> &pool)
+    : mPool(pool),
+      mWeight(kDefaultOperatingRate) {
+}
+
+SimpleC2WorkerPool::Client::~Client() {
+    std::lock_guard<std::mutex> lock(mPool->mLock);
+    mPool->mClients.remove(this);
+}
+
+void SimpleC2WorkerPool::Client::setPriority(int32_t priority, float operatingRate) {
+    std::lock_guard<std::mutex> lock(mPool->mLock);
+    // Positive priorities are not defined and are treated as 0.
+    mPriority = std::min(priority, 0);
+    mWeight = operatingRate > 0.f ? operatingRate : kDefaultOperatingRate;
+}
+
+void SimpleC2WorkerPool::Client::setRunning(bool running) {
+    std::lock_guard<std::mutex> lock(mPool->mLock);
+    mRunning = running;
+}
+
+void SimpleC2WorkerPool::Client::parallelFor(
+        size_t count, const std::function<void(size_t)> &fn) {
+    if (count <= 1 || mPool->mNumWorkers == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->client = this;
+    job->fn = &fn;
+    job->count = count;
+    job->remaining = count;
+    {
+        std::lock_guard<std::mutex> lock(mPool->mLock);
+        // Do not let a client that was idle catch up on the time it did not use.
+        mVirtualTime = std::max(mVirtualTime, mPool->mVirtualTime);
+        mPool->mJobs.push_back(job);
+    }
+    const size_t wakeups = std::min(count - 1, mPool->mNumWorkers);
+    for (size_t i = 0; i < wakeups; ++i) {
+        mPool->mWorkCond.notify_one();
+    }
+
+    while (runItem(job.get())) {
+    }
+    {
+        std::unique_lock<std::mutex> lock(job->doneLock);
+        job->doneCond.wait(lock, [&job] {
+            return job->remaining.load(std::memory_order_acquire) == 0;
+        });
+    }
+    std::lock_guard<std::mutex> lock(mPool->mLock);
+    mPool->mJobs.remove(job);
+}
+
+size_t SimpleC2WorkerPool::Client::getThreadShare() const {
+    std::lock_guard<std::mutex> lock(mPool->mLock);
+    size_t competing = 0;
+    for (const Client *client : mPool->mClients) {
+        // Stopped clients do not use their threads. This client counts either way,
+        // as it is about to.
+        if ((client == this || client->mRunning) && client->mPriority >= mPriority) {
+            ++competing;
+        }
+    }
+    return std::max((mPool->mNumCpus + competing - 1) / competing, (size_t)1);
+}
+
+}  // namespace android
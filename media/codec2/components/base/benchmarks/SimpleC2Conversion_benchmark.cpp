@@ -0,0 +1,129 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <C2Config.h>
+#include <SimpleC2Component.h>
+
+using namespace android;
+
+/*
+ * Frame conversions of the software decoders and encoders, per frame.
+ * Args: width, height.
+ */
+
+static std::vector<uint16_t> Random10Bit(size_t count) {
+    std::vector<uint16_t> samples(count);
+    for (uint16_t &sample : samples) {
+        sample = rand() & 0x3FF;
+    }
+    return samples;
+}
+
+static void BM_YUV420Planar16ToY410OrRGBA1010102(benchmark::State &state) {
+    const size_t width = state.range(0);
+    const size_t height = state.range(1);
+    std::vector<uint16_t> y = Random10Bit(width * height);
+    std::vector<uint16_t> u = Random10Bit(width * height / 4);
+    std::vector<uint16_t> v = Random10Bit(width * height / 4);
+    std::vector<uint32_t> dst(width * height);
+    auto aspects = std::make_shared<C2ColorAspectsStruct>(
+            C2Color::RANGE_LIMITED, C2Color::PRIMARIES_BT2020, C2Color::TRANSFER_ST2084,
+            C2Color::MATRIX_BT2020);
+
+    for (auto _ : state) {
+        convertYUV420Planar16ToY410OrRGBA1010102(
+                dst.data(), y.data(), u.data(), v.data(), width, width / 2, width / 2, width,
+                width, height, aspects);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+static void BM_YUV420Planar16ToP010(benchmark::State &state) {
+    const size_t width = state.range(0);
+    const size_t height = state.range(1);
+    std::vector<uint16_t> y = Random10Bit(width * height);
+    std::vector<uint16_t> u = Random10Bit(width * height / 4);
+    std::vector<uint16_t> v = Random10Bit(width * height / 4);
+    std::vector<uint16_t> dstY(width * height);
+    std::vector<uint16_t> dstUV(width * height / 2);
+
+    for (auto _ : state) {
+        convertYUV420Planar16ToP010(
+                dstY.data(), dstUV.data(), y.data(), u.data(), v.data(), width, width / 2,
+                width / 2, width, width, width, height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+static void BM_P010ToYUV420Planar16(benchmark::State &state) {
+    const size_t width = state.range(0);
+    const size_t height = state.range(1);
+    std::vector<uint16_t> y = Random10Bit(width * height);
+    std::vector<uint16_t> uv = Random10Bit(width * height / 2);
+    std::vector<uint16_t> dstY(width * height);
+    std::vector<uint16_t> dstU(width * height / 4);
+    std::vector<uint16_t> dstV(width * height / 4);
+
+    for (auto _ : state) {
+        convertP010ToYUV420Planar16(
+                dstY.data(), dstU.data(), dstV.data(), y.data(), uv.data(), width, width,
+                width, width / 2, width / 2, width, height);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+static void BM_RGBA1010102ToYUV420Planar16(benchmark::State &state) {
+    const size_t width = state.range(0);
+    const size_t height = state.range(1);
+    std::vector<uint32_t> src(width * height);
+    for (uint32_t &pixel : src) {
+        pixel = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    }
+    std::vector<uint16_t> dstY(width * height);
+    std::vector<uint16_t> dstU(width * height / 4);
+    std::vector<uint16_t> dstV(width * height / 4);
+
+    for (auto _ : state) {
+        convertRGBA1010102ToYUV420Planar16(
+                dstY.data(), dstU.data(), dstV.data(), src.data(), width, width, height,
+                C2Color::MATRIX_BT2020, C2Color::RANGE_LIMITED);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * width * height);
+}
+
+static void FrameSizes(benchmark::internal::Benchmark *b) {
+    b->ArgNames({"width", "height"});
+    b->Args({1920, 1080});
+    b->Args({3840, 2160});
+}
+
+BENCHMARK(BM_YUV420Planar16ToY410OrRGBA1010102)->Apply(FrameSizes);
+BENCHMARK(BM_YUV420Planar16ToP010)->Apply(FrameSizes);
+BENCHMARK(BM_P010ToYUV420Planar16)->Apply(FrameSizes);
+BENCHMARK(BM_RGBA1010102ToYUV420Planar16)->Apply(FrameSizes);
+
+BENCHMARK_MAIN();
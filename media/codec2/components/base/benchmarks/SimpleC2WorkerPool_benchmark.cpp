@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <SimpleC2WorkerPool.h>
+
+using android::SimpleC2WorkerPool;
+
+static constexpr size_t kWidth = 1920;
+static constexpr size_t kHeight = 1080;
+static constexpr size_t kBandHeight = 64;
+
+static size_t getCpuCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (size_t)count;
+}
+
+/*
+ * Packs a band of 10-bit 4:2:0 rows into 32-bit pixels, roughly the per-frame work of the
+ * Y410 output conversion of the VP9 decoder.
+ */
+static void convertBand(const uint16_t *srcY, const uint16_t *srcU, const uint16_t *srcV,
+                        uint32_t *dst, size_t band) {
+    const size_t top = band * kBandHeight;
+    const size_t bottom = std::min(top + kBandHeight, kHeight);
+    for (size_t y = top; y < bottom; ++y) {
+        const uint16_t *rowY = srcY + y * kWidth;
+        const uint16_t *rowU = srcU + (y / 2) * (kWidth / 2);
+        const uint16_t *rowV = srcV + (y / 2) * (kWidth / 2);
+        uint32_t *rowDst = dst + y * kWidth;
+        for (size_t x = 0; x < kWidth; ++x) {
+            rowDst[x] = (3u << 30) | ((uint32_t)rowV[x / 2] << 20)
+                    | ((uint32_t)rowY[x] << 10) | rowU[x / 2];
+        }
+    }
+}
+
+/*
+ * Every benchmark thread is one decoder converting 1080p frames in bands of rows.
+ * Arg 0: each decoder has its own worker threads, as decoders used to start one converter
+ *        thread per CPU.
+ * Arg 1: all decoders share one process-wide pool.
+ * The total CPU threads are (decoders x CPUs) in the first mode and CPUs in the second.
+ */
+static void BM_ConcurrentConversion(benchmark::State &state) {
+    const size_t numWorkers = getCpuCount() - 1;
+    static const std::shared_ptr<SimpleC2WorkerPool> sSharedPool =
+            SimpleC2WorkerPool::Create(numWorkers);
+    std::shared_ptr<SimpleC2WorkerPool> pool =
+            state.range(0) != 0 ? sSharedPool : SimpleC2WorkerPool::Create(numWorkers);
+    std::shared_ptr<SimpleC2WorkerPool::Client> client = pool->createClient();
+
+    std::vector<uint16_t> srcY(kWidth * kHeight, 0x155);
+    std::vector<uint16_t> srcU(kWidth * kHeight / 4, 0x200);
+    std::vector<uint16_t> srcV(kWidth * kHeight / 4, 0x2AA);
+    std::vector<uint32_t> dst(kWidth * kHeight);
+    const size_t numBands = (kHeight + kBandHeight - 1) / kBandHeight;
+    const std::function<void(size_t)> convert = [&](size_t band) {
+        convertBand(srcY.data(), srcU.data(), srcV.data(), dst.data(), band);
+    };
+
+    for (auto _ : state) {
+        client->parallelFor(numBands, convert);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ConcurrentConversion)
+        ->ArgName("shared")
+        ->Arg(0)
+        ->Arg(1)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -27,6 +27,8 @@
 #include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/Mutexed.h>
 
+#include <SimpleC2WorkerPool.h>
+
 struct C2ColorAspectsStruct;
 
 namespace android {
@@ -37,6 +39,17 @@ void convertYUV420Planar8ToYV12(uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, con
                                 size_t dstUStride, size_t dstVStride, uint32_t width,
                                 uint32_t height, bool isMonochrome = false);
 
+void convertYUV420Planar16ToY410(uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+                                 const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+                                 size_t srcVStride, size_t dstStride, size_t width, size_t height);
+
+void convertYUV420Planar16ToRGBA1010102(
+        uint32_t *dst, const uint16_t *srcY, const uint16_t *srcU,
+        const uint16_t *srcV, size_t srcYStride, size_t srcUStride,
+        size_t srcVStride, size_t dstStride, size_t width,
+        size_t height,
+        std::shared_ptr<const C2ColorAspectsStruct> aspects = nullptr);
+
 void convertYUV420Planar16ToY410OrRGBA1010102(
         uint32_t *dst, const uint16_t *srcY,
         const uint16_t *srcU, const uint16_t *srcV,
@@ -146,6 +159,35 @@ protected:
             uint32_t drainMode,
             const std::shared_ptr<C2BlockPool> &pool) = 0;
 
+    /**
+     * Data prepared by onStage() for process().
+     */
+    struct StagedWork {
+        virtual ~StagedWork() = default;
+    };
+
+    /**
+     * Prepare the given work for process(), e.g. parse codec headers or fetch
+     * output blocks. Only called if pipelining is enabled.
+     *
+     * The work is usually staged on a separate thread while process() runs for
+     * the previous work, in queue order. This method must therefore only access
+     * |work|, |pool| and state that does not change while the component is
+     * running. Config updates of |work| have been applied.
+     *
+     * Client calls such as flush_sm() wait for staging to finish, so |pool|
+     * does not wait for blocks: it returns C2_BLOCKING instead. In that case
+     * return without the block and fetch it in process().
+     *
+     * \param[in]   work    the work to stage
+     * \param[in]   pool    the pool to use for allocating output blocks.
+     *
+     * \return data to retrieve with takeStagedWork() in process(), or nullptr.
+     */
+    virtual std::unique_ptr<StagedWork> onStage(
+            const std::unique_ptr<C2Work> &work,
+            const std::shared_ptr<C2BlockPool> &pool);
+
     // for derived classes
     /**
      * Finish pending work.
@@ -185,6 +227,34 @@ protected:
             const std::shared_ptr<C2GraphicBlock> &block,
             const C2Rect &crop);
 
+    /**
+     * Run |fn(i)| for each i in [0, |count|) on the calling thread and on the worker
+     * threads shared by the software components of this process. Returns when all
+     * items have completed.
+     *
+     * Workers are shared according to C2RealTimePriorityTuning and C2OperatingRateTuning
+     * if the component supports them.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+    /**
+     * Get the number of threads to give a codec library that runs its own threads,
+     * so that concurrent components do not oversubscribe the CPUs.
+     */
+    size_t getThreadShare();
+
+    /**
+     * Enable pipelined processing, where onStage() of the next work overlaps
+     * with process() of the current one. Must be called from the constructor.
+     * Has no effect if debug.stagefright.c2.pipelining is set to false.
+     */
+    void enablePipelining();
+
+    /**
+     * Retrieve the result of onStage() for the work in process(), or nullptr.
+     */
+    std::unique_ptr<StagedWork> takeStagedWork();
+
     static constexpr uint32_t NO_DRAIN = ~0u;
 
     C2ReadView mDummyReadView;
@@ -193,6 +263,13 @@ protected:
 private:
     const std::shared_ptr<C2ComponentInterface> mIntf;
 
+    // created on first use, accessed on the WorkHandler thread only
+    std::shared_ptr<SimpleC2WorkerPool::Client> mWorkerPoolClient;
+    bool mWorkerPoolRunning = false;
+    const std::shared_ptr<SimpleC2WorkerPool::Client> &getWorkerPoolClient();
+    void updateWorkerPoolPriority();
+    void setWorkerPoolRunning(bool running);
+
     class WorkHandler : public AHandler {
     public:
         enum {
@@ -202,6 +279,7 @@ private:
             kWhatStop,
             kWhatReset,
             kWhatRelease,
+            kWhatStage,
         };
 
         WorkHandler();
@@ -234,11 +312,17 @@ private:
     sp<ALooper> mLooper;
     sp<WorkHandler> mHandler;
 
+    // set if pipelining is enabled
+    sp<ALooper> mStageLooper;
+    sp<WorkHandler> mStageHandler;
+    // accessed on the WorkHandler thread only
+    std::unique_ptr<StagedWork> mStagedWork;
+
     class WorkQueue {
     public:
         typedef std::unordered_map<uint64_t, std::unique_ptr<C2Work>> PendingWork;
 
-        inline WorkQueue() : mFlush(false), mGeneration(0ul) {}
+        inline WorkQueue() : mFlush(false), mGeneration(0ul), mStaging(false) {}
 
         inline uint64_t generation() const { return mGeneration; }
         inline void incGeneration() { ++mGeneration; mFlush = true; }
@@ -256,19 +340,48 @@ private:
         void clear();
         PendingWork &pending() { return mPendingWork; }
 
+        // for pipelining
+        std::unique_ptr<StagedWork> takeFrontStaged();
+        bool isFrontStaged() const;
+        // Mark the front work as being staged with |pool| if it can be staged
+        // ahead of processing.
+        bool startStaging(const std::shared_ptr<C2BlockPool> &pool);
+        void finishStaging(std::unique_ptr<StagedWork> staged);
+        inline bool isStaging() const { return mStaging; }
+        inline const std::unique_ptr<C2Work> &stagingWork() const {
+            return mQueue.front().work;
+        }
+        inline const std::shared_ptr<C2BlockPool> &stagingPool() const {
+            return mStagingPool;
+        }
+        inline Condition &stagedCond() { return mStagedCond; }
+
     private:
         struct Entry {
             std::unique_ptr<C2Work> work;
             uint32_t drainMode;
+            bool isStaged;
+            std::unique_ptr<StagedWork> staged;
         };
 
         bool mFlush;
         uint64_t mGeneration;
         std::list<Entry> mQueue;
         PendingWork mPendingWork;
+        // the front work is being staged; it must not be removed until staged
+        bool mStaging;
+        std::shared_ptr<C2BlockPool> mStagingPool;
+        Condition mStagedCond;
     };
     Mutexed<WorkQueue> mWorkQueue;
 
+    // Wait until no work is being staged.
+    void waitForStaging_l(Mutexed<WorkQueue>::Locked &queue);
+    // Stage the front work on the staging thread if possible.
+    void stageAhead();
+    // Called on the staging thread.
+    void stageFront();
+
     class BlockingBlockPool;
     std::shared_ptr<BlockingBlockPool> mOutputBlockPool;
 
@@ -123,6 +123,10 @@ public:
         /// must add support for C2ComponentTimeStretchTuning.
         void noTimeStretch();
 
+        /// Adds support for C2RealTimePriorityTuning and C2OperatingRateTuning, which
+        /// SimpleC2Component uses to share worker threads between components.
+        void addPriorityTuning();
+
         std::shared_ptr<C2ApiLevelSetting> mApiLevel;
         std::shared_ptr<C2ApiFeaturesSetting> mApiFeatures;
 
@@ -135,6 +139,8 @@ public:
         std::shared_ptr<C2ComponentDomainSetting> mDomain;
         std::shared_ptr<C2ComponentAttributesSetting> mAttrib;
         std::shared_ptr<C2ComponentTimeStretchTuning> mTimeStretch;
+        std::shared_ptr<C2RealTimePriorityTuning> mRealTimePriority;
+        std::shared_ptr<C2OperatingRateTuning> mOperatingRate;
 
         std::shared_ptr<C2PortMediaTypeSetting::input> mInputMediaType;
         std::shared_ptr<C2PortMediaTypeSetting::output> mOutputMediaType;
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SIMPLE_C2_WORKER_POOL_H_
+#define SIMPLE_C2_WORKER_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android {
+
+/**
+ * Worker threads shared by all software components of the process.
+ *
+ * Components split frame- or tile-level work into jobs of independent items and run them
+ * with Client::parallelFor(). The calling thread works on its own job while idle workers
+ * steal the remaining items, so a job always completes even if every worker is busy with
+ * other components.
+ *
+ * When several jobs are pending, a free worker serves the client with the highest priority
+ * first and, among clients of equal priority, the one that has received the least worker
+ * time relative to its operating rate.
+ *
+ * Workers run at ANDROID_PRIORITY_AUDIO, like the conversion threads the components ran
+ * before, so that they are not preempted by the normal priority threads of the process.
+ *
+ * The pool exists while any client does.
+ */
+class SimpleC2WorkerPool : public std::enable_shared_from_this<SimpleC2WorkerPool> {
+public:
+    class Client;
+
+    /**
+     * Returns the pool of this process, creating it if needed.
+     */
+    static std::shared_ptr<SimpleC2WorkerPool> GetInstance();
+
+    /**
+     * Creates a pool with the given number of worker threads, for tests and benchmarks.
+     * Components should use GetInstance().
+     */
+    static std::shared_ptr<SimpleC2WorkerPool> Create(size_t numWorkers);
+
+    ~SimpleC2WorkerPool();
+
+    std::shared_ptr<Client> createClient();
+
+    size_t getNumWorkers() const { return mNumWorkers; }
+
+    /**
+     * A component using the pool.
+     */
+    class Client {
+    public:
+        ~Client();
+
+        /**
+         * Sets the scheduling parameters of this client.
+         *
+         * \param priority      C2RealTimePriorityTuning value. 0 is realtime and lower
+         *                      values are progressively more in the background.
+         * \param operatingRate C2OperatingRateTuning value, or 0 if unknown. Clients of the
+         *                      same priority receive worker time in proportion to it.
+         */
+        void setPriority(int32_t priority, float operatingRate);
+
+        /**
+         * Sets whether this client is running, i.e. between start and stop of the
+         * component. Clients are created stopped.
+         */
+        void setRunning(bool running);
+
+        /**
+         * Runs |fn(i)| for each i in [0, |count|) and returns when all have completed.
+         * The calling thread runs items too. Items may run concurrently and in any order.
+         * Must not be called from an item of another job.
+         */
+        void parallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+        /**
+         * Number of threads this client should give a codec library that runs its own
+         * threads: the CPUs shared by this client and every running client of the same or
+         * higher priority, and at least 1.
+         */
+        size_t getThreadShare() const;
+
+    private:
+        friend class SimpleC2WorkerPool;
+        explicit Client(const std::shared_ptr<SimpleC2WorkerPool> &pool);
+
+        const std::shared_ptr<SimpleC2WorkerPool> mPool;
+        // the following are guarded by mPool->mLock
+        int32_t mPriority = 0;
+        bool mRunning = false;
+        float mWeight;
+        double mVirtualTime = 0.;
+    };
+
+private:
+    struct Job {
+        Client *client;
+        const std::function<void(size_t)> *fn;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> remaining;
+        std::mutex doneLock;
+        std::condition_variable doneCond;
+    };
+
+    explicit SimpleC2WorkerPool(size_t numWorkers);
+    void start();
+    void workerLoop();
+    // Returns the job to serve next, or nullptr if no pending job has items left.
+    std::shared_ptr<Job> pickJob_l();
+    static bool runItem(Job *job);
+
+    const size_t mNumCpus;
+    const size_t mNumWorkers;
+
+    std::mutex mLock;
+    std::condition_variable mWorkCond;
+    std::list<std::shared_ptr<Job>> mJobs;
+    std::list<Client *> mClients;
+    double mVirtualTime = 0.;
+    bool mExiting = false;
+
+    std::vector<std::thread> mWorkers;
+};
+
+}  // namespace android
+
+#endif  // SIMPLE_C2_WORKER_POOL_H_
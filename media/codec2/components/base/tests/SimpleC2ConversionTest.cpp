@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <C2Config.h>
+#include <SimpleC2Component.h>
+
+// Checks the vectorized pixel format conversions of SimpleC2Component against
+// scalar reference implementations, for sizes that exercise the vector blocks and the
+// remaining pixels of each row.
+
+namespace android {
+
+namespace {
+
+constexpr size_t kStridePadding = 24;
+
+std::vector<uint16_t> Random10Bit(size_t count) {
+    std::vector<uint16_t> samples(count);
+    for (uint16_t &sample : samples) {
+        sample = rand() & 0x3FF;
+    }
+    return samples;
+}
+
+struct Coeffs {
+    int32_t _y, _r_v, _g_u, _g_v, _b_u, _c16;
+};
+
+Coeffs GetCoeffs(C2Color::matrix_t matrix, C2Color::range_t range) {
+    bool isFullRange = range == C2Color::RANGE_FULL;
+    switch (matrix) {
+        case C2Color::MATRIX_BT601:
+            return isFullRange ? Coeffs{ 1024, 1436, 352, 731, 1815, 0 }
+                               : Coeffs{ 1196, 1639, 402, 835, 2072, 64 };
+        case C2Color::MATRIX_BT709:
+            return isFullRange ? Coeffs{ 1024, 1613, 192, 479, 1900, 0 }
+                               : Coeffs{ 1196, 1841, 219, 547, 2169, 64 };
+        default:
+            return isFullRange ? Coeffs{ 1024, 1510, 169, 585, 1927, 0 }
+                               : Coeffs{ 1196, 1724, 192, 668, 2200, 64 };
+    }
+}
+
+uint32_t RefY410(uint16_t y, uint16_t u, uint16_t v) {
+    return 3u << 30 | (v << 20) | (y << 10) | u;
+}
+
+uint32_t RefRGBA1010102(uint16_t y, uint16_t u, uint16_t v, const Coeffs &c) {
+    int32_t yMult = (y - c._c16) * c._y + 512;
+    int32_t b = (yMult + (u - 512) * c._b_u) / 1024;
+    int32_t g = (yMult - (v - 512) * c._g_v - (u - 512) * c._g_u) / 1024;
+    int32_t r = (yMult + (v - 512) * c._r_v) / 1024;
+    b = std::clamp(b, 0, 1023);
+    g = std::clamp(g, 0, 1023);
+    r = std::clamp(r, 0, 1023);
+    return 3u << 30 | (b << 20) | (g << 10) | r;
+}
+
+}  // namespace
+
+class YUV420Planar16Test : public ::testing::TestWithParam<std::tuple<size_t, size_t>> {
+protected:
+    void SetUp() override {
+        std::tie(mWidth, mHeight) = GetParam();
+        mYStride = mWidth + kStridePadding;
+        mUVStride = mWidth / 2 + kStridePadding;
+        mY = Random10Bit(mYStride * mHeight);
+        mU = Random10Bit(mUVStride * mHeight / 2);
+        mV = Random10Bit(mUVStride * mHeight / 2);
+    }
+
+    size_t mWidth;
+    size_t mHeight;
+    size_t mYStride;
+    size_t mUVStride;
+    std::vector<uint16_t> mY;
+    std::vector<uint16_t> mU;
+    std::vector<uint16_t> mV;
+};
+
+TEST_P(YUV420Planar16Test, ToY410) {
+    const size_t dstStride = mWidth + kStridePadding;
+    std::vector<uint32_t> dst(dstStride * mHeight, 0u);
+    convertYUV420Planar16ToY410(
+            dst.data(), mY.data(), mU.data(), mV.data(), mYStride, mUVStride, mUVStride,
+            dstStride, mWidth, mHeight);
+    for (size_t y = 0; y < mHeight; ++y) {
+        for (size_t x = 0; x < mWidth; ++x) {
+            uint16_t luma = mY[y * mYStride + x];
+            uint16_t u = mU[y / 2 * mUVStride + x / 2];
+            uint16_t v = mV[y / 2 * mUVStride + x / 2];
+            uint32_t expected = RefY410(luma, u, v);
+            // the scalar code leaves the alpha of the last two pixels of a row clear if
+            // the width is not a multiple of 4
+            if (mWidth % 4 != 0 && x >= mWidth - 2) {
+                expected &= ~(3u << 30);
+            }
+            ASSERT_EQ(expected, dst[y * dstStride + x]) << "at (" << x << ", " << y << ")";
+        }
+        for (size_t x = mWidth; x < dstStride; ++x) {
+            ASSERT_EQ(0u, dst[y * dstStride + x]) << "wrote past width";
+        }
+    }
+}
+
+TEST_P(YUV420Planar16Test, ToRGBA1010102) {
+    const size_t dstStride = mWidth + kStridePadding;
+    const C2Color::matrix_t matrices[] = {
+            C2Color::MATRIX_BT601, C2Color::MATRIX_BT709, C2Color::MATRIX_BT2020 };
+    const C2Color::range_t ranges[] = { C2Color::RANGE_FULL, C2Color::RANGE_LIMITED };
+    for (C2Color::matrix_t matrix : matrices) {
+        for (C2Color::range_t range : ranges) {
+            auto aspects = std::make_shared<C2ColorAspectsStruct>(
+                    range, C2Color::PRIMARIES_UNSPECIFIED, C2Color::TRANSFER_UNSPECIFIED,
+                    matrix);
+            std::vector<uint32_t> dst(dstStride * mHeight, 0u);
+            convertYUV420Planar16ToRGBA1010102(
+                    dst.data(), mY.data(), mU.data(), mV.data(), mYStride, mUVStride,
+                    mUVStride, dstStride, mWidth, mHeight, aspects);
+
+            const Coeffs coeffs = GetCoeffs(matrix, range);
+            for (size_t y = 0; y < mHeight; ++y) {
+                for (size_t x = 0; x < mWidth; ++x) {
+                    uint16_t luma = mY[y * mYStride + x];
+                    uint16_t u = mU[y / 2 * mUVStride + x / 2];
+                    uint16_t v = mV[y / 2 * mUVStride + x / 2];
+                    ASSERT_EQ(RefRGBA1010102(luma, u, v, coeffs), dst[y * dstStride + x])
+                            << "at (" << x << ", " << y << ") matrix " << matrix
+                            << " range " << range;
+                }
+                for (size_t x = mWidth; x < dstStride; ++x) {
+                    ASSERT_EQ(0u, dst[y * dstStride + x]) << "wrote past width";
+                }
+            }
+        }
+    }
+}
+
+TEST_P(YUV420Planar16Test, ToP010AndBack) {
+    const size_t dstYStride = mWidth + kStridePadding;
+    const size_t dstUVStride = mWidth + kStridePadding;
+    std::vector<uint16_t> dstY(dstYStride * mHeight, 0u);
+    std::vector<uint16_t> dstUV(dstUVStride * mHeight / 2, 0u);
+    convertYUV420Planar16ToP010(
+            dstY.data(), dstUV.data(), mY.data(), mU.data(), mV.data(), mYStride, mUVStride,
+            mUVStride, dstYStride, dstUVStride, mWidth, mHeight);
+    for (size_t y = 0; y < mHeight; ++y) {
+        for (size_t x = 0; x < mWidth; ++x) {
+            ASSERT_EQ(mY[y * mYStride + x] << 6, dstY[y * dstYStride + x])
+                    << "Y at (" << x << ", " << y << ")";
+        }
+    }
+    for (size_t y = 0; y < mHeight / 2; ++y) {
+        for (size_t x = 0; x < (mWidth + 1) / 2; ++x) {
+            ASSERT_EQ(mU[y * mUVStride + x] << 6, dstUV[y * dstUVStride + 2 * x])
+                    << "U at (" << x << ", " << y << ")";
+            ASSERT_EQ(mV[y * mUVStride + x] << 6, dstUV[y * dstUVStride + 2 * x + 1])
+                    << "V at (" << x << ", " << y << ")";
+        }
+        ASSERT_EQ(0u, dstUV[y * dstUVStride + 2 * ((mWidth + 1) / 2)]) << "wrote past width";
+    }
+
+    std::vector<uint16_t> y16(mYStride * mHeight, 0u);
+    std::vector<uint16_t> u16(mUVStride * mHeight / 2, 0u);
+    std::vector<uint16_t> v16(mUVStride * mHeight / 2, 0u);
+    convertP010ToYUV420Planar16(
+            y16.data(), u16.data(), v16.data(), dstY.data(), dstUV.data(), dstYStride,
+            dstUVStride, mYStride, mUVStride, mUVStride, mWidth, mHeight);
+    for (size_t y = 0; y < mHeight; ++y) {
+        for (size_t x = 0; x < mWidth; ++x) {
+            ASSERT_EQ(mY[y * mYStride + x], y16[y * mYStride + x])
+                    << "Y at (" << x << ", " << y << ")";
+        }
+    }
+    for (size_t y = 0; y < mHeight / 2; ++y) {
+        for (size_t x = 0; x < (mWidth + 1) / 2; ++x) {
+            ASSERT_EQ(mU[y * mUVStride + x], u16[y * mUVStride + x])
+                    << "U at (" << x << ", " << y << ")";
+            ASSERT_EQ(mV[y * mUVStride + x], v16[y * mUVStride + x])
+                    << "V at (" << x << ", " << y << ")";
+        }
+        ASSERT_EQ(0u, u16[y * mUVStride + (mWidth + 1) / 2]) << "wrote past width";
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        Sizes, YUV420Planar16Test,
+        ::testing::Combine(::testing::Values(2, 6, 8, 14, 16, 30, 48, 176, 1922),
+                           ::testing::Values(2, 4, 18)));
+
+class RGBA1010102Test : public ::testing::TestWithParam<std::tuple<size_t, size_t>> {};
+
+TEST_P(RGBA1010102Test, ToYUV420Planar16) {
+    size_t width, height;
+    std::tie(width, height) = GetParam();
+    const size_t srcStride = width + kStridePadding;
+    std::vector<uint32_t> src(srcStride * height);
+    for (uint32_t &pixel : src) {
+        pixel = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    }
+
+    const C2Color::matrix_t matrices[] = { C2Color::MATRIX_BT709, C2Color::MATRIX_BT2020 };
+    const C2Color::range_t ranges[] = { C2Color::RANGE_FULL, C2Color::RANGE_LIMITED };
+    for (C2Color::matrix_t matrix : matrices) {
+        for (C2Color::range_t range : ranges) {
+            // The planes are packed, with chroma rows of width / 2.
+            std::vector<uint16_t> dstY(width * height + kStridePadding, 0u);
+            std::vector<uint16_t> dstU(width * height / 4 + kStridePadding, 0u);
+            std::vector<uint16_t> dstV(width * height / 4 + kStridePadding, 0u);
+            convertRGBA1010102ToYUV420Planar16(
+                    dstY.data(), dstU.data(), dstV.data(), src.data(), srcStride, width,
+                    height, matrix, range);
+
+            static const int16_t bt709[2][3][3] = {
+                { { 218, 732, 74 }, { -117, -395, 512 }, { 512, -465, -47 } },
+                { { 186, 627, 63 }, { -103, -345, 448 }, { 448, -407, -41 } },
+            };
+            static const int16_t bt2020[2][3][3] = {
+                { { 269, 694, 61 }, { -143, -369, 512 }, { 512, -471, -41 } },
+                { { 230, 594, 52 }, { -125, -323, 448 }, { 448, -412, -36 } },
+            };
+            const bool isFullRange = range == C2Color::RANGE_FULL;
+            const int16_t (*w)[3] = (matrix == C2Color::MATRIX_BT709)
+                    ? bt709[isFullRange ? 0 : 1] : bt2020[isFullRange ? 0 : 1];
+            const int32_t zero = isFullRange ? 0 : 64;
+            const int32_t maxLuma = isFullRange ? 1023 : 940;
+            const int32_t maxChroma = isFullRange ? 1023 : 960;
+
+            for (size_t y = 0; y < height; ++y) {
+                for (size_t x = 0; x < width; ++x) {
+                    uint32_t pixel = src[y * srcStride + x];
+                    int32_t b = (pixel >> 20) & 0x3FF;
+                    int32_t g = (pixel >> 10) & 0x3FF;
+                    int32_t r = pixel & 0x3FF;
+                    int32_t luma = ((r * w[0][0] + g * w[0][1] + b * w[0][2] + 512) >> 10)
+                            + zero;
+                    ASSERT_EQ(std::clamp(luma, zero, maxLuma), dstY[y * width + x])
+                            << "Y at (" << x << ", " << y << ")";
+                    if (y % 2 == 0 && x % 2 == 0) {
+                        int32_t u = ((r * w[1][0] + g * w[1][1] + b * w[1][2] + 512) >> 10)
+                                + 512;
+                        int32_t v = ((r * w[2][0] + g * w[2][1] + b * w[2][2] + 512) >> 10)
+                                + 512;
+                        size_t index = y / 2 * (width / 2) + x / 2;
+                        ASSERT_EQ(std::clamp(u, zero, maxChroma), dstU[index])
+                                << "U at (" << x << ", " << y << ")";
+                        ASSERT_EQ(std::clamp(v, zero, maxChroma), dstV[index])
+                                << "V at (" << x << ", " << y << ")";
+                    }
+                }
+            }
+            ASSERT_EQ(0u, dstY[width * height]) << "wrote past the Y plane";
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        Sizes, RGBA1010102Test,
+        ::testing::Combine(::testing::Values(2, 6, 8, 14, 16, 30, 48, 176, 1922),
+                           ::testing::Values(2, 4, 18)));
+
+}  // namespace android
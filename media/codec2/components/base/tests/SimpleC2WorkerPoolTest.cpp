@@ -0,0 +1,295 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <SimpleC2WorkerPool.h>
+
+// Checks that SimpleC2WorkerPool runs every item of a job, serves pending jobs by priority
+// and operating rate, shares the CPUs among running clients, and tears down cleanly.
+
+namespace android {
+
+namespace {
+
+// Records which client each item run by a pool worker belongs to, and lets the test
+// hold the items run by the threads calling parallelFor().
+class Recorder {
+public:
+    void open() {
+        std::lock_guard<std::mutex> lock(mLock);
+        mOpen = true;
+        mCond.notify_all();
+    }
+
+    // Called by an item of |client|. Items run by |caller| wait until open().
+    void onItem(int client, std::thread::id caller) {
+        std::unique_lock<std::mutex> lock(mLock);
+        if (std::this_thread::get_id() == caller) {
+            ++mCallersWaiting;
+            mCond.notify_all();
+            mCond.wait(lock, [this] { return mOpen; });
+        } else {
+            mWorkerItems.push_back(client);
+            mCond.notify_all();
+        }
+    }
+
+    void waitForCallers(int count) {
+        std::unique_lock<std::mutex> lock(mLock);
+        mCond.wait(lock, [this, count] { return mCallersWaiting >= count; });
+    }
+
+    void waitForWorkerItems(size_t count) {
+        std::unique_lock<std::mutex> lock(mLock);
+        mCond.wait(lock, [this, count] { return mWorkerItems.size() >= count; });
+    }
+
+    std::vector<int> workerItems() {
+        std::lock_guard<std::mutex> lock(mLock);
+        return mWorkerItems;
+    }
+
+private:
+    std::mutex mLock;
+    std::condition_variable mCond;
+    bool mOpen = false;
+    int mCallersWaiting = 0;
+    std::vector<int> mWorkerItems;
+};
+
+// Keeps the only worker of a pool busy until release().
+class WorkerBlocker {
+public:
+    explicit WorkerBlocker(const std::shared_ptr<SimpleC2WorkerPool> &pool)
+        : mClient(pool->createClient()) {
+        mThread = std::thread([this] {
+            mClient->parallelFor(2, [this](size_t) {
+                std::unique_lock<std::mutex> lock(mLock);
+                ++mStarted;
+                mCond.notify_all();
+                mCond.wait(lock, [this] { return mReleased; });
+            });
+        });
+        std::unique_lock<std::mutex> lock(mLock);
+        mCond.wait(lock, [this] { return mStarted == 2; });
+    }
+
+    ~WorkerBlocker() {
+        release();
+        mThread.join();
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mLock);
+        mReleased = true;
+        mCond.notify_all();
+    }
+
+private:
+    std::shared_ptr<SimpleC2WorkerPool::Client> mClient;
+    std::thread mThread;
+    std::mutex mLock;
+    std::condition_variable mCond;
+    int mStarted = 0;
+    bool mReleased = false;
+};
+
+size_t CpuCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count < 1 ? 1 : (size_t)count;
+}
+
+}  // namespace
+
+TEST(SimpleC2WorkerPoolTest, RunsEveryItemOnce) {
+    std::shared_ptr<SimpleC2WorkerPool> pool = SimpleC2WorkerPool::Create(3);
+    std::shared_ptr<SimpleC2WorkerPool::Client> client = pool->createClient();
+    for (size_t count : {0u, 1u, 2u, 1000u}) {
+        std::vector<std::atomic<int>> runs(count);
+        client->parallelFor(count, [&runs](size_t i) { runs[i].fetch_add(1); });
+        for (size_t i = 0; i < count; ++i) {
+            EXPECT_EQ(1, runs[i].load()) << "item " << i << " of " << count;
+        }
+    }
+}
+
+TEST(SimpleC2WorkerPoolTest, ConcurrentClientsComplete) {
+    constexpr int kNumClients = 4;
+    constexpr size_t kNumItems = 200;
+    std::shared_ptr<SimpleC2WorkerPool> pool = SimpleC2WorkerPool::Create(2);
+    std::vector<std::atomic<size_t>> sums(kNumClients);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < kNumClients; ++c) {
+        threads.emplace_back([&pool, &sums, c] {
+            std::shared_ptr<SimpleC2WorkerPool::Client> client = pool->createClient();
+            for (int round = 0; round < 20; ++round) {
+                client->parallelFor(kNumItems, [&sums, c](size_t i) { sums[c] += i; });
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    for (int c = 0; c < kNumClients; ++c) {
+        EXPECT_EQ(20 * kNumItems * (kNumItems - 1) / 2, sums[c].load()) << "client " << c;
+    }
+}
+
+// A free worker serves the pending job of the higher priority client first, even if it
+// was queued last.
+TEST(SimpleC2WorkerPoolTest, ServesHigherPriorityFirst) {
+    std::shared_ptr<SimpleC2WorkerPool> pool = SimpleC2WorkerPool::Create(1);
+    std::shared_ptr<SimpleC2WorkerPool::Client> background = pool->createClient();
+    std::shared_ptr<SimpleC2WorkerPool::Client> realtime = pool->createClient();
+    background->setPriority(-10, 30.f);
+    realtime->setPriority(0, 30.f);
+
+    Recorder recorder;
+    std::vector<std::thread> threads;
+    {
+        WorkerBlocker blocker(pool);
+        int numCallers = 0;
+        for (auto [id, client] : {std::make_pair(0, background), std::make_pair(1, realtime)}) {
+            threads.emplace_back([&recorder, id = id, client = client] {
+                const std::thread::id caller = std::this_thread::get_id();
+                client->parallelFor(4, [&recorder, id, caller](size_t) {
+                    recorder.onItem(id, caller);
+                });
+            });
+            // Queue the jobs in order: the caller is blocked in its first item.
+            recorder.waitForCallers(++numCallers);
+        }
+    }
+    // The callers would run the items left once they are let go.
+    recorder.waitForWorkerItems(6);
+    recorder.open();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const std::vector<int> items = recorder.workerItems();
+    ASSERT_EQ(6u, items.size());
+    EXPECT_EQ(std::vector<int>({1, 1, 1, 0, 0, 0}), items);
+}
+
+// Among clients of the same priority, a free worker splits its time in proportion to the
+// operating rates.
+TEST(SimpleC2WorkerPoolTest, SharesByOperatingRate) {
+    constexpr size_t kNumItems = 31;  // per client, including the item run by the caller
+    std::shared_ptr<SimpleC2WorkerPool> pool = SimpleC2WorkerPool::Create(1);
+    std::shared_ptr<SimpleC2WorkerPool::Client> slow = pool->createClient();
+    std::shared_ptr<SimpleC2WorkerPool::Client> fast = pool->createClient();
+    slow->setPriority(0, 30.f);
+    fast->setPriority(0, 60.f);
+
+    Recorder recorder;
+    std::vector<std::thread> threads;
+    {
+        WorkerBlocker blocker(pool);
+        int numCallers = 0;
+        for (auto [id, client] : {std::make_pair(0, slow), std::make_pair(1, fast)}) {
+            threads.emplace_back([&recorder, id = id, client = client] {
+                const std::thread::id caller = std::this_thread::get_id();
+                client->parallelFor(kNumItems, [&recorder, id, caller](size_t) {
+                    recorder.onItem(id, caller);
+                });
+            });
+            recorder.waitForCallers(++numCallers);
+        }
+    }
+    recorder.waitForWorkerItems(2 * (kNumItems - 1));
+    recorder.open();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const std::vector<int> items = recorder.workerItems();
+    ASSERT_EQ(2 * (kNumItems - 1), items.size());
+    // While both jobs have items left, the fast client gets two items for each item of
+    // the slow one.
+    for (size_t n = 3; n <= 3 * (kNumItems - 1) / 2; n += 3) {
+        const size_t numFast = std::count(items.begin(), items.begin() + n, 1);
+        EXPECT_NEAR(2. * n / 3., (double)numFast, 1.) << "after " << n << " items";
+    }
+}
+
+TEST(SimpleC2WorkerPoolTest, ThreadShareCountsRunningClients) {
+    const size_t numCpus = CpuCount();
+    std::shared_ptr<SimpleC2WorkerPool> pool = SimpleC2WorkerPool::Create(1);
+    std::shared_ptr<SimpleC2WorkerPool::Client> client = pool->createClient();
+    std::shared_ptr<SimpleC2WorkerPool::Client> other = pool->createClient();
+    std::shared_ptr<SimpleC2WorkerPool::Client> background = pool->createClient();
+    background->setPriority(-1, 0.f);
+
+    // Stopped clients do not count, the client asking always does.
+    EXPECT_EQ(numCpus, client->getThreadShare());
+
+    // Lower priority clients do not count.
+    other->setRunning(true);
+    background->setRunning(true);
+    EXPECT_EQ((numCpus + 1) / 2, client->getThreadShare());
+    EXPECT_EQ((numCpus + 1) / 2, background->getThreadShare());
+
+    client->setRunning(true);
+    EXPECT_EQ((numCpus + 1) / 2, client->getThreadShare());
+    EXPECT_EQ((numCpus + 2) / 3, background->getThreadShare());
+
+    other->setRunning(false);
+    EXPECT_EQ(numCpus, client->getThreadShare());
+    EXPECT_EQ((numCpus + 1) / 2, background->getThreadShare());
+
+    other->setRunning(true);
+    other.reset();
+    EXPECT_EQ(numCpus, client->getThreadShare());
+}
+
+// The pool outlives the references to it while a client exists, and joins its workers
+// when the last client goes away, including while they wait for work.
+TEST(SimpleC2WorkerPoolTest, TearsDownWithLastClient) {
+    std::weak_ptr<SimpleC2WorkerPool> weakPool;
+    {
+        std::shared_ptr<SimpleC2WorkerPool::Client> client;
+        {
+            std::shared_ptr<SimpleC2WorkerPool> pool = SimpleC2WorkerPool::Create(4);
+            weakPool = pool;
+            client = pool->createClient();
+        }
+        ASSERT_FALSE(weakPool.expired());
+        std::atomic<size_t> runs{0};
+        client->parallelFor(100, [&runs](size_t) { ++runs; });
+        EXPECT_EQ(100u, runs.load());
+    }
+    EXPECT_TRUE(weakPool.expired());
+
+    // The process pool is created again after its last client is gone.
+    std::shared_ptr<SimpleC2WorkerPool::Client> client =
+        SimpleC2WorkerPool::GetInstance()->createClient();
+    std::atomic<size_t> runs{0};
+    client->parallelFor(10, [&runs](size_t) { ++runs; });
+    EXPECT_EQ(10u, runs.load());
+}
+
+}  // namespace android
@@ -55,6 +55,7 @@ class C2SoftGav1Dec::IntfImpl : public SimpleInterface<void>::BaseParams {
     noOutputReferences();
     noInputLatency();
     noTimeStretch();
+    addPriorityTuning();
 
     addParameter(DefineParam(mAttrib, C2_PARAMKEY_COMPONENT_ATTRIBUTES)
                      .withConstValue(new C2ComponentAttributesSetting(
@@ -476,19 +477,6 @@ c2_status_t C2SoftGav1Dec::onFlush_sm() {
   return C2_OK;
 }
 
-static int GetCPUCoreCount() {
-  int cpuCoreCount = 1;
-#if defined(_SC_NPROCESSORS_ONLN)
-  cpuCoreCount = sysconf(_SC_NPROCESSORS_ONLN);
-#else
-  // _SC_NPROC_ONLN must be defined...
-  cpuCoreCount = sysconf(_SC_NPROC_ONLN);
-#endif
-  CHECK(cpuCoreCount >= 1);
-  ALOGV("Number of CPU cores: %d", cpuCoreCount);
-  return cpuCoreCount;
-}
-
 bool C2SoftGav1Dec::initDecoder() {
   mSignalledError = false;
   mSignalledOutputEos = false;
@@ -505,7 +493,7 @@ bool C2SoftGav1Dec::initDecoder() {
   }
 
   libgav1::DecoderSettings settings = {};
-  settings.threads = GetCPUCoreCount();
+  settings.threads = getThreadShare();
 
   ALOGV("Using libgav1 AV1 software decoder.");
   Libgav1StatusCode status = mCodecCtx->Init(&settings);
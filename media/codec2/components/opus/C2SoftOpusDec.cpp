@@ -99,6 +99,8 @@ C2SoftOpusDec::C2SoftOpusDec(const char *name, c2_node_id_t id,
         std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
       mIntf(intfImpl),
       mDecoder(nullptr) {
+    // Fetch output blocks while the previous packet is decoded.
+    enablePipelining();
 }
 
 C2SoftOpusDec::~C2SoftOpusDec() {
@@ -375,14 +377,20 @@ void C2SoftOpusDec::process(
     if (work->input.ordinal.timestamp.peeku() == 0) mSamplesToDiscard = mCodecDelay;
 
     std::shared_ptr<C2LinearBlock> block;
-    C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
-    c2_status_t err = pool->fetchLinearBlock(
-                          kMaxNumSamplesPerBuffer * kMaxChannels * sizeof(int16_t),
-                          usage, &block);
-    if (err != C2_OK) {
-        ALOGE("fetchLinearBlock for Output failed with status %d", err);
-        work->result = C2_NO_MEMORY;
-        return;
+    std::unique_ptr<StagedWork> staged = takeStagedWork();
+    if (staged) {
+        block = static_cast<StagedOutput *>(staged.get())->block;
+    }
+    if (!block) {
+        C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+        c2_status_t err = pool->fetchLinearBlock(
+                              kMaxNumSamplesPerBuffer * kMaxChannels * sizeof(int16_t),
+                              usage, &block);
+        if (err != C2_OK) {
+            ALOGE("fetchLinearBlock for Output failed with status %d", err);
+            work->result = C2_NO_MEMORY;
+            return;
+        }
     }
     C2WriteView wView = block->map().get();
     if (wView.error()) {
@@ -436,6 +444,27 @@ void C2SoftOpusDec::process(
     }
 }
 
+std::unique_ptr<SimpleC2Component::StagedWork> C2SoftOpusDec::onStage(
+        const std::unique_ptr<C2Work> &work,
+        const std::shared_ptr<C2BlockPool> &pool) {
+    // Only audio packets need an output block; headers and CSD are handled in process().
+    if (work->input.buffers.empty()
+            || (work->input.flags & C2FrameData::FLAG_CODEC_CONFIG)) {
+        return nullptr;
+    }
+    std::unique_ptr<StagedOutput> staged(new StagedOutput);
+    C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+    c2_status_t err = pool->fetchLinearBlock(
+                          kMaxNumSamplesPerBuffer * kMaxChannels * sizeof(int16_t),
+                          usage, &staged->block);
+    if (err != C2_OK) {
+        // process() fetches the block again and reports the error.
+        ALOGV("fetchLinearBlock for staging failed with status %d", err);
+        return nullptr;
+    }
+    return staged;
+}
+
 class C2SoftOpusDecFactory : public C2ComponentFactory {
 public:
     C2SoftOpusDecFactory() : mHelper(std::static_pointer_cast<C2ReflectorHelper>(
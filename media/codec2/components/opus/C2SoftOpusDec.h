@@ -43,6 +43,9 @@ struct C2SoftOpusDec : public SimpleC2Component {
     c2_status_t drain(
             uint32_t drainMode,
             const std::shared_ptr<C2BlockPool> &pool) override;
+    std::unique_ptr<StagedWork> onStage(
+            const std::unique_ptr<C2Work> &work,
+            const std::shared_ptr<C2BlockPool> &pool) override;
 private:
     enum {
         kMaxNumSamplesPerBuffer = 960 * 6
@@ -59,6 +62,11 @@ private:
     bool mSignalledError;
     bool mSignalledOutputEos;
 
+    // output block fetched by onStage()
+    struct StagedOutput : public StagedWork {
+        std::shared_ptr<C2LinearBlock> block;
+    };
+
     status_t initDecoder();
 
     C2_DO_NOT_COPY(C2SoftOpusDec);
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * Copyright (C) 2021 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ *****************************************************************************
+ * Originally developed and contributed by Ittiam Systems Pvt. Ltd, Bangalore
+ */
+#ifndef ANDROID_C2_SOFT_CODEC_TEST_H
+#define ANDROID_C2_SOFT_CODEC_TEST_H
+
+#include <C2Config.h>
+#include <C2ComponentFactory.h>
+#include <gtest/gtest.h>
+#include <log/log.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+extern "C" ::C2ComponentFactory* CreateCodec2Factory();
+extern "C" void DestroyCodec2Factory(::C2ComponentFactory* factory);
+
+class C2SoftCodecTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    mFactory = CreateCodec2Factory();
+  }
+
+  void TearDown() override {
+    if (mFactory) {
+      DestroyCodec2Factory(mFactory);
+    }
+  }
+
+  c2_status_t createComponent(
+        std::shared_ptr<C2Component>* const comp) {
+    if (!mFactory) {
+      return C2_NO_INIT;
+    }
+    return mFactory->createComponent(
+        kPlaceholderId, comp, std::default_delete<C2Component>());
+  }
+
+  c2_status_t createInterface(
+      std::shared_ptr<C2ComponentInterface>* const intf) {
+    if (!mFactory) {
+      return C2_NO_INIT;
+    }
+    return mFactory->createInterface(
+        kPlaceholderId, intf, std::default_delete<C2ComponentInterface>());
+  }
+
+  ::C2ComponentFactory *getFactory() { return mFactory; }
+
+private:
+  static constexpr ::c2_node_id_t kPlaceholderId = 0;
+
+  ::C2ComponentFactory *mFactory;
+};
+
+// Counts the works returned by a component, and records their frame index and result
+// in the order they are returned.
+class WorkCounter : public C2Component::Listener {
+public:
+  struct DoneWork {
+    uint64_t frameIndex;
+    c2_status_t result;
+  };
+
+  void onWorkDone_nb(std::weak_ptr<C2Component> component,
+                     std::list<std::unique_ptr<C2Work>> workItems) override {
+    (void)component;
+    std::lock_guard<std::mutex> lock(mLock);
+    for (const std::unique_ptr<C2Work> &work : workItems) {
+      if (work->result != C2_OK) {
+        ++mNumErrors;
+      }
+      ++mNumDone;
+      mDoneWork.push_back({work->input.ordinal.frameIndex.peeku(), work->result});
+    }
+    mCond.notify_all();
+  }
+
+  void onTripped_nb(std::weak_ptr<C2Component> component,
+                    std::vector<std::shared_ptr<C2SettingResult>> settingResult) override {
+    (void)component;
+    (void)settingResult;
+  }
+
+  void onError_nb(std::weak_ptr<C2Component> component, uint32_t errorCode) override {
+    (void)component;
+    ALOGE("component error %u", errorCode);
+    std::lock_guard<std::mutex> lock(mLock);
+    ++mNumErrors;
+    mCond.notify_all();
+  }
+
+  bool waitForWork(size_t count, std::chrono::seconds timeout) {
+    std::unique_lock<std::mutex> lock(mLock);
+    return mCond.wait_for(lock, timeout, [this, count] { return mNumDone >= count; });
+  }
+
+  size_t getNumErrors() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mNumErrors;
+  }
+
+  std::vector<DoneWork> getDoneWork() {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mDoneWork;
+  }
+
+private:
+  std::mutex mLock;
+  std::condition_variable mCond;
+  size_t mNumDone = 0;
+  size_t mNumErrors = 0;
+  std::vector<DoneWork> mDoneWork;
+};
+
+#endif  // ANDROID_C2_SOFT_CODEC_TEST_H
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "C2SoftCodecTest.h"
+
+#include <android-base/properties.h>
+#include <C2PlatformSupport.h>
+
+#include <cmath>
+#include <string>
+
+#include <opus.h>
+
+using namespace android;
+
+namespace {
+
+constexpr char kPipeliningProperty[] = "debug.stagefright.c2.pipelining";
+constexpr int kSampleRate = 48000;
+constexpr int kChannels = 2;
+constexpr int kFrameSize = 960;  // 20 ms
+constexpr int64_t kFrameDurationUs = 20000;
+constexpr int kPreSkip = 312;
+
+// Sets the pipelining property for the components created in its scope.
+class ScopedPipelining {
+public:
+  explicit ScopedPipelining(bool enable)
+      : mPrevious(base::GetProperty(kPipeliningProperty, "")) {
+    base::SetProperty(kPipeliningProperty, enable ? "true" : "false");
+  }
+
+  ~ScopedPipelining() {
+    base::SetProperty(kPipeliningProperty, mPrevious);
+  }
+
+private:
+  const std::string mPrevious;
+};
+
+}  // namespace
+
+// Feeds C2SoftOpusDec real Opus packets, so that works are staged ahead of process().
+class C2SoftOpusDecTest : public C2SoftCodecTest {
+public:
+  void SetUp() override {
+    C2SoftCodecTest::SetUp();
+
+    ASSERT_EQ(GetCodec2BlockPool(C2BlockPool::BASIC_LINEAR, nullptr, &mInputPool), C2_OK);
+
+    int err = OPUS_OK;
+    OpusEncoder *encoder = opus_encoder_create(kSampleRate, kChannels,
+                                               OPUS_APPLICATION_AUDIO, &err);
+    ASSERT_EQ(err, OPUS_OK);
+    ASSERT_NE(encoder, nullptr);
+    std::vector<int16_t> pcm(kFrameSize * kChannels);
+    std::vector<uint8_t> packet(1500);
+    for (size_t i = 0; i < kNumPackets; ++i) {
+      for (int s = 0; s < kFrameSize; ++s) {
+        double t = double(i * kFrameSize + s) / kSampleRate;
+        int16_t value = (int16_t)(8000 * std::sin(2 * M_PI * 440 * t));
+        pcm[s * kChannels] = value;
+        pcm[s * kChannels + 1] = value;
+      }
+      int size = opus_encode(encoder, pcm.data(), kFrameSize, packet.data(), packet.size());
+      ASSERT_GT(size, 0) << "opus_encode failed: " << opus_strerror(size);
+      mPackets.emplace_back(packet.begin(), packet.begin() + size);
+    }
+    opus_encoder_destroy(encoder);
+  }
+
+  // Creates and starts a decoder, and queues its three codec config works. Frame
+  // indices restart from zero.
+  void startDecoder(std::shared_ptr<C2Component> *component,
+                    std::shared_ptr<WorkCounter> *listener) {
+    mNextFrameIndex = 0;
+    ASSERT_EQ(createComponent(component), C2_OK);
+    ASSERT_NE(*component, nullptr);
+    *listener = std::make_shared<WorkCounter>();
+    ASSERT_EQ((*component)->setListener_vb(*listener, C2_MAY_BLOCK), C2_OK);
+    ASSERT_EQ((*component)->start(), C2_OK);
+
+    const uint8_t opusHead[] = {
+        'O', 'p', 'u', 's', 'H', 'e', 'a', 'd',
+        1,                                   // version
+        kChannels,
+        kPreSkip & 0xff, kPreSkip >> 8,      // pre-skip
+        0x80, 0xbb, 0x00, 0x00,              // 48000 Hz
+        0x00, 0x00,                          // output gain
+        0,                                   // channel mapping family
+    };
+    uint64_t codecDelayNs = kPreSkip * 1000000000ull / kSampleRate;
+    uint64_t seekPreRollNs = 80000000ull;
+    queueBuffer(component->get(), opusHead, sizeof(opusHead),
+                C2FrameData::FLAG_CODEC_CONFIG);
+    queueBuffer(component->get(), &codecDelayNs, sizeof(codecDelayNs),
+                C2FrameData::FLAG_CODEC_CONFIG);
+    queueBuffer(component->get(), &seekPreRollNs, sizeof(seekPreRollNs),
+                C2FrameData::FLAG_CODEC_CONFIG);
+  }
+
+  // Queues the next packet, looping over the encoded ones.
+  void queuePacket(C2Component *component, C2FrameData::flags_t flags = (C2FrameData::flags_t)0) {
+    const std::vector<uint8_t> &packet = mPackets[mNextPacket++ % mPackets.size()];
+    queueBuffer(component, packet.data(), packet.size(), flags);
+  }
+
+  uint64_t numQueued() const { return mNextFrameIndex; }
+
+private:
+  void queueBuffer(C2Component *component, const void *data, size_t size,
+                   C2FrameData::flags_t flags) {
+    std::shared_ptr<C2LinearBlock> block;
+    C2MemoryUsage usage = { C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE };
+    ASSERT_EQ(mInputPool->fetchLinearBlock(size, usage, &block), C2_OK);
+    C2WriteView view = block->map().get();
+    ASSERT_EQ(view.error(), C2_OK);
+    memcpy(view.base(), data, size);
+
+    std::unique_ptr<C2Work> work(new C2Work);
+    work->input.flags = flags;
+    work->input.ordinal.timestamp = mNextFrameIndex * kFrameDurationUs;
+    work->input.ordinal.frameIndex = mNextFrameIndex++;
+    work->input.buffers.push_back(C2Buffer::CreateLinearBuffer(block->share(0, size, C2Fence())));
+    work->worklets.emplace_back(new C2Worklet);
+    std::list<std::unique_ptr<C2Work>> items;
+    items.push_back(std::move(work));
+    ASSERT_EQ(component->queue_nb(&items), C2_OK);
+  }
+
+  static constexpr size_t kNumPackets = 50;
+
+  std::shared_ptr<C2BlockPool> mInputPool;
+  std::vector<std::vector<uint8_t>> mPackets;
+  size_t mNextPacket = 0;
+  uint64_t mNextFrameIndex = 0;
+};
+
+// Measures how many works per second the decoder returns with and without staging
+// ahead of process(), one packet queued at a time as a client streaming an offline
+// decode would.
+TEST_F(C2SoftOpusDecTest, ThroughputTest) {
+  constexpr size_t kNumWorks = 2000;
+
+  for (bool pipelined : {false, true}) {
+    SCOPED_TRACE(pipelined ? "pipelined" : "not pipelined");
+    ScopedPipelining scopedPipelining(pipelined);
+    std::shared_ptr<C2Component> component;
+    std::shared_ptr<WorkCounter> listener;
+    ASSERT_NO_FATAL_FAILURE(startDecoder(&component, &listener));
+    uint64_t numConfig = numQueued();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kNumWorks; ++i) {
+      ASSERT_NO_FATAL_FAILURE(queuePacket(
+          component.get(), (i == kNumWorks - 1) ? C2FrameData::FLAG_END_OF_STREAM
+                                                : (C2FrameData::flags_t)0));
+    }
+    ASSERT_TRUE(listener->waitForWork(numConfig + kNumWorks, std::chrono::seconds(30)))
+        << "timed out waiting for work";
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    EXPECT_EQ(listener->getNumErrors(), 0u);
+    double worksPerSecond = kNumWorks / elapsed.count();
+    ALOGI("%s: %zu works in %.3f s: %.0f works/s", pipelined ? "pipelined" : "not pipelined",
+          kNumWorks, elapsed.count(), worksPerSecond);
+    RecordProperty(pipelined ? "pipelined_works_per_second"
+                             : "not_pipelined_works_per_second",
+                   std::to_string((int64_t)worksPerSecond));
+
+    ASSERT_EQ(component->stop(), C2_OK);
+    ASSERT_EQ(component->release(), C2_OK);
+  }
+}
+
+// Flushes and drains while works are being staged, and checks that every work comes
+// back exactly once, either done or flushed, and in queueing order.
+TEST_F(C2SoftOpusDecTest, FlushAndDrainWhileStaging) {
+  constexpr size_t kNumRounds = 20;
+  constexpr size_t kWorksPerRound = 16;
+
+  ScopedPipelining scopedPipelining(true);
+  std::shared_ptr<C2Component> component;
+  std::shared_ptr<WorkCounter> listener;
+  ASSERT_NO_FATAL_FAILURE(startDecoder(&component, &listener));
+  ASSERT_TRUE(listener->waitForWork(numQueued(), std::chrono::seconds(5)));
+
+  std::vector<uint64_t> flushed;
+  for (size_t round = 0; round < kNumRounds; ++round) {
+    for (size_t i = 0; i < kWorksPerRound; ++i) {
+      ASSERT_NO_FATAL_FAILURE(queuePacket(component.get()));
+    }
+    std::list<std::unique_ptr<C2Work>> flushedWork;
+    ASSERT_EQ(component->flush_sm(C2Component::FLUSH_COMPONENT, &flushedWork), C2_OK);
+    for (const std::unique_ptr<C2Work> &work : flushedWork) {
+      flushed.push_back(work->input.ordinal.frameIndex.peeku());
+    }
+    // The work process() was running during the flush comes back as done.
+    ASSERT_TRUE(listener->waitForWork(numQueued() - flushed.size(), std::chrono::seconds(5)))
+        << "round " << round;
+
+    std::vector<WorkCounter::DoneWork> done = listener->getDoneWork();
+    ASSERT_EQ(done.size() + flushed.size(), numQueued()) << "round " << round;
+    for (size_t i = 1; i < done.size(); ++i) {
+      ASSERT_LT(done[i - 1].frameIndex, done[i].frameIndex) << "round " << round;
+    }
+    for (size_t i = 1; i < flushed.size(); ++i) {
+      ASSERT_LT(flushed[i - 1], flushed[i]) << "round " << round;
+    }
+    // Works flushed in this round were all queued after every work that completed.
+    size_t flushedBefore = flushed.size() - flushedWork.size();
+    for (size_t i = flushedBefore; i < flushed.size(); ++i) {
+      ASSERT_GT(flushed[i], done.back().frameIndex) << "round " << round;
+    }
+    std::vector<bool> seen(numQueued(), false);
+    for (const WorkCounter::DoneWork &work : done) {
+      ASSERT_LT(work.frameIndex, numQueued());
+      ASSERT_FALSE(seen[work.frameIndex]) << "work " << work.frameIndex << " returned twice";
+      seen[work.frameIndex] = true;
+    }
+    for (uint64_t frameIndex : flushed) {
+      ASSERT_LT(frameIndex, numQueued());
+      ASSERT_FALSE(seen[frameIndex]) << "work " << frameIndex << " returned twice";
+      seen[frameIndex] = true;
+    }
+  }
+
+  // Works queued around a drain all complete, in order.
+  size_t numDoneBefore = listener->getDoneWork().size();
+  for (size_t i = 0; i < kWorksPerRound; ++i) {
+    ASSERT_NO_FATAL_FAILURE(queuePacket(component.get()));
+  }
+  ASSERT_EQ(component->drain_nb(C2Component::DRAIN_COMPONENT_NO_EOS), C2_OK);
+  for (size_t i = 0; i < kWorksPerRound; ++i) {
+    ASSERT_NO_FATAL_FAILURE(queuePacket(component.get()));
+  }
+  ASSERT_TRUE(listener->waitForWork(numQueued() - flushed.size(), std::chrono::seconds(5)));
+  std::vector<WorkCounter::DoneWork> done = listener->getDoneWork();
+  ASSERT_EQ(done.size(), numDoneBefore + 2 * kWorksPerRound);
+  for (size_t i = numDoneBefore; i < done.size(); ++i) {
+    EXPECT_EQ(done[i].result, C2_OK);
+    EXPECT_LT(done[i - 1].frameIndex, done[i].frameIndex);
+  }
+
+  ASSERT_EQ(component->stop(), C2_OK);
+  ASSERT_EQ(component->release(), C2_OK);
+}
@@ -57,6 +57,7 @@ public:
         noOutputReferences();
         noInputLatency();
         noTimeStretch();
+        addPriorityTuning();
 
         // TODO: output latency and reordering
 
@@ -333,43 +334,13 @@ private:
 #endif
 };
 
-C2SoftVpxDec::ConverterThread::ConverterThread(
-        const std::shared_ptr<Mutexed<ConversionQueue>> &queue)
-    : Thread(false), mQueue(queue) {}
-
-bool C2SoftVpxDec::ConverterThread::threadLoop() {
-    Mutexed<ConversionQueue>::Locked queue(*mQueue);
-    if (queue->entries.empty()) {
-        queue.waitForCondition(queue->cond);
-        if (queue->entries.empty()) {
-            return true;
-        }
-    }
-    std::function<void()> convert = queue->entries.front();
-    queue->entries.pop_front();
-    if (!queue->entries.empty()) {
-        queue->cond.signal();
-    }
-    queue.unlock();
-
-    convert();
-
-    queue.lock();
-    if (--queue->numPending == 0u) {
-        queue->cond.broadcast();
-    }
-    return true;
-}
-
 C2SoftVpxDec::C2SoftVpxDec(
         const char *name,
         c2_node_id_t id,
         const std::shared_ptr<IntfImpl> &intfImpl)
     : SimpleC2Component(std::make_shared<SimpleInterface<IntfImpl>>(name, id, intfImpl)),
       mIntf(intfImpl),
-      mCodecCtx(nullptr),
-      mCoreCount(1),
-      mQueue(new Mutexed<ConversionQueue>) {
+      mCodecCtx(nullptr) {
 }
 
 C2SoftVpxDec::~C2SoftVpxDec() {
@@ -423,19 +394,6 @@ c2_status_t C2SoftVpxDec::onFlush_sm() {
     return C2_OK;
 }
 
-static int GetCPUCoreCount() {
-    int cpuCoreCount = 1;
-#if defined(_SC_NPROCESSORS_ONLN)
-    cpuCoreCount = sysconf(_SC_NPROCESSORS_ONLN);
-#else
-    // _SC_NPROC_ONLN must be defined...
-    cpuCoreCount = sysconf(_SC_NPROC_ONLN);
-#endif
-    CHECK(cpuCoreCount >= 1);
-    ALOGV("Number of CPU cores: %d", cpuCoreCount);
-    return cpuCoreCount;
-}
-
 status_t C2SoftVpxDec::initDecoder() {
 #ifdef VP9
     mMode = MODE_VP9;
@@ -464,7 +422,7 @@ status_t C2SoftVpxDec::initDecoder() {
 
     vpx_codec_dec_cfg_t cfg;
     memset(&cfg, 0, sizeof(vpx_codec_dec_cfg_t));
-    cfg.threads = mCoreCount = GetCPUCoreCount();
+    cfg.threads = getThreadShare();
 
     vpx_codec_flags_t flags;
     memset(&flags, 0, sizeof(vpx_codec_flags_t));
@@ -478,18 +436,6 @@ status_t C2SoftVpxDec::initDecoder() {
         return UNKNOWN_ERROR;
     }
 
-    if (mMode == MODE_VP9) {
-        using namespace std::string_literals;
-        for (int i = 0; i < mCoreCount; ++i) {
-            sp<ConverterThread> thread(new ConverterThread(mQueue));
-            mConverterThreads.push_back(thread);
-            if (thread->run(("vp9conv #"s + std::to_string(i)).c_str(),
-                            ANDROID_PRIORITY_AUDIO) != OK) {
-                return UNKNOWN_ERROR;
-            }
-        }
-    }
-
     return OK;
 }
 
@@ -499,22 +445,6 @@ status_t C2SoftVpxDec::destroyDecoder() {
         delete mCodecCtx;
         mCodecCtx = nullptr;
     }
-    bool running = true;
-    for (const sp<ConverterThread> &thread : mConverterThreads) {
-        thread->requestExit();
-    }
-    while (running) {
-        mQueue->lock()->cond.broadcast();
-        running = false;
-        for (const sp<ConverterThread> &thread : mConverterThreads) {
-            if (thread->isRunning()) {
-                running = true;
-                break;
-            }
-        }
-    }
-    mConverterThreads.clear();
-
     return OK;
 }
 
@@ -775,33 +705,22 @@ status_t C2SoftVpxDec::outputBuffer(
         const uint16_t *srcV = (const uint16_t *)img->planes[VPX_PLANE_V];
 
         if (format == HAL_PIXEL_FORMAT_RGBA_1010102) {
-            Mutexed<ConversionQueue>::Locked queue(*mQueue);
-            size_t i = 0;
+            // Convert bands of rows on the shared worker threads.
             constexpr size_t kHeight = 64;
-            for (; i < mHeight; i += kHeight) {
-                queue->entries.push_back(
-                        [dstY, srcY, srcU, srcV,
-                         srcYStride, srcUStride, srcVStride, dstYStride,
-                         width = mWidth, height = std::min(mHeight - i, kHeight),
-                         defaultColorAspects] {
-                            convertYUV420Planar16ToY410OrRGBA1010102(
-                                    (uint32_t *)dstY, srcY, srcU, srcV, srcYStride / 2,
-                                    srcUStride / 2, srcVStride / 2, dstYStride / sizeof(uint32_t),
-                                    width, height,
-                                    std::static_pointer_cast<const C2ColorAspectsStruct>(
-                                            defaultColorAspects));
-                        });
-                srcY += srcYStride / 2 * kHeight;
-                srcU += srcUStride / 2 * (kHeight / 2);
-                srcV += srcVStride / 2 * (kHeight / 2);
-                dstY += dstYStride * kHeight;
-            }
-            CHECK_EQ(0u, queue->numPending);
-            queue->numPending = queue->entries.size();
-            while (queue->numPending > 0) {
-                queue->cond.signal();
-                queue.waitForCondition(queue->cond);
-            }
+            const size_t numBands = (mHeight + kHeight - 1) / kHeight;
+            parallelFor(numBands, [=, width = mWidth, height = mHeight](size_t band) {
+                const size_t i = band * kHeight;
+                convertYUV420Planar16ToY410OrRGBA1010102(
+                        (uint32_t *)(dstY + dstYStride * i),
+                        srcY + srcYStride / 2 * i,
+                        srcU + srcUStride / 2 * (i / 2),
+                        srcV + srcVStride / 2 * (i / 2),
+                        srcYStride / 2, srcUStride / 2, srcVStride / 2,
+                        dstYStride / sizeof(uint32_t),
+                        width, std::min(height - i, kHeight),
+                        std::static_pointer_cast<const C2ColorAspectsStruct>(
+                                defaultColorAspects));
+            });
         } else if (format == HAL_PIXEL_FORMAT_YCBCR_P010) {
             convertYUV420Planar16ToP010((uint16_t *)dstY, (uint16_t *)dstU, srcY, srcU, srcV,
                                         srcYStride / 2, srcUStride / 2, srcVStride / 2,
@@ -50,19 +50,6 @@ struct C2SoftVpxDec : public SimpleC2Component {
         MODE_VP9,
     } mMode;
 
-    struct ConversionQueue;
-
-    class ConverterThread : public Thread {
-    public:
-        explicit ConverterThread(
-                const std::shared_ptr<Mutexed<ConversionQueue>> &queue);
-        ~ConverterThread() override = default;
-        bool threadLoop() override;
-
-    private:
-        std::shared_ptr<Mutexed<ConversionQueue>> mQueue;
-    };
-
     // configurations used by component in process
     // (TODO: keep this in intf but make them internal only)
     std::shared_ptr<C2StreamPixelFormatInfo::output> mPixelFormatInfo;
@@ -77,15 +64,6 @@ struct C2SoftVpxDec : public SimpleC2Component {
     bool mSignalledOutputEos;
     bool mSignalledError;
 
-    int mCoreCount;
-    struct ConversionQueue {
-        std::list<std::function<void()>> entries;
-        Condition cond;
-        size_t numPending{0u};
-    };
-    std::shared_ptr<Mutexed<ConversionQueue>> mQueue;
-    std::vector<sp<ConverterThread>> mConverterThreads;
-
     status_t initDecoder();
     status_t destroyDecoder();
     void finishWork(uint64_t index, const std::unique_ptr<C2Work> &work,
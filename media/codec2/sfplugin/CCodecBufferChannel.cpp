@@ -1215,6 +1215,7 @@ void CCodecBufferChannel::getOutputBufferArray(Vector<sp<MediaCodecBuffer>> *arr
     if (!output->buffers->isArrayMode()) {
         output->buffers = output->buffers->toArrayMode(output->numSlots);
     }
+    static_cast<OutputBuffersArray*>(output->buffers.get())->keepClientBuffers();
 
     output->buffers->getArray(array);
 }
@@ -1797,6 +1798,12 @@ void CCodecBufferChannel::reset() {
     }
     {
         Mutexed<Output>::Locked output(mOutput);
+        if (output->buffers) {
+            ALOGD("[%s] output: %llu bytes copied, %llu bytes passed without copy",
+                  mName,
+                  (unsigned long long)output->buffers->getBytesCopied(),
+                  (unsigned long long)output->buffers->getBytesWrapped());
+        }
         output->buffers.reset();
     }
     // reset the frames that are being tracked for onFrameRendered callbacks
@@ -2259,6 +2266,18 @@ void CCodecBufferChannel::sendOutputBuffers() {
     constexpr int kMaxReallocTry = 5;
     int reallocTryNum = 0;
 
+    {
+        // Slots of the array held by the client that had a buffer lent to it
+        // get a new buffer once it is returned.
+        Mutexed<Output>::Locked output(mOutput);
+        if (output->buffers && output->buffers->isArrayMode()
+                && static_cast<OutputBuffersArray*>(output->buffers.get())->
+                        replaceReturnedBuffers()) {
+            output.unlock();
+            mCCodecCallback->onOutputBuffersChanged();
+        }
+    }
+
     while (true) {
         Mutexed<Output>::Locked output(mOutput);
         if (!output->buffers) {
@@ -206,11 +206,7 @@ void OutputBuffers::setSkipCutBuffer(int32_t skip, int32_t cut) {
     mSkipCutBuffer = new SkipCutBuffer(skip, cut, mChannelCount);
 }
 
-bool OutputBuffers::convert(
-        const std::shared_ptr<C2Buffer> &src, sp<Codec2Buffer> *dst) {
-    if (src && src->data().type() != C2BufferData::LINEAR) {
-        return false;
-    }
+bool OutputBuffers::needsConversion() {
     int32_t configEncoding = kAudioEncodingPcm16bit;
     int32_t codecEncoding = kAudioEncodingPcm16bit;
     if (mFormat->findInt32("android._codec-pcm-encoding", &codecEncoding)
@@ -234,7 +230,15 @@ bool OutputBuffers::convert(
                 || encoding != mDstEncoding) {
         }
     }
-    if (!mDataConverter) {
+    return mDataConverter != nullptr;
+}
+
+bool OutputBuffers::convert(
+        const std::shared_ptr<C2Buffer> &src, sp<Codec2Buffer> *dst) {
+    if (src && src->data().type() != C2BufferData::LINEAR) {
+        return false;
+    }
+    if (!needsConversion()) {
         return false;
     }
     sp<MediaCodecBuffer> srcBuffer;
@@ -257,6 +261,7 @@ bool OutputBuffers::convert(
         ALOGD("[%s] buffer conversion failed: %d", mName, err);
         return false;
     }
+    mBytesCopied += srcBuffer->size();
     dstBuffer->setFormat(mFormatWithConverter);
     return true;
 }
@@ -578,11 +583,11 @@ void BuffersArrayImpl::initialize(
         if (!ownedByClient) {
             clientBuffer = allocate();
         }
-        mBuffers.push_back({ clientBuffer, impl.mBuffers[i].compBuffer, ownedByClient });
+        mBuffers.push_back({ clientBuffer, impl.mBuffers[i].compBuffer, ownedByClient, false });
     }
     ALOGV("[%s] converted %zu buffers to array mode of %zu", mName, mBuffers.size(), minSize);
     for (size_t i = impl.mBuffers.size(); i < minSize; ++i) {
-        mBuffers.push_back({ allocate(), std::weak_ptr<C2Buffer>(), false });
+        mBuffers.push_back({ allocate(), std::weak_ptr<C2Buffer>(), false, false });
     }
 }
 
@@ -598,8 +603,10 @@ status_t BuffersArrayImpl::grabBuffer(
             if (match(mBuffers[i].clientBuffer)) {
                 mBuffers[i].ownedByClient = true;
                 *buffer = mBuffers[i].clientBuffer;
-                (*buffer)->meta()->clear();
-                (*buffer)->setRange(0, (*buffer)->capacity());
+                if (*buffer) {
+                    (*buffer)->meta()->clear();
+                    (*buffer)->setRange(0, (*buffer)->capacity());
+                }
                 *index = i;
                 return OK;
             }
@@ -610,6 +617,24 @@ status_t BuffersArrayImpl::grabBuffer(
     return allBuffersDontMatch ? NO_MEMORY : WOULD_BLOCK;
 }
 
+void BuffersArrayImpl::lendBuffer(size_t index, const sp<Codec2Buffer> &buffer) {
+    CHECK_LT(index, mBuffers.size());
+    CHECK(mBuffers[index].ownedByClient);
+    mBuffers[index].clientBuffer = buffer;
+    mBuffers[index].lent = true;
+}
+
+bool BuffersArrayImpl::fillEmptySlots(std::function<sp<Codec2Buffer>()> alloc) {
+    bool filled = false;
+    for (Entry &entry : mBuffers) {
+        if (entry.clientBuffer == nullptr) {
+            entry.clientBuffer = alloc();
+            filled = true;
+        }
+    }
+    return filled;
+}
+
 bool BuffersArrayImpl::returnBuffer(
         const sp<MediaCodecBuffer> &buffer,
         std::shared_ptr<C2Buffer> *c2buffer,
@@ -644,6 +669,11 @@ bool BuffersArrayImpl::returnBuffer(
     if (c2buffer) {
         *c2buffer = result;
     }
+    if (release && mBuffers[index].lent) {
+        // Do not keep the component buffer mapped while the slot is free.
+        mBuffers[index].clientBuffer.clear();
+        mBuffers[index].lent = false;
+    }
     return true;
 }
 
@@ -679,6 +709,10 @@ void BuffersArrayImpl::getArray(Vector<sp<MediaCodecBuffer>> *array) const {
 void BuffersArrayImpl::flush() {
     for (Entry &entry : mBuffers) {
         entry.ownedByClient = false;
+        if (entry.lent) {
+            entry.clientBuffer.clear();
+            entry.lent = false;
+        }
     }
 }
 
@@ -686,7 +720,7 @@ void BuffersArrayImpl::realloc(std::function<sp<Codec2Buffer>()> alloc) {
     size_t size = mBuffers.size();
     mBuffers.clear();
     for (size_t i = 0; i < size; ++i) {
-        mBuffers.push_back({ alloc(), std::weak_ptr<C2Buffer>(), false });
+        mBuffers.push_back({ alloc(), std::weak_ptr<C2Buffer>(), false, false });
     }
 }
 
@@ -694,7 +728,7 @@ void BuffersArrayImpl::grow(
         size_t newSize, std::function<sp<Codec2Buffer>()> alloc) {
     CHECK_LT(mBuffers.size(), newSize);
     while (mBuffers.size() < newSize) {
-        mBuffers.push_back({ alloc(), std::weak_ptr<C2Buffer>(), false });
+        mBuffers.push_back({ alloc(), std::weak_ptr<C2Buffer>(), false, false });
     }
 }
 
@@ -1123,16 +1157,36 @@ void OutputBuffersArray::initialize(
     mImpl.initialize(impl, minSize, allocate);
 }
 
+sp<Codec2Buffer> OutputBuffersArray::wrapForClient(const std::shared_ptr<C2Buffer> &buffer) {
+    if (mClientBuffersKept) {
+        return nullptr;
+    }
+    if (!buffer
+            || buffer->data().type() != C2BufferData::LINEAR
+            || buffer->data().linearBlocks().size() != 1u) {
+        return nullptr;
+    }
+    // SkipCutBuffer rewrites the buffer in place.
+    if (mSkipCutBuffer != nullptr || needsConversion()) {
+        return nullptr;
+    }
+    return ConstLinearBlockBuffer::Allocate(mFormat, buffer);
+}
+
 status_t OutputBuffersArray::registerBuffer(
         const std::shared_ptr<C2Buffer> &buffer,
         size_t *index,
         sp<MediaCodecBuffer> *clientBuffer) {
+    sp<Codec2Buffer> wrapped = wrapForClient(buffer);
+    if (wrapped == nullptr) {
+        fillEmptySlots();
+    }
     sp<Codec2Buffer> c2Buffer;
     status_t err = mImpl.grabBuffer(
             index,
             &c2Buffer,
-            [buffer](const sp<Codec2Buffer> &clientBuffer) {
-                return clientBuffer->canCopy(buffer);
+            [buffer, wrapped](const sp<Codec2Buffer> &clientBuffer) {
+                return wrapped != nullptr || clientBuffer->canCopy(buffer);
             });
     if (err == WOULD_BLOCK) {
         ALOGV("[%s] buffers temporarily not available", mName);
@@ -1141,10 +1195,20 @@ status_t OutputBuffersArray::registerBuffer(
         ALOGD("[%s] grabBuffer failed: %d", mName, err);
         return err;
     }
+    if (wrapped != nullptr) {
+        mImpl.lendBuffer(*index, wrapped);
+        *clientBuffer = wrapped;
+        mBytesWrapped += wrapped->size();
+        ALOGV("[%s] lent buffer %zu", mName, *index);
+        return OK;
+    }
     c2Buffer->setFormat(mFormat);
-    if (!convert(buffer, &c2Buffer) && !c2Buffer->copy(buffer)) {
-        ALOGD("[%s] copy buffer failed", mName);
-        return WOULD_BLOCK;
+    if (!convert(buffer, &c2Buffer)) {
+        if (!c2Buffer->copy(buffer)) {
+            ALOGD("[%s] copy buffer failed", mName);
+            return WOULD_BLOCK;
+        }
+        mBytesCopied += c2Buffer->size();
     }
     submit(c2Buffer);
     handleImageData(c2Buffer);
@@ -1157,6 +1221,7 @@ status_t OutputBuffersArray::registerCsd(
         const C2StreamInitDataInfo::output *csd,
         size_t *index,
         sp<MediaCodecBuffer> *clientBuffer) {
+    fillEmptySlots();
     sp<Codec2Buffer> c2Buffer;
     status_t err = mImpl.grabBuffer(
             index,
@@ -1250,6 +1315,28 @@ void OutputBuffersArray::transferFrom(OutputBuffers* source) {
     mReorderStash = std::move(source->mReorderStash);
     mDepth = source->mDepth;
     mKey = source->mKey;
+    mBytesCopied = source->mBytesCopied;
+    mBytesWrapped = source->mBytesWrapped;
+}
+
+void OutputBuffersArray::keepClientBuffers() {
+    mClientBuffersKept = true;
+    // Buffers still lent to the client stay in their slots until they are returned.
+    mImpl.fillEmptySlots(mAlloc);
+    mClientArrayChanged = false;
+}
+
+bool OutputBuffersArray::replaceReturnedBuffers() {
+    fillEmptySlots();
+    bool changed = mClientArrayChanged;
+    mClientArrayChanged = false;
+    return changed;
+}
+
+void OutputBuffersArray::fillEmptySlots() {
+    if (mImpl.fillEmptySlots(mAlloc) && mClientBuffersKept) {
+        mClientArrayChanged = true;
+    }
 }
 
 // FlexOutputBuffers
@@ -1339,6 +1426,7 @@ sp<Codec2Buffer> LinearOutputBuffers::wrap(const std::shared_ptr<C2Buffer> &buff
         ALOGD("[%s] ConstLinearBlockBuffer::Allocate failed", mName);
         return nullptr;
     }
+    mBytesWrapped += clientBuffer->size();
     submit(clientBuffer);
     return clientBuffer;
 }
@@ -223,6 +223,18 @@ public:
      */
     void updateSkipCutBuffer(const sp<AMessage> &format);
 
+    /**
+     * Return the number of output bytes copied or converted into client
+     * buffers so far.
+     */
+    uint64_t getBytesCopied() const { return mBytesCopied; }
+
+    /**
+     * Return the number of output bytes handed to the client without copying
+     * so far.
+     */
+    uint64_t getBytesWrapped() const { return mBytesWrapped; }
+
     /**
      * Output Stash
      * ============
@@ -392,6 +404,15 @@ protected:
      */
     bool convert(const std::shared_ptr<C2Buffer> &src, sp<Codec2Buffer> *dst);
 
+    /**
+     * Returns true if output data goes through DataConverter for the current
+     * format, in which case it cannot be handed to the client as-is.
+     */
+    bool needsConversion();
+
+    uint64_t mBytesCopied{0};
+    uint64_t mBytesWrapped{0};
+
 private:
     // SkipCutBuffer
     int32_t mDelay;
@@ -659,6 +680,24 @@ public:
             std::function<bool(const sp<Codec2Buffer> &)> match =
                 [](const sp<Codec2Buffer> &buffer) { return (buffer != nullptr); });
 
+    /**
+     * Lend |buffer| to the client in place of the client buffer of the slot at
+     * |index|, which must have just been grabbed. The slot keeps |buffer| only
+     * until the client returns it, and is left empty afterwards.
+     *
+     * \param index[in]   index of the slot.
+     * \param buffer[in]  the buffer to hand to the client.
+     */
+    void lendBuffer(size_t index, const sp<Codec2Buffer> &buffer);
+
+    /**
+     * Allocate client buffers for the slots left empty by lendBuffer().
+     *
+     * \param alloc[in]   the allocation function for client buffers.
+     * \return true if any slot was empty.
+     */
+    bool fillEmptySlots(std::function<sp<Codec2Buffer>()> alloc);
+
     /**
      * Return the buffer from the client, and get the C2Buffer object back from
      * the buffer. Note that the slot is not completely free until the returned
@@ -729,9 +768,10 @@ private:
     const char *mName; ///< C-string version of name
 
     struct Entry {
-        const sp<Codec2Buffer> clientBuffer;
+        sp<Codec2Buffer> clientBuffer;
         std::weak_ptr<C2Buffer> compBuffer;
         bool ownedByClient;
+        bool lent;
     };
     std::vector<Entry> mBuffers;
 };
@@ -1055,9 +1095,41 @@ public:
      */
     void transferFrom(OutputBuffers* source);
 
+    /**
+     * Called whenever the client obtains the buffer array. From then on the
+     * client may refer to the buffers by slot, so output is always copied into
+     * the buffers of the array.
+     */
+    void keepClientBuffers();
+
+    /**
+     * Allocate client buffers for the slots whose lent buffer the client
+     * returned after it obtained the buffer array. A lent buffer cannot be
+     * copied into, so it is not reused.
+     *
+     * \return true if the buffer array changed since the client last obtained
+     *         it and since the previous call, in which case the client has to
+     *         be notified with onOutputBuffersChanged().
+     */
+    bool replaceReturnedBuffers();
+
 private:
+    /**
+     * Return a buffer wrapping |buffer| that can be handed to the client in
+     * place of a copy, or nullptr if the output has to be copied.
+     */
+    sp<Codec2Buffer> wrapForClient(const std::shared_ptr<C2Buffer> &buffer);
+
+    /**
+     * Allocate client buffers for the empty slots, and record whether the
+     * array held by the client changed.
+     */
+    void fillEmptySlots();
+
     BuffersArrayImpl mImpl;
     std::function<sp<Codec2Buffer>()> mAlloc;
+    bool mClientBuffersKept{false};
+    bool mClientArrayChanged{false};
 };
 
 class FlexOutputBuffers : public OutputBuffers {
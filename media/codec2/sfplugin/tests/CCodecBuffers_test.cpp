@@ -914,4 +914,92 @@ TEST(LinearOutputBuffersTest, PcmConvertFormat) {
     ASSERT_TRUE(buffers->releaseBuffer(clientBuffer, &c2Buffer));
 }
 
+TEST(LinearOutputBuffersTest, ArrayModeWithoutCopy) {
+    std::shared_ptr<LinearOutputBuffers> buffers =
+        std::make_shared<LinearOutputBuffers>("test");
+    sp<AMessage> format{new AMessage};
+    format->setInt32(KEY_CHANNEL_COUNT, 2);
+    format->setInt32(KEY_SAMPLE_RATE, 48000);
+    buffers->setFormat(format);
+
+    std::shared_ptr<C2BlockPool> pool;
+    ASSERT_EQ(OK, GetCodec2BlockPool(C2BlockPool::BASIC_LINEAR, nullptr, &pool));
+
+    constexpr uint32_t kSize = 1024;
+    std::shared_ptr<C2LinearBlock> block;
+    ASSERT_EQ(OK, pool->fetchLinearBlock(
+            kSize, C2MemoryUsage{C2MemoryUsage::CPU_READ, C2MemoryUsage::CPU_WRITE}, &block));
+    C2WriteView view = block->map().get();
+    ASSERT_EQ(C2_OK, view.error());
+    for (uint32_t i = 0; i < kSize; ++i) {
+        view.data()[i] = i & 0xFF;
+    }
+    const uint8_t *blockData = view.data();
+    std::shared_ptr<C2Buffer> c2Buffer =
+        C2Buffer::CreateLinearBuffer(block->share(0, kSize, C2Fence()));
+
+    std::unique_ptr<OutputBuffersArray> array = buffers->toArrayMode(4);
+
+    // Until the client asks for the array, the component buffer is handed out as-is.
+    size_t index;
+    sp<MediaCodecBuffer> clientBuffer;
+    ASSERT_EQ(OK, array->registerBuffer(c2Buffer, &index, &clientBuffer));
+    ASSERT_EQ(kSize, clientBuffer->size());
+    EXPECT_EQ(0, memcmp(blockData, clientBuffer->data(), kSize));
+    EXPECT_EQ(c2Buffer, clientBuffer->asC2Buffer());
+    EXPECT_EQ(kSize, array->getBytesWrapped());
+    EXPECT_EQ(0u, array->getBytesCopied());
+    std::shared_ptr<C2Buffer> returned;
+    ASSERT_TRUE(array->releaseBuffer(clientBuffer, &returned));
+    EXPECT_EQ(c2Buffer, returned);
+    returned.reset();
+
+    // The client gets the array while it holds a lent buffer.
+    size_t lentIndex;
+    sp<MediaCodecBuffer> lentBuffer;
+    ASSERT_EQ(OK, array->registerBuffer(c2Buffer, &lentIndex, &lentBuffer));
+    EXPECT_EQ(c2Buffer, lentBuffer->asC2Buffer());
+    array->keepClientBuffers();
+    Vector<sp<MediaCodecBuffer>> clientBuffers;
+    array->getArray(&clientBuffers);
+    ASSERT_EQ(4u, clientBuffers.size());
+    for (const sp<MediaCodecBuffer> &buffer : clientBuffers) {
+        ASSERT_NE(nullptr, buffer);
+    }
+    EXPECT_EQ(lentBuffer, clientBuffers[lentIndex]);
+    EXPECT_FALSE(array->replaceReturnedBuffers());
+
+    // Once returned, the lent buffer is replaced by a buffer the output can be
+    // copied into, and the client is told to get the array again.
+    ASSERT_TRUE(array->releaseBuffer(lentBuffer, &returned));
+    EXPECT_EQ(c2Buffer, returned);
+    returned.reset();
+    EXPECT_TRUE(array->replaceReturnedBuffers());
+    EXPECT_FALSE(array->replaceReturnedBuffers());
+    array->keepClientBuffers();
+    array->getArray(&clientBuffers);
+    ASSERT_EQ(4u, clientBuffers.size());
+    ASSERT_NE(nullptr, clientBuffers[lentIndex]);
+    EXPECT_NE(lentBuffer, clientBuffers[lentIndex]);
+
+    // Now the output is copied into the array buffers, and every slot is usable.
+    std::vector<sp<MediaCodecBuffer>> copies;
+    std::vector<bool> used(clientBuffers.size(), false);
+    for (size_t i = 0; i < clientBuffers.size(); ++i) {
+        ASSERT_EQ(OK, array->registerBuffer(c2Buffer, &index, &clientBuffer));
+        ASSERT_LT(index, clientBuffers.size());
+        EXPECT_FALSE(used[index]);
+        used[index] = true;
+        EXPECT_EQ(clientBuffers[index], clientBuffer);
+        ASSERT_EQ(kSize, clientBuffer->size());
+        EXPECT_EQ(0, memcmp(blockData, clientBuffer->data(), kSize));
+        copies.push_back(clientBuffer);
+    }
+    EXPECT_EQ(kSize * clientBuffers.size(), array->getBytesCopied());
+    for (const sp<MediaCodecBuffer> &copy : copies) {
+        ASSERT_TRUE(array->releaseBuffer(copy, &returned));
+    }
+    EXPECT_FALSE(array->replaceReturnedBuffers());
+}
+
 } // namespace android
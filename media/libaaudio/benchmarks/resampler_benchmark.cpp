@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "flowgraph/resampler/ConvolutionKernels.h"
+#include "flowgraph/resampler/MultiChannelResampler.h"
+
+using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
+
+static constexpr int32_t kOutputRate = 48000;
+static constexpr int32_t kFramesPerBuffer = 4096;
+
+/*
+ * Resample a sine wave with numChannels channels from inputRate to kOutputRate.
+ * 44100 uses the polyphase resamplers for every quality.
+ * 11025 needs too many coefficients for High and Best so they use the sinc resamplers.
+ */
+static void BM_Resampler(benchmark::State& state) {
+    const auto quality = static_cast<MultiChannelResampler::Quality>(state.range(0));
+    const auto channelCount = static_cast<int32_t>(state.range(1));
+    const auto inputRate = static_cast<int32_t>(state.range(2));
+
+    std::unique_ptr<MultiChannelResampler> resampler(
+            MultiChannelResampler::make(channelCount, inputRate, kOutputRate, quality));
+    std::vector<float> input(static_cast<size_t>(kFramesPerBuffer * channelCount));
+    for (int32_t i = 0; i < kFramesPerBuffer; i++) {
+        const float sample = sinf(i * 0.01f);
+        for (int32_t channel = 0; channel < channelCount; channel++) {
+            input[i * channelCount + channel] = sample;
+        }
+    }
+    std::vector<float> output(static_cast<size_t>(channelCount));
+
+    int64_t framesRead = 0;
+    for (auto _ : state) {
+        const float *frame = input.data();
+        for (int32_t framesLeft = kFramesPerBuffer; framesLeft > 0; ) {
+            if (resampler->isWriteNeeded()) {
+                resampler->writeNextFrame(frame);
+                frame += channelCount;
+                framesLeft--;
+            } else {
+                resampler->readNextFrame(output.data());
+                framesRead++;
+            }
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(framesRead);
+    state.SetLabel(ConvolutionKernels::best().name);
+}
+
+static void ResamplerArgs(benchmark::internal::Benchmark* b) {
+    for (int inputRate : {44100, 11025}) {
+        for (int quality = static_cast<int>(MultiChannelResampler::Quality::Fastest);
+                quality <= static_cast<int>(MultiChannelResampler::Quality::Best); quality++) {
+            for (int channelCount : {1, 2, 4, 6, 8}) {
+                b->Args({quality, channelCount, inputRate});
+            }
+        }
+    }
+    b->ArgNames({"quality", "channels", "inputRate"});
+}
+
+BENCHMARK(BM_Resampler)->Apply(ResamplerArgs);
+
+BENCHMARK_MAIN();
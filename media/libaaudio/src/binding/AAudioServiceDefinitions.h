@@ -62,6 +62,9 @@ enum RingbufferFlags : uint32_t {
     COHERENCY_DMA = 0x0004,
     COHERENCY_ACQUIRE_RELEASE = 0x0008,
     COHERENCY_AUTO = 0x0010,
+    // The data and write counter are shared with other readers and may be read-only.
+    // The writer does not wait for this reader so it must detect its own overruns.
+    SHARED_DATA = 0x0020,
 };
 
 // This is not passed through Binder.
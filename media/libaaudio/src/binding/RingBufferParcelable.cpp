@@ -106,6 +106,14 @@ void RingBufferParcelable::setCapacityInFrames(int32_t capacityInFrames) {
     mCapacityInFrames = capacityInFrames;
 }
 
+RingbufferFlags RingBufferParcelable::getFlags() const {
+    return mFlags;
+}
+
+void RingBufferParcelable::setFlags(RingbufferFlags flags) {
+    mFlags = flags;
+}
+
 aaudio_result_t RingBufferParcelable::resolve(SharedMemoryParcelable *memoryParcels, RingBufferDescriptor *descriptor) {
     aaudio_result_t result;
 
@@ -141,6 +149,7 @@ void RingBufferParcelable::updateMemory(const RingBufferParcelable& parcelable,
     setBytesPerFrame(parcelable.getBytesPerFrame());
     setFramesPerBurst(parcelable.getFramesPerBurst());
     setCapacityInFrames(parcelable.getCapacityInFrames());
+    setFlags(parcelable.getFlags());
 }
 
 aaudio_result_t RingBufferParcelable::validate() const {
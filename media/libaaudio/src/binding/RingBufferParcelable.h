@@ -75,6 +75,10 @@ public:
 
     void setCapacityInFrames(int32_t capacityInFrames);
 
+    RingbufferFlags getFlags() const;
+
+    void setFlags(RingbufferFlags flags);
+
     bool isFileDescriptorSafe(SharedMemoryParcelable *memoryParcels);
 
     aaudio_result_t resolve(SharedMemoryParcelable *memoryParcels, RingBufferDescriptor *descriptor);
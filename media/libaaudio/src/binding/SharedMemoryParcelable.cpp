@@ -18,6 +18,7 @@
 //#define LOG_NDEBUG 0
 #include <utils/Log.h>
 
+#include <errno.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -91,6 +92,11 @@ aaudio_result_t SharedMemoryParcelable::closeAndReleaseFd() {
 aaudio_result_t SharedMemoryParcelable::resolveSharedMemory(const unique_fd& fd) {
     mResolvedAddress = (uint8_t *) mmap(nullptr, mSizeInBytes, PROT_READ | PROT_WRITE,
                                         MAP_SHARED, fd.get(), 0);
+    if (mResolvedAddress == MMAP_UNRESOLVED_ADDRESS && errno == EPERM) {
+        // The service may share memory read-only, eg. a capture ring read by several clients.
+        mResolvedAddress = (uint8_t *) mmap(nullptr, mSizeInBytes, PROT_READ,
+                                            MAP_SHARED, fd.get(), 0);
+    }
     if (mResolvedAddress == MMAP_UNRESOLVED_ADDRESS) {
         ALOGE("mmap() failed for fd = %d, nBytes = %" PRId64 ", errno = %s",
               fd.get(), mSizeInBytes, strerror(errno));
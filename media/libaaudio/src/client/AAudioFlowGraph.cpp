@@ -20,6 +20,9 @@
 
 #include "AAudioFlowGraph.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <flowgraph/Limiter.h>
 #include <flowgraph/ManyToMultiConverter.h>
 #include <flowgraph/MonoBlend.h>
@@ -35,8 +38,134 @@
 #include <flowgraph/SourceI24.h>
 #include <flowgraph/SourceI32.h>
 
+#include <audio_utils/primitives.h>
+
 using namespace FLOWGRAPH_OUTER_NAMESPACE::flowgraph;
 
+namespace {
+
+// Sample formats of the fused kernels.
+// These convert exactly like the SourceXxx and SinkXxx nodes.
+
+struct FormatFloat {
+    static constexpr int32_t kBytesPerSample = sizeof(float);
+    static float read(const uint8_t *data) {
+        return *reinterpret_cast<const float *>(data);
+    }
+    static void write(uint8_t *data, float value) {
+        *reinterpret_cast<float *>(data) = value;
+    }
+};
+
+struct FormatI16 {
+    static constexpr int32_t kBytesPerSample = sizeof(int16_t);
+    static float read(const uint8_t *data) {
+        return float_from_i16(*reinterpret_cast<const int16_t *>(data));
+    }
+    static void write(uint8_t *data, float value) {
+        *reinterpret_cast<int16_t *>(data) = clamp16_from_float(value);
+    }
+};
+
+struct FormatI24 {
+    static constexpr int32_t kBytesPerSample = 3; // packed
+    static float read(const uint8_t *data) {
+        return float_from_p24(data);
+    }
+    static void write(uint8_t *data, float value) {
+        // Write as a packed 24-bit integer in Little Endian format.
+        const int32_t n = clamp24_from_float(value);
+        data[0] = (uint8_t) n;
+        data[1] = (uint8_t) (n >> 8);
+        data[2] = (uint8_t) (n >> 16);
+    }
+};
+
+struct FormatI32 {
+    static constexpr int32_t kBytesPerSample = sizeof(int32_t);
+    static float read(const uint8_t *data) {
+        return float_from_i32(*reinterpret_cast<const int32_t *>(data));
+    }
+    static void write(uint8_t *data, float value) {
+        *reinterpret_cast<int32_t *>(data) = clamp32_from_float(value);
+    }
+};
+
+/**
+ * Equivalent to Source -> [MonoToMultiConverter] -> [RampLinear per channel] -> Sink,
+ * in a single pass without intermediate buffers.
+ * Without the channel expansion the loop is over contiguous samples so that it vectorizes.
+ */
+template <typename Source, typename Sink, bool kMonoToMulti>
+void processFused(const uint8_t *source, uint8_t *destination,
+                  int32_t numFrames, int32_t channelCount, const float *levels) {
+    if constexpr (kMonoToMulti) {
+        for (int32_t frame = 0; frame < numFrames; frame++) {
+            const float sample = Source::read(source);
+            source += Source::kBytesPerSample;
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                Sink::write(destination, sample * *levels++);
+                destination += Sink::kBytesPerSample;
+            }
+        }
+    } else {
+        const int32_t numSamples = numFrames * channelCount;
+        for (int32_t i = 0; i < numSamples; i++) {
+            Sink::write(&destination[i * Sink::kBytesPerSample],
+                        Source::read(&source[i * Source::kBytesPerSample]) * levels[i]);
+        }
+    }
+}
+
+template <typename Source>
+AAudioFlowGraph::FusedKernel selectFusedKernel(audio_format_t sinkFormat, bool monoToMulti,
+                                               int32_t *sinkBytesPerSample) {
+    switch (sinkFormat) {
+        case AUDIO_FORMAT_PCM_FLOAT:
+            *sinkBytesPerSample = FormatFloat::kBytesPerSample;
+            return monoToMulti ? processFused<Source, FormatFloat, true>
+                               : processFused<Source, FormatFloat, false>;
+        case AUDIO_FORMAT_PCM_16_BIT:
+            *sinkBytesPerSample = FormatI16::kBytesPerSample;
+            return monoToMulti ? processFused<Source, FormatI16, true>
+                               : processFused<Source, FormatI16, false>;
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+            *sinkBytesPerSample = FormatI24::kBytesPerSample;
+            return monoToMulti ? processFused<Source, FormatI24, true>
+                               : processFused<Source, FormatI24, false>;
+        case AUDIO_FORMAT_PCM_32_BIT:
+            *sinkBytesPerSample = FormatI32::kBytesPerSample;
+            return monoToMulti ? processFused<Source, FormatI32, true>
+                               : processFused<Source, FormatI32, false>;
+        default:
+            return nullptr;
+    }
+}
+
+AAudioFlowGraph::FusedKernel selectFusedKernel(audio_format_t sourceFormat,
+                                               audio_format_t sinkFormat, bool monoToMulti,
+                                               int32_t *sourceBytesPerSample,
+                                               int32_t *sinkBytesPerSample) {
+    switch (sourceFormat) {
+        case AUDIO_FORMAT_PCM_FLOAT:
+            *sourceBytesPerSample = FormatFloat::kBytesPerSample;
+            return selectFusedKernel<FormatFloat>(sinkFormat, monoToMulti, sinkBytesPerSample);
+        case AUDIO_FORMAT_PCM_16_BIT:
+            *sourceBytesPerSample = FormatI16::kBytesPerSample;
+            return selectFusedKernel<FormatI16>(sinkFormat, monoToMulti, sinkBytesPerSample);
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+            *sourceBytesPerSample = FormatI24::kBytesPerSample;
+            return selectFusedKernel<FormatI24>(sinkFormat, monoToMulti, sinkBytesPerSample);
+        case AUDIO_FORMAT_PCM_32_BIT:
+            *sourceBytesPerSample = FormatI32::kBytesPerSample;
+            return selectFusedKernel<FormatI32>(sinkFormat, monoToMulti, sinkBytesPerSample);
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace
+
 aaudio_result_t AAudioFlowGraph::configure(audio_format_t sourceFormat,
                           int32_t sourceChannelCount,
                           audio_format_t sinkFormat,
@@ -134,14 +263,64 @@ aaudio_result_t AAudioFlowGraph::configure(audio_format_t sourceFormat,
     }
     lastOutput->connect(&mSink->input);
 
+    // The graph is left connected, but a graph without MonoBlend and Limiter
+    // can be run by a single fused kernel instead.
+    if (mFusionAllowed && mMonoBlend == nullptr && mLimiter == nullptr) {
+        int32_t sourceBytesPerSample = 0;
+        int32_t sinkBytesPerSample = 0;
+        mFusedKernel = selectFusedKernel(sourceFormat, sinkFormat,
+                                         mChannelConverter != nullptr,
+                                         &sourceBytesPerSample, &sinkBytesPerSample);
+        mFusedChannelCount = sinkChannelCount;
+        mSourceBytesPerFrame = sourceBytesPerSample * sourceChannelCount;
+        mSinkBytesPerFrame = sinkBytesPerSample * sinkChannelCount;
+        mFusedLevels.assign(kFusedBlockFrames * sinkChannelCount, 1.0f);
+        mFusedSteadyLevels.assign(sinkChannelCount, std::numeric_limits<float>::quiet_NaN());
+        ALOGD("%s() fused = %d", __func__, isFused());
+    }
+
     return AAUDIO_OK;
 }
 
 void AAudioFlowGraph::process(const void *source, void *destination, int32_t numFrames) {
+    if (mFusedKernel != nullptr) {
+        processFused(source, destination, numFrames);
+        return;
+    }
     mSource->setData(source, numFrames);
     mSink->read(destination, numFrames);
 }
 
+void AAudioFlowGraph::processFused(const void *source, void *destination, int32_t numFrames) {
+    const uint8_t *sourceBytes = static_cast<const uint8_t *>(source);
+    uint8_t *destinationBytes = static_cast<uint8_t *>(destination);
+    while (numFrames > 0) {
+        const int32_t framesToProcess = std::min(numFrames, kFusedBlockFrames);
+        updateFusedLevels(framesToProcess);
+        mFusedKernel(sourceBytes, destinationBytes, framesToProcess, mFusedChannelCount,
+                     mFusedLevels.data());
+        sourceBytes += framesToProcess * mSourceBytesPerFrame;
+        destinationBytes += framesToProcess * mSinkBytesPerFrame;
+        numFrames -= framesToProcess;
+    }
+}
+
+void AAudioFlowGraph::updateFusedLevels(int32_t numFrames) {
+    // Without volume ramps the levels stay at one.
+    for (size_t channel = 0; channel < mVolumeRamps.size(); channel++) {
+        const RampLinear::Segment segment = mVolumeRamps[channel]->nextSegment(numFrames);
+        if (segment.framesToRamp == 0 && segment.levelTo == mFusedSteadyLevels[channel]) {
+            continue; // already filled with this level
+        }
+        // Fill the whole block so that it can be reused when the level is steady.
+        for (int32_t frame = 0; frame < kFusedBlockFrames; frame++) {
+            mFusedLevels[frame * mFusedChannelCount + channel] = segment.levelAt(frame);
+        }
+        mFusedSteadyLevels[channel] = (segment.framesToRamp == 0)
+                ? segment.levelTo : std::numeric_limits<float>::quiet_NaN();
+    }
+}
+
 /**
  * @param volume between 0.0 and 1.0
  */
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <stdint.h>
+#include <vector>
 #include <sys/types.h>
 #include <system/audio.h>
 
@@ -33,6 +34,14 @@
 
 class AAudioFlowGraph {
 public:
+    /**
+     * A fused kernel converts numFrames of source data to the sink format, expanding mono
+     * to channelCount channels if needed, and multiplies each sample by its level.
+     * The levels hold one value per sink sample.
+     */
+    using FusedKernel = void (*)(const uint8_t *source, uint8_t *destination,
+                                 int32_t numFrames, int32_t channelCount, const float *levels);
+
     /** Connect several modules together to convert from source to sink.
      * This should only be called once for each instance.
      *
@@ -56,6 +65,24 @@ public:
 
     void process(const void *source, void *destination, int32_t numFrames);
 
+    /**
+     * Allow configure() to compile a simple graph into a single fused kernel,
+     * which converts, applies the volume ramps and converts back in one pass.
+     * This is allowed by default. It must be called before configure().
+     *
+     * @param allowed false to always pull data through the graph node by node
+     */
+    void setFusionAllowed(bool allowed) {
+        mFusionAllowed = allowed;
+    }
+
+    /**
+     * @return true if configure() compiled the graph into a fused kernel
+     */
+    bool isFused() const {
+        return mFusedKernel != nullptr;
+    }
+
     /**
      * @param volume between 0.0 and 1.0
      */
@@ -72,6 +99,22 @@ public:
     void setRampLengthInFrames(int32_t numFrames);
 
 private:
+    // Frames processed by a fused kernel call, so that the levels stay in the cache.
+    static constexpr int32_t kFusedBlockFrames = 64;
+
+    void processFused(const void *source, void *destination, int32_t numFrames);
+    void updateFusedLevels(int32_t numFrames);
+
+    bool mFusionAllowed = true;
+    FusedKernel mFusedKernel = nullptr;
+    int32_t mFusedChannelCount = 0;
+    int32_t mSourceBytesPerFrame = 0;
+    int32_t mSinkBytesPerFrame = 0;
+    // kFusedBlockFrames frames of levels, and the steady level of each channel,
+    // or NaN if the levels of that channel have to be refreshed.
+    std::vector<float> mFusedLevels;
+    std::vector<float> mFusedSteadyLevels;
+
     std::unique_ptr<FLOWGRAPH_OUTER_NAMESPACE::flowgraph::FlowGraphSourceBuffered> mSource;
     std::unique_ptr<FLOWGRAPH_OUTER_NAMESPACE::flowgraph::MonoBlend> mMonoBlend;
     std::unique_ptr<FLOWGRAPH_OUTER_NAMESPACE::flowgraph::Limiter> mLimiter;
@@ -70,9 +70,13 @@ static aaudio_result_t AudioEndpoint_validateQueueDescriptor(const char *type,
     uint8_t value = descriptor->dataAddress[0];
     ALOGV("AudioEndpoint_validateQueueDescriptor() dataAddress[0] = %d, then try to write",
         (int) value);
-    // Try to WRITE to the data area.
-    descriptor->dataAddress[0] = value * 3;
-    ALOGV("AudioEndpoint_validateQueueDescriptor() wrote successfully");
+    // Shared data and its write counter may be mapped read-only.
+    const bool sharedData = (descriptor->flags & RingbufferFlags::SHARED_DATA) != 0;
+    if (!sharedData) {
+        // Try to WRITE to the data area.
+        descriptor->dataAddress[0] = value * 3;
+        ALOGV("AudioEndpoint_validateQueueDescriptor() wrote successfully");
+    }
 
     if (descriptor->readCounterAddress) {
         fifo_counter_t counter = *descriptor->readCounterAddress;
@@ -82,7 +86,7 @@ static aaudio_result_t AudioEndpoint_validateQueueDescriptor(const char *type,
         ALOGV("AudioEndpoint_validateQueueDescriptor() wrote readCounterAddress successfully");
     }
 
-    if (descriptor->writeCounterAddress) {
+    if (descriptor->writeCounterAddress && !sharedData) {
         fifo_counter_t counter = *descriptor->writeCounterAddress;
         ALOGV("AudioEndpoint_validateQueueDescriptor() *writeCounterAddress = %d, now write",
               (int) counter);
@@ -171,15 +175,20 @@ aaudio_result_t AudioEndpoint::configureDataQueue(const RingBufferDescriptor& de
                                   : descriptor.writeCounterAddress;
 
     // Clear buffer to avoid an initial glitch on some devices.
-    size_t bufferSizeBytes = descriptor.capacityInFrames * descriptor.bytesPerFrame;
-    memset(descriptor.dataAddress, 0, bufferSizeBytes);
+    // Shared data is owned by the service and may be mapped read-only.
+    mSharedData = (descriptor.flags & RingbufferFlags::SHARED_DATA) != 0;
+    if (!mSharedData) {
+        size_t bufferSizeBytes = descriptor.capacityInFrames * descriptor.bytesPerFrame;
+        memset(descriptor.dataAddress, 0, bufferSizeBytes);
+    }
 
     mDataQueue = std::make_unique<FifoBufferIndirect>(
             descriptor.bytesPerFrame,
             descriptor.capacityInFrames,
             readCounterAddress,
             writeCounterAddress,
-            descriptor.dataAddress
+            descriptor.dataAddress,
+            mSharedData && direction == AAUDIO_DIRECTION_INPUT
     );
     uint32_t threshold = descriptor.capacityInFrames / 2;
     mDataQueue->setThreshold(threshold);
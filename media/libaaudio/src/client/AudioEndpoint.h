@@ -88,6 +88,14 @@ public:
      */
     bool isFreeRunning() const { return mFreeRunning; }
 
+    /**
+     * The result is not valid until after configure() is called.
+     *
+     * @return true if the data is shared with other streams, which may overwrite it
+     *         without waiting for this stream to read it
+     */
+    bool isSharedData() const { return mSharedData; }
+
     int32_t setBufferSizeInFrames(int32_t requestedFrames,
                                   int32_t *actualFrames);
     int32_t getBufferSizeInFrames() const;
@@ -115,6 +123,7 @@ private:
     std::unique_ptr<android::FifoBufferIndirect> mUpCommandQueue;
     std::unique_ptr<android::FifoBufferIndirect> mDataQueue;
     bool                    mFreeRunning{false};
+    bool                    mSharedData{false};
     android::fifo_counter_t mDataReadCounter{0}; // only used if free-running
     android::fifo_counter_t mDataWriteCounter{0}; // only used if free-running
 
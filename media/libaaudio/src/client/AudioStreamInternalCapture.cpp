@@ -113,7 +113,8 @@ aaudio_result_t AudioStreamInternalCapture::processDataNow(void *buffer, int32_t
     }
 
     // If the capture buffer is full beyond capacity then consider it an overrun.
-    // For shared streams, the xRunCount is passed up from the service.
+    // For shared streams, the xRunCount is passed up from the service unless
+    // the data queue itself is shared, see below.
     if (mAudioEndpoint->isFreeRunning()
         && mAudioEndpoint->getFullFramesAvailable() > mAudioEndpoint->getBufferCapacityInFrames()) {
         mXRunCount++;
@@ -122,6 +123,19 @@ aaudio_result_t AudioStreamInternalCapture::processDataNow(void *buffer, int32_t
         }
     }
 
+    // Shared data is written by the service without waiting for this stream,
+    // so the oldest burst may already be getting overwritten.
+    // Skip over the stale data rather than reading it.
+    if (mAudioEndpoint->isSharedData()
+        && mAudioEndpoint->getFullFramesAvailable()
+                > mAudioEndpoint->getBufferCapacityInFrames() - getFramesPerBurst()) {
+        mXRunCount++;
+        if (ATRACE_ENABLED()) {
+            ATRACE_INT("aaOverRuns", mXRunCount);
+        }
+        advanceClientToMatchServerPosition(0 /*serverMargin*/);
+    }
+
     // Read some data from the buffer.
     //ALOGD("AudioStreamInternalCapture::processDataNow() - readNowWithConversion(%d)", numFrames);
     int32_t framesProcessed = readNowWithConversion(buffer, numFrames);
@@ -171,6 +185,7 @@ aaudio_result_t AudioStreamInternalCapture::readNowWithConversion(void *buffer,
     WrappingBuffer wrappingBuffer;
     uint8_t *destination = (uint8_t *) buffer;
     int32_t framesLeft = numFrames;
+    const int64_t readCounter = mAudioEndpoint->getDataReadCounter();
 
     mAudioEndpoint->getFullFramesAvailable(&wrappingBuffer);
 
@@ -198,6 +213,20 @@ aaudio_result_t AudioStreamInternalCapture::readNowWithConversion(void *buffer,
     }
 
     int32_t framesProcessed = numFrames - framesLeft;
+
+    // Like a seqlock reader, check that the service did not write over the frames
+    // while they were copied. It may be writing the burst after the write counter.
+    if (mAudioEndpoint->isSharedData() && framesProcessed > 0
+        && mAudioEndpoint->getDataWriteCounter() - readCounter
+                > mAudioEndpoint->getBufferCapacityInFrames() - getFramesPerBurst()) {
+        mXRunCount++;
+        if (ATRACE_ENABLED()) {
+            ATRACE_INT("aaOverRuns", mXRunCount);
+        }
+        advanceClientToMatchServerPosition(0 /*serverMargin*/);
+        return 0;
+    }
+
     mAudioEndpoint->advanceReadIndex(framesProcessed);
 
     //ALOGD("readNowWithConversion() returns %d", framesProcessed);
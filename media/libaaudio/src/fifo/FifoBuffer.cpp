@@ -53,7 +53,8 @@ FifoBufferIndirect::FifoBufferIndirect( int32_t   bytesPerFrame,
                         fifo_frames_t   capacityInFrames,
                         fifo_counter_t *readIndexAddress,
                         fifo_counter_t *writeIndexAddress,
-                        void *  dataStorageAddress
+                        void *  dataStorageAddress,
+                        bool sharedReader
                         )
         : FifoBuffer(bytesPerFrame)
         , mExternalStorage(static_cast<uint8_t *>(dataStorageAddress))
@@ -61,7 +62,8 @@ FifoBufferIndirect::FifoBufferIndirect( int32_t   bytesPerFrame,
     mFifo = std::make_unique<FifoControllerIndirect>(capacityInFrames,
                                        capacityInFrames,
                                        readIndexAddress,
-                                       writeIndexAddress);
+                                       writeIndexAddress,
+                                       sharedReader);
 }
 
 int32_t FifoBuffer::convertFramesToBytes(fifo_frames_t frames) {
@@ -147,11 +147,13 @@ class FifoBufferIndirect : public FifoBuffer {
 public:
     // We use raw pointers because the memory may be
     // in the middle of an allocated block and cannot be deleted directly.
+    // A sharedReader only owns the read counter, see FifoControllerIndirect.
     FifoBufferIndirect(int32_t bytesPerFrame,
                        fifo_frames_t capacityInFrames,
                        fifo_counter_t* readCounterAddress,
                        fifo_counter_t* writeCounterAddress,
-                       void* dataStorageAddress);
+                       void* dataStorageAddress,
+                       bool sharedReader = false);
 
 private:
 
@@ -29,6 +29,10 @@ namespace android {
  *
  * The actual counters may be stored in separate regions of shared memory
  * with different access rights.
+ *
+ * A reader of data that is shared with other readers only owns its read counter.
+ * The write counter may be in read-only memory and is already being advanced,
+ * so a reader starts at the current write counter and leaves it alone.
  */
 class FifoControllerIndirect : public FifoControllerBase {
 
@@ -36,13 +40,18 @@ public:
     FifoControllerIndirect(fifo_frames_t capacity,
                            fifo_frames_t threshold,
                            fifo_counter_t * readCounterAddress,
-                           fifo_counter_t * writeCounterAddress)
+                           fifo_counter_t * writeCounterAddress,
+                           bool sharedReader = false)
         : FifoControllerBase(capacity, threshold)
         , mReadCounterAddress((std::atomic<fifo_counter_t> *) readCounterAddress)
         , mWriteCounterAddress((std::atomic<fifo_counter_t> *) writeCounterAddress)
     {
-        setReadCounter(0);
-        setWriteCounter(0);
+        if (sharedReader) {
+            setReadCounter(getWriteCounter());
+        } else {
+            setReadCounter(0);
+            setWriteCounter(0);
+        }
     }
     virtual ~FifoControllerIndirect() = default;
 
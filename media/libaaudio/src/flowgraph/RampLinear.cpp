@@ -42,10 +42,11 @@ float RampLinear::interpolateCurrent() {
     return mLevelTo - (mRemaining * mScaler);
 }
 
-int32_t RampLinear::onProcess(int32_t numFrames) {
-    const float *inputBuffer = input.getBuffer();
-    float *outputBuffer = output.getBuffer();
-    int32_t channelCount = output.getSamplesPerFrame();
+RampLinear::Segment RampLinear::nextSegment(int32_t numFrames) {
+    // A caller that does not pull data through this node still uses the ramp.
+    if (mLastCallCount == kInitialCallCount) {
+        mLastCallCount = 0; // so that setTarget() ramps from now on
+    }
 
     float target = getTarget();
     if (target != mLevelTo) {
@@ -56,25 +57,30 @@ int32_t RampLinear::onProcess(int32_t numFrames) {
         mScaler = (mLevelTo - mLevelFrom) / mLengthInFrames; // for interpolation
     }
 
-    int32_t framesLeft = numFrames;
+    Segment segment{mLevelTo, mScaler, mRemaining, std::min(numFrames, mRemaining)};
+    mRemaining -= segment.framesToRamp;
+    return segment;
+}
+
+int32_t RampLinear::onProcess(int32_t numFrames) {
+    const float *inputBuffer = input.getBuffer();
+    float *outputBuffer = output.getBuffer();
+    int32_t channelCount = output.getSamplesPerFrame();
+
+    const Segment segment = nextSegment(numFrames);
 
-    if (mRemaining > 0) { // Ramping? This doesn't happen very often.
-        int32_t framesToRamp = std::min(framesLeft, mRemaining);
-        framesLeft -= framesToRamp;
-        while (framesToRamp > 0) {
-            float currentLevel = interpolateCurrent();
-            for (int ch = 0; ch < channelCount; ch++) {
-                *outputBuffer++ = *inputBuffer++ * currentLevel;
-            }
-            mRemaining--;
-            framesToRamp--;
+    // Ramping? This doesn't happen very often.
+    for (int32_t frame = 0; frame < segment.framesToRamp; frame++) {
+        float currentLevel = segment.levelAt(frame);
+        for (int ch = 0; ch < channelCount; ch++) {
+            *outputBuffer++ = *inputBuffer++ * currentLevel;
         }
     }
 
     // Process any frames after the ramp.
-    int32_t samplesLeft = framesLeft * channelCount;
+    int32_t samplesLeft = (numFrames - segment.framesToRamp) * channelCount;
     for (int i = 0; i < samplesLeft; i++) {
-        *outputBuffer++ = *inputBuffer++ * mLevelTo;
+        *outputBuffer++ = *inputBuffer++ * segment.levelTo;
     }
 
     return numFrames;
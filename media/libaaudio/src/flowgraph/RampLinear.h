@@ -78,6 +78,32 @@ public:
         return "RampLinear";
     }
 
+    /**
+     * The levels of the next frames of a ramp.
+     * Frame i of the segment has the level levelTo - ((remaining - i) * scaler)
+     * while i < framesToRamp, and levelTo after that.
+     */
+    struct Segment {
+        float   levelTo;
+        float   scaler;
+        int32_t remaining;    // frames left in the ramp at the first frame
+        int32_t framesToRamp; // frames of the segment that are still ramping
+
+        float levelAt(int32_t frame) const {
+            return (frame < framesToRamp) ? levelTo - ((remaining - frame) * scaler) : levelTo;
+        }
+    };
+
+    /**
+     * Start a new ramp if the target has changed and advance the ramp by numFrames.
+     * This is used by onProcess(), and by callers that apply the levels themselves
+     * instead of pulling data through this node.
+     *
+     * @param numFrames
+     * @return the levels of the next numFrames frames
+     */
+    Segment nextSegment(int32_t numFrames);
+
 private:
 
     float interpolateCurrent();
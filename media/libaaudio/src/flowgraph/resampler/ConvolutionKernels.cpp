@@ -0,0 +1,511 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include "ConvolutionKernels.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RESAMPLER_USE_NEON 1
+#elif defined(__SSE2__)
+#include <immintrin.h>
+#define RESAMPLER_USE_SSE 1
+#if defined(__GNUC__) || defined(__clang__)
+// The AVX2 kernels are compiled with a target attribute and selected at run time.
+#define RESAMPLER_USE_AVX2 1
+#endif
+#endif
+
+using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
+
+namespace {
+
+// Portable kernels, which are also used for the taps and channels left over by the vector loops.
+
+float convolveChannelPortable(const float *x, const float *coefficients, int32_t numTaps,
+                              int32_t channelCount) {
+    float sum = 0.0f;
+    for (int32_t tap = 0; tap < numTaps; tap++) {
+        sum += *x * coefficients[tap];
+        x += channelCount;
+    }
+    return sum;
+}
+
+void convolveChannelDualPortable(const float *x, const float *coefficients1,
+                                 const float *coefficients2, int32_t numTaps,
+                                 int32_t channelCount, float *sample1, float *sample2) {
+    float sum1 = 0.0f;
+    float sum2 = 0.0f;
+    for (int32_t tap = 0; tap < numTaps; tap++) {
+        const float sample = *x;
+        sum1 += sample * coefficients1[tap];
+        sum2 += sample * coefficients2[tap];
+        x += channelCount;
+    }
+    *sample1 = sum1;
+    *sample2 = sum2;
+}
+
+float convolveMonoPortable(const float *x, const float *coefficients, int32_t numTaps) {
+    return convolveChannelPortable(x, coefficients, numTaps, 1);
+}
+
+void convolveStereoPortable(const float *x, const float *coefficients, int32_t numTaps,
+                            float *frame) {
+    float left = 0.0f;
+    float right = 0.0f;
+    for (int32_t tap = 0; tap < numTaps; tap++) {
+        const float coefficient = coefficients[tap];
+        left += *x++ * coefficient;
+        right += *x++ * coefficient;
+    }
+    frame[0] = left;
+    frame[1] = right;
+}
+
+void convolvePortable(const float *x, const float *coefficients, int32_t numTaps,
+                      int32_t channelCount, float *frame) {
+    std::fill(frame, frame + channelCount, 0.0f);
+    for (int32_t tap = 0; tap < numTaps; tap++) {
+        const float coefficient = coefficients[tap];
+        for (int32_t channel = 0; channel < channelCount; channel++) {
+            frame[channel] += *x++ * coefficient;
+        }
+    }
+}
+
+void convolveDualPortable(const float *x, const float *coefficients1,
+                          const float *coefficients2, int32_t numTaps,
+                          int32_t channelCount, float *frame1, float *frame2) {
+    std::fill(frame1, frame1 + channelCount, 0.0f);
+    std::fill(frame2, frame2 + channelCount, 0.0f);
+    for (int32_t tap = 0; tap < numTaps; tap++) {
+        const float coefficient1 = coefficients1[tap];
+        const float coefficient2 = coefficients2[tap];
+        for (int32_t channel = 0; channel < channelCount; channel++) {
+            const float sample = *x++;
+            frame1[channel] += sample * coefficient1;
+            frame2[channel] += sample * coefficient2;
+        }
+    }
+}
+
+constexpr ConvolutionKernels kPortableKernels = {
+    convolveMonoPortable,
+    convolveStereoPortable,
+    convolvePortable,
+    convolveDualPortable,
+    "portable",
+};
+
+#if RESAMPLER_USE_NEON || RESAMPLER_USE_SSE
+
+// Thin wrappers so that the 4 lane kernels below can be shared by NEON and SSE.
+#if RESAMPLER_USE_NEON
+using Vector4 = float32x4_t;
+
+inline Vector4 zero4() { return vdupq_n_f32(0.0f); }
+inline Vector4 load4(const float *p) { return vld1q_f32(p); }
+inline void store4(float *p, Vector4 v) { vst1q_f32(p, v); }
+inline Vector4 broadcast4(float f) { return vdupq_n_f32(f); }
+inline Vector4 add4(Vector4 a, Vector4 b) { return vaddq_f32(a, b); }
+
+inline Vector4 mulAdd4(Vector4 sum, Vector4 a, Vector4 b) {
+#if defined(__aarch64__)
+    return vfmaq_f32(sum, a, b);
+#else
+    return vmlaq_f32(sum, a, b);
+#endif
+}
+
+// {c0, c0, c1, c1}
+inline Vector4 duplicateLow4(Vector4 c) { return vzipq_f32(c, c).val[0]; }
+// {c2, c2, c3, c3}
+inline Vector4 duplicateHigh4(Vector4 c) { return vzipq_f32(c, c).val[1]; }
+
+inline float horizontalSum4(Vector4 v) {
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    const float32x2_t sum = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(sum, sum), 0);
+#endif
+}
+
+// Add the two stereo frames {L0, R0, L1, R1} of v and write {L, R}.
+inline void storeStereoSum4(float *frame, Vector4 v) {
+    vst1_f32(frame, vadd_f32(vget_low_f32(v), vget_high_f32(v)));
+}
+
+constexpr const char *kVectorName = "NEON";
+#else
+using Vector4 = __m128;
+
+inline Vector4 zero4() { return _mm_setzero_ps(); }
+inline Vector4 load4(const float *p) { return _mm_loadu_ps(p); }
+inline void store4(float *p, Vector4 v) { _mm_storeu_ps(p, v); }
+inline Vector4 broadcast4(float f) { return _mm_set1_ps(f); }
+inline Vector4 add4(Vector4 a, Vector4 b) { return _mm_add_ps(a, b); }
+inline Vector4 mulAdd4(Vector4 sum, Vector4 a, Vector4 b) {
+    return _mm_add_ps(sum, _mm_mul_ps(a, b));
+}
+inline Vector4 duplicateLow4(Vector4 c) { return _mm_unpacklo_ps(c, c); }
+inline Vector4 duplicateHigh4(Vector4 c) { return _mm_unpackhi_ps(c, c); }
+
+inline float horizontalSum4(Vector4 v) {
+    const __m128 sum = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+inline void storeStereoSum4(float *frame, Vector4 v) {
+    _mm_storel_pi(reinterpret_cast<__m64 *>(frame), _mm_add_ps(v, _mm_movehl_ps(v, v)));
+}
+
+constexpr const char *kVectorName = "SSE";
+#endif
+
+float convolveMonoVector(const float *x, const float *coefficients, int32_t numTaps) {
+    Vector4 sum = zero4();
+    int32_t tap = 0;
+    for (; tap + 4 <= numTaps; tap += 4) {
+        sum = mulAdd4(sum, load4(x + tap), load4(coefficients + tap));
+    }
+    return horizontalSum4(sum)
+            + convolveChannelPortable(x + tap, coefficients + tap, numTaps - tap, 1);
+}
+
+void convolveStereoVector(const float *x, const float *coefficients, int32_t numTaps,
+                          float *frame) {
+    Vector4 sum = zero4();
+    int32_t tap = 0;
+    for (; tap + 4 <= numTaps; tap += 4) {
+        const Vector4 coefficient = load4(coefficients + tap);
+        sum = mulAdd4(sum, load4(x + tap * 2), duplicateLow4(coefficient));
+        sum = mulAdd4(sum, load4(x + tap * 2 + 4), duplicateHigh4(coefficient));
+    }
+    storeStereoSum4(frame, sum);
+    for (int channel = 0; channel < 2; channel++) {
+        frame[channel] += convolveChannelPortable(x + tap * 2 + channel, coefficients + tap,
+                                                  numTaps - tap, 2);
+    }
+}
+
+void convolveVector(const float *x, const float *coefficients, int32_t numTaps,
+                    int32_t channelCount, float *frame) {
+    if (channelCount == 1) {
+        frame[0] = convolveMonoVector(x, coefficients, numTaps);
+        return;
+    } else if (channelCount == 2) {
+        convolveStereoVector(x, coefficients, numTaps, frame);
+        return;
+    }
+    // Run the taps for four channels at a time.
+    // The odd and even taps are added separately to shorten the dependency chain.
+    int32_t channel = 0;
+    for (; channel + 4 <= channelCount; channel += 4) {
+        const float *sample = x + channel;
+        Vector4 sumEven = zero4();
+        Vector4 sumOdd = zero4();
+        int32_t tap = 0;
+        for (; tap + 2 <= numTaps; tap += 2) {
+            sumEven = mulAdd4(sumEven, load4(sample), broadcast4(coefficients[tap]));
+            sumOdd = mulAdd4(sumOdd, load4(sample + channelCount),
+                             broadcast4(coefficients[tap + 1]));
+            sample += channelCount * 2;
+        }
+        if (tap < numTaps) {
+            sumEven = mulAdd4(sumEven, load4(sample), broadcast4(coefficients[tap]));
+        }
+        store4(frame + channel, add4(sumEven, sumOdd));
+    }
+    for (; channel < channelCount; channel++) {
+        frame[channel] = convolveChannelPortable(x + channel, coefficients, numTaps,
+                                                 channelCount);
+    }
+}
+
+void convolveDualVector(const float *x, const float *coefficients1,
+                        const float *coefficients2, int32_t numTaps,
+                        int32_t channelCount, float *frame1, float *frame2) {
+    int32_t channel = 0;
+    if (channelCount <= 2) {
+        // Consecutive taps are next to each other in x so run four samples at a time.
+        Vector4 sum1 = zero4();
+        Vector4 sum2 = zero4();
+        int32_t tap = 0;
+        if (channelCount == 1) {
+            for (; tap + 4 <= numTaps; tap += 4) {
+                const Vector4 sample = load4(x + tap);
+                sum1 = mulAdd4(sum1, sample, load4(coefficients1 + tap));
+                sum2 = mulAdd4(sum2, sample, load4(coefficients2 + tap));
+            }
+            frame1[0] = horizontalSum4(sum1);
+            frame2[0] = horizontalSum4(sum2);
+        } else {
+            for (; tap + 4 <= numTaps; tap += 4) {
+                const Vector4 samples01 = load4(x + tap * 2);
+                const Vector4 samples23 = load4(x + tap * 2 + 4);
+                const Vector4 coefficient1 = load4(coefficients1 + tap);
+                const Vector4 coefficient2 = load4(coefficients2 + tap);
+                sum1 = mulAdd4(sum1, samples01, duplicateLow4(coefficient1));
+                sum1 = mulAdd4(sum1, samples23, duplicateHigh4(coefficient1));
+                sum2 = mulAdd4(sum2, samples01, duplicateLow4(coefficient2));
+                sum2 = mulAdd4(sum2, samples23, duplicateHigh4(coefficient2));
+            }
+            storeStereoSum4(frame1, sum1);
+            storeStereoSum4(frame2, sum2);
+        }
+        for (; channel < channelCount; channel++) {
+            float sample1;
+            float sample2;
+            convolveChannelDualPortable(x + tap * channelCount + channel,
+                                        coefficients1 + tap, coefficients2 + tap,
+                                        numTaps - tap, channelCount, &sample1, &sample2);
+            frame1[channel] += sample1;
+            frame2[channel] += sample2;
+        }
+        return;
+    }
+    for (; channel + 4 <= channelCount; channel += 4) {
+        const float *sample = x + channel;
+        Vector4 sum1 = zero4();
+        Vector4 sum2 = zero4();
+        for (int32_t tap = 0; tap < numTaps; tap++) {
+            const Vector4 samples = load4(sample);
+            sum1 = mulAdd4(sum1, samples, broadcast4(coefficients1[tap]));
+            sum2 = mulAdd4(sum2, samples, broadcast4(coefficients2[tap]));
+            sample += channelCount;
+        }
+        store4(frame1 + channel, sum1);
+        store4(frame2 + channel, sum2);
+    }
+    for (; channel < channelCount; channel++) {
+        convolveChannelDualPortable(x + channel, coefficients1, coefficients2, numTaps,
+                                    channelCount, frame1 + channel, frame2 + channel);
+    }
+}
+
+constexpr ConvolutionKernels kVectorKernels = {
+    convolveMonoVector,
+    convolveStereoVector,
+    convolveVector,
+    convolveDualVector,
+    kVectorName,
+};
+
+#endif // RESAMPLER_USE_NEON || RESAMPLER_USE_SSE
+
+#if RESAMPLER_USE_AVX2
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+// Fold the two 128 bit lanes together.
+AVX2_TARGET inline __m128 fold8(__m256 v) {
+    return _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+}
+
+// {c0, c0, c1, c1, c2, c2, c3, c3} from four coefficients.
+AVX2_TARGET inline __m256 duplicatePairs8(const float *coefficients) {
+    return _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(coefficients)),
+                                    _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3));
+}
+
+AVX2_TARGET void convolveAVX2(const float *x, const float *coefficients, int32_t numTaps,
+                              int32_t channelCount, float *frame) {
+    if (channelCount == 1) {
+        frame[0] = convolveMonoVector(x, coefficients, numTaps);
+        return;
+    } else if (channelCount == 2) {
+        convolveStereoVector(x, coefficients, numTaps, frame);
+        return;
+    }
+    // The odd and even taps are added separately to shorten the dependency chain.
+    int32_t channel = 0;
+    for (; channel + 8 <= channelCount; channel += 8) {
+        const float *sample = x + channel;
+        __m256 sumEven = _mm256_setzero_ps();
+        __m256 sumOdd = _mm256_setzero_ps();
+        int32_t tap = 0;
+        for (; tap + 2 <= numTaps; tap += 2) {
+            sumEven = _mm256_fmadd_ps(_mm256_loadu_ps(sample),
+                                      _mm256_set1_ps(coefficients[tap]), sumEven);
+            sumOdd = _mm256_fmadd_ps(_mm256_loadu_ps(sample + channelCount),
+                                     _mm256_set1_ps(coefficients[tap + 1]), sumOdd);
+            sample += channelCount * 2;
+        }
+        if (tap < numTaps) {
+            sumEven = _mm256_fmadd_ps(_mm256_loadu_ps(sample),
+                                      _mm256_set1_ps(coefficients[tap]), sumEven);
+        }
+        _mm256_storeu_ps(frame + channel, _mm256_add_ps(sumEven, sumOdd));
+    }
+    for (; channel + 4 <= channelCount; channel += 4) {
+        const float *sample = x + channel;
+        __m128 sumEven = _mm_setzero_ps();
+        __m128 sumOdd = _mm_setzero_ps();
+        int32_t tap = 0;
+        for (; tap + 2 <= numTaps; tap += 2) {
+            sumEven = _mm_fmadd_ps(_mm_loadu_ps(sample), _mm_set1_ps(coefficients[tap]),
+                                   sumEven);
+            sumOdd = _mm_fmadd_ps(_mm_loadu_ps(sample + channelCount),
+                                  _mm_set1_ps(coefficients[tap + 1]), sumOdd);
+            sample += channelCount * 2;
+        }
+        if (tap < numTaps) {
+            sumEven = _mm_fmadd_ps(_mm_loadu_ps(sample), _mm_set1_ps(coefficients[tap]),
+                                   sumEven);
+        }
+        _mm_storeu_ps(frame + channel, _mm_add_ps(sumEven, sumOdd));
+    }
+    for (; channel < channelCount; channel++) {
+        frame[channel] = convolveChannelPortable(x + channel, coefficients, numTaps,
+                                                 channelCount);
+    }
+}
+
+AVX2_TARGET void convolveDualAVX2(const float *x, const float *coefficients1,
+                                  const float *coefficients2, int32_t numTaps,
+                                  int32_t channelCount, float *frame1, float *frame2) {
+    int32_t channel = 0;
+    if (channelCount <= 2) {
+        // Consecutive taps are next to each other in x so run eight samples at a time.
+        __m256 sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps();
+        int32_t tap = 0;
+        if (channelCount == 1) {
+            for (; tap + 8 <= numTaps; tap += 8) {
+                const __m256 samples = _mm256_loadu_ps(x + tap);
+                sum1 = _mm256_fmadd_ps(samples, _mm256_loadu_ps(coefficients1 + tap), sum1);
+                sum2 = _mm256_fmadd_ps(samples, _mm256_loadu_ps(coefficients2 + tap), sum2);
+            }
+            __m128 sum1x4 = fold8(sum1);
+            __m128 sum2x4 = fold8(sum2);
+            if (tap + 4 <= numTaps) {
+                const __m128 samples = _mm_loadu_ps(x + tap);
+                sum1x4 = _mm_fmadd_ps(samples, _mm_loadu_ps(coefficients1 + tap), sum1x4);
+                sum2x4 = _mm_fmadd_ps(samples, _mm_loadu_ps(coefficients2 + tap), sum2x4);
+                tap += 4;
+            }
+            frame1[0] = horizontalSum4(sum1x4);
+            frame2[0] = horizontalSum4(sum2x4);
+        } else {
+            for (; tap + 4 <= numTaps; tap += 4) {
+                const __m256 samples = _mm256_loadu_ps(x + tap * 2);
+                sum1 = _mm256_fmadd_ps(samples, duplicatePairs8(coefficients1 + tap), sum1);
+                sum2 = _mm256_fmadd_ps(samples, duplicatePairs8(coefficients2 + tap), sum2);
+            }
+            storeStereoSum4(frame1, fold8(sum1));
+            storeStereoSum4(frame2, fold8(sum2));
+        }
+        for (; channel < channelCount; channel++) {
+            float sample1;
+            float sample2;
+            convolveChannelDualPortable(x + tap * channelCount + channel,
+                                        coefficients1 + tap, coefficients2 + tap,
+                                        numTaps - tap, channelCount, &sample1, &sample2);
+            frame1[channel] += sample1;
+            frame2[channel] += sample2;
+        }
+        return;
+    }
+    for (; channel + 8 <= channelCount; channel += 8) {
+        const float *sample = x + channel;
+        __m256 sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps();
+        for (int32_t tap = 0; tap < numTaps; tap++) {
+            const __m256 samples = _mm256_loadu_ps(sample);
+            sum1 = _mm256_fmadd_ps(samples, _mm256_set1_ps(coefficients1[tap]), sum1);
+            sum2 = _mm256_fmadd_ps(samples, _mm256_set1_ps(coefficients2[tap]), sum2);
+            sample += channelCount;
+        }
+        _mm256_storeu_ps(frame1 + channel, sum1);
+        _mm256_storeu_ps(frame2 + channel, sum2);
+    }
+    for (; channel + 4 <= channelCount; channel += 4) {
+        const float *sample = x + channel;
+        __m128 sum1 = _mm_setzero_ps();
+        __m128 sum2 = _mm_setzero_ps();
+        for (int32_t tap = 0; tap < numTaps; tap++) {
+            const __m128 samples = _mm_loadu_ps(sample);
+            sum1 = _mm_fmadd_ps(samples, _mm_set1_ps(coefficients1[tap]), sum1);
+            sum2 = _mm_fmadd_ps(samples, _mm_set1_ps(coefficients2[tap]), sum2);
+            sample += channelCount;
+        }
+        _mm_storeu_ps(frame1 + channel, sum1);
+        _mm_storeu_ps(frame2 + channel, sum2);
+    }
+    for (; channel < channelCount; channel++) {
+        convolveChannelDualPortable(x + channel, coefficients1, coefficients2, numTaps,
+                                    channelCount, frame1 + channel, frame2 + channel);
+    }
+}
+
+#undef AVX2_TARGET
+
+// The polyphase mono and stereo dot products are too short to gain from 8 lanes
+// and measured faster with the 4 lane kernels.
+constexpr ConvolutionKernels kAVX2Kernels = {
+    convolveMonoVector,
+    convolveStereoVector,
+    convolveAVX2,
+    convolveDualAVX2,
+    "AVX2",
+};
+
+bool isAVX2Supported() {
+#if defined(__AVX2__) && defined(__FMA__)
+    return true;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif // RESAMPLER_USE_AVX2
+
+} // namespace
+
+const ConvolutionKernels &ConvolutionKernels::portable() {
+    return kPortableKernels;
+}
+
+const ConvolutionKernels &ConvolutionKernels::best() {
+#if RESAMPLER_USE_AVX2
+    static const bool useAVX2 = isAVX2Supported();
+    if (useAVX2) {
+        return kAVX2Kernels;
+    }
+#endif
+#if RESAMPLER_USE_NEON || RESAMPLER_USE_SSE
+    return kVectorKernels;
+#else
+    return kPortableKernels;
+#endif
+}
+
+std::vector<const ConvolutionKernels *> ConvolutionKernels::supported() {
+    std::vector<const ConvolutionKernels *> kernels = {&kPortableKernels};
+#if RESAMPLER_USE_NEON || RESAMPLER_USE_SSE
+    kernels.push_back(&kVectorKernels);
+#endif
+#if RESAMPLER_USE_AVX2
+    if (isAVX2Supported()) {
+        kernels.push_back(&kAVX2Kernels);
+    }
+#endif
+    return kernels;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef RESAMPLER_CONVOLUTION_KERNELS_H
+#define RESAMPLER_CONVOLUTION_KERNELS_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ResamplerDefinitions.h"
+
+namespace RESAMPLER_OUTER_NAMESPACE::resampler {
+
+/**
+ * Table of the FIR dot products used by the resamplers to read a frame.
+ *
+ * The input x is the delay line of the resampler, numTaps interleaved frames
+ * of channelCount samples. Each output sample is the sum over the taps of
+ * one channel of x multiplied by the coefficient of that tap.
+ *
+ * The vector versions may add the products in a different order than the portable version
+ * so their results can differ by a few ULPs.
+ */
+struct ConvolutionKernels {
+    /**
+     * @return sum of x[i] * coefficients[i] for i in [0, numTaps)
+     */
+    float (*convolveMono)(const float *x, const float *coefficients, int32_t numTaps);
+
+    /**
+     * Convolve numTaps stereo frames and write one stereo frame.
+     */
+    void (*convolveStereo)(const float *x, const float *coefficients, int32_t numTaps,
+                           float *frame);
+
+    /**
+     * Convolve numTaps frames of any channelCount and write one frame.
+     */
+    void (*convolve)(const float *x, const float *coefficients, int32_t numTaps,
+                     int32_t channelCount, float *frame);
+
+    /**
+     * Convolve the same frames with two sets of coefficients, for the interpolating resamplers.
+     * Writes one frame to frame1 from coefficients1 and one frame to frame2 from coefficients2.
+     */
+    void (*convolveDual)(const float *x, const float *coefficients1,
+                         const float *coefficients2, int32_t numTaps,
+                         int32_t channelCount, float *frame1, float *frame2);
+
+    /** Name of the instruction set used, for logging and benchmarks. */
+    const char *name;
+
+    /**
+     * @return portable kernels written in plain C++
+     */
+    static const ConvolutionKernels &portable();
+
+    /**
+     * The kernels are selected once, based on the CPU features detected at run time.
+     * @return fastest kernels supported by this CPU
+     */
+    static const ConvolutionKernels &best();
+
+    /**
+     * @return every set of kernels supported by this CPU, starting with the portable ones
+     */
+    static std::vector<const ConvolutionKernels *> supported();
+};
+
+} /* namespace RESAMPLER_OUTER_NAMESPACE::resampler */
+
+#endif //RESAMPLER_CONVOLUTION_KERNELS_H
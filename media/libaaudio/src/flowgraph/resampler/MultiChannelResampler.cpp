@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <math.h>
 
 #include "IntegerRatio.h"
@@ -32,6 +33,7 @@ MultiChannelResampler::MultiChannelResampler(const MultiChannelResampler::Builde
         , mX(static_cast<size_t>(builder.getChannelCount())
                 * static_cast<size_t>(builder.getNumTaps()) * 2)
         , mSingleFrame(builder.getChannelCount())
+        , mKernels(ConvolutionKernels::best())
         , mChannelCount(builder.getChannelCount())
         {
     // Reduce sample rates to the smallest ratio.
@@ -113,10 +115,9 @@ void MultiChannelResampler::writeFrame(const float *frame) {
     }
     float *dest = &mX[static_cast<size_t>(mCursor) * static_cast<size_t>(getChannelCount())];
     int offset = getNumTaps() * getChannelCount();
-    for (int channel = 0; channel < getChannelCount(); channel++) {
-        // Write twice so we avoid having to wrap when reading.
-        dest[channel] = dest[channel + offset] = frame[channel];
-    }
+    // Write twice so we avoid having to wrap when reading.
+    std::copy(frame, frame + getChannelCount(), dest);
+    std::copy(frame, frame + getChannelCount(), dest + offset);
 }
 
 float MultiChannelResampler::sinc(float radians) {
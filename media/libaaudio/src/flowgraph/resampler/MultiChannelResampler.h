@@ -34,6 +34,7 @@
 #include "HyperbolicCosineWindow.h"
 #endif
 
+#include "ConvolutionKernels.h"
 #include "ResamplerDefinitions.h"
 
 namespace RESAMPLER_OUTER_NAMESPACE::resampler {
@@ -255,6 +256,9 @@ protected:
     int32_t              mNumerator = 0;
     int32_t              mDenominator = 0;
 
+    // FIR dot products, vectorized for this CPU when possible.
+    const ConvolutionKernels &mKernels;
+
 
 private:
 
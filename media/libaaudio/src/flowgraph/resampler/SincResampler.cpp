@@ -36,30 +36,20 @@ SincResampler::SincResampler(const MultiChannelResampler::Builder &builder)
 }
 
 void SincResampler::readFrame(float *frame) {
-    // Clear accumulator for mixing.
-    std::fill(mSingleFrame.begin(), mSingleFrame.end(), 0.0);
-    std::fill(mSingleFrame2.begin(), mSingleFrame2.end(), 0.0);
-
     // Determine indices into coefficients table.
     const double tablePhase = getIntegerPhase() * mPhaseScaler;
     const int indexLow = static_cast<int>(floor(tablePhase));
     const int indexHigh = indexLow + 1; // OK because using a guard row.
     assert (indexHigh < mNumRows);
-    float *coefficientsLow = &mCoefficients[static_cast<size_t>(indexLow)
-                                            * static_cast<size_t>(getNumTaps())];
-    float *coefficientsHigh = &mCoefficients[static_cast<size_t>(indexHigh)
-                                             * static_cast<size_t>(getNumTaps())];
+    const float *coefficientsLow = &mCoefficients[static_cast<size_t>(indexLow)
+                                                  * static_cast<size_t>(getNumTaps())];
+    const float *coefficientsHigh = &mCoefficients[static_cast<size_t>(indexHigh)
+                                                   * static_cast<size_t>(getNumTaps())];
 
-    float *xFrame = &mX[static_cast<size_t>(mCursor) * static_cast<size_t>(getChannelCount())];
-    for (int tap = 0; tap < mNumTaps; tap++) {
-        const float coefficientLow = *coefficientsLow++;
-        const float coefficientHigh = *coefficientsHigh++;
-        for (int channel = 0; channel < getChannelCount(); channel++) {
-            const float sample = *xFrame++;
-            mSingleFrame[channel] += sample * coefficientLow;
-            mSingleFrame2[channel] += sample * coefficientHigh;
-        }
-    }
+    const float *xFrame = &mX[static_cast<size_t>(mCursor)
+            * static_cast<size_t>(getChannelCount())];
+    mKernels.convolveDual(xFrame, coefficientsLow, coefficientsHigh, mNumTaps,
+                          getChannelCount(), mSingleFrame.data(), mSingleFrame2.data());
 
     // Interpolate and copy to output.
     const float fraction = tablePhase - indexLow;
@@ -632,6 +632,10 @@ int32_t AAudioProperty_getOutputMMapOffsetMicros() {
     return AAudioProperty_getMMapOffsetMicros(__func__, AAUDIO_PROP_OUTPUT_MMAP_OFFSET_USEC);
 }
 
+bool AAudioProperty_isSharedCaptureRingEnabled() {
+    return property_get_bool(AAUDIO_PROP_SHARED_CAPTURE_RING, false);
+}
+
 int32_t AAudioProperty_getLogMask() {
     return property_get_int32(AAUDIO_PROP_LOG_MASK, 0);
 }
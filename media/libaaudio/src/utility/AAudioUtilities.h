@@ -166,6 +166,16 @@ int32_t AAudioProperty_getInputMMapOffsetMicros();
 int32_t AAudioProperty_getOutputMMapOffsetMicros();
 #define AAUDIO_PROP_OUTPUT_MMAP_OFFSET_USEC   "aaudio.out_mmap_offset_usec"
 
+/**
+ * Read a system property that specifies whether the shared streams of an MMAP capture
+ * endpoint read a single ring buffer written by the service, instead of each stream
+ * receiving its own copy of the data.
+ *
+ * @return true if the streams share the captured data
+ */
+bool AAudioProperty_isSharedCaptureRingEnabled();
+#define AAUDIO_PROP_SHARED_CAPTURE_RING   "aaudio.shared_capture_ring"
+
 // These are powers of two that can be combined as a bit mask.
 // AAUDIO_LOG_CLOCK_MODEL_HISTOGRAM must be enabled before the stream is opened.
 #define AAUDIO_LOG_CLOCK_MODEL_HISTOGRAM   1
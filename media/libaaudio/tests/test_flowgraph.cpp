@@ -22,9 +22,13 @@
  */
 
 #include <iostream>
+#include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "client/AAudioFlowGraph.h"
+
 #include "flowgraph/ClipToRange.h"
 #include "flowgraph/Limiter.h"
 #include "flowgraph/MonoBlend.h"
@@ -394,3 +398,82 @@ TEST(test_flowgraph, module_limiter_nan) {
         EXPECT_NEAR(expected[i], output[i], tolerance);
     }
 }
+
+static int32_t bytesPerSample(audio_format_t format) {
+    return format == AUDIO_FORMAT_PCM_24_BIT_PACKED ? kBytesPerI24Packed
+            : static_cast<int32_t>(audio_bytes_per_sample(format));
+}
+
+// The fused kernel of AAudioFlowGraph must match pulling data through the graph node by node.
+TEST(test_flowgraph, aaudio_flowgraph_fused) {
+    constexpr audio_format_t kFormats[] = {
+            AUDIO_FORMAT_PCM_FLOAT,
+            AUDIO_FORMAT_PCM_16_BIT,
+            AUDIO_FORMAT_PCM_24_BIT_PACKED,
+            AUDIO_FORMAT_PCM_32_BIT,
+    };
+    constexpr std::pair<int32_t, int32_t> kChannelCounts[] = {{1, 1}, {1, 2}, {2, 2}, {6, 6}};
+    // Uneven bursts so that ramps and fused blocks end in the middle of a burst.
+    constexpr int32_t kBursts[] = {37, 200, 5, 96, 64, 301};
+    constexpr int32_t kMaxFrames = 301;
+    constexpr int32_t kRampFrames = 50;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> distribution(-1.2f, 1.2f);
+
+    for (audio_format_t sourceFormat : kFormats) {
+        for (audio_format_t sinkFormat : kFormats) {
+            for (const auto& [sourceChannelCount, sinkChannelCount] : kChannelCounts) {
+                for (bool isExclusive : {false, true}) {
+                    AAudioFlowGraph fused;
+                    AAudioFlowGraph graph;
+                    graph.setFusionAllowed(false);
+                    for (AAudioFlowGraph *flowGraph : {&fused, &graph}) {
+                        ASSERT_EQ(AAUDIO_OK, flowGraph->configure(sourceFormat,
+                                sourceChannelCount, sinkFormat, sinkChannelCount,
+                                false /* useMonoBlend */, 0.0f /* audioBalance */,
+                                isExclusive));
+                        flowGraph->setRampLengthInFrames(kRampFrames);
+                    }
+                    // float to float uses the Limiter, which is not fused.
+                    EXPECT_EQ(sourceFormat != AUDIO_FORMAT_PCM_FLOAT
+                            || sinkFormat != AUDIO_FORMAT_PCM_FLOAT, fused.isFused());
+                    EXPECT_FALSE(graph.isFused());
+
+                    const int32_t sourceBytes = bytesPerSample(sourceFormat) * sourceChannelCount;
+                    const int32_t sinkBytes = bytesPerSample(sinkFormat) * sinkChannelCount;
+                    std::vector<uint8_t> source(kMaxFrames * sourceBytes);
+                    std::vector<uint8_t> expected(kMaxFrames * sinkBytes);
+                    std::vector<uint8_t> actual(kMaxFrames * sinkBytes);
+                    float volume = 1.0f;
+                    for (int32_t numFrames : kBursts) {
+                        if (sourceFormat == AUDIO_FORMAT_PCM_FLOAT) {
+                            float *floats = reinterpret_cast<float *>(source.data());
+                            for (int32_t i = 0; i < numFrames * sourceChannelCount; i++) {
+                                floats[i] = distribution(random);
+                            }
+                        } else {
+                            for (uint8_t &byte : source) {
+                                byte = random();
+                            }
+                        }
+                        graph.process(source.data(), expected.data(), numFrames);
+                        fused.process(source.data(), actual.data(), numFrames);
+                        ASSERT_EQ(0, memcmp(expected.data(), actual.data(),
+                                            numFrames * sinkBytes))
+                                << "source format " << sourceFormat
+                                << " sink format " << sinkFormat
+                                << " channels " << sourceChannelCount << "->" << sinkChannelCount
+                                << " exclusive " << isExclusive << " burst " << numFrames;
+
+                        // Start a new ramp, which only applies to exclusive streams.
+                        volume = volume * 0.7f;
+                        graph.setTargetVolume(volume);
+                        fused.setTargetVolume(volume);
+                        graph.setAudioBalance(volume - 0.5f);
+                        fused.setAudioBalance(volume - 0.5f);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -27,7 +27,10 @@
 #include <sys/mman.h>
 
 #include <aaudio/AAudio.h>
+#include <binding/AAudioServiceMessage.h>
 #include <binding/AudioEndpointParcelable.h>
+#include <client/AudioEndpoint.h>
+#include <fifo/FifoBuffer.h>
 
 using android::base::unique_fd;
 using namespace android;
@@ -186,3 +189,133 @@ TEST(test_marshalling, aaudio_ring_buffer_parcelable) {
     EXPECT_EQ(ringBufferA.getBytesPerFrame(), ringBufferB.getBytesPerFrame());
     EXPECT_EQ(ringBufferA.getCapacityInFrames(), ringBufferB.getCapacityInFrames());
 }
+
+// Test a RingBufferParcelable whose data is shared read-only by several readers,
+// each with its own read counter.
+TEST(test_marshalling, aaudio_ring_buffer_parcelable_shared_data) {
+    SharedMemoryParcelable sharedMemories[2];
+    RingBufferParcelable ringBufferA;
+
+    const size_t bytesPerFrame = 8;
+    const size_t dataSizeBytes = 2048;
+    const int32_t counterSizeBytes = sizeof(int64_t);
+    const size_t dataMemSizeBytes = dataSizeBytes + counterSizeBytes;
+
+    // The writer maps the data before it is made read-only.
+    unique_fd dataFd(ashmem_create_region("TestMarshalling Data", dataMemSizeBytes));
+    ASSERT_LE(0, dataFd);
+    auto writerAddress = (uint8_t *) mmap(nullptr, dataMemSizeBytes, PROT_READ | PROT_WRITE,
+                                          MAP_SHARED, dataFd.get(), 0);
+    ASSERT_NE(MAP_FAILED, writerAddress);
+    ASSERT_EQ(0, ashmem_set_prot_region(dataFd.get(), PROT_READ));
+    unique_fd readFd(ashmem_create_region("TestMarshalling Read", counterSizeBytes));
+    ASSERT_LE(0, readFd);
+    sharedMemories[0].setup(dataFd, dataMemSizeBytes);
+    sharedMemories[1].setup(readFd, counterSizeBytes);
+
+    // write counter followed by the data, read counter in its own memory
+    ringBufferA.setupMemory({0, counterSizeBytes, dataSizeBytes},
+                            {1, 0, counterSizeBytes},
+                            {0, 0, counterSizeBytes});
+    ringBufferA.setBytesPerFrame(bytesPerFrame);
+    ringBufferA.setCapacityInFrames(dataSizeBytes / bytesPerFrame);
+    ringBufferA.setFlags(RingbufferFlags::SHARED_DATA);
+
+    // write A to parcel
+    Parcel parcel;
+    size_t pos = parcel.dataPosition();
+    writeToParcel(ringBufferA, &parcel);
+
+    // read B from parcel
+    parcel.setDataPosition(pos);
+    RingBufferParcelable ringBufferB = readFromParcel<RingBufferParcelable>(parcel);
+    EXPECT_EQ(RingbufferFlags::SHARED_DATA, ringBufferB.getFlags());
+
+    // The read-only data can still be resolved.
+    RingBufferDescriptor descriptorB;
+    ASSERT_EQ(AAUDIO_OK, ringBufferB.resolve(sharedMemories, &descriptorB));
+    EXPECT_EQ(RingbufferFlags::SHARED_DATA, descriptorB.flags);
+    writerAddress[counterSizeBytes] = 95;
+    reinterpret_cast<int64_t *>(writerAddress)[0] = 39;
+    EXPECT_EQ(95, descriptorB.dataAddress[0]);
+    EXPECT_EQ(39, descriptorB.writeCounterAddress[0]);
+    descriptorB.readCounterAddress[0] = 17;
+    EXPECT_EQ(17, descriptorB.readCounterAddress[0]);
+
+    munmap(writerAddress, dataMemSizeBytes);
+}
+
+// Open a second reader over a ring that is already being written and that
+// is only mapped read-only by its readers.
+TEST(test_marshalling, aaudio_shared_data_second_reader) {
+    const int32_t bytesPerFrame = 4;
+    const int32_t capacityInFrames = 64;
+    const int32_t dataSizeBytes = bytesPerFrame * capacityInFrames;
+    const int32_t counterSizeBytes = sizeof(int64_t);
+    const int32_t dataMemSizeBytes = dataSizeBytes + counterSizeBytes;
+
+    // The writer owns the write counter and the data, like SharedRingBuffer.
+    unique_fd dataFd(ashmem_create_region("TestMarshalling Data", dataMemSizeBytes));
+    ASSERT_LE(0, dataFd);
+    auto writerAddress = (uint8_t *) mmap(nullptr, dataMemSizeBytes, PROT_READ | PROT_WRITE,
+                                          MAP_SHARED, dataFd.get(), 0);
+    ASSERT_NE(MAP_FAILED, writerAddress);
+    fifo_counter_t writerReadCounter = 0;
+    FifoBufferIndirect writer(bytesPerFrame, capacityInFrames, &writerReadCounter,
+                              reinterpret_cast<fifo_counter_t *>(writerAddress),
+                              writerAddress + counterSizeBytes);
+    int32_t frames[capacityInFrames];
+    for (int32_t i = 0; i < capacityInFrames; i++) {
+        frames[i] = i;
+    }
+    writer.write(frames, 40);
+    writer.setReadCounter(writer.getWriteCounter()); // the writer does not wait
+    ASSERT_EQ(0, ashmem_set_prot_region(dataFd.get(), PROT_READ));
+
+    // Each reader owns only its read counter.
+    AAudioServiceMessage messages[4];
+    fifo_counter_t messageCounters[2] = {};
+    EndpointDescriptor descriptors[2];
+    SharedMemoryParcelable sharedMemories[2][2];
+    AudioEndpoint endpoints[2];
+    for (int i = 0; i < 2; i++) {
+        unique_fd readFd(ashmem_create_region("TestMarshalling Read", counterSizeBytes));
+        ASSERT_LE(0, readFd);
+        sharedMemories[i][0].setup(dataFd, dataMemSizeBytes);
+        sharedMemories[i][1].setup(readFd, counterSizeBytes);
+        RingBufferParcelable ringBuffer;
+        ringBuffer.setupMemory({0, counterSizeBytes, dataSizeBytes},
+                               {1, 0, counterSizeBytes},
+                               {0, 0, counterSizeBytes});
+        ringBuffer.setBytesPerFrame(bytesPerFrame);
+        ringBuffer.setCapacityInFrames(capacityInFrames);
+        ringBuffer.setFlags(RingbufferFlags::SHARED_DATA);
+
+        EndpointDescriptor& descriptor = descriptors[i];
+        descriptor.upMessageQueueDescriptor = {
+                reinterpret_cast<uint8_t *>(messages), &messageCounters[1], &messageCounters[0],
+                sizeof(AAudioServiceMessage), 1, 4, RingbufferFlags::NONE};
+        ASSERT_EQ(AAUDIO_OK, ringBuffer.resolve(sharedMemories[i],
+                                                &descriptor.dataQueueDescriptor));
+        ASSERT_EQ(AAUDIO_OK, endpoints[i].configure(&descriptor, AAUDIO_DIRECTION_INPUT));
+        ASSERT_TRUE(endpoints[i].isSharedData());
+
+        // The live write counter is left alone and the reader starts at the newest data.
+        EXPECT_EQ(40, writer.getWriteCounter());
+        EXPECT_EQ(40, endpoints[i].getDataReadCounter());
+        EXPECT_EQ(0, endpoints[i].getFullFramesAvailable());
+    }
+
+    writer.write(frames, 8);
+    for (AudioEndpoint& endpoint : endpoints) {
+        int32_t read[8] = {};
+        ASSERT_EQ(8, endpoint.getFullFramesAvailable());
+        ASSERT_EQ(8, endpoint.read(read, 8));
+        for (int32_t i = 0; i < 8; i++) {
+            EXPECT_EQ(i, read[i]);
+        }
+        EXPECT_EQ(48, endpoint.getDataReadCounter());
+    }
+
+    munmap(writerAddress, dataMemSizeBytes);
+}
@@ -21,10 +21,12 @@
  * sometimes that have caused compiler bugs.
  */
 
-#include <iostream>
+#include <random>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "flowgraph/resampler/ConvolutionKernels.h"
 #include "flowgraph/resampler/MultiChannelResampler.h"
 
 using namespace RESAMPLER_OUTER_NAMESPACE::resampler;
@@ -219,3 +221,67 @@ TEST(test_resampler, resampler_48000_44100_best) {
 TEST(test_resampler, resampler_44100_11025_best) {
     checkResampler(44100, 11025, MultiChannelResampler::Quality::Best);
 }
+
+// Compare each kernel of a set against the portable one with random input.
+static void checkConvolutionKernels(const ConvolutionKernels &portable,
+                                    const ConvolutionKernels &kernels, float tolerance) {
+    std::mt19937 generator(1234);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    // Include tap counts that are not a multiple of the vector width.
+    for (int32_t numTaps : {1, 3, 4, 8, 12, 16, 20, 32, 37}) {
+        for (int32_t channelCount = 1; channelCount <= 12; channelCount++) {
+            std::vector<float> x(static_cast<size_t>(numTaps * channelCount));
+            std::vector<float> coefficients1(static_cast<size_t>(numTaps));
+            std::vector<float> coefficients2(static_cast<size_t>(numTaps));
+            for (float &sample : x) sample = distribution(generator);
+            for (float &coefficient : coefficients1) coefficient = distribution(generator);
+            for (float &coefficient : coefficients2) coefficient = distribution(generator);
+
+            std::vector<float> expected1(static_cast<size_t>(channelCount));
+            std::vector<float> expected2(static_cast<size_t>(channelCount));
+            std::vector<float> actual1(static_cast<size_t>(channelCount));
+            std::vector<float> actual2(static_cast<size_t>(channelCount));
+            SCOPED_TRACE(testing::Message() << "numTaps " << numTaps
+                    << ", channelCount " << channelCount);
+
+            portable.convolve(x.data(), coefficients1.data(), numTaps, channelCount,
+                              expected1.data());
+            kernels.convolve(x.data(), coefficients1.data(), numTaps, channelCount,
+                             actual1.data());
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                EXPECT_NEAR(expected1[channel], actual1[channel], tolerance);
+            }
+
+            portable.convolveDual(x.data(), coefficients1.data(), coefficients2.data(), numTaps,
+                                  channelCount, expected1.data(), expected2.data());
+            kernels.convolveDual(x.data(), coefficients1.data(), coefficients2.data(), numTaps,
+                                 channelCount, actual1.data(), actual2.data());
+            for (int32_t channel = 0; channel < channelCount; channel++) {
+                EXPECT_NEAR(expected1[channel], actual1[channel], tolerance);
+                EXPECT_NEAR(expected2[channel], actual2[channel], tolerance);
+            }
+
+            if (channelCount == 1) {
+                EXPECT_NEAR(portable.convolveMono(x.data(), coefficients1.data(), numTaps),
+                            kernels.convolveMono(x.data(), coefficients1.data(), numTaps),
+                            tolerance);
+            } else if (channelCount == 2) {
+                portable.convolveStereo(x.data(), coefficients1.data(), numTaps,
+                                        expected1.data());
+                kernels.convolveStereo(x.data(), coefficients1.data(), numTaps, actual1.data());
+                EXPECT_NEAR(expected1[0], actual1[0], tolerance);
+                EXPECT_NEAR(expected1[1], actual1[1], tolerance);
+            }
+        }
+    }
+}
+
+// The vector kernels only reorder the additions so they should closely match the portable ones.
+TEST(test_resampler, convolution_kernels_match_portable) {
+    const ConvolutionKernels &portable = ConvolutionKernels::portable();
+    constexpr float kTolerance = 1.0e-5f;
+    for (const ConvolutionKernels *kernels : ConvolutionKernels::supported()) {
+        SCOPED_TRACE(testing::Message() << kernels->name << " convolution kernels");
+        checkConvolutionKernels(portable, *kernels, kTolerance);
+    }
+}
@@ -717,6 +717,9 @@ void AudioMixerBase::process__validate()
         } else {
             // we keep temp arrays around.
             mHook = &AudioMixerBase::process__genericNoResampling;
+            if (mEnabled.size() > 1 && canMixMultiTrackNoResample()) {
+                mHook = &AudioMixerBase::process__noResampleMultiTrack;
+            }
             if (all16BitsStereoNoResample && !volumeRamp) {
                 if (mEnabled.size() == 1) {
                     const std::shared_ptr<TrackBase> &t = mTracks[mEnabled[0]];
@@ -1170,6 +1173,103 @@ void AudioMixerBase::process__genericNoResampling()
     }
 }
 
+bool AudioMixerBase::canMixMultiTrackNoResample() const
+{
+    for (const auto &pair : mGroups) {
+        const auto &group = pair.second;
+        if (group.size() > kMaxMultiTrackCount) {
+            return false;
+        }
+        const std::shared_ptr<TrackBase> &t1 = mTracks.at(group[0]);
+        for (const int name : group) {
+            const std::shared_ptr<TrackBase> &t = mTracks.at(name);
+            if ((t->needs & (NEEDS_RESAMPLE | NEEDS_AUX)) != 0
+                    || t->mMixerInFormat != AUDIO_FORMAT_PCM_FLOAT
+                    || t->mMixerFormat != t1->mMixerFormat
+                    || t->mMixerChannelCount != t1->mMixerChannelCount) {
+                return false;
+            }
+            // MONO_HACK tracks are expanded to all channels by their own hook.
+            if ((t->needs & NEEDS_MUTE) == 0
+                    && (t->needs & NEEDS_CHANNEL_COUNT__MASK) == NEEDS_CHANNEL_1
+                    && t->channelMask == AUDIO_CHANNEL_OUT_MONO
+                    && isAudioChannelPositionMask(t->mMixerChannelMask)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/* This process hook is called when there are several tracks, none of which needs
+ * resampling or an aux buffer. Each group of tracks sharing a main buffer is mixed
+ * one cache-resident block at a time: the first audible track stores into the block
+ * and the others add to it, with their volume ramps applied by volumeMix().
+ * Unlike process__genericNoResampling() the block is not cleared first, and a float
+ * main buffer is mixed in place instead of through a temp buffer and a copy.
+ */
+void AudioMixerBase::process__noResampleMultiTrack()
+{
+    ALOGVV("process__noResampleMultiTrack\n");
+    float outTemp[kMultiTrackBlockFrames * MAX_NUM_CHANNELS] __attribute__((aligned(32)));
+
+    for (const auto &pair : mGroups) {
+        const auto &group = pair.second;
+        const std::shared_ptr<TrackBase> &t1 = mTracks[group[0]];
+        const uint32_t channels = t1->mMixerChannelCount;
+        const bool inPlace = t1->mMixerFormat == AUDIO_FORMAT_PCM_FLOAT;
+
+        // acquire buffer
+        for (const int name : group) {
+            const std::shared_ptr<TrackBase> &t = mTracks[name];
+            t->buffer.frameCount = mFrameCount;
+            t->bufferProvider->getNextBuffer(&t->buffer);
+            t->frameCount = t->buffer.frameCount;
+            t->mIn = t->buffer.raw;
+        }
+
+        uint8_t *out = reinterpret_cast<uint8_t *>(pair.first);
+        for (size_t numFrames = 0; numFrames < mFrameCount; ) {
+            const size_t frameCount =
+                    std::min(kMultiTrackBlockFrames, mFrameCount - numFrames);
+            const size_t framesLeft = mFrameCount - numFrames;
+            float * const block = inPlace ? reinterpret_cast<float *>(out) : outTemp;
+            bool stored = false;
+            for (const int name : group) {
+                const std::shared_ptr<TrackBase> &t = mTracks[name];
+                if (stored || (t->needs & NEEDS_MUTE) != 0) {
+                    t->mixNoResampleBlock<false /* SAVEONLY */>(block, frameCount, framesLeft);
+                } else {
+                    // the first audible track stores, so the block need not be cleared.
+                    const size_t framesStored = t->mixNoResampleBlock<true /* SAVEONLY */>(
+                            block, frameCount, framesLeft);
+                    memset(block + framesStored * channels, 0,
+                            (frameCount - framesStored) * channels * sizeof(float));
+                    stored = true;
+                }
+            }
+            if (!stored) {
+                memset(block, 0, frameCount * channels * sizeof(float));
+            }
+            if (!inPlace) {
+                convertMixerFormat(out, t1->mMixerFormat, block, t1->mMixerInFormat,
+                        frameCount * channels);
+            }
+            out += frameCount * channels * audio_bytes_per_sample(t1->mMixerFormat);
+            numFrames += frameCount;
+        }
+
+        // release each track's buffer
+        for (const int name : group) {
+            const std::shared_ptr<TrackBase> &t = mTracks[name];
+            t->bufferProvider->releaseBuffer(&t->buffer);
+            if (t->needsRamp()) {
+                t->adjustVolumeRamp(false /* aux */, true /* useFloat */);
+            }
+        }
+    }
+}
+
 // generic code with resampling
 void AudioMixerBase::process__genericResampling()
 {
@@ -1549,6 +1649,51 @@ void AudioMixerBase::TrackBase::track__NoResample(
     mIn = in;
 }
 
+template <bool SAVEONLY>
+size_t AudioMixerBase::TrackBase::mixNoResampleBlock(
+        float *out, size_t outFrames, size_t framesLeft)
+{
+    const bool muted = (needs & NEEDS_MUTE) != 0;
+    const bool ramp = needsRamp();
+    size_t framesMixed = 0;
+    while (framesMixed < outFrames) {
+        // mIn == nullptr can happen if the track was flushed just after having
+        // been enabled for mixing.
+        if (mIn == nullptr) {
+            break;
+        }
+        const size_t inFrames = std::min((size_t)frameCount, outFrames - framesMixed);
+        if (inFrames > 0) {
+            // a muted track does not mix, but still consumes its data.
+            if (!muted) {
+                const float *in = static_cast<const float *>(mIn);
+                float *dst = out + framesMixed * mMixerChannelCount;
+                if (useStereoVolume()) {
+                    volumeMix<SAVEONLY ? MIXTYPE_MULTI_SAVEONLY_STEREOVOL
+                                    : MIXTYPE_MULTI_STEREOVOL,
+                            true /* USEFLOATVOL */, false /* ADJUSTVOL */>(
+                            dst, inFrames, in, (TYPE_AUX *)nullptr, ramp);
+                } else {
+                    volumeMix<SAVEONLY ? MIXTYPE_MULTI_SAVEONLY : MIXTYPE_MULTI,
+                            true /* USEFLOATVOL */, false /* ADJUSTVOL */>(
+                            dst, inFrames, in, (TYPE_AUX *)nullptr, ramp);
+                }
+                mIn = in + inFrames * mMixerChannelCount;
+            }
+            frameCount -= inFrames;
+            framesMixed += inFrames;
+        }
+        if (frameCount == 0 && framesMixed < outFrames) {
+            bufferProvider->releaseBuffer(&buffer);
+            buffer.frameCount = framesLeft - framesMixed;
+            bufferProvider->getNextBuffer(&buffer);
+            mIn = buffer.raw;
+            frameCount = buffer.frameCount;
+        }
+    }
+    return framesMixed;
+}
+
 /* The Mixer engine generates either int32_t (Q4_27) or float data.
  * We use this function to convert the engine buffers
  * to the desired mixer output format, either int16_t (Q.15) or float.
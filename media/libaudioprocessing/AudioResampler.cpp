@@ -30,6 +30,7 @@
 #include "AudioResamplerSinc.h"
 #include "AudioResamplerCubic.h"
 #include "AudioResamplerDyn.h"
+#include "AudioResamplerFirCache.h"
 
 #ifdef __arm__
     // bug 13102576
@@ -147,6 +148,11 @@ static const uint32_t maxMHz = 130; // an arbitrary number that permits 3 VHQ, s
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 static uint32_t currentMHz = 0;
 
+/* static */
+std::string AudioResampler::dumpFilterCache() {
+    return FirCacheStats::dump();
+}
+
 AudioResampler* AudioResampler::create(audio_format_t format, int inChannelCount,
         int32_t sampleRate, src_quality quality) {
 
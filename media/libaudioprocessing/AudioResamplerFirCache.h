@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_RESAMPLER_FIR_CACHE_H
+#define ANDROID_AUDIO_RESAMPLER_FIR_CACHE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include <utils/Log.h>
+
+namespace android {
+
+/*
+ * FirCacheStats holds the statistics shared by every FirCache<TC> in the process.
+ */
+class FirCacheStats {
+public:
+    static std::string dump() {
+        std::lock_guard lock(sMutex);
+        std::stringstream ss;
+        const int64_t lookups = sHits + sMisses;
+        ss << "Resampler filter cache: entries " << sEntries
+           << " bytes " << sBytes
+           << " unused bytes " << sUnusedBytes
+           << " hits " << sHits
+           << " misses " << sMisses
+           << " evictions " << sEvictions
+           << " hit rate " << (lookups > 0 ? 100. * sHits / lookups : 0.) << "%\n";
+        return ss.str();
+    }
+
+protected:
+    // Filters that are not used by any resampler are evicted once they exceed this.
+    static constexpr size_t kMaxUnusedBytes = 512 * 1024;
+
+    // sMutex guards the cache entries of every FirCache<TC> as well as the statistics.
+    static inline std::mutex sMutex;
+    static inline int64_t sHits = 0;
+    static inline int64_t sMisses = 0;
+    static inline int64_t sEvictions = 0;
+    static inline size_t sEntries = 0;
+    static inline size_t sBytes = 0;        // all filters in the cache
+    static inline size_t sUnusedBytes = 0;  // filters in the cache not used by any resampler
+};
+
+/*
+ * FirCache is a process-wide cache of immutable polyphase filter banks of coefficient
+ * type TC, created by firKaiserGen().
+ *
+ * The filter bank only depends on the design parameters in Key, so resamplers with the same
+ * conversion ratio and quality share one copy, whatever their channel count.
+ * A resampler holds its filter through the returned shared_ptr. When the last resampler
+ * using a filter releases it, the cache keeps the filter so that it survives tracks being
+ * stopped and restarted, and evicts unused filters once they exceed kMaxUnusedBytes.
+ */
+template <typename TC>
+class FirCache : public FirCacheStats {
+public:
+    struct Key {
+        int32_t phases;
+        int32_t halfLength;
+        double stopBandAtten;
+        double fcr;
+
+        bool operator<(const Key& other) const {
+            return std::tie(phases, halfLength, stopBandAtten, fcr)
+                    < std::tie(other.phases, other.halfLength, other.stopBandAtten, other.fcr);
+        }
+
+        size_t bytes() const {
+            return (phases + 1) * halfLength * sizeof(TC);
+        }
+    };
+
+    // Returns the filter bank for key. On a miss, design(TC *coefs) is called without
+    // the cache lock held to fill (phases + 1) * halfLength coefficients.
+    template <typename F>
+    static std::shared_ptr<const TC> get(const Key& key, F design) {
+        {
+            std::lock_guard lock(sMutex);
+            const auto it = entries().find(key);
+            if (it != entries().end()) {
+                ++sHits;
+                return acquire_l(it);
+            }
+            ++sMisses;
+        }
+
+        TC *coefs = nullptr;
+        int ret = posix_memalign(reinterpret_cast<void **>(&coefs), kAlignment, key.bytes());
+        LOG_ALWAYS_FATAL_IF(ret != 0, "Cannot allocate buffer memory, ret %d", ret);
+        design(coefs);
+        std::unique_ptr<TC, Free> filter(coefs);
+
+        std::lock_guard lock(sMutex);
+        // Another resampler may have designed the same filter while we were not locked.
+        const auto [it, inserted] = entries().emplace(key, Entry{std::move(filter)});
+        if (inserted) {
+            ++sEntries;
+            sBytes += key.bytes();
+            sUnusedBytes += key.bytes();
+        }
+        return acquire_l(it);
+    }
+
+private:
+    struct Free {
+        void operator()(TC *p) const { free(p); }
+    };
+
+    struct Entry {
+        std::unique_ptr<TC, Free> filter;
+        size_t users = 0;   // resamplers holding the filter
+    };
+
+    using Entries = std::map<Key, Entry>;
+
+    // use this for our buffer alignment.  Should be at least 32 bytes.
+    static constexpr size_t kAlignment = 64;
+
+    static Entries& entries() {
+        static Entries sEntriesMap;
+        return sEntriesMap;
+    }
+
+    // Returns a reference to the filter of the entry that releases it when dropped.
+    // An entry is only evicted while it has no users, so the filter outlives the reference.
+    static std::shared_ptr<const TC> acquire_l(typename Entries::iterator it) {
+        if (it->second.users++ == 0) {
+            sUnusedBytes -= it->first.bytes();
+        }
+        const Key key = it->first;
+        return std::shared_ptr<const TC>(it->second.filter.get(),
+                [key](const TC *) { release(key); });
+    }
+
+    static void release(const Key& key) {
+        std::lock_guard lock(sMutex);
+        const auto it = entries().find(key);
+        LOG_ALWAYS_FATAL_IF(it == entries().end() || it->second.users == 0,
+                "released a filter that is not in use");
+        if (--it->second.users == 0) {
+            sUnusedBytes += key.bytes();
+            evictUnused_l();
+        }
+    }
+
+    static void evictUnused_l() {
+        for (auto it = entries().begin();
+                it != entries().end() && sUnusedBytes > kMaxUnusedBytes; ) {
+            if (it->second.users == 0) {
+                sBytes -= it->first.bytes();
+                sUnusedBytes -= it->first.bytes();
+                --sEntries;
+                ++sEvictions;
+                it = entries().erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+} // namespace android
+
+#endif /*ANDROID_AUDIO_RESAMPLER_FIR_CACHE_H*/
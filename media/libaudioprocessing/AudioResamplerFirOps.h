@@ -43,10 +43,10 @@ namespace android {
 #elif defined(__SSSE3__)  // Should be supported in x86 ABI for both 32 & 64-bit.
 #define USE_SSE (true)  // Inference SSE Intrinsics
 #define USE_AVX2 (false)
-#include <tmmintrin.h>
+#include <immintrin.h>  // AVX2/FMA intrinsics are also used with runtime dispatch
 #else
 #define USE_SSE (false)
-#define USE_AVX2(false)
+#define USE_AVX2 (false)
 #endif
 
 
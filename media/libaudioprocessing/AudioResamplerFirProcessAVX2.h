@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_AVX2_H
+#define ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_AVX2_H
+
+namespace android {
+
+// depends on AudioResamplerFirOps.h, AudioResamplerFirProcess.h
+// must be included before AudioResamplerFirProcessSSE.h, which dispatches to it.
+
+#if USE_SSE
+
+//
+// AVX2/FMA kernels for Process() and ProcessL() with a stride of 16.
+//
+// These are compiled with a target attribute so that they are available on x86 builds
+// that only assume SSSE3; resamplerUseAVX2() selects them at runtime.
+// The float kernels are used by the SSE specializations in AudioResamplerFirProcessSSE.h
+// and the int16_t kernels by the specializations at the end of this file.
+//
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+static inline bool resamplerUseAVX2()
+{
+#if USE_AVX2
+    return true; // compiled for an AVX2 capable cpu
+#else
+    static const bool useAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return useAVX2;
+#endif
+}
+
+template <int CHANNELS, int STRIDE, bool FIXED>
+AVX2_TARGET
+static inline void ProcessAVX2Intrinsic(float* out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* volumeLR,
+        float lerpP,
+        const float* coefsP1,
+        const float* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    static_assert(CHANNELS == 1 || CHANNELS == 2, "CHANNELS must be 1 or 2");
+
+    sP -= CHANNELS*(8-1);   // adjust sP for a loop iteration of eight
+
+    __m256 interp;
+    if (!FIXED) {
+        interp = _mm256_set1_ps(lerpP);
+    }
+
+    // permutations applied to a vector of eight coefficients.
+    // mono: the positive samples are in reverse order.
+    // stereo: each coefficient is duplicated for L and R, eight samples cover four frames.
+    const __m256i reverse = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    const __m256i posLo = _mm256_setr_epi32(7, 7, 6, 6, 5, 5, 4, 4);
+    const __m256i posHi = _mm256_setr_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+    const __m256i negLo = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i negHi = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+
+    // for stereo the accumulators hold interleaved L and R.
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    do {
+        __m256 posCoef = _mm256_load_ps(coefsP);
+        __m256 negCoef = _mm256_load_ps(coefsN);
+        coefsP += 8;
+        coefsN += 8;
+
+        if (!FIXED) { // interpolate
+            __m256 posCoef1 = _mm256_load_ps(coefsP1);
+            __m256 negCoef1 = _mm256_load_ps(coefsN1);
+            coefsP1 += 8;
+            coefsN1 += 8;
+
+            // Calculate the final coefficient for interpolation
+            // posCoef = interp * (posCoef1 - posCoef) + posCoef
+            // negCoef = interp * (negCoef - negCoef1) + negCoef1
+            posCoef = _mm256_fmadd_ps(_mm256_sub_ps(posCoef1, posCoef), interp, posCoef);
+            negCoef = _mm256_fmadd_ps(_mm256_sub_ps(negCoef, negCoef1), interp, negCoef1);
+        }
+        switch (CHANNELS) {
+        case 1: {
+            __m256 posSamp = _mm256_loadu_ps(sP);
+            __m256 negSamp = _mm256_loadu_ps(sN);
+            sP -= 8;
+            sN += 8;
+
+            posCoef = _mm256_permutevar8x32_ps(posCoef, reverse);
+
+            acc0 = _mm256_fmadd_ps(posSamp, posCoef, acc0);
+            acc1 = _mm256_fmadd_ps(negSamp, negCoef, acc1);
+        } break;
+        case 2: {
+            __m256 posSamp0 = _mm256_loadu_ps(sP);
+            __m256 posSamp1 = _mm256_loadu_ps(sP+8);
+            __m256 negSamp0 = _mm256_loadu_ps(sN);
+            __m256 negSamp1 = _mm256_loadu_ps(sN+8);
+            sP -= 16;
+            sN += 16;
+
+            acc0 = _mm256_fmadd_ps(posSamp0, _mm256_permutevar8x32_ps(posCoef, posLo), acc0);
+            acc1 = _mm256_fmadd_ps(posSamp1, _mm256_permutevar8x32_ps(posCoef, posHi), acc1);
+            acc0 = _mm256_fmadd_ps(negSamp0, _mm256_permutevar8x32_ps(negCoef, negLo), acc0);
+            acc1 = _mm256_fmadd_ps(negSamp1, _mm256_permutevar8x32_ps(negCoef, negHi), acc1);
+        } break;
+        }
+    } while (count -= 8);
+
+    // combine and funnel down accumulator
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 outAccum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    outAccum = _mm_add_ps(outAccum, _mm_movehl_ps(outAccum, outAccum)); // L R in low half
+    if (CHANNELS == 1) {
+        // duplicate the sum to both L and R
+        outAccum = _mm_add_ps(outAccum, _mm_shuffle_ps(outAccum, outAccum, 0x11));
+    }
+
+    // multiply by volume and save
+    __m128 vLR = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(volumeLR)));
+    __m128 outSamp = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(out)));
+    outSamp = _mm_fmadd_ps(outAccum, vLR, outSamp);
+    _mm_store_sd(reinterpret_cast<double*>(out), _mm_castps_pd(outSamp));
+}
+
+/*
+ * Interpolates eight int16_t coefficients exactly as interpolate<int16_t, uint32_t>():
+ * coef_0 + (lerp * (int16_t)(coef_1 - coef_0) >> 15), truncated to 16 bits.
+ */
+AVX2_TARGET
+static inline __m128i interpolateAVX2(__m128i coef_0, __m128i coef_1, __m128i lerp)
+{
+    const __m128i diff = _mm_sub_epi16(coef_1, coef_0);
+    // bits 15 to 30 of the 32 bit product
+    const __m128i prod = _mm_or_si128(_mm_slli_epi16(_mm_mulhi_epi16(diff, lerp), 1),
+            _mm_srli_epi16(_mm_mullo_epi16(diff, lerp), 15));
+    return _mm_add_epi16(prod, coef_0);
+}
+
+/*
+ * int16_t samples and coefficients are multiplied and summed in pairs with
+ * _mm256_madd_epi16(), so a single instruction accumulates sixteen products.
+ * The pairs are arranged to share a channel, and the result is bit-exact
+ * with ProcessBase() since all sums are in two's complement 32 bit arithmetic.
+ */
+template <int CHANNELS, int STRIDE, bool FIXED>
+AVX2_TARGET
+static inline void ProcessAVX2Intrinsic(int32_t* out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* volumeLR,
+        uint32_t lerpP,
+        const int16_t* coefsP1,
+        const int16_t* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    static_assert(CHANNELS == 1 || CHANNELS == 2, "CHANNELS must be 1 or 2");
+
+    sP -= CHANNELS*(8-1);   // adjust sP for a loop iteration of eight
+
+    __m128i interp;
+    if (!FIXED) {
+        interp = _mm_set1_epi16(static_cast<int16_t>(lerpP));
+    }
+
+    // byte shuffles, applied to each 128 bit lane.
+    // mono: reverse eight positive samples.
+    const __m128i reverse = _mm_setr_epi8(
+            14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+    // stereo: deinterleave four frames to LLLLRRRR, reversed for the positive side.
+    const __m256i posSamp = _mm256_setr_epi8(
+            12, 13, 8, 9, 4, 5, 0, 1, 14, 15, 10, 11, 6, 7, 2, 3,
+            12, 13, 8, 9, 4, 5, 0, 1, 14, 15, 10, 11, 6, 7, 2, 3);
+    const __m256i negSamp = _mm256_setr_epi8(
+            0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15,
+            0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    // stereo: coefficients 4-7 (positive) or 0-3 (negative) for both channels in the
+    // low lane, and the other four in the high lane.
+    const __m256i posCoefs = _mm256_setr_epi8(
+            8, 9, 10, 11, 12, 13, 14, 15, 8, 9, 10, 11, 12, 13, 14, 15,
+            0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i negCoefs = _mm256_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7,
+            8, 9, 10, 11, 12, 13, 14, 15, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    // for stereo, the 32 bit lanes are L L R R L L R R.
+    __m256i acc = _mm256_setzero_si256();
+
+    do {
+        __m128i posCoef = _mm_load_si128(reinterpret_cast<const __m128i*>(coefsP));
+        __m128i negCoef = _mm_load_si128(reinterpret_cast<const __m128i*>(coefsN));
+        coefsP += 8;
+        coefsN += 8;
+
+        if (!FIXED) { // interpolate
+            __m128i posCoef1 = _mm_load_si128(reinterpret_cast<const __m128i*>(coefsP1));
+            __m128i negCoef1 = _mm_load_si128(reinterpret_cast<const __m128i*>(coefsN1));
+            coefsP1 += 8;
+            coefsN1 += 8;
+
+            posCoef = interpolateAVX2(posCoef, posCoef1, interp);
+            negCoef = interpolateAVX2(negCoef1, negCoef, interp);
+        }
+        switch (CHANNELS) {
+        case 1: {
+            __m128i pos = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sP));
+            __m128i neg = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sN));
+            sP -= 8;
+            sN += 8;
+
+            pos = _mm_shuffle_epi8(pos, reverse);
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(
+                    _mm256_set_m128i(neg, pos), _mm256_set_m128i(negCoef, posCoef)));
+        } break;
+        case 2: {
+            __m256i pos = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sP));
+            __m256i neg = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sN));
+            sP -= 16;
+            sN += 16;
+
+            pos = _mm256_shuffle_epi8(pos, posSamp);
+            neg = _mm256_shuffle_epi8(neg, negSamp);
+            const __m256i posC = _mm256_shuffle_epi8(_mm256_set_m128i(posCoef, posCoef), posCoefs);
+            const __m256i negC = _mm256_shuffle_epi8(_mm256_set_m128i(negCoef, negCoef), negCoefs);
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pos, posC));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(neg, negC));
+        } break;
+        }
+    } while (count -= 8);
+
+    // combine and funnel down accumulator
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    int32_t l, r;
+    if (CHANNELS == 1) {
+        sum = _mm_add_epi32(sum, _mm_unpackhi_epi64(sum, sum));
+        l = r = _mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 1);
+    } else {
+        l = _mm_cvtsi128_si32(sum) + _mm_extract_epi32(sum, 1);
+        r = _mm_extract_epi32(sum, 2) + _mm_extract_epi32(sum, 3);
+    }
+
+    // multiply by volume and save
+    out[0] += volumeAdjust(l, volumeLR[0]);
+    out[1] += volumeAdjust(r, volumeLR[1]);
+}
+
+#undef AVX2_TARGET
+
+//
+// int16_t specializations, which otherwise use ProcessBase() on x86.
+//
+
+template<>
+inline void ProcessL<1, 16>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* const volumeLR)
+{
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<1, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+    } else {
+        ProcessBase<1, 16, InterpNull>(out, count, coefsP, coefsN, sP, sN, 0, volumeLR);
+    }
+}
+
+template<>
+inline void ProcessL<2, 16>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* sP,
+        const int16_t* sN,
+        const int32_t* const volumeLR)
+{
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<2, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+    } else {
+        ProcessBase<2, 16, InterpNull>(out, count, coefsP, coefsN, sP, sN, 0, volumeLR);
+    }
+}
+
+template<>
+inline void Process<1, 16>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* coefsP1,
+        const int16_t* coefsN1,
+        const int16_t* sP,
+        const int16_t* sN,
+        uint32_t lerpP,
+        const int32_t* const volumeLR)
+{
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<1, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                lerpP, coefsP1, coefsN1);
+    } else {
+        ProcessBase<1, 16, InterpCompute>(out, count, coefsP, coefsN, sP, sN, lerpP, volumeLR);
+    }
+}
+
+template<>
+inline void Process<2, 16>(int32_t* const out,
+        int count,
+        const int16_t* coefsP,
+        const int16_t* coefsN,
+        const int16_t* coefsP1,
+        const int16_t* coefsN1,
+        const int16_t* sP,
+        const int16_t* sN,
+        uint32_t lerpP,
+        const int32_t* const volumeLR)
+{
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<2, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                lerpP, coefsP1, coefsN1);
+    } else {
+        ProcessBase<2, 16, InterpCompute>(out, count, coefsP, coefsN, sP, sN, lerpP, volumeLR);
+    }
+}
+
+#endif //USE_SSE
+
+} // namespace android
+
+#endif /*ANDROID_AUDIO_RESAMPLER_FIR_PROCESS_AVX2_H*/
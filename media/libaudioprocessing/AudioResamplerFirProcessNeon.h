@@ -1207,6 +1207,183 @@ inline void Process<2, 16>(float* const out,
             lerpP, coefsP1, coefsN1);
 }
 
+//
+// Multichannel float kernels for 4, 6 and 8 channels.
+//
+// Each coefficient is loaded once and multiplied with all the interleaved channels
+// of a frame, held in two vectors of four channels. For 6 channels the second
+// vector overlaps the first and holds channels 2 to 5; only its upper half is saved.
+//
+
+template <int CHANNELS>
+static inline void MacNeonMulti(float32x4_t& accum, float32x4_t& accum2,
+        const float* samples, float coef)
+{
+    accum = vmlaq_n_f32(accum, vld1q_f32(samples), coef);
+    if (CHANNELS > 4) {
+        accum2 = vmlaq_n_f32(accum2, vld1q_f32(samples + CHANNELS - 4), coef);
+    }
+}
+
+template <int CHANNELS, int STRIDE, bool FIXED>
+static inline void ProcessNeonIntrinsicMulti(float* out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* volumeLR,
+        float lerpP,
+        const float* coefsP1,
+        const float* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    static_assert(CHANNELS == 4 || CHANNELS == 6 || CHANNELS == 8,
+            "CHANNELS must be 4, 6 or 8");
+
+    coefsP = (const float*)__builtin_assume_aligned(coefsP, 16);
+    coefsN = (const float*)__builtin_assume_aligned(coefsN, 16);
+
+    float32x2_t interp;
+    if (!FIXED) {
+        interp = vdup_n_f32(lerpP);
+        coefsP1 = (const float*)__builtin_assume_aligned(coefsP1, 16);
+        coefsN1 = (const float*)__builtin_assume_aligned(coefsN1, 16);
+    }
+    // separate positive and negative accumulators shorten the dependency chains.
+    float32x4_t accumP = vdupq_n_f32(0);
+    float32x4_t accumP2 = vdupq_n_f32(0);
+    float32x4_t accumN = vdupq_n_f32(0);
+    float32x4_t accumN2 = vdupq_n_f32(0);
+    do {
+        float32x4_t posCoef = vld1q_f32(coefsP);
+        coefsP += 4;
+        float32x4_t negCoef = vld1q_f32(coefsN);
+        coefsN += 4;
+        if (!FIXED) { // interpolate
+            float32x4_t posCoef1 = vld1q_f32(coefsP1);
+            coefsP1 += 4;
+            float32x4_t negCoef1 = vld1q_f32(coefsN1);
+            coefsN1 += 4;
+
+            posCoef1 = vsubq_f32(posCoef1, posCoef);
+            negCoef = vsubq_f32(negCoef, negCoef1);
+
+            posCoef = vmlaq_lane_f32(posCoef, posCoef1, interp, 0);
+            negCoef = vmlaq_lane_f32(negCoef1, negCoef, interp, 0); // rev
+        }
+        MacNeonMulti<CHANNELS>(accumP, accumP2, sP, vgetq_lane_f32(posCoef, 0));
+        MacNeonMulti<CHANNELS>(accumP, accumP2, sP - CHANNELS, vgetq_lane_f32(posCoef, 1));
+        MacNeonMulti<CHANNELS>(accumP, accumP2, sP - 2 * CHANNELS, vgetq_lane_f32(posCoef, 2));
+        MacNeonMulti<CHANNELS>(accumP, accumP2, sP - 3 * CHANNELS, vgetq_lane_f32(posCoef, 3));
+        MacNeonMulti<CHANNELS>(accumN, accumN2, sN, vgetq_lane_f32(negCoef, 0));
+        MacNeonMulti<CHANNELS>(accumN, accumN2, sN + CHANNELS, vgetq_lane_f32(negCoef, 1));
+        MacNeonMulti<CHANNELS>(accumN, accumN2, sN + 2 * CHANNELS, vgetq_lane_f32(negCoef, 2));
+        MacNeonMulti<CHANNELS>(accumN, accumN2, sN + 3 * CHANNELS, vgetq_lane_f32(negCoef, 3));
+        sP -= 4 * CHANNELS;
+        sN += 4 * CHANNELS;
+    } while (count -= 4);
+
+    // multiply by volume and save, all channels use the left volume like ProcessBase().
+    const float volume = volumeLR[0];
+    float32x4_t accum = vaddq_f32(accumP, accumN);
+    vst1q_f32(out, vmlaq_n_f32(vld1q_f32(out), accum, volume));
+    if (CHANNELS == 6) {
+        float32x2_t accum2 = vget_high_f32(vaddq_f32(accumP2, accumN2)); // channels 4 and 5
+        vst1_f32(out + 4, vmla_n_f32(vld1_f32(out + 4), accum2, volume));
+    } else if (CHANNELS == 8) {
+        float32x4_t accum2 = vaddq_f32(accumP2, accumN2);
+        vst1q_f32(out + 4, vmlaq_n_f32(vld1q_f32(out + 4), accum2, volume));
+    }
+}
+
+template<>
+inline void ProcessL<4, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessNeonIntrinsicMulti<4, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template<>
+inline void Process<4, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessNeonIntrinsicMulti<4, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template<>
+inline void ProcessL<6, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessNeonIntrinsicMulti<6, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template<>
+inline void Process<6, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessNeonIntrinsicMulti<6, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template<>
+inline void ProcessL<8, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessNeonIntrinsicMulti<8, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template<>
+inline void Process<8, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessNeonIntrinsicMulti<8, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
 #endif //USE_NEON
 
 } // namespace android
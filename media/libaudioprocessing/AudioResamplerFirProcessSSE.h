@@ -19,7 +19,8 @@
 
 namespace android {
 
-// depends on AudioResamplerFirOps.h, AudioResamplerFirProcess.h
+// depends on AudioResamplerFirOps.h, AudioResamplerFirProcess.h,
+// AudioResamplerFirProcessAVX2.h
 
 #if USE_SSE
 
@@ -32,6 +33,7 @@ namespace android {
 
 //
 // SSEx specializations are enabled for Process() and ProcessL() in AudioResamplerFirProcess.h
+// These use the AVX2 kernels in AudioResamplerFirProcessAVX2.h when the cpu supports them.
 //
 
 template <int CHANNELS, int STRIDE, bool FIXED>
@@ -182,6 +184,11 @@ inline void ProcessL<1, 16>(float* const out,
         const float* sN,
         const float* const volumeLR)
 {
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<1, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+        return;
+    }
     ProcessSSEIntrinsic<1, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
             0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
 }
@@ -195,6 +202,11 @@ inline void ProcessL<2, 16>(float* const out,
         const float* sN,
         const float* const volumeLR)
 {
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<2, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+        return;
+    }
     ProcessSSEIntrinsic<2, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
             0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
 }
@@ -211,6 +223,11 @@ inline void Process<1, 16>(float* const out,
         float lerpP,
         const float* const volumeLR)
 {
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<1, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                lerpP, coefsP1, coefsN1);
+        return;
+    }
     ProcessSSEIntrinsic<1, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
             lerpP, coefsP1, coefsN1);
 }
@@ -227,10 +244,207 @@ inline void Process<2, 16>(float* const out,
         float lerpP,
         const float* const volumeLR)
 {
+    if (resamplerUseAVX2()) {
+        ProcessAVX2Intrinsic<2, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+                lerpP, coefsP1, coefsN1);
+        return;
+    }
     ProcessSSEIntrinsic<2, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
             lerpP, coefsP1, coefsN1);
 }
 
+//
+// Multichannel float kernels for 4, 6 and 8 channels.
+//
+// Each coefficient is loaded once and multiplied with all the interleaved channels
+// of a frame, held in two vectors of four channels. For 6 channels the second
+// vector overlaps the first and holds channels 2 to 5; only its upper half is saved.
+//
+
+template <int CHANNELS>
+static inline void MacSSEMulti(__m128& accum, __m128& accum2,
+        const float* samples, __m128 coef)
+{
+    #if USE_AVX2
+    accum = _mm_fmadd_ps(_mm_loadu_ps(samples), coef, accum);
+    if (CHANNELS > 4) {
+        accum2 = _mm_fmadd_ps(_mm_loadu_ps(samples + CHANNELS - 4), coef, accum2);
+    }
+    #else
+    accum = _mm_add_ps(accum, _mm_mul_ps(_mm_loadu_ps(samples), coef));
+    if (CHANNELS > 4) {
+        accum2 = _mm_add_ps(accum2, _mm_mul_ps(_mm_loadu_ps(samples + CHANNELS - 4), coef));
+    }
+    #endif
+}
+
+template <int CHANNELS, int STRIDE, bool FIXED>
+static inline void ProcessSSEIntrinsicMulti(float* out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* volumeLR,
+        float lerpP,
+        const float* coefsP1,
+        const float* coefsN1)
+{
+    ALOG_ASSERT(count > 0 && (count & 7) == 0); // multiple of 8
+    static_assert(CHANNELS == 4 || CHANNELS == 6 || CHANNELS == 8,
+            "CHANNELS must be 4, 6 or 8");
+
+    __m128 interp;
+    if (!FIXED) {
+        interp = _mm_set1_ps(lerpP);
+    }
+
+    // separate positive and negative accumulators shorten the dependency chains.
+    __m128 accP = _mm_setzero_ps();
+    __m128 accP2 = _mm_setzero_ps();
+    __m128 accN = _mm_setzero_ps();
+    __m128 accN2 = _mm_setzero_ps();
+
+    do {
+        __m128 posCoef = _mm_load_ps(coefsP);
+        __m128 negCoef = _mm_load_ps(coefsN);
+        coefsP += 4;
+        coefsN += 4;
+
+        if (!FIXED) { // interpolate
+            __m128 posCoef1 = _mm_load_ps(coefsP1);
+            __m128 negCoef1 = _mm_load_ps(coefsN1);
+            coefsP1 += 4;
+            coefsN1 += 4;
+
+            // posCoef = interp * (posCoef1 - posCoef) + posCoef
+            // negCoef = interp * (negCoef - negCoef1) + negCoef1
+            posCoef1 = _mm_sub_ps(posCoef1, posCoef);
+            negCoef = _mm_sub_ps(negCoef, negCoef1);
+            posCoef = _mm_add_ps(_mm_mul_ps(posCoef1, interp), posCoef);
+            negCoef = _mm_add_ps(_mm_mul_ps(negCoef, interp), negCoef1);
+        }
+        MacSSEMulti<CHANNELS>(accP, accP2, sP, _mm_shuffle_ps(posCoef, posCoef, 0x00));
+        MacSSEMulti<CHANNELS>(accP, accP2, sP - CHANNELS,
+                _mm_shuffle_ps(posCoef, posCoef, 0x55));
+        MacSSEMulti<CHANNELS>(accP, accP2, sP - 2 * CHANNELS,
+                _mm_shuffle_ps(posCoef, posCoef, 0xAA));
+        MacSSEMulti<CHANNELS>(accP, accP2, sP - 3 * CHANNELS,
+                _mm_shuffle_ps(posCoef, posCoef, 0xFF));
+        MacSSEMulti<CHANNELS>(accN, accN2, sN, _mm_shuffle_ps(negCoef, negCoef, 0x00));
+        MacSSEMulti<CHANNELS>(accN, accN2, sN + CHANNELS,
+                _mm_shuffle_ps(negCoef, negCoef, 0x55));
+        MacSSEMulti<CHANNELS>(accN, accN2, sN + 2 * CHANNELS,
+                _mm_shuffle_ps(negCoef, negCoef, 0xAA));
+        MacSSEMulti<CHANNELS>(accN, accN2, sN + 3 * CHANNELS,
+                _mm_shuffle_ps(negCoef, negCoef, 0xFF));
+        sP -= 4 * CHANNELS;
+        sN += 4 * CHANNELS;
+    } while (count -= 4);
+
+    // multiply by volume and save, all channels use the left volume like ProcessBase().
+    const __m128 volume = _mm_set1_ps(volumeLR[0]);
+    __m128 acc = _mm_add_ps(accP, accN);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(acc, volume)));
+    if (CHANNELS == 6) {
+        __m128 acc2 = _mm_add_ps(accP2, accN2);
+        acc2 = _mm_movehl_ps(acc2, acc2); // channels 4 and 5
+        __m128 outSamp = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<__m64*>(out + 4));
+        outSamp = _mm_add_ps(outSamp, _mm_mul_ps(acc2, volume));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out + 4), outSamp);
+    } else if (CHANNELS == 8) {
+        __m128 acc2 = _mm_add_ps(accP2, accN2);
+        _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(acc2, volume)));
+    }
+}
+
+template<>
+inline void ProcessL<4, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessSSEIntrinsicMulti<4, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template<>
+inline void Process<4, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessSSEIntrinsicMulti<4, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template<>
+inline void ProcessL<6, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessSSEIntrinsicMulti<6, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template<>
+inline void Process<6, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessSSEIntrinsicMulti<6, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
+template<>
+inline void ProcessL<8, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* sP,
+        const float* sN,
+        const float* const volumeLR)
+{
+    ProcessSSEIntrinsicMulti<8, 16, true>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            0 /*lerpP*/, NULL /*coefsP1*/, NULL /*coefsN1*/);
+}
+
+template<>
+inline void Process<8, 16>(float* const out,
+        int count,
+        const float* coefsP,
+        const float* coefsN,
+        const float* coefsP1,
+        const float* coefsN1,
+        const float* sP,
+        const float* sN,
+        float lerpP,
+        const float* const volumeLR)
+{
+    ProcessSSEIntrinsicMulti<8, 16, false>(out, count, coefsP, coefsN, sP, sN, volumeLR,
+            lerpP, coefsP1, coefsN1);
+}
+
 #endif //USE_SSE
 
 } // namespace android
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "RecordConverterGroup"
+//#define LOG_NDEBUG 0
+
+#include <algorithm>
+
+#include <audio_utils/roundup.h>
+#include <audio_utils/safe_math.h>
+#include <media/AudioResamplerPublic.h>
+#include <media/RecordBufferConverter.h>
+#include <media/RecordConverterGroup.h>
+#include <utils/Log.h>
+
+namespace android {
+
+RecordConverterGroup::RecordConverterGroup(const Input& input,
+        audio_channel_mask_t channelMask, audio_format_t format, uint32_t sampleRate,
+        int32_t front)
+    : mInput(input)
+    , mInputRear(front)
+    , mChannelMask(channelMask)
+    , mFormat(format)
+    , mSampleRate(sampleRate)
+    , mFrameSize(audio_bytes_per_frame(audio_channel_count_from_in_mask(channelMask), format))
+    , mConverter(std::make_unique<RecordBufferConverter>(
+            input.channelMask, input.format, input.sampleRate,
+            channelMask, format, sampleRate))
+    , mFront(front)
+      // Hold as much converted data as the RecordThread buffer holds input data,
+      // so that a RecordTrack of the group overruns as it would on its own.
+    , mFrames(roundup((size_t)((uint64_t)input.frames * sampleRate / input.sampleRate) + 2))
+    , mBuffer(mFrames * mFrameSize)
+{
+}
+
+RecordConverterGroup::~RecordConverterGroup() = default;
+
+status_t RecordConverterGroup::initCheck() const
+{
+    return mConverter->initCheck();
+}
+
+bool RecordConverterGroup::matches(audio_channel_mask_t channelMask, audio_format_t format,
+        uint32_t sampleRate, int32_t front) const
+{
+    // The Reader of a new member starts after the data already converted, so the track
+    // must have consumed exactly the RecordThread data that the group has: a track ahead
+    // would read frames again, a track behind would skip frames.
+    return front == mFront
+            && sampleRate == mSampleRate
+            && format == mFormat
+            && channelMask == mChannelMask;
+}
+
+RecordBufferConverter *RecordConverterGroup::exchangeConverter(RecordBufferConverter *converter)
+{
+    RecordBufferConverter *previous = mConverter.release();
+    mConverter.reset(converter);
+    return previous;
+}
+
+void RecordConverterGroup::convert(int32_t rear)
+{
+    mInputRear = rear;
+    for (;;) {
+        const ssize_t filled = audio_utils::safe_sub_overflow(rear, mFront);
+        if (filled < 0 || (size_t) filled > mInput.frames) {
+            // should not happen as the group converts all the data of every cycle
+            ALOGW("%s: overrun of %zd frames", __func__, filled);
+            mFront = audio_utils::safe_sub_overflow(rear, static_cast<int32_t>(mInput.frames));
+            continue;
+        }
+        const size_t rearOut = mRear & (mFrames - 1);
+        const size_t framesOut = std::min(mFrames - rearOut, destinationFramesPossible(
+                filled, mInput.sampleRate, mSampleRate));
+        if (framesOut == 0) {
+            break;
+        }
+        const size_t framesConverted = mConverter->convert(
+                mBuffer.data() + rearOut * mFrameSize, this, framesOut);
+        if (framesConverted == 0) {
+            break;
+        }
+        mRear = audio_utils::safe_add_overflow(mRear, static_cast<int32_t>(framesConverted));
+    }
+}
+
+// AudioBufferProvider interface
+status_t RecordConverterGroup::getNextBuffer(AudioBufferProvider::Buffer* buffer)
+{
+    const ssize_t filled = audio_utils::safe_sub_overflow(mInputRear, mFront);
+    const int32_t front = mFront & (mInput.framesP2 - 1);
+    const size_t part1 = std::min({mInput.framesP2 - front, (size_t) filled,
+            buffer->frameCount});
+    if (part1 == 0) {
+        buffer->raw = NULL;
+        buffer->frameCount = 0;
+        mUnrel = 0;
+        return NOT_ENOUGH_DATA;
+    }
+    buffer->raw = (uint8_t*)mInput.buffer + front * mInput.frameSize;
+    buffer->frameCount = part1;
+    mUnrel = part1;
+    return NO_ERROR;
+}
+
+// AudioBufferProvider interface
+void RecordConverterGroup::releaseBuffer(AudioBufferProvider::Buffer* buffer)
+{
+    const int32_t stepCount = static_cast<int32_t>(buffer->frameCount);
+    ALOG_ASSERT(stepCount <= (int32_t)mUnrel);
+    mUnrel -= stepCount;
+    mFront = audio_utils::safe_add_overflow(mFront, stepCount);
+    buffer->raw = NULL;
+    buffer->frameCount = 0;
+}
+
+void RecordConverterGroup::Reader::reset()
+{
+    mFront = mGroup->mRear;
+    mUnrel = 0;
+}
+
+void RecordConverterGroup::Reader::sync(size_t *framesAvailable, bool *hasOverrun)
+{
+    const ssize_t filled = audio_utils::safe_sub_overflow(mGroup->mRear, mFront);
+    size_t framesIn;
+    bool overrun = false;
+    if (filled < 0) {
+        // should not happen, but treat like a massive overrun and re-sync
+        framesIn = 0;
+        mFront = mGroup->mRear;
+        overrun = true;
+    } else if ((size_t) filled <= mGroup->mFrames) {
+        framesIn = (size_t) filled;
+    } else {
+        // client is not keeping up with the group, but give it latest data
+        framesIn = mGroup->mFrames;
+        mFront = audio_utils::safe_sub_overflow(mGroup->mRear, static_cast<int32_t>(framesIn));
+        overrun = true;
+    }
+    if (framesAvailable != NULL) {
+        *framesAvailable = framesIn;
+    }
+    if (hasOverrun != NULL) {
+        *hasOverrun = overrun;
+    }
+}
+
+// AudioBufferProvider interface
+status_t RecordConverterGroup::Reader::getNextBuffer(AudioBufferProvider::Buffer* buffer)
+{
+    const ssize_t filled = audio_utils::safe_sub_overflow(mGroup->mRear, mFront);
+    LOG_ALWAYS_FATAL_IF(!(0 <= filled && (size_t) filled <= mGroup->mFrames));
+    const int32_t front = mFront & (mGroup->mFrames - 1);
+    const size_t part1 = std::min({mGroup->mFrames - front, (size_t) filled, buffer->frameCount});
+    if (part1 == 0) {
+        buffer->raw = NULL;
+        buffer->frameCount = 0;
+        mUnrel = 0;
+        return NOT_ENOUGH_DATA;
+    }
+    buffer->raw = const_cast<uint8_t*>(mGroup->mBuffer.data()) + front * mGroup->mFrameSize;
+    buffer->frameCount = part1;
+    mUnrel = part1;
+    return NO_ERROR;
+}
+
+// AudioBufferProvider interface
+void RecordConverterGroup::Reader::releaseBuffer(AudioBufferProvider::Buffer* buffer)
+{
+    const int32_t stepCount = static_cast<int32_t>(buffer->frameCount);
+    if (stepCount == 0) {
+        return;
+    }
+    ALOG_ASSERT(stepCount <= (int32_t)mUnrel);
+    mUnrel -= stepCount;
+    mFront = audio_utils::safe_add_overflow(mFront, stepCount);
+    buffer->raw = NULL;
+    buffer->frameCount = 0;
+}
+
+} // namespace android
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "VolumeRamp"
+//#define LOG_NDEBUG 0
+
+#include <algorithm>
+
+#include <audio_utils/primitives.h>
+#include <media/VolumeRamp.h>
+#include <utils/Log.h>
+
+#include "AudioMixerOps.h"
+
+namespace android {
+
+namespace {
+
+// One AUDIO_FORMAT_PCM_24_BIT_PACKED sample, little endian.
+struct packed24_t {
+    uint8_t bytes[3];
+};
+static_assert(sizeof(packed24_t) == 3);
+
+/*
+ * SampleOps<T>::mul() scales one sample of type T by a volume of type volume_t.
+ *
+ * Integer samples are scaled in fixed point by a U4.28 volume, as in the AudioMixer,
+ * so that they do not go through float. int16_t uses the AudioMixer MixMul,
+ * which keeps 12 bits of the volume. The 24 and 32 bit formats multiply in 64 bits.
+ */
+template <typename T>
+struct SampleOps;
+
+// U4.28 volume, or a signed increment of one, from float. Volumes are clamped below 8
+// so that a ramp does not overflow int32_t.
+static inline int32_t u4_28_from_float_volume(float volume) {
+    static constexpr float kMaxVolume = 7.99f;
+    return static_cast<int32_t>(std::clamp(volume, -kMaxVolume, kMaxVolume) * (1 << 28));
+}
+
+template <>
+struct SampleOps<int16_t> {
+    using volume_t = int32_t;
+    static volume_t volumeFromFloat(float volume) {
+        return u4_28_from_float_volume(volume);
+    }
+    static int16_t mul(int16_t value, volume_t volume) {
+        return MixMul<int16_t, int16_t, int32_t>(value, volume);
+    }
+};
+
+template <>
+struct SampleOps<packed24_t> {
+    using volume_t = int32_t;
+    static volume_t volumeFromFloat(float volume) {
+        return u4_28_from_float_volume(volume);
+    }
+    static packed24_t mul(const packed24_t& value, volume_t volume) {
+        // sign extend to Q8.23 through the top byte.
+        const int32_t in = static_cast<int32_t>(value.bytes[0] << 8 | value.bytes[1] << 16
+                | static_cast<uint32_t>(value.bytes[2]) << 24) >> 8;
+        const int32_t sample = static_cast<int32_t>(std::clamp<int64_t>(
+                (static_cast<int64_t>(in) * volume) >> 28, -(1 << 23), (1 << 23) - 1));
+        return {{(uint8_t)sample, (uint8_t)(sample >> 8), (uint8_t)(sample >> 16)}};
+    }
+};
+
+template <>
+struct SampleOps<int32_t> {
+    using volume_t = int32_t;
+    static volume_t volumeFromFloat(float volume) {
+        return u4_28_from_float_volume(volume);
+    }
+    static int32_t mul(int32_t value, volume_t volume) {
+        return static_cast<int32_t>(std::clamp<int64_t>(
+                (static_cast<int64_t>(value) * volume) >> 28, INT32_MIN, INT32_MAX));
+    }
+};
+
+template <>
+struct SampleOps<float> {
+    using volume_t = float;
+    static volume_t volumeFromFloat(float volume) {
+        return volume;
+    }
+    static float mul(float value, volume_t volume) {
+        return MixMul<float, float, float>(value, volume);
+    }
+};
+
+/*
+ * Applies the volume in place, frame by frame, with the channel to left/right/center
+ * volume assignment of the AudioMixer for NCHAN channels.
+ * If RAMP is true, the volume is incremented by volumeInc after every frame.
+ * The volume is converted to the volume_t of T once per call.
+ */
+template <int NCHAN, typename T, bool RAMP>
+void processVolume(void *buffer, size_t frameCount, const float *volume, const float *volumeInc)
+{
+    using Ops = SampleOps<T>;
+    using volume_t = typename Ops::volume_t;
+    T *out = static_cast<T *>(buffer);
+    const T *in = out;
+    volume_t vol[2] = {Ops::volumeFromFloat(volume[0]), Ops::volumeFromFloat(volume[1])};
+    volume_t inc[2] = {};
+    if constexpr (RAMP) {
+        inc[0] = Ops::volumeFromFloat(volumeInc[0]);
+        inc[1] = Ops::volumeFromFloat(volumeInc[1]);
+    }
+    do {
+        stereoVolumeHelper<MIXTYPE_MULTI_SAVEONLY_STEREOVOL, NCHAN>(out, in, vol,
+                [] (const T& value, volume_t v) {
+            return Ops::mul(value, v);
+        });
+        if constexpr (RAMP) {
+            vol[0] += inc[0];
+            vol[1] += inc[1];
+        }
+    } while (--frameCount);
+}
+
+template <typename T, bool RAMP>
+VolumeRamp::ProcessFunc selectProcess(uint32_t channelCount)
+{
+    switch (channelCount) {
+    case 1: return processVolume<1, T, RAMP>;
+    case 2: return processVolume<2, T, RAMP>;
+    case 3: return processVolume<3, T, RAMP>;
+    case 4: return processVolume<4, T, RAMP>;
+    case 5: return processVolume<5, T, RAMP>;
+    case 6: return processVolume<6, T, RAMP>;
+    case 7: return processVolume<7, T, RAMP>;
+    case 8: return processVolume<8, T, RAMP>;
+    default: return nullptr;
+    }
+}
+
+template <bool RAMP>
+VolumeRamp::ProcessFunc selectProcess(audio_format_t format, uint32_t channelCount)
+{
+    switch (format) {
+    case AUDIO_FORMAT_PCM_16_BIT:
+        return selectProcess<int16_t, RAMP>(channelCount);
+    case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+        return selectProcess<packed24_t, RAMP>(channelCount);
+    case AUDIO_FORMAT_PCM_32_BIT:
+        return selectProcess<int32_t, RAMP>(channelCount);
+    case AUDIO_FORMAT_PCM_FLOAT:
+        return selectProcess<float, RAMP>(channelCount);
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace
+
+VolumeRamp::VolumeRamp(audio_format_t format, uint32_t channelCount)
+    : mProcess(selectProcess<true /* RAMP */>(format, channelCount))
+    , mProcessConstant(selectProcess<false /* RAMP */>(format, channelCount))
+{
+    ALOGW_IF(mProcess == nullptr, "%s: unsupported format %#x channel count %u",
+            __func__, format, channelCount);
+}
+
+void VolumeRamp::setVolume(float left, float right)
+{
+    mTargetVolume[0] = left;
+    mTargetVolume[1] = right;
+}
+
+void VolumeRamp::process(void *buffer, size_t frameCount)
+{
+    if (mProcess == nullptr || frameCount == 0) {
+        return;
+    }
+    if (mVolume[0] != mTargetVolume[0] || mVolume[1] != mTargetVolume[1]) {
+        const float volumeInc[2] = {
+            (mTargetVolume[0] - mVolume[0]) / frameCount,
+            (mTargetVolume[1] - mVolume[1]) / frameCount,
+        };
+        mProcess(buffer, frameCount, mVolume, volumeInc);
+        mVolume[0] = mTargetVolume[0];
+        mVolume[1] = mTargetVolume[1];
+    } else if (mVolume[0] != 1.f || mVolume[1] != 1.f) {
+        mProcessConstant(buffer, frameCount, mVolume, nullptr);
+    }
+}
+
+} // namespace android
@@ -242,6 +242,14 @@ public:
             typename TO, typename TI, typename TA>
         void volumeMix(TO *out, size_t outFrames, const TI *in, TA *aux, bool ramp);
 
+        // Mixes (or with SAVEONLY, stores) up to frameCount float frames into out,
+        // fetching the next input buffer when the current one runs out.
+        // framesLeft is the number of frames still to be mixed in this process() cycle.
+        // Returns the number of frames written, which is less than frameCount
+        // only when the provider has no more data.
+        template <bool SAVEONLY>
+        size_t mixNoResampleBlock(float *out, size_t frameCount, size_t framesLeft);
+
         uint32_t    needs;
 
         // TODO: Eventually remove legacy integer volume settings
@@ -351,6 +359,11 @@ public:
     void process__genericNoResampling();
     void process__genericResampling();
     void process__oneTrack16BitsStereoNoResampling();
+    void process__noResampleMultiTrack();
+
+    // Returns true if every group of enabled tracks can be mixed by
+    // process__noResampleMultiTrack().
+    bool canMixMultiTrackNoResample() const;
 
     template <int MIXTYPE, typename TO, typename TI, typename TA>
     void process__noResampleOneTrack();
@@ -362,6 +375,15 @@ public:
     static void convertMixerFormat(void *out, audio_format_t mixerOutFormat,
             void *in, audio_format_t mixerInFormat, size_t sampleCount);
 
+    // Maximum number of tracks sharing a main buffer that process__noResampleMultiTrack()
+    // adds together in one pass.
+    static constexpr size_t kMaxMultiTrackCount = 16;
+
+    // Frames mixed per pass by process__noResampleMultiTrack(). With up to
+    // MAX_NUM_CHANNELS float samples per frame the block stays resident in L1 cache
+    // while every track is added to it.
+    static constexpr size_t kMultiTrackBlockFrames = 64;
+
     // initialization constants
     const uint32_t mSampleRate;
     const size_t mFrameCount;
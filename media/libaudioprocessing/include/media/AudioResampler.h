@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <string>
 
 #include <cutils/compiler.h>
 #include <utils/Compat.h>
@@ -54,6 +55,10 @@ public:
     static AudioResampler* create(audio_format_t format, int inChannelCount,
             int32_t sampleRate, src_quality quality=DEFAULT_QUALITY);
 
+    // Returns the statistics of the process-wide filter cache shared by the
+    // DYN_*_QUALITY resamplers, for dumpsys.
+    static std::string dumpFilterCache();
+
     virtual ~AudioResampler();
 
     virtual void init() = 0;
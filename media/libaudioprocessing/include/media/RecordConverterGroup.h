@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_RECORD_CONVERTER_GROUP_H
+#define ANDROID_RECORD_CONVERTER_GROUP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <memory>
+#include <vector>
+
+#include <media/AudioBufferProvider.h>
+#include <system/audio.h>
+
+namespace android {
+
+class RecordBufferConverter;
+
+/* The RecordConverterGroup converts the RecordThread data once for all the RecordTracks
+ * with the same sample rate, format and channel mask, instead of each RecordTrack
+ * converting it with its own RecordBufferConverter.
+ * The converted data is kept in a buffer sized like the RecordThread buffer, from which
+ * each RecordTrack of the group reads at its own pace through a Reader.
+ * The group and its Readers are not thread safe.
+ *
+ * Original source audioflinger/Threads.{h,cpp}
+ */
+class RecordConverterGroup : public AudioBufferProvider
+{
+public:
+    // The RecordThread buffer: a ring of framesP2 frames, of which the last frames
+    // written can be read before they are overwritten.
+    struct Input {
+        const void          *buffer;
+        size_t               frames;        // frames that can be read
+        size_t               framesP2;      // size of the ring, a power of 2 >= frames
+        size_t               frameSize;
+        audio_channel_mask_t channelMask;
+        audio_format_t       format;
+        uint32_t             sampleRate;
+    };
+
+    // The group starts converting the input at front.
+    RecordConverterGroup(const Input& input, audio_channel_mask_t channelMask,
+            audio_format_t format, uint32_t sampleRate, int32_t front);
+    ~RecordConverterGroup() override;
+
+    status_t    initCheck() const;
+
+    // true if a track of this configuration, at input position front, can read the data
+    // of the group.
+    bool        matches(audio_channel_mask_t channelMask, audio_format_t format,
+                        uint32_t sampleRate, int32_t front) const;
+
+    // Takes converter and returns the converter of the group, so that a RecordTrack
+    // founding or dissolving the group continues from the state of its previous converter.
+    RecordBufferConverter *exchangeConverter(RecordBufferConverter *converter);
+
+    // Converts all the input data written up to rear and not converted yet.
+    void        convert(int32_t rear);
+
+    // next input frame to convert
+    int32_t     getFront() const { return mFront; }
+
+    // frames of converted data held by the group
+    size_t      getFrames() const { return mFrames; }
+
+    // AudioBufferProvider interface, for the RecordBufferConverter
+    status_t    getNextBuffer(AudioBufferProvider::Buffer* buffer) override;
+    void        releaseBuffer(AudioBufferProvider::Buffer* buffer) override;
+
+    // A Reader provides the converted data of the group to one RecordTrack.
+    // It starts after the data already converted, and must not outlive the group.
+    class Reader : public AudioBufferProvider
+    {
+    public:
+        explicit Reader(const RecordConverterGroup *group)
+            : mGroup(group), mFront(group->mRear) { }
+
+        bool    isCaughtUp() const { return mFront == mGroup->mRear; }
+
+        // Skips the data not read yet.
+        void    reset();
+
+        /* Calculates the frames available to read. If the group has converted more
+         * than it holds since the last read, skips to the oldest frame held and reports
+         * an overrun.
+         *
+         * Parameters
+         * framesAvailable:  pointer to optional output size_t to store frames available.
+         *      hasOverrun:  pointer to optional boolean, returns true if the reader overran.
+         */
+        void    sync(size_t *framesAvailable = NULL, bool *hasOverrun = NULL);
+
+        // AudioBufferProvider interface
+        status_t    getNextBuffer(AudioBufferProvider::Buffer* buffer) override;
+        void        releaseBuffer(AudioBufferProvider::Buffer* buffer) override;
+
+    private:
+        const RecordConverterGroup * const mGroup;
+        int32_t             mFront;         // next available frame of the group buffer
+        size_t              mUnrel = 0;     // unreleased frames from getNextBuffer
+    };
+
+private:
+    const Input         mInput;
+    int32_t             mInputRear;     // last input frame written + 1, set by convert()
+    const audio_channel_mask_t mChannelMask;
+    const audio_format_t mFormat;
+    const uint32_t      mSampleRate;
+    const size_t        mFrameSize;
+    std::unique_ptr<RecordBufferConverter> mConverter;
+    int32_t             mFront;         // next input frame to convert
+    size_t              mUnrel = 0;     // unreleased frames from getNextBuffer
+
+    // converted data, mFrames is a power of 2.
+    const size_t        mFrames;
+    std::vector<uint8_t> mBuffer;
+    int32_t             mRear = 0;      // last converted frame + 1, rolling counter
+};
+
+} // namespace android
+
+#endif // ANDROID_RECORD_CONVERTER_GROUP_H
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_VOLUME_RAMP_H
+#define ANDROID_VOLUME_RAMP_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <system/audio.h>
+#include <utils/Errors.h>
+
+namespace android {
+
+/* The VolumeRamp applies a stereo volume in place to interleaved PCM data,
+ * for outputs that do not go through the AudioMixer.
+ *
+ * Supported formats are AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_24_BIT_PACKED,
+ * AUDIO_FORMAT_PCM_32_BIT and AUDIO_FORMAT_PCM_FLOAT with 1 to 8 channels.
+ * Channels take the left, right or center volume according to the canonical
+ * channel position mask for the channel count, as in the AudioMixer.
+ *
+ * A volume change is ramped linearly over the next process() call.
+ * The processing loop is selected at construction from specializations for each
+ * format and channel count. Integer formats are scaled in fixed point and float
+ * in float. At unity volume process() does not touch the data.
+ */
+class VolumeRamp
+{
+public:
+    VolumeRamp(audio_format_t format, uint32_t channelCount);
+
+    // returns NO_ERROR if the format and channel count are supported.
+    status_t initCheck() const {
+        return mProcess != nullptr ? NO_ERROR : BAD_VALUE;
+    }
+
+    // Sets the volume reached at the end of the next process() call.
+    void setVolume(float left, float right);
+
+    void getVolume(float *left, float *right) const {
+        *left = mTargetVolume[0];
+        *right = mTargetVolume[1];
+    }
+
+    /* Applies the volume to the data.
+     *
+     * Parameters
+     *      buffer:  interleaved data in the format and channel count of the VolumeRamp.
+     *  frameCount:  number of frames to process.
+     */
+    void process(void *buffer, size_t frameCount);
+
+    // Signature of the specialized processing loops.
+    using ProcessFunc = void (*)(void *buffer, size_t frameCount,
+            const float *volume, const float *volumeInc);
+
+private:
+    ProcessFunc mProcess = nullptr;         // ramps from volume by volumeInc every frame
+    ProcessFunc mProcessConstant = nullptr; // applies volume, ignores volumeInc
+    float mVolume[2] = {1.f, 1.f};          // volume at the end of the last process()
+    float mTargetVolume[2] = {1.f, 1.f};
+};
+
+} // namespace android
+
+#endif // ANDROID_VOLUME_RAMP_H
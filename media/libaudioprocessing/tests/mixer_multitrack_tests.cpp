@@ -0,0 +1,247 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "mixer_multitrack_tests"
+#include <log/log.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <media/AudioMixerBase.h>
+
+#include "test_utils.h"
+
+using namespace android;
+
+namespace {
+
+constexpr size_t kFrameCount = 300;   // not a multiple of the 64 frame block
+constexpr uint32_t kSampleRate = 48000;
+constexpr size_t kProcessCount = 6;
+
+// An AudioMixerBase that mixes float tracks from TestProviders, and can be kept
+// from selecting process__noResampleMultiTrack() so that its output can be compared
+// with that of process__genericNoResampling().
+class TestMixer : public AudioMixerBase {
+public:
+    explicit TestMixer(bool allowMultiTrack)
+        : AudioMixerBase(kFrameCount, kSampleRate)
+        , mAllowMultiTrack(allowMultiTrack) {
+    }
+
+    void setBufferProvider(int name, AudioBufferProvider *provider) {
+        mTracks[name]->bufferProvider = provider;
+    }
+
+    bool usedMultiTrack() const { return mUsedMultiTrack; }
+
+protected:
+    void preProcess() override {
+        if (mHook == &TestMixer::process__noResampleMultiTrack) {
+            if (mAllowMultiTrack) {
+                mUsedMultiTrack = true;
+            } else {
+                mHook = &TestMixer::process__genericNoResampling;
+            }
+        }
+    }
+
+private:
+    const bool mAllowMultiTrack;
+    bool mUsedMultiTrack = false;
+};
+
+// How one track is set up, and how its volume is changed after the first process().
+struct TrackConfig {
+    int group;                  // index of the main buffer
+    audio_channel_mask_t channelMask;
+    float volume[2];
+    float nextVolume[2];        // ramped to after the first process()
+    size_t frames;              // frames the provider holds
+    std::vector<int> increments; // frames provided per getNextBuffer()
+};
+
+// How one main buffer is set up.
+struct GroupConfig {
+    audio_channel_mask_t channelMask;
+    audio_format_t format;
+};
+
+struct MixerConfig {
+    const char *name;
+    std::vector<GroupConfig> groups;
+    std::vector<TrackConfig> tracks;
+};
+
+std::vector<float> createInput(size_t frames, uint32_t channels, size_t seed) {
+    std::vector<float> input(frames * channels);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = float((i * 7919 + seed * 104729) % 2001) / 1000.f - 1.f;
+    }
+    return input;
+}
+
+// Runs a mixer over the configuration and returns the content of each main buffer
+// after each process().
+std::vector<std::vector<uint8_t>> mix(const MixerConfig &config, bool allowMultiTrack) {
+    TestMixer mixer(allowMultiTrack);
+    std::vector<std::vector<uint8_t>> mainBuffers;
+    for (const GroupConfig &group : config.groups) {
+        mainBuffers.emplace_back(kFrameCount * audio_bytes_per_frame(
+                audio_channel_count_from_out_mask(group.channelMask), group.format));
+    }
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::unique_ptr<TestProvider>> providers;
+    for (size_t name = 0; name < config.tracks.size(); ++name) {
+        const TrackConfig &track = config.tracks[name];
+        const GroupConfig &group = config.groups[track.group];
+        const uint32_t channels = audio_channel_count_from_out_mask(track.channelMask);
+        inputs.push_back(createInput(track.frames, channels, name));
+        providers.push_back(std::make_unique<TestProvider>(inputs.back().data(), track.frames,
+                channels * sizeof(float), track.increments));
+
+        EXPECT_EQ(OK, mixer.create(name, track.channelMask, AUDIO_FORMAT_PCM_FLOAT,
+                AUDIO_SESSION_OUTPUT_MIX));
+        mixer.setBufferProvider(name, providers.back().get());
+        mixer.setParameter(name, AudioMixerBase::TRACK, AudioMixerBase::MIXER_FORMAT,
+                (void *)(uintptr_t)group.format);
+        mixer.setParameter(name, AudioMixerBase::TRACK, AudioMixerBase::MIXER_CHANNEL_MASK,
+                (void *)(uintptr_t)group.channelMask);
+        mixer.setParameter(name, AudioMixerBase::TRACK, AudioMixerBase::MAIN_BUFFER,
+                mainBuffers[track.group].data());
+        for (int i = 0; i < 2; ++i) {
+            float volume = track.volume[i];
+            mixer.setParameter(name, AudioMixerBase::VOLUME, AudioMixerBase::VOLUME0 + i,
+                    &volume);
+        }
+        mixer.enable(name);
+    }
+
+    std::vector<std::vector<uint8_t>> output;
+    for (size_t n = 0; n < kProcessCount; ++n) {
+        if (n == 1) {
+            for (size_t name = 0; name < config.tracks.size(); ++name) {
+                for (int i = 0; i < 2; ++i) {
+                    float volume = config.tracks[name].nextVolume[i];
+                    mixer.setParameter(name, AudioMixerBase::RAMP_VOLUME,
+                            AudioMixerBase::VOLUME0 + i, &volume);
+                }
+            }
+        }
+        mixer.process();
+        for (const std::vector<uint8_t> &mainBuffer : mainBuffers) {
+            output.push_back(mainBuffer);
+        }
+    }
+    EXPECT_EQ(allowMultiTrack, mixer.usedMultiTrack());
+    return output;
+}
+
+const MixerConfig kConfigs[] = {
+    {
+        "stereo",
+        {{AUDIO_CHANNEL_OUT_STEREO, AUDIO_FORMAT_PCM_FLOAT}},
+        {
+            {0, AUDIO_CHANNEL_OUT_STEREO, {1.f, 1.f}, {1.f, 1.f}, 10000, {}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.5f, 0.25f}, {0.5f, 0.25f}, 10000, {}},
+        },
+    },
+    {
+        // Providers that hand out odd sized buffers, run out of data, or have none.
+        // The first track, which stores into each block, runs out in the middle of one.
+        "partial buffers",
+        {{AUDIO_CHANNEL_OUT_STEREO, AUDIO_FORMAT_PCM_FLOAT}},
+        {
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.7f, 0.7f}, {0.7f, 0.7f}, 450, {100}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.8f, 0.6f}, {0.8f, 0.6f}, 10000, {17, 64, 3, 200}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.3f, 0.9f}, {0.3f, 0.9f}, 0, {}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.5f, 0.5f}, {0.5f, 0.5f}, 10000, {63, 65}},
+        },
+    },
+    {
+        // The first track is muted, so the second one stores into each block;
+        // others ramp up from or down to silence.
+        "muted and ramped",
+        {{AUDIO_CHANNEL_OUT_STEREO, AUDIO_FORMAT_PCM_FLOAT}},
+        {
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.f, 0.f}, {0.f, 0.f}, 10000, {}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {1.f, 1.f}, {0.f, 0.5f}, 10000, {50}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.f, 0.f}, {1.f, 0.75f}, 10000, {}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.25f, 0.5f}, {0.5f, 0.25f}, 10000, {}},
+        },
+    },
+    {
+        // Two main buffers, one of them int16, and multichannel tracks.
+        "groups",
+        {{AUDIO_CHANNEL_OUT_STEREO, AUDIO_FORMAT_PCM_16_BIT},
+         {AUDIO_CHANNEL_OUT_5POINT1, AUDIO_FORMAT_PCM_FLOAT}},
+        {
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.4f, 0.4f}, {0.2f, 0.6f}, 10000, {}},
+            {1, AUDIO_CHANNEL_OUT_5POINT1, {0.5f, 0.5f}, {0.5f, 0.5f}, 10000, {91}},
+            {0, AUDIO_CHANNEL_OUT_STEREO, {0.3f, 0.3f}, {0.3f, 0.3f}, 700, {}},
+            {1, AUDIO_CHANNEL_OUT_5POINT1, {0.25f, 0.25f}, {0.75f, 0.75f}, 10000, {}},
+            {1, AUDIO_CHANNEL_OUT_5POINT1, {0.f, 0.f}, {0.f, 0.f}, 10000, {}},
+        },
+    },
+};
+
+}  // namespace
+
+class MixerMultiTrackTest : public ::testing::TestWithParam<MixerConfig> {
+};
+
+// process__noResampleMultiTrack() must produce what process__genericNoResampling()
+// produces for the same tracks.
+TEST_P(MixerMultiTrackTest, MatchesGenericNoResampling) {
+    const MixerConfig &config = GetParam();
+    const std::vector<std::vector<uint8_t>> expected = mix(config, false /* allowMultiTrack */);
+    const std::vector<std::vector<uint8_t>> actual = mix(config, true /* allowMultiTrack */);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const size_t process = i / config.groups.size();
+        const GroupConfig &group = config.groups[i % config.groups.size()];
+        ASSERT_EQ(expected[i].size(), actual[i].size());
+        if (group.format == AUDIO_FORMAT_PCM_FLOAT) {
+            const float *e = reinterpret_cast<const float *>(expected[i].data());
+            const float *a = reinterpret_cast<const float *>(actual[i].data());
+            for (size_t s = 0; s < expected[i].size() / sizeof(float); ++s) {
+                ASSERT_NEAR(e[s], a[s], 1e-6f)
+                        << "process " << process << " group " << i % config.groups.size()
+                        << " sample " << s;
+            }
+        } else {
+            const int16_t *e = reinterpret_cast<const int16_t *>(expected[i].data());
+            const int16_t *a = reinterpret_cast<const int16_t *>(actual[i].data());
+            for (size_t s = 0; s < expected[i].size() / sizeof(int16_t); ++s) {
+                ASSERT_EQ(e[s], a[s])
+                        << "process " << process << " group " << i % config.groups.size()
+                        << " sample " << s;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        Configs, MixerMultiTrackTest, ::testing::ValuesIn(kConfigs),
+        [](const ::testing::TestParamInfo<MixerConfig> &info) {
+            std::string name = info.param.name;
+            std::replace(name.begin(), name.end(), ' ', '_');
+            return name;
+        });
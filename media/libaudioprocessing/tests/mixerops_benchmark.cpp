@@ -15,7 +15,9 @@
  */
 
 #include <inttypes.h>
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 #define LOG_ALWAYS_FATAL(...)
 
 #include <../AudioMixerOps.h>
@@ -72,6 +74,65 @@ static void BM_VolumeMulti(benchmark::State& state) {
     }
 }
 
+// Mixes state.range(0) tracks of NCHAN channels into one output buffer.
+//
+// If BLOCKED is false, each track is ramped and accumulated over the whole buffer
+// in turn, as process__genericNoResampling() does.
+// If BLOCKED is true, all tracks are mixed one block at a time with the first track
+// storing into the block, as process__noResampleMultiTrack() does.
+template <int NCHAN, bool BLOCKED>
+static void BM_MixTracks(benchmark::State& state) {
+    constexpr size_t FRAME_COUNT = 1920;  // 40 ms at 48 kHz
+    constexpr size_t SAMPLE_COUNT = FRAME_COUNT * NCHAN;
+    constexpr size_t BLOCK_FRAMES = 64;   // AudioMixerBase::kMultiTrackBlockFrames
+    constexpr int STOREMIXTYPE = MIXTYPE_MULTI_SAVEONLY_STEREOVOL;
+    constexpr int ADDMIXTYPE = MIXTYPE_MULTI_STEREOVOL;
+    const size_t trackCount = state.range(0);
+
+    std::vector<float> out(SAMPLE_COUNT);
+    std::vector<std::vector<float>> in(trackCount, std::vector<float>(SAMPLE_COUNT, 0.5f));
+    std::vector<float> vol(2 * trackCount);
+    const float volinc[2] = {1.f / FRAME_COUNT, 1.f / FRAME_COUNT};
+    float vola = 0.f;
+
+    while (state.KeepRunning()) {
+        std::fill(vol.begin(), vol.end(), 0.f);
+        benchmark::DoNotOptimize(out.data());
+        if (BLOCKED) {
+            for (size_t frame = 0; frame < FRAME_COUNT; frame += BLOCK_FRAMES) {
+                const size_t frames = std::min(BLOCK_FRAMES, FRAME_COUNT - frame);
+                float *block = out.data() + frame * NCHAN;
+                volumeRampMulti<STOREMIXTYPE, NCHAN>(block, frames, in[0].data() + frame * NCHAN,
+                        (float *)nullptr, vol.data(), volinc, &vola, 0.f);
+                for (size_t i = 1; i < trackCount; ++i) {
+                    volumeRampMulti<ADDMIXTYPE, NCHAN>(block, frames,
+                            in[i].data() + frame * NCHAN, (float *)nullptr, vol.data() + 2 * i,
+                            volinc, &vola, 0.f);
+                }
+            }
+        } else {
+            std::fill(out.begin(), out.end(), 0.f);
+            for (size_t i = 0; i < trackCount; ++i) {
+                volumeRampMulti<ADDMIXTYPE, NCHAN>(out.data(), FRAME_COUNT, in[i].data(),
+                        (float *)nullptr, vol.data() + 2 * i, volinc, &vola, 0.f);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * trackCount * FRAME_COUNT);
+}
+
+static void MixTracksArgs(benchmark::internal::Benchmark* b) {
+    for (int trackCount : {2, 4, 6, 8, 10, 16}) {
+        b->Arg(trackCount);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_MixTracks, 2, false)->Apply(MixTracksArgs);
+BENCHMARK_TEMPLATE(BM_MixTracks, 2, true)->Apply(MixTracksArgs);
+BENCHMARK_TEMPLATE(BM_MixTracks, 8, false)->Apply(MixTracksArgs);
+BENCHMARK_TEMPLATE(BM_MixTracks, 8, true)->Apply(MixTracksArgs);
+
 // MULTI mode and MULTI_SAVEONLY mode are not used by AudioMixer for channels > 2,
 // which is ensured by a static_assert (won't compile for those configurations).
 // So we benchmark MIXTYPE_MULTI_MONOVOL and MIXTYPE_MULTI_SAVEONLY_MONOVOL compared
@@ -0,0 +1,373 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "record_converter_group_tests"
+#include <log/log.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <media/AudioResamplerPublic.h>
+#include <media/RecordBufferConverter.h>
+#include <media/RecordConverterGroup.h>
+
+using namespace android;
+
+namespace {
+
+// Like a RecordThread reading 2 ms periods at 48 kHz into a 480 frame buffer.
+constexpr uint32_t kInputSampleRate = 48000;
+constexpr audio_channel_mask_t kChannelMask = AUDIO_CHANNEL_IN_STEREO;
+constexpr uint32_t kChannelCount = 2;
+constexpr size_t kInputFrames = 480;
+constexpr size_t kInputFramesP2 = 512;
+constexpr size_t kPeriodFrames = 96;
+constexpr size_t kTotalInputFrames = 100 * kPeriodFrames;
+
+// The RecordThread buffer, filled period by period from a stream of int16 samples.
+class InputRing {
+public:
+    InputRing()
+        : mBuffer(kInputFramesP2 * kChannelCount)
+        , mStream(kTotalInputFrames * kChannelCount) {
+        for (size_t i = 0; i < mStream.size(); ++i) {
+            mStream[i] = static_cast<int16_t>((i * 7919 + (i >> 3) * 104729) % 60001 - 30000);
+        }
+    }
+
+    RecordConverterGroup::Input input() const {
+        return {mBuffer.data(), kInputFrames, kInputFramesP2, kChannelCount * sizeof(int16_t),
+                kChannelMask, AUDIO_FORMAT_PCM_16_BIT, kInputSampleRate};
+    }
+
+    // Writes the next period and returns the new rear.
+    int32_t write() {
+        for (size_t i = 0; i < kPeriodFrames; ++i, ++mRear) {
+            std::copy_n(&mStream[mRear * kChannelCount], kChannelCount,
+                    &mBuffer[(mRear & (kInputFramesP2 - 1)) * kChannelCount]);
+        }
+        return mRear;
+    }
+
+    int32_t rear() const { return mRear; }
+    const int16_t *buffer() const { return mBuffer.data(); }
+    const std::vector<int16_t>& stream() const { return mStream; }
+
+private:
+    std::vector<int16_t> mBuffer;
+    std::vector<int16_t> mStream;
+    int32_t mRear = 0;
+};
+
+// Provides the data of the InputRing to the converter of a track not in a group,
+// like the ResamplerBufferProvider of a RecordTrack.
+class InputRingProvider : public AudioBufferProvider {
+public:
+    InputRingProvider(const InputRing& ring, int32_t front) : mRing(ring), mFront(front) { }
+
+    status_t getNextBuffer(Buffer* buffer) override {
+        const size_t front = mFront & (kInputFramesP2 - 1);
+        buffer->frameCount = std::min({buffer->frameCount, kInputFramesP2 - front,
+                static_cast<size_t>(mRing.rear() - mFront)});
+        if (buffer->frameCount == 0) {
+            buffer->raw = nullptr;
+            return NOT_ENOUGH_DATA;
+        }
+        buffer->raw = const_cast<int16_t *>(mRing.buffer()) + front * kChannelCount;
+        return NO_ERROR;
+    }
+
+    void releaseBuffer(Buffer* buffer) override {
+        mFront += buffer->frameCount;
+        buffer->raw = nullptr;
+        buffer->frameCount = 0;
+    }
+
+    int32_t front() const { return mFront; }
+
+private:
+    const InputRing& mRing;
+    int32_t mFront;
+};
+
+// Provides the whole input stream at once.
+class StreamProvider : public AudioBufferProvider {
+public:
+    explicit StreamProvider(const std::vector<int16_t>& stream) : mStream(stream) { }
+
+    status_t getNextBuffer(Buffer* buffer) override {
+        buffer->frameCount = std::min(buffer->frameCount, mStream.size() / kChannelCount - mFront);
+        if (buffer->frameCount == 0) {
+            buffer->raw = nullptr;
+            return NOT_ENOUGH_DATA;
+        }
+        buffer->raw = const_cast<int16_t *>(mStream.data()) + mFront * kChannelCount;
+        return NO_ERROR;
+    }
+
+    void releaseBuffer(Buffer* buffer) override {
+        mFront += buffer->frameCount;
+        buffer->raw = nullptr;
+        buffer->frameCount = 0;
+    }
+
+private:
+    const std::vector<int16_t>& mStream;
+    size_t mFront = 0;
+};
+
+RecordBufferConverter *createConverter(uint32_t sampleRate) {
+    return new RecordBufferConverter(kChannelMask, AUDIO_FORMAT_PCM_16_BIT, kInputSampleRate,
+            kChannelMask, AUDIO_FORMAT_PCM_FLOAT, sampleRate);
+}
+
+// A member of a group: reads the group with a Reader and keeps what it read.
+struct Member {
+    Member(const RecordConverterGroup *group, size_t start)
+        : reader(std::make_unique<RecordConverterGroup::Reader>(group)), start(start) { }
+
+    // Reads what is available, at most maxFrames at a time,
+    // and returns whether the reader overran.
+    bool read(size_t maxFrames) {
+        size_t framesIn;
+        bool overrun;
+        reader->sync(&framesIn, &overrun);
+        while (framesIn > 0) {
+            AudioBufferProvider::Buffer buffer;
+            buffer.frameCount = std::min(framesIn, maxFrames);
+            EXPECT_EQ(NO_ERROR, reader->getNextBuffer(&buffer));
+            const float *data = static_cast<const float *>(buffer.raw);
+            output.insert(output.end(), data, data + buffer.frameCount * kChannelCount);
+            framesIn -= buffer.frameCount;
+            reader->releaseBuffer(&buffer);
+        }
+        return overrun;
+    }
+
+    std::unique_ptr<RecordConverterGroup::Reader> reader;
+    size_t start;               // index in the converted stream of the first frame read
+    std::vector<float> output;
+};
+
+} // namespace
+
+class RecordConverterGroupTest : public ::testing::TestWithParam<uint32_t> {
+protected:
+    void SetUp() override {
+        mSampleRate = GetParam();
+        // The expected output: the whole input stream converted by a lone converter.
+        std::unique_ptr<RecordBufferConverter> converter(createConverter(mSampleRate));
+        ASSERT_EQ(NO_ERROR, converter->initCheck());
+        StreamProvider provider(mRing.stream());
+        mExpected.resize(kTotalInputFrames * kChannelCount);
+        const size_t frames = converter->convert(mExpected.data(), &provider,
+                destinationFramesPossible(kTotalInputFrames, kInputSampleRate, mSampleRate));
+        mExpected.resize(frames * kChannelCount);
+    }
+
+    std::unique_ptr<RecordConverterGroup> createGroup(int32_t front) {
+        auto group = std::make_unique<RecordConverterGroup>(mRing.input(), kChannelMask,
+                AUDIO_FORMAT_PCM_FLOAT, mSampleRate, front);
+        EXPECT_EQ(NO_ERROR, group->initCheck());
+        return group;
+    }
+
+    // Checks that the frames read by a member are the expected ones, from the given frame
+    // of the expected output.
+    void expectFrames(const std::vector<float>& output, size_t start, size_t count) {
+        ASSERT_LE(count * kChannelCount, output.size());
+        ASSERT_LE((start + count) * kChannelCount, mExpected.size());
+        for (size_t i = 0; i < count * kChannelCount; ++i) {
+            ASSERT_NEAR(mExpected[start * kChannelCount + i], output[i], 1e-6f)
+                    << "frame " << start + i / kChannelCount;
+        }
+    }
+
+    uint32_t mSampleRate;
+    InputRing mRing;
+    std::vector<float> mExpected;
+};
+
+// Members reading at different paces get the converted stream across the wrap
+// of the RecordThread buffer and of the group buffer.
+TEST_P(RecordConverterGroupTest, ReadAcrossWrap) {
+    auto group = createGroup(mRing.rear());
+    Member every(group.get(), 0);
+    Member everyOther(group.get(), 0);
+    for (int period = 0; period < 40; ++period) {
+        group->convert(mRing.write());
+        EXPECT_FALSE(every.read(37 /* maxFrames */));
+        if (period % 2 == 1) {
+            EXPECT_FALSE(everyOther.read(SIZE_MAX));
+        }
+        EXPECT_TRUE(every.reader->isCaughtUp());
+    }
+    const size_t converted = every.output.size() / kChannelCount;
+    // The group buffer wrapped at least 3 times.
+    EXPECT_GT(converted, 3 * group->getFrames());
+    expectFrames(every.output, 0, converted);
+    expectFrames(everyOther.output, 0, converted);
+}
+
+// A member that does not read for longer than the group buffer holds gets the
+// latest data and an overrun.
+TEST_P(RecordConverterGroupTest, Overrun) {
+    auto group = createGroup(mRing.rear());
+    Member reading(group.get(), 0);
+    Member stalled(group.get(), 0);
+    for (int period = 0; period < 5; ++period) {
+        group->convert(mRing.write());
+        reading.read(SIZE_MAX);
+    }
+    const size_t before = reading.output.size() / kChannelCount;
+    EXPECT_FALSE(stalled.read(SIZE_MAX));
+    expectFrames(stalled.output, 0, before);
+
+    stalled.output.clear();
+    for (int period = 0; period < 20; ++period) {
+        group->convert(mRing.write());
+        EXPECT_FALSE(reading.read(SIZE_MAX));
+    }
+    size_t framesIn;
+    bool overrun;
+    stalled.reader->sync(&framesIn, &overrun);
+    EXPECT_TRUE(overrun);
+    EXPECT_EQ(group->getFrames(), framesIn);
+    EXPECT_FALSE(stalled.read(SIZE_MAX));
+    const size_t converted = reading.output.size() / kChannelCount;
+    ASSERT_EQ(group->getFrames(), stalled.output.size() / kChannelCount);
+    expectFrames(stalled.output, converted - group->getFrames(), group->getFrames());
+    expectFrames(reading.output, 0, converted);
+}
+
+// Members leaving do not disturb the others, and a track joins only at the position
+// of the group, to read from the next frame converted.
+TEST_P(RecordConverterGroupTest, MembersLeaveAndJoin) {
+    auto group = createGroup(mRing.rear());
+    std::vector<std::unique_ptr<Member>> members;
+    members.push_back(std::make_unique<Member>(group.get(), 0));
+    members.push_back(std::make_unique<Member>(group.get(), 0));
+    size_t converted = 0;
+    for (int period = 0; period < 30; ++period) {
+        if (period == 10) {
+            // A member leaves with unread data.
+            members.front().reset();
+        }
+        if (period == 20) {
+            const int32_t front = group->getFront();
+            EXPECT_TRUE(group->matches(kChannelMask, AUDIO_FORMAT_PCM_FLOAT, mSampleRate, front));
+            EXPECT_FALSE(group->matches(
+                    kChannelMask, AUDIO_FORMAT_PCM_FLOAT, mSampleRate, front + 1));
+            EXPECT_FALSE(group->matches(
+                    kChannelMask, AUDIO_FORMAT_PCM_FLOAT, mSampleRate, front - 1));
+            EXPECT_FALSE(group->matches(kChannelMask, AUDIO_FORMAT_PCM_16_BIT, mSampleRate, front));
+            EXPECT_FALSE(group->matches(
+                    AUDIO_CHANNEL_IN_MONO, AUDIO_FORMAT_PCM_FLOAT, mSampleRate, front));
+            members.push_back(std::make_unique<Member>(group.get(), converted));
+            EXPECT_TRUE(members.back()->reader->isCaughtUp());
+        }
+        // The second member reads all that is converted.
+        group->convert(mRing.write());
+        members[1]->read(SIZE_MAX);
+        converted = members[1]->output.size() / kChannelCount;
+        if (period % 3 == 0) {
+            for (size_t i = 2; i < members.size(); ++i) {
+                members[i]->read(SIZE_MAX);
+            }
+        }
+    }
+    for (const auto& member : members) {
+        if (member != nullptr) {
+            member->read(SIZE_MAX);
+            expectFrames(member->output, member->start,
+                    member->output.size() / kChannelCount);
+            EXPECT_EQ(converted, member->start + member->output.size() / kChannelCount);
+        }
+    }
+}
+
+// The track founding a group gives its converter to the group, and the last member takes
+// it back: the track converts without discontinuity before, in and after the group.
+TEST_P(RecordConverterGroupTest, ConverterExchangeBackToLastMember) {
+    RecordBufferConverter *trackConverter = createConverter(mSampleRate);
+    RecordBufferConverter * const originalConverter = trackConverter;
+    std::vector<float> output;
+    auto convertAlone = [&](InputRingProvider *provider) {
+        std::vector<float> buffer(kPeriodFrames * kChannelCount);
+        for (;;) {
+            const size_t framesOut = destinationFramesPossible(
+                    mRing.rear() - provider->front(), kInputSampleRate, mSampleRate);
+            if (framesOut == 0) {
+                break;
+            }
+            const size_t frames = trackConverter->convert(buffer.data(), provider,
+                    std::min(framesOut, kPeriodFrames));
+            if (frames == 0) {
+                break;
+            }
+            output.insert(output.end(), buffer.begin(), buffer.begin() + frames * kChannelCount);
+        }
+    };
+
+    // The track converts on its own.
+    InputRingProvider provider(mRing, mRing.rear());
+    for (int period = 0; period < 7; ++period) {
+        mRing.write();
+        convertAlone(&provider);
+    }
+
+    // The track founds a group at its position, with another track.
+    auto group = createGroup(provider.front());
+    trackConverter = group->exchangeConverter(trackConverter);
+    Member founder(group.get(), output.size() / kChannelCount);
+    Member other(group.get(), output.size() / kChannelCount);
+    for (int period = 0; period < 13; ++period) {
+        group->convert(mRing.write());
+        founder.read(SIZE_MAX);
+        other.read(SIZE_MAX);
+    }
+    output.insert(output.end(), founder.output.begin(), founder.output.end());
+
+    // The other track leaves, the founder takes its converter back and continues on its own
+    // from the position of the group.
+    other.reader.reset();
+    ASSERT_TRUE(founder.reader->isCaughtUp());
+    trackConverter = group->exchangeConverter(trackConverter);
+    EXPECT_EQ(originalConverter, trackConverter);
+    InputRingProvider providerAfter(mRing, group->getFront());
+    founder.reader.reset();
+    group.reset();
+    for (int period = 0; period < 9; ++period) {
+        mRing.write();
+        convertAlone(&providerAfter);
+    }
+    delete trackConverter;
+
+    expectFrames(output, 0, output.size() / kChannelCount);
+    expectFrames(other.output, other.start, other.output.size() / kChannelCount);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        SampleRates, RecordConverterGroupTest, ::testing::Values(48000, 16000),
+        [](const ::testing::TestParamInfo<uint32_t> &info) {
+            return std::to_string(info.param);
+        });
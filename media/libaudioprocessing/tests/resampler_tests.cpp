@@ -28,8 +28,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -40,6 +43,11 @@
 #include <media/AudioResampler.h>
 #include "../AudioResamplerDyn.h"
 #include "../AudioResamplerFirGen.h"
+#include "../AudioResamplerFirOps.h"
+#include "../AudioResamplerFirProcess.h"
+#include "../AudioResamplerFirProcessNeon.h"
+#include "../AudioResamplerFirProcessAVX2.h"
+#include "../AudioResamplerFirProcessSSE.h"
 #include "test_utils.h"
 
 template <typename T>
@@ -601,3 +609,223 @@ TEST(audioflinger_resampler, generalresponse) {
         }
     }
 }
+
+// Resamplers designing the same filter share one copy of the coefficients
+// from the process-wide filter cache, whatever their channel count.
+TEST(audioflinger_resampler, filtercache) {
+    using ResamplerType = android::AudioResamplerDyn<float, float, float>;
+    auto createResampler = [](int channels, int32_t inSampleRate, int32_t outSampleRate) {
+        std::unique_ptr<ResamplerType> rdyn(
+                static_cast<ResamplerType *>(
+                        android::AudioResampler::create(
+                                AUDIO_FORMAT_PCM_FLOAT,
+                                channels,
+                                outSampleRate,
+                                android::AudioResampler::DYN_HIGH_QUALITY)));
+        rdyn->setSampleRate(inSampleRate);
+        return rdyn;
+    };
+
+    auto stereo = createResampler(2 /* channels */, 44100, 48000);
+    auto multichannel = createResampler(6 /* channels */, 44100, 48000);
+    auto downsampler = createResampler(2 /* channels */, 96000, 48000);
+
+    EXPECT_EQ(stereo->getFilterCoefs(), multichannel->getFilterCoefs());
+    EXPECT_NE(stereo->getFilterCoefs(), downsampler->getFilterCoefs());
+
+    // the shared filter stays valid after one of its users is destroyed.
+    multichannel.reset();
+    auto stereo2 = createResampler(2 /* channels */, 44100, 48000);
+    EXPECT_EQ(stereo->getFilterCoefs(), stereo2->getFilterCoefs());
+
+    // a filter that no resampler uses is kept for the next one.
+    const void *downsamplerCoefs = downsampler->getFilterCoefs();
+    downsampler.reset();
+    downsampler = createResampler(2 /* channels */, 96000, 48000);
+    EXPECT_EQ(downsamplerCoefs, downsampler->getFilterCoefs());
+
+    const std::string dump = android::AudioResampler::dumpFilterCache();
+    EXPECT_NE(std::string::npos, dump.find("hits"));
+    EXPECT_NE(std::string::npos, dump.find("unused bytes"));
+}
+
+#if USE_SSE
+
+/*
+ * Compares the AVX2 kernel for one output frame against ProcessBase(),
+ * for fixed and interpolated phase, with random coefficients and samples.
+ * The int16_t kernel must be bit-exact, the float kernel sums in a different order.
+ * Integer coefficients are scaled like a designed filter so that neither kernel overflows.
+ */
+template <int CHANNELS, typename TC, typename TI, typename TO, typename TINTERP>
+void testProcessAVX2(TINTERP lerpP, TO tolerance) {
+    constexpr int kMaxHalfNumCoefs = 64;
+    // two phases (for interpolation) of each of the positive and negative coefficients.
+    alignas(32) TC coefs[4][kMaxHalfNumCoefs];
+    // the impulse is in the middle of the samples.
+    TI samples[CHANNELS * (2 * kMaxHalfNumCoefs + 1)];
+    const TI *impulse = samples + CHANNELS * kMaxHalfNumCoefs;
+
+    auto random = [](auto max) {
+        using T = decltype(max);
+        return static_cast<T>((static_cast<double>(rand()) / RAND_MAX * 2. - 1.) * max);
+    };
+    const TC coefMax = std::is_same_v<TC, float> ? 1. : 32767;
+    const TI sampleMax = std::is_same_v<TI, float> ? 1. : 32767;
+    const TO volumeLR[2] = {
+        static_cast<TO>(std::is_same_v<TO, float> ? 0.75 : 0x0c000000),
+        static_cast<TO>(std::is_same_v<TO, float> ? -0.5 : -0x08000000),
+    };
+
+    for (int halfNumCoefs = 8; halfNumCoefs <= kMaxHalfNumCoefs; halfNumCoefs += 8) {
+        for (auto &phase : coefs) {
+            for (auto &coef : phase) {
+                coef = random(coefMax);
+            }
+        }
+        if constexpr (!std::is_same_v<TC, float>) {
+            // Like a designed filter, keep the sum of the magnitudes of one phase within
+            // half of unity gain, with the largest taps next to the center. The interpolated
+            // phase is then within unity gain, so the int32_t accumulation of full scale
+            // samples cannot overflow, and the difference of two phases fits in TC.
+            for (int phase = 0; phase < 2; ++phase) {
+                double sum = 0;
+                for (TC *half : {coefs[phase], coefs[phase + 2]}) {
+                    for (int i = 0; i < halfNumCoefs; ++i) {
+                        half[i] = static_cast<TC>(half[i] * (1. - double(i) / halfNumCoefs));
+                        sum += std::abs(half[i]);
+                    }
+                }
+                const double scale = sum > coefMax / 2 ? coefMax / 2 / sum : 1.;
+                for (TC *half : {coefs[phase], coefs[phase + 2]}) {
+                    for (int i = 0; i < halfNumCoefs; ++i) {
+                        half[i] = static_cast<TC>(half[i] * scale);
+                    }
+                }
+            }
+        }
+        for (auto &sample : samples) {
+            sample = random(sampleMax);
+        }
+        for (bool fixed : {true, false}) {
+            TO expected[2] = {1, 2};
+            TO actual[2] = {1, 2};
+            if (fixed) {
+                android::ProcessBase<CHANNELS, 16, android::InterpNull>(expected,
+                        halfNumCoefs, coefs[0], coefs[2],
+                        impulse, impulse + CHANNELS, lerpP, volumeLR);
+                android::ProcessAVX2Intrinsic<CHANNELS, 16, true>(actual,
+                        halfNumCoefs, coefs[0], coefs[2],
+                        impulse, impulse + CHANNELS, volumeLR, lerpP, coefs[1], coefs[3]);
+            } else {
+                // ProcessBase() finds the next phase at an offset of halfNumCoefs.
+                TC baseP[2 * kMaxHalfNumCoefs];
+                TC baseN[2 * kMaxHalfNumCoefs];
+                std::copy(coefs[0], coefs[0] + halfNumCoefs, baseP);
+                std::copy(coefs[1], coefs[1] + halfNumCoefs, baseP + halfNumCoefs);
+                std::copy(coefs[2], coefs[2] + halfNumCoefs, baseN);
+                std::copy(coefs[3], coefs[3] + halfNumCoefs, baseN + halfNumCoefs);
+                android::ProcessBase<CHANNELS, 16, android::InterpCompute>(expected,
+                        halfNumCoefs, baseP, baseN,
+                        impulse, impulse + CHANNELS, lerpP, volumeLR);
+                android::ProcessAVX2Intrinsic<CHANNELS, 16, false>(actual,
+                        halfNumCoefs, coefs[0], coefs[2],
+                        impulse, impulse + CHANNELS, volumeLR, lerpP, coefs[1], coefs[3]);
+            }
+            for (int i = 0; i < 2; ++i) {
+                if (tolerance == 0) {
+                    EXPECT_EQ(expected[i], actual[i]) << "channels:" << CHANNELS
+                            << " halfNumCoefs:" << halfNumCoefs << " fixed:" << fixed;
+                } else {
+                    EXPECT_NEAR(expected[i], actual[i], tolerance) << "channels:" << CHANNELS
+                            << " halfNumCoefs:" << halfNumCoefs << " fixed:" << fixed;
+                }
+            }
+        }
+    }
+}
+
+TEST(audioflinger_resampler, avx2_integer_bitexact) {
+    if (!android::resamplerUseAVX2()) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    srand(42);
+    for (uint32_t lerpP : {0u, 1u, 0x1234u, 0x4000u, 0x7fffu}) {
+        testProcessAVX2<1, int16_t, int16_t, int32_t>(lerpP, 0 /* tolerance */);
+        testProcessAVX2<2, int16_t, int16_t, int32_t>(lerpP, 0 /* tolerance */);
+    }
+}
+
+TEST(audioflinger_resampler, avx2_float_tolerance) {
+    if (!android::resamplerUseAVX2()) {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    srand(42);
+    for (float lerpP : {0.f, 0.25f, 0.5f, 0.999f}) {
+        testProcessAVX2<1, float, float, float>(lerpP, 1e-4f /* tolerance */);
+        testProcessAVX2<2, float, float, float>(lerpP, 1e-4f /* tolerance */);
+    }
+}
+
+#endif // USE_SSE
+
+/*
+ * Compares the multichannel float Process() and ProcessL() specializations for one
+ * output frame against ProcessBase(), with random coefficients and samples.
+ */
+template <int CHANNELS>
+void testProcessMultichannel(float lerpP) {
+    constexpr int kMaxHalfNumCoefs = 64;
+    // the positive and negative coefficients, each followed by the next phase.
+    alignas(32) float coefsP[2 * kMaxHalfNumCoefs];
+    alignas(32) float coefsN[2 * kMaxHalfNumCoefs];
+    // the impulse is in the middle of the samples.
+    float samples[CHANNELS * (2 * kMaxHalfNumCoefs + 1)];
+    const float *impulse = samples + CHANNELS * kMaxHalfNumCoefs;
+    const float volumeLR[2] = {0.75f, 0.25f};
+
+    auto random = []() { return static_cast<float>(rand()) / RAND_MAX * 2.f - 1.f; };
+    for (int halfNumCoefs = 8; halfNumCoefs <= kMaxHalfNumCoefs; halfNumCoefs += 8) {
+        std::generate(std::begin(coefsP), std::end(coefsP), random);
+        std::generate(std::begin(coefsN), std::end(coefsN), random);
+        std::generate(std::begin(samples), std::end(samples), random);
+
+        for (bool fixed : {true, false}) {
+            float expected[CHANNELS];
+            float actual[CHANNELS];
+            for (int i = 0; i < CHANNELS; ++i) {
+                expected[i] = actual[i] = i;
+            }
+            if (fixed) {
+                android::ProcessBase<CHANNELS, 16, android::InterpNull>(expected,
+                        halfNumCoefs, coefsP, coefsN,
+                        impulse, impulse + CHANNELS, lerpP, volumeLR);
+                android::ProcessL<CHANNELS, 16>(actual,
+                        halfNumCoefs, coefsP, coefsN,
+                        impulse, impulse + CHANNELS, volumeLR);
+            } else {
+                android::ProcessBase<CHANNELS, 16, android::InterpCompute>(expected,
+                        halfNumCoefs, coefsP, coefsN,
+                        impulse, impulse + CHANNELS, lerpP, volumeLR);
+                android::Process<CHANNELS, 16>(actual,
+                        halfNumCoefs, coefsP, coefsN,
+                        coefsP + halfNumCoefs, coefsN + halfNumCoefs,
+                        impulse, impulse + CHANNELS, lerpP, volumeLR);
+            }
+            for (int i = 0; i < CHANNELS; ++i) {
+                EXPECT_NEAR(expected[i], actual[i], 1e-4f) << "channels:" << CHANNELS
+                        << " channel:" << i
+                        << " halfNumCoefs:" << halfNumCoefs << " fixed:" << fixed;
+            }
+        }
+    }
+}
+
+TEST(audioflinger_resampler, multichannel_float_tolerance) {
+    srand(42);
+    for (float lerpP : {0.f, 0.25f, 0.5f, 0.999f}) {
+        testProcessMultichannel<4>(lerpP);
+        testProcessMultichannel<6>(lerpP);
+        testProcessMultichannel<8>(lerpP);
+    }
+}
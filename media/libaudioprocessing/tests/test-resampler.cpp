@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
+#include <algorithm>
 #include <memory>
 #include <string.h>
 #include <sys/mman.h>
@@ -38,14 +39,16 @@ using namespace android;
 static bool gVerbose = false;
 
 static int usage(const char* name) {
-    fprintf(stderr,"Usage: %s [-p] [-f] [-F] [-v] [-c channels]"
+    fprintf(stderr,"Usage: %s [-p] [-f] [-F] [-b] [-v] [-c channels]"
                    " [-q {dq|lq|mq|hq|vhq|dlq|dmq|dhq}]"
                    " [-i input-sample-rate] [-o output-sample-rate]"
                    " [-O csv] [-P csv] [<input-file>]"
                    " <output-file>\n", name);
     fprintf(stderr,"    -p    enable profiling\n");
     fprintf(stderr,"    -f    enable filter profiling\n");
-    fprintf(stderr,"    -F    enable floating point -q {dlq|dmq|dhq} only");
+    fprintf(stderr,"    -F    enable floating point -q {dlq|dmq|dhq} only\n");
+    fprintf(stderr,"    -b    benchmark 1, 2, 4, 6 and 8 channels -q {dlq|dmq|dhq} only,"
+                   " no files are used\n");
     fprintf(stderr,"    -v    verbose : log buffer provider calls\n");
     fprintf(stderr,"    -c    # channels (1-2 for lq|mq|hq; 1-8 for dlq|dmq|dhq)\n");
     fprintf(stderr,"    -q    resampler quality\n");
@@ -103,11 +106,98 @@ int parseCSV(const char *string, Vector<int>& values)
     }
 }
 
+// Provides the same input buffer over and over, for benchmarking.
+class RepeatingProvider : public AudioBufferProvider {
+public:
+    RepeatingProvider(const void* addr, size_t frames, size_t frameSize)
+        : mAddr(addr), mNumFrames(frames), mFrameSize(frameSize) {}
+
+    status_t getNextBuffer(Buffer* buffer) override {
+        const size_t offset = mNextFrame % mNumFrames;
+        buffer->frameCount = std::min(buffer->frameCount, mNumFrames - offset);
+        buffer->raw = (char *)mAddr + mFrameSize * offset;
+        return NO_ERROR;
+    }
+
+    void releaseBuffer(Buffer* buffer) override {
+        mNextFrame += buffer->frameCount;
+        buffer->frameCount = 0;
+        buffer->raw = NULL;
+    }
+
+private:
+    const void*  mAddr;
+    const size_t mNumFrames;
+    const size_t mFrameSize;
+    size_t       mNextFrame = 0;
+};
+
+// Profiles the dynamic resampler for the channel counts with (multichannel) SIMD kernels.
+static void benchmarkChannels(AudioResampler::src_quality quality, bool useFloat,
+        int input_freq, int output_freq) {
+    static constexpr int kChannels[] = {1, 2, 4, 6, 8};
+    static constexpr size_t kOutputFrames = 1 << 16;
+    const audio_format_t format = useFloat ? AUDIO_FORMAT_PCM_FLOAT : AUDIO_FORMAT_PCM_16_BIT;
+    const size_t sampleSize = useFloat ? sizeof(float) : sizeof(int16_t);
+    const size_t inputFrames = input_freq; // one second of input
+
+    for (int channels : kChannels) {
+        // a sine wave of a different level in each channel.
+        std::unique_ptr<char[]> input(new char[inputFrames * channels * sampleSize]);
+        for (size_t i = 0; i < inputFrames; ++i) {
+            const double y = sin(2. * M_PI * 1000. * i / input_freq);
+            for (int j = 0; j < channels; ++j) {
+                const double sample = y / (1 + j);
+                if (useFloat) {
+                    reinterpret_cast<float*>(input.get())[i * channels + j] = sample;
+                } else {
+                    reinterpret_cast<int16_t*>(input.get())[i * channels + j] =
+                            floor(sample * 32767. + 0.5);
+                }
+            }
+        }
+        RepeatingProvider provider(input.get(), inputFrames, channels * sampleSize);
+
+        const int outputChannels = channels > 2 ? channels : 2;
+        std::unique_ptr<int32_t[]> output(new int32_t[kOutputFrames * outputChannels]);
+        std::unique_ptr<AudioResampler> resampler(
+                AudioResampler::create(format, channels, output_freq, quality));
+        resampler->setSampleRate(input_freq);
+        resampler->setVolume(AudioResampler::UNITY_GAIN_FLOAT, AudioResampler::UNITY_GAIN_FLOAT);
+
+        // best of a few short trials, see the comments for -p.
+        const int trials = 4;
+        const int looplimit = 4;
+        int64_t time = 0;
+        for (int n = 0; n < trials; ++n) {
+            timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            for (int i = 0; i < looplimit; ++i) {
+                memset(output.get(), 0, kOutputFrames * outputChannels * sizeof(int32_t));
+                resampler->resample(output.get(), kOutputFrames, &provider);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            const int64_t start_ns = start.tv_sec * 1000000000LL + start.tv_nsec;
+            const int64_t end_ns = end.tv_sec * 1000000000LL + end.tv_nsec;
+            const int64_t diff_ns = end_ns - start_ns;
+            if (n == 0 || diff_ns < time) {
+                time = diff_ns;
+            }
+        }
+        // Mfrms/s is "Millions of output frames per second",
+        // Msmps/s is "Millions of output samples per second".
+        const double mfrms = kOutputFrames * looplimit / (time / 1e9) / 1e6;
+        printf("quality: %d  %s  channels: %d  Mfrms/s: %.2lf  Msmps/s: %.2lf\n",
+                quality, useFloat ? "float" : "int16", channels, mfrms, mfrms * channels);
+    }
+}
+
 int main(int argc, char* argv[]) {
     const char* const progname = argv[0];
     bool profileResample = false;
     bool profileFilter = false;
     bool useFloat = false;
+    bool benchmark = false;
     int channels = 1;
     int input_freq = 0;
     int output_freq = 0;
@@ -116,7 +206,7 @@ int main(int argc, char* argv[]) {
     Vector<int> Pvalues;
 
     int ch;
-    while ((ch = getopt(argc, argv, "pfFvc:q:i:o:O:P:")) != -1) {
+    while ((ch = getopt(argc, argv, "pfFbvc:q:i:o:O:P:")) != -1) {
         switch (ch) {
         case 'p':
             profileResample = true;
@@ -127,6 +217,9 @@ int main(int argc, char* argv[]) {
         case 'F':
             useFloat = true;
             break;
+        case 'b':
+            benchmark = true;
+            break;
         case 'v':
             gVerbose = true;
             break;
@@ -190,6 +283,16 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
+    if (benchmark) {
+        if (quality < AudioResampler::DYN_LOW_QUALITY) {
+            fprintf(stderr, "benchmarking is only possible for dynamic resamplers\n");
+            return -1;
+        }
+        benchmarkChannels(quality, useFloat,
+                input_freq > 0 ? input_freq : 44100, output_freq > 0 ? output_freq : 48000);
+        return EXIT_SUCCESS;
+    }
+
     argc -= optind;
     argv += optind;
 
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include <audio_utils/format.h>
+#include <benchmark/benchmark.h>
+#include <media/VolumeRamp.h>
+#include <system/audio.h>
+
+using namespace android;
+
+static constexpr size_t kFrameCount = 1920;  // 10 ms at 192 kHz
+
+static constexpr struct {
+    audio_format_t format;
+    const char *name;
+} kFormats[] = {
+    {AUDIO_FORMAT_PCM_16_BIT, "i16"},
+    {AUDIO_FORMAT_PCM_24_BIT_PACKED, "p24"},
+    {AUDIO_FORMAT_PCM_32_BIT, "i32"},
+    {AUDIO_FORMAT_PCM_FLOAT, "float"},
+};
+
+enum {
+    MODE_MEMCPY,    // copy of the period only, as a DirectOutputThread at unity volume
+    MODE_CONSTANT,  // copy and constant volume
+    MODE_RAMP,      // copy and a volume change every period
+};
+
+/*
+ * Replays DirectOutputThread::threadLoop_mix() for one period of a high resolution
+ * output: the track data is copied to the sink buffer, then the VolumeRamp applies
+ * the software volume in place.
+ */
+static void BM_VolumeRamp(benchmark::State& state) {
+    const audio_format_t format = kFormats[state.range(0)].format;
+    const auto channelCount = static_cast<uint32_t>(state.range(1));
+    const int mode = state.range(2);
+    const size_t frameSize = audio_bytes_per_frame(channelCount, format);
+
+    const size_t sampleCount = kFrameCount * channelCount;
+    std::vector<float> source(sampleCount);
+    for (size_t i = 0; i < sampleCount; i++) {
+        source[i] = sinf(i * 0.01f);
+    }
+    std::vector<uint8_t> track(kFrameCount * frameSize);
+    memcpy_by_audio_format(track.data(), format, source.data(), AUDIO_FORMAT_PCM_FLOAT,
+            sampleCount);
+    std::vector<uint8_t> sink(kFrameCount * frameSize);
+
+    VolumeRamp volumeRamp(format, channelCount);
+    if (volumeRamp.initCheck() != NO_ERROR) {
+        state.SkipWithError("unsupported configuration");
+        return;
+    }
+    volumeRamp.setVolume(0.5f, 0.25f);
+    volumeRamp.process(sink.data(), kFrameCount);
+
+    bool toggle = false;
+    for (auto _ : state) {
+        memcpy(sink.data(), track.data(), sink.size());
+        if (mode == MODE_RAMP) {
+            toggle = !toggle;
+            volumeRamp.setVolume(toggle ? 0.25f : 0.5f, 0.25f);
+        }
+        if (mode != MODE_MEMCPY) {
+            volumeRamp.process(sink.data(), kFrameCount);
+        }
+        benchmark::DoNotOptimize(sink.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * sink.size());
+    state.SetLabel(kFormats[state.range(0)].name);
+}
+
+static void VolumeRampArgs(benchmark::internal::Benchmark* b) {
+    for (size_t format = 0; format < std::size(kFormats); format++) {
+        for (int channelCount : {2, 6, 8}) {
+            for (int mode : {MODE_MEMCPY, MODE_CONSTANT, MODE_RAMP}) {
+                b->Args({(int64_t)format, channelCount, mode});
+            }
+        }
+    }
+    b->ArgNames({"format", "channels", "mode"});
+}
+
+BENCHMARK(BM_VolumeRamp)->Apply(VolumeRampArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "volumeramp_tests"
+#include <log/log.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <audio_utils/format.h>
+#include <gtest/gtest.h>
+#include <media/VolumeRamp.h>
+
+using namespace android;
+
+TEST(volumeramp_tests, unsupported) {
+    EXPECT_NE(NO_ERROR, VolumeRamp(AUDIO_FORMAT_PCM_8_BIT, 2).initCheck());
+    EXPECT_NE(NO_ERROR, VolumeRamp(AUDIO_FORMAT_PCM_FLOAT, 0).initCheck());
+    EXPECT_NE(NO_ERROR, VolumeRamp(AUDIO_FORMAT_PCM_FLOAT, 12).initCheck());
+    EXPECT_EQ(NO_ERROR, VolumeRamp(AUDIO_FORMAT_PCM_24_BIT_PACKED, 8).initCheck());
+}
+
+TEST(volumeramp_tests, unity) {
+    VolumeRamp volumeRamp(AUDIO_FORMAT_PCM_32_BIT, 2);
+    const std::vector<int32_t> in = {INT32_MAX, INT32_MIN, 1, -1};
+    std::vector<int32_t> out = in;
+    volumeRamp.process(out.data(), out.size() / 2);
+    EXPECT_EQ(in, out);  // bit exact
+}
+
+TEST(volumeramp_tests, ramp) {
+    constexpr size_t FRAME_COUNT = 100;
+    VolumeRamp volumeRamp(AUDIO_FORMAT_PCM_FLOAT, 2);
+    volumeRamp.setVolume(0.f, 0.5f);
+
+    // The first period ramps from unity, left decreasing to 0 and right to 0.5.
+    std::vector<float> buffer(FRAME_COUNT * 2, 1.f);
+    volumeRamp.process(buffer.data(), FRAME_COUNT);
+    EXPECT_FLOAT_EQ(1.f, buffer[0]);
+    EXPECT_FLOAT_EQ(1.f, buffer[1]);
+    for (size_t i = 1; i < FRAME_COUNT; ++i) {
+        EXPECT_LT(buffer[2 * i], buffer[2 * (i - 1)]);
+        EXPECT_LT(buffer[2 * i + 1], buffer[2 * (i - 1) + 1]);
+        EXPECT_GT(buffer[2 * i + 1], 0.5f);
+    }
+
+    // The next period is at the target volume.
+    std::fill(buffer.begin(), buffer.end(), 1.f);
+    volumeRamp.process(buffer.data(), FRAME_COUNT);
+    for (size_t i = 0; i < FRAME_COUNT; ++i) {
+        EXPECT_EQ(0.f, buffer[2 * i]);
+        EXPECT_EQ(0.5f, buffer[2 * i + 1]);
+    }
+}
+
+TEST(volumeramp_tests, formats) {
+    constexpr size_t CHANNEL_COUNT = 6;  // 5.1: front center and LFE take the center volume
+    constexpr float in[CHANNEL_COUNT] = {0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f};
+    constexpr float expected[CHANNEL_COUNT] = {0.25f, 0.125f, 0.1875f, 0.1875f, 0.25f, 0.125f};
+    for (audio_format_t format : {AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_24_BIT_PACKED,
+            AUDIO_FORMAT_PCM_32_BIT, AUDIO_FORMAT_PCM_FLOAT}) {
+        SCOPED_TRACE(format);
+        VolumeRamp volumeRamp(format, CHANNEL_COUNT);
+        ASSERT_EQ(NO_ERROR, volumeRamp.initCheck());
+        volumeRamp.setVolume(0.5f, 0.25f);
+        std::vector<uint8_t> buffer(audio_bytes_per_frame(CHANNEL_COUNT, format));
+        volumeRamp.process(buffer.data(), 1);  // ramp to the target on a silent frame
+
+        memcpy_by_audio_format(buffer.data(), format, in, AUDIO_FORMAT_PCM_FLOAT,
+                CHANNEL_COUNT);
+        volumeRamp.process(buffer.data(), 1);
+        float out[CHANNEL_COUNT];
+        memcpy_by_audio_format(out, AUDIO_FORMAT_PCM_FLOAT, buffer.data(), format,
+                CHANNEL_COUNT);
+        for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+            EXPECT_NEAR(expected[i], out[i], 1.f / (1 << 14));
+        }
+    }
+}
+
+TEST(volumeramp_tests, fixed_point_ramp) {
+    // The integer formats ramp in fixed point and track the float ramp.
+    constexpr size_t CHANNEL_COUNT = 2;
+    constexpr size_t FRAME_COUNT = 480;
+    for (audio_format_t format : {AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_24_BIT_PACKED,
+            AUDIO_FORMAT_PCM_32_BIT}) {
+        SCOPED_TRACE(format);
+        VolumeRamp volumeRamp(format, CHANNEL_COUNT);
+        VolumeRamp floatRamp(AUDIO_FORMAT_PCM_FLOAT, CHANNEL_COUNT);
+        std::vector<float> in(FRAME_COUNT * CHANNEL_COUNT, -0.75f);
+        std::vector<uint8_t> buffer(FRAME_COUNT * audio_bytes_per_frame(CHANNEL_COUNT, format));
+        std::vector<float> out(in.size());
+        for (float volume : {0.3f, 0.9f, 0.f}) {
+            volumeRamp.setVolume(volume, 1.f - volume);
+            floatRamp.setVolume(volume, 1.f - volume);
+            std::vector<float> expected = in;
+            floatRamp.process(expected.data(), FRAME_COUNT);
+            memcpy_by_audio_format(buffer.data(), format, in.data(), AUDIO_FORMAT_PCM_FLOAT,
+                    in.size());
+            volumeRamp.process(buffer.data(), FRAME_COUNT);
+            memcpy_by_audio_format(out.data(), AUDIO_FORMAT_PCM_FLOAT, buffer.data(), format,
+                    out.size());
+            for (size_t i = 0; i < out.size(); ++i) {
+                EXPECT_NEAR(expected[i], out[i], 1.f / (1 << 11));
+            }
+        }
+    }
+}
@@ -15,8 +15,11 @@
  */
 
 #include <array>
+#include <condition_variable>
 #include <dlfcn.h>
+#include <mutex>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include <benchmark/benchmark.h>
@@ -83,27 +86,14 @@ constexpr float kMaxAmplitude = 1.0f;
  * BM_SPATIALIZER/2/2    4267814 ns      4259567 ns          155
  *******************************************************************/
 
-static void BM_SPATIALIZER(benchmark::State& state) {
-    const size_t sampleRate = kSampleRates[state.range(0)];
-    const size_t durationMs = kDurations[state.range(1)];
-    const size_t frameCount = durationMs * sampleRate / 1000;
-    const size_t inputChannelCount = audio_channel_count_from_out_mask(kInputChMask);
-    const size_t outputChannelCount = audio_channel_count_from_out_mask(AUDIO_CHANNEL_OUT_STEREO);
-
-    // Initialize input buffer with deterministic pseudo-random values
-    std::minstd_rand gen(kInputChMask);
-    std::uniform_real_distribution<> dis(kMinAmplitude, kMaxAmplitude);
-    std::vector<float> input(frameCount * inputChannelCount);
-    for (auto& in : input) {
-        in = dis(gen);
-    }
-
+// Creates and enables a spatializer, returns nullptr on error.
+static effect_handle_t createSpatializer(size_t sampleRate) {
     effect_handle_t effectHandle = nullptr;
     if (int status = AUDIO_EFFECT_LIBRARY_INFO_SYM.create_effect(&kEffectUuid, 1 /* sessionId */,
                                                                  1 /* ioId */, &effectHandle);
         status != 0) {
         ALOGE("create_effect returned an error = %d\n", status);
-        return;
+        return nullptr;
     }
 
     effect_config_t config{};
@@ -119,7 +109,8 @@ static void BM_SPATIALIZER(benchmark::State& state) {
                                        &config, &replySize, &reply);
         status != 0) {
         ALOGE("command returned an error = %d\n", status);
-        return;
+        AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(effectHandle);
+        return nullptr;
     }
 
     if (int status = (*effectHandle)
@@ -127,6 +118,29 @@ static void BM_SPATIALIZER(benchmark::State& state) {
                                        &config, &replySize, &reply);
         status != 0) {
         ALOGE("command returned an error = %d\n", status);
+        AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(effectHandle);
+        return nullptr;
+    }
+    return effectHandle;
+}
+
+static void BM_SPATIALIZER(benchmark::State& state) {
+    const size_t sampleRate = kSampleRates[state.range(0)];
+    const size_t durationMs = kDurations[state.range(1)];
+    const size_t frameCount = durationMs * sampleRate / 1000;
+    const size_t inputChannelCount = audio_channel_count_from_out_mask(kInputChMask);
+    const size_t outputChannelCount = audio_channel_count_from_out_mask(AUDIO_CHANNEL_OUT_STEREO);
+
+    // Initialize input buffer with deterministic pseudo-random values
+    std::minstd_rand gen(kInputChMask);
+    std::uniform_real_distribution<> dis(kMinAmplitude, kMaxAmplitude);
+    std::vector<float> input(frameCount * inputChannelCount);
+    for (auto& in : input) {
+        in = dis(gen);
+    }
+
+    effect_handle_t effectHandle = createSpatializer(sampleRate);
+    if (effectHandle == nullptr) {
         return;
     }
 
@@ -161,4 +175,132 @@ static void SPATIALIZERArgs(benchmark::internal::Benchmark* b) {
 
 BENCHMARK(BM_SPATIALIZER)->Apply(SPATIALIZERArgs);
 
+// number of spatialized tracks mixed before the spatializer
+constexpr size_t kMixedTrackCount = 4;
+
+/*
+ * Replays a SpatializerThread period at 48 kHz: mixing kMixedTrackCount 5.1 tracks, then
+ * spatializing the mix. With pipelined=1, the spatializer processes the previous period on
+ * a second thread while the current period is mixed, as in the SpatializerThread pipelined
+ * mode, and the mix and spatializer buffers are exchanged once both are done.
+ * The first parameter is the duration in ms, as for BM_SPATIALIZER.
+ * Real time is measured as the stages run on two threads in pipelined mode.
+ */
+static void BM_SPATIALIZER_PIPELINE(benchmark::State& state) {
+    const size_t sampleRate = kSampleRates[1];
+    const size_t durationMs = kDurations[state.range(0)];
+    const bool pipelined = state.range(1) != 0;
+    const size_t frameCount = durationMs * sampleRate / 1000;
+    const size_t inputChannelCount = audio_channel_count_from_out_mask(kInputChMask);
+    const size_t outputChannelCount = audio_channel_count_from_out_mask(AUDIO_CHANNEL_OUT_STEREO);
+
+    std::minstd_rand gen(kInputChMask);
+    std::uniform_real_distribution<> dis(kMinAmplitude, kMaxAmplitude);
+    std::vector<std::vector<float>> tracks(kMixedTrackCount,
+                                           std::vector<float>(frameCount * inputChannelCount));
+    for (auto& track : tracks) {
+        for (auto& in : track) {
+            in = dis(gen);
+        }
+    }
+
+    effect_handle_t effectHandle = createSpatializer(sampleRate);
+    if (effectHandle == nullptr) {
+        return;
+    }
+
+    std::vector<float> mix(frameCount * inputChannelCount);
+    std::vector<float> output(frameCount * outputChannelCount);
+    // buffers of the period processed by the spatializer in pipelined mode
+    std::vector<float> pipelineInput(frameCount * inputChannelCount);
+    std::vector<float> pipelineOutput(frameCount * outputChannelCount);
+
+    const auto mixTracks = [&]() {
+        std::fill(mix.begin(), mix.end(), 0.f);
+        for (const auto& track : tracks) {
+            for (size_t i = 0; i < mix.size(); i++) {
+                mix[i] += track[i] * 0.5f;
+            }
+        }
+    };
+    const auto spatialize = [&](std::vector<float>& in, std::vector<float>& out) {
+        audio_buffer_t inBuffer = {.frameCount = frameCount, .f32 = in.data()};
+        audio_buffer_t outBuffer = {.frameCount = frameCount, .f32 = out.data()};
+        (*effectHandle)->process(effectHandle, &inBuffer, &outBuffer);
+    };
+
+    std::mutex lock;
+    std::condition_variable cv;
+    bool processing = false;  // guarded by lock
+    bool exiting = false;     // guarded by lock
+    std::thread processThread;
+    if (pipelined) {
+        processThread = std::thread([&]() {
+            std::unique_lock l(lock);
+            while (true) {
+                cv.wait(l, [&]() { return processing || exiting; });
+                if (exiting) {
+                    break;
+                }
+                l.unlock();
+                spatialize(pipelineInput, pipelineOutput);
+                l.lock();
+                processing = false;
+                cv.notify_all();
+            }
+        });
+    }
+
+    // Run the test
+    for (auto _ : state) {
+        if (pipelined) {
+            {
+                std::lock_guard l(lock);
+                processing = true;
+            }
+            cv.notify_all();
+            mixTracks();
+            {
+                std::unique_lock l(lock);
+                cv.wait(l, [&]() { return !processing; });
+            }
+            std::copy(pipelineOutput.begin(), pipelineOutput.end(), output.begin());
+            std::copy(mix.begin(), mix.end(), pipelineInput.begin());
+        } else {
+            mixTracks();
+            spatialize(mix, output);
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+
+    if (pipelined) {
+        {
+            std::lock_guard l(lock);
+            exiting = true;
+        }
+        cv.notify_all();
+        processThread.join();
+    }
+
+    state.SetItemsProcessed(state.iterations() * frameCount);
+    state.SetLabel(pipelined ? "pipelined" : "serial");
+
+    if (int status = AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(effectHandle); status != 0) {
+        ALOGE("release_effect returned an error = %d\n", status);
+        return;
+    }
+}
+
+static void SPATIALIZERPipelineArgs(benchmark::internal::Benchmark* b) {
+    for (int j = 0; j < kNumDurations; ++j) {
+        for (int pipelined : {0, 1}) {
+            b->Args({j, pipelined});
+        }
+    }
+    b->ArgNames({"duration", "pipelined"});
+}
+
+BENCHMARK(BM_SPATIALIZER_PIPELINE)->Apply(SPATIALIZERPipelineArgs)->UseRealTime();
+
 BENCHMARK_MAIN();
@@ -17,12 +17,16 @@
 #define LOG_TAG "mediametrics::Item"
 
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <set>
+#include <thread>
 #include <unordered_map>
 
 #include <binder/Parcel.h>
@@ -37,6 +41,7 @@
 #include <android/media/IMediaMetricsService.h>
 #include <binder/IServiceManager.h>
 #include <media/MediaMetricsItem.h>
+#include <media/MediaMetricsRecordRing.h>
 #include <private/android_filesystem_config.h>
 
 // Max per-property string size before truncation in toString().
@@ -142,7 +147,11 @@ int64_t mediametrics::Item::getPkgVersionCode() const {
 size_t mediametrics::Item::filter(size_t n, const char *attrs[]) {
     size_t zapped = 0;
     for (size_t i = 0; i < n; ++i) {
-        zapped += mProps.erase(attrs[i]);
+        const auto it = lowerBoundProp(attrs[i]);
+        if (it != mProps.end() && it->isNamed(attrs[i])) {
+            mProps.erase(it);
+            ++zapped;
+        }
     }
     return zapped;
 }
@@ -151,15 +160,11 @@ size_t mediametrics::Item::filter(size_t n, const char *attrs[]) {
 // return value is # keys removed
 size_t mediametrics::Item::filterNot(size_t n, const char *attrs[]) {
     std::set<std::string> check(attrs, attrs + n);
-    size_t zapped = 0;
-    for (auto it = mProps.begin(); it != mProps.end();) {
-        if (check.find(it->first) != check.end()) {
-            ++it;
-        } else {
-           it = mProps.erase(it);
-           ++zapped;
-        }
-    }
+    const auto it = std::remove_if(mProps.begin(), mProps.end(), [&check](const Prop& prop) {
+        return check.find(prop.getName()) == check.end();
+    });
+    const size_t zapped = mProps.end() - it;
+    mProps.erase(it, mProps.end());
     return zapped;
 }
 
@@ -197,11 +202,13 @@ status_t mediametrics::Item::readFromParcel0(const Parcel& data) {
     if (count < 0) return BAD_VALUE;
     mPkgVersionCode = version;
     mTimestamp = timestamp;
+    // Each prop takes at least 4 bytes, don't trust count for the reservation.
+    mProps.reserve(std::min((size_t)count, data.dataAvail() / sizeof(int32_t)));
     for (int i = 0; i < count; i++) {
         Prop prop;
         status_t status = prop.readFromParcel(data);
         if (status != NO_ERROR) return status;
-        mProps[prop.getName()] = std::move(prop);
+        insertProp(std::move(prop));
     }
     return NO_ERROR;
 }
@@ -382,6 +389,90 @@ void BaseItem::dropInstance() {
     sMediaMetricsService = nullptr;
 }
 
+// Sends buffer to the service in a one-way transaction of method code.
+static status_t transactBuffer(const sp<media::IMediaMetricsService>& svc, uint32_t code,
+        const char *buffer, size_t size) {
+    // Use the Binder calling interface - this direct implementation avoids
+    // malloc/copy/free for the vector and reduces the overhead for logging.
+    // We based this off of the AIDL generated file:
+    // out/soong/.intermediates/frameworks/av/media/libmediametrics/mediametricsservice-aidl-unstable-cpp-source/gen/android/media/IMediaMetricsService.cpp
+    // TODO: Create an AIDL C++ back end optimized form of vector writing.
+    ::android::Parcel _aidl_data;
+    ::android::Parcel _aidl_reply; // we don't care about this as it is one-way.
+
+    ::android::status_t status = _aidl_data.writeInterfaceToken(svc->getInterfaceDescriptor());
+    if (status != ::android::OK) return status;
+
+    status = _aidl_data.writeInt32(static_cast<int32_t>(size));
+    if (status != ::android::OK) return status;
+
+    status = _aidl_data.write(buffer, static_cast<int32_t>(size));
+    if (status != ::android::OK) return status;
+
+    // AIDL permits setting a default implementation for additional functionality.
+    // See go/aog/713984. This is not used here.
+    return ::android::IInterface::asBinder(svc)->transact(
+            code, _aidl_data, &_aidl_reply, ::android::IBinder::FLAG_ONEWAY);
+}
+
+// Records larger than kBatchRecordSize are not batched; Items logged by
+// AudioFlinger and the media framework are typically a few hundred bytes.
+static constexpr size_t kBatchRecordSize = 1024;
+static constexpr size_t kBatchRecordCount = 128;
+using BatchRing = RecordRing<kBatchRecordSize, kBatchRecordCount>;
+
+// Set once by enableBatching(), and never freed as the batching thread runs
+// until the process exits.
+static std::atomic<BatchRing *> sBatchRing{};
+
+// Queues buffer in the batch ring, returns false if it should be sent directly.
+static bool appendToBatch(const char *buffer, size_t size) {
+    BatchRing * const ring = sBatchRing.load(std::memory_order_acquire);
+    if (ring == nullptr || size > kBatchRecordSize) return false;
+
+    // The service stamps a zero timestamp on arrival, which may be up to a batch
+    // period late; stamp it here instead.
+    char record[kBatchRecordSize];
+    memcpy(record, buffer, size);
+    uint32_t headerLen;
+    int64_t timestamp;
+    if (size >= 2 * sizeof(uint32_t)) {
+        memcpy(&headerLen, record + sizeof(uint32_t), sizeof(headerLen));
+        if (headerLen >= 2 * sizeof(uint32_t) + sizeof(timestamp) && headerLen <= size) {
+            char * const timestampPtr = record + headerLen - sizeof(timestamp);
+            memcpy(&timestamp, timestampPtr, sizeof(timestamp));
+            if (timestamp == 0) {
+                timestamp = systemTime(SYSTEM_TIME_REALTIME);
+                memcpy(timestampPtr, &timestamp, sizeof(timestamp));
+            }
+        }
+    }
+    return ring->append(record, size);
+}
+
+// static
+void BaseItem::enableBatching(int32_t periodMs) {
+    if (periodMs <= 0 || !isEnabled()) return;
+    static std::once_flag once;
+    std::call_once(once, [periodMs] {
+        BatchRing * const ring = new BatchRing();
+        std::thread([ring, periodMs] {
+            pthread_setname_np(pthread_self(), "MetricsBatch");
+            std::vector<char> buffers;
+            buffers.reserve(kBatchRecordSize * kBatchRecordCount);
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(periodMs));
+                buffers.clear();
+                if (ring->drain(&buffers) > 0) {
+                    (void)submitBuffers(buffers.data(), buffers.size());
+                }
+            }
+        }).detach();
+        sBatchRing.store(ring, std::memory_order_release);
+        ALOGD("%s: sending items every %d ms", __func__, periodMs);
+    });
+}
+
 // static
 status_t BaseItem::submitBuffer(const char *buffer, size_t size) {
     ALOGD_IF(DEBUG_API, "%s: delivering %zu bytes", __func__, size);
@@ -389,6 +480,8 @@ status_t BaseItem::submitBuffer(const char *buffer, size_t size) {
     // Validate size
     if (size > std::numeric_limits<int32_t>::max()) return BAD_VALUE;
 
+    if (appendToBatch(buffer, size)) return NO_ERROR;
+
     // Do we have the service available?
     sp<media::IMediaMetricsService> svc = getService();
     if (svc == nullptr)  return NO_INIT;
@@ -397,47 +490,45 @@ status_t BaseItem::submitBuffer(const char *buffer, size_t size) {
     if constexpr (/* DISABLES CODE */ (false)) {
         // THIS PATH IS FOR REFERENCE ONLY.
         // It is compiled so that any changes to IMediaMetricsService::submitBuffer()
-        // will lead here.  If this code is changed, the else branch must
-        // be changed as well.
+        // will lead here.  If this code is changed, transactBuffer()
+        // must be changed as well.
         //
         // Use the AIDL calling interface - this is a bit slower as a byte vector must be
         // constructed. As the call is one-way, the only a transaction error occurs.
         status = svc->submitBuffer({buffer, buffer + size}).transactionError();
     } else {
-        // Use the Binder calling interface - this direct implementation avoids
-        // malloc/copy/free for the vector and reduces the overhead for logging.
-        // We based this off of the AIDL generated file:
-        // out/soong/.intermediates/frameworks/av/media/libmediametrics/mediametricsservice-aidl-unstable-cpp-source/gen/android/media/IMediaMetricsService.cpp
-        // TODO: Create an AIDL C++ back end optimized form of vector writing.
-        ::android::Parcel _aidl_data;
-        ::android::Parcel _aidl_reply; // we don't care about this as it is one-way.
+        status = transactBuffer(svc,
+                ::android::media::BnMediaMetricsService::TRANSACTION_submitBuffer,
+                buffer, size);
+    }
+
+    if (status == NO_ERROR) return NO_ERROR;
 
-        status = _aidl_data.writeInterfaceToken(svc->getInterfaceDescriptor());
-        if (status != ::android::OK) goto _aidl_error;
+    ALOGW("%s: failed(%d) to record: %zu bytes", __func__, status, size);
+    return status;
+}
 
-        status = _aidl_data.writeInt32(static_cast<int32_t>(size));
-        if (status != ::android::OK) goto _aidl_error;
+// static
+status_t BaseItem::submitBuffers(const char *buffers, size_t size) {
+    ALOGD_IF(DEBUG_API, "%s: delivering %zu bytes", __func__, size);
 
-        status = _aidl_data.write(buffer, static_cast<int32_t>(size));
-        if (status != ::android::OK) goto _aidl_error;
+    if (size > std::numeric_limits<int32_t>::max()) return BAD_VALUE;
 
-        status = ::android::IInterface::asBinder(svc)->transact(
-                ::android::media::BnMediaMetricsService::TRANSACTION_submitBuffer,
-                _aidl_data, &_aidl_reply, ::android::IBinder::FLAG_ONEWAY);
+    sp<media::IMediaMetricsService> svc = getService();
+    if (svc == nullptr)  return NO_INIT;
 
-        // AIDL permits setting a default implementation for additional functionality.
-        // See go/aog/713984. This is not used here.
-        // if (status == ::android::UNKNOWN_TRANSACTION
-        //         && ::android::media::IMediaMetricsService::getDefaultImpl()) {
-        //     status = ::android::media::IMediaMetricsService::getDefaultImpl()
-        //             ->submitBuffer(immutableByteVectorFromBuffer(buffer, size))
-        //             .transactionError();
-        // }
+    ::android::status_t status = NO_ERROR;
+    if constexpr (/* DISABLES CODE */ (false)) {
+        // THIS PATH IS FOR REFERENCE ONLY, as in submitBuffer().
+        status = svc->submitBuffers({buffers, buffers + size}).transactionError();
+    } else {
+        status = transactBuffer(svc,
+                ::android::media::BnMediaMetricsService::TRANSACTION_submitBuffers,
+                buffers, size);
     }
 
     if (status == NO_ERROR) return NO_ERROR;
 
-    _aidl_error:
     ALOGW("%s: failed(%d) to record: %zu bytes", __func__, status, size);
     return status;
 }
@@ -608,17 +699,33 @@ status_t mediametrics::Item::readFromByteString(const char *bufferptr, size_t le
     mPid = pid;
     mUid = uid;
     mTimestamp = timestamp;
+    // Each prop takes at least 4 bytes, don't trust propCount for the reservation.
+    mProps.reserve(std::min((size_t)propCount, (size_t)(readend - read) / sizeof(uint32_t)));
     for (size_t i = 0; i < propCount; ++i) {
         Prop prop;
         if (prop.readFromByteString(&read, readend) != NO_ERROR) {
             ALOGW("%s: cannot read prop %zu", __func__, i);
             return INVALID_OPERATION;
         }
-        mProps[prop.getName()] = std::move(prop);
+        insertProp(std::move(prop));
     }
     return NO_ERROR;
 }
 
+void mediametrics::Item::insertProp(Prop&& prop) {
+    // Props are serialized in name order, so they are normally appended.
+    if (mProps.empty() || strcmp(mProps.back().getName(), prop.getName()) < 0) {
+        mProps.push_back(std::move(prop));
+        return;
+    }
+    auto it = mProps.begin() + (lowerBoundProp(prop.getName()) - mProps.cbegin());
+    if (it != mProps.end() && it->isNamed(prop.getName())) {
+        *it = std::move(prop);
+    } else {
+        mProps.insert(it, std::move(prop));
+    }
+}
+
 status_t mediametrics::Item::Prop::readFromParcel(const Parcel& data)
 {
     const char *key = data.readCString();
@@ -226,6 +226,7 @@
 #define AMEDIAMETRICS_PROP_VOICEVOLUME    "voiceVolume"    // double (audio.flinger)
 #define AMEDIAMETRICS_PROP_VOLUME_LEFT    "volume.left"    // double (AudioTrack)
 #define AMEDIAMETRICS_PROP_VOLUME_RIGHT   "volume.right"   // double (AudioTrack)
+#define AMEDIAMETRICS_PROP_WAKEUPJITTERMS "wakeupJitterMs" // double - avg wakeup lateness
 #define AMEDIAMETRICS_PROP_WHERE          "where"          // string value
 // EncodingClient is the encoding format requested by the client
 #define AMEDIAMETRICS_PROP_ENCODINGCLIENT "encodingClient" // string
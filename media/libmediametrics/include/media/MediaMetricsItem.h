@@ -23,8 +23,10 @@
 #include <algorithm>
 #include <map>
 #include <string>
+#include <string.h>
 #include <sys/types.h>
 #include <variant>
+#include <vector>
 
 #include <binder/Parcel.h>
 #include <log/log.h>
@@ -275,6 +277,16 @@ public:
     static sp<media::IMediaMetricsService> getService();
     // submits a raw buffer directly to the MediaMetrics service - this is highly optimized.
     static status_t submitBuffer(const char *buffer, size_t len);
+    // submits concatenated raw buffers to the MediaMetrics service in one transaction.
+    static status_t submitBuffers(const char *buffers, size_t len);
+
+    /*
+     * Queues the buffers given to submitBuffer() in a per-process ring instead of
+     * sending each in its own transaction; a thread sends the queued buffers
+     * with submitBuffers() every periodMs. Buffers that do not fit in the ring
+     * are sent directly. Batching cannot be disabled once enabled.
+     */
+    static void enableBatching(int32_t periodMs);
 
 protected:
     static constexpr const char * const EnabledProperty = "media.metrics.enabled";
@@ -886,7 +898,7 @@ public:
     // Iteration of props within item
     class iterator {
     public:
-        explicit iterator(const std::map<std::string, Prop>::const_iterator &_it) : it(_it) { }
+        explicit iterator(const std::vector<Prop>::const_iterator &_it) : it(_it) { }
         iterator &operator++() {
             ++it;
             return *this;
@@ -895,11 +907,11 @@ public:
             return it != other.it;
         }
         const Prop &operator*() const {
-            return it->second;
+            return *it;
         }
 
     private:
-        std::map<std::string, Prop>::const_iterator it;
+        std::vector<Prop>::const_iterator it;
     };
 
     iterator begin() const {
@@ -1188,19 +1200,30 @@ private:
     int32_t writeToParcel0(Parcel *) const;
     int32_t readFromParcel0(const Parcel&);
 
+    // mProps is sorted by name, so iteration order is the same as a std::map.
+    std::vector<Prop>::const_iterator lowerBoundProp(const char *key) const {
+        return std::lower_bound(mProps.begin(), mProps.end(), key,
+                [](const Prop& prop, const char *name) {
+                    return strcmp(prop.getName(), name) < 0;
+                });
+    }
+
     const Prop *findProp(const char *key) const {
-        auto it = mProps.find(key);
-        return it != mProps.end() ? &it->second : nullptr;
+        auto it = lowerBoundProp(key);
+        return it != mProps.end() && it->isNamed(key) ? &*it : nullptr;
     }
 
     Prop &findOrAllocateProp(const char *key) {
-        auto it = mProps.find(key);
-        if (it != mProps.end()) return it->second;
-        Prop &prop = mProps[key];
-        prop.setName(key);
-        return prop;
+        auto it = mProps.begin() + (lowerBoundProp(key) - mProps.cbegin());
+        if (it != mProps.end() && it->isNamed(key)) return *it;
+        it = mProps.emplace(it);
+        it->setName(key);
+        return *it;
     }
 
+    // Adds a prop read from a Parcel or a byte string, replacing any prop with the same name.
+    void insertProp(Prop&& prop);
+
     // Changes to member variables below require changes to clear().
     pid_t         mPid = -1;
     uid_t         mUid = -1;
@@ -1208,7 +1231,9 @@ private:
     int64_t       mPkgVersionCode = 0;
     std::string   mKey;
     nsecs_t       mTimestamp = 0;
-    std::map<std::string, Prop> mProps;
+    // A sorted vector rather than a std::map: an item holds few props and is mostly read,
+    // so this saves a node allocation and a copy of the name per prop.
+    std::vector<Prop> mProps;
 };
 
 } // namespace mediametrics
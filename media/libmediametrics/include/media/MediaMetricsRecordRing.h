@@ -0,0 +1,127 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_MEDIA_MEDIAMETRICSRECORDRING_H
+#define ANDROID_MEDIA_MEDIAMETRICSRECORDRING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace android::mediametrics {
+
+/**
+ * RecordRing is a bounded ring of fixed size records, used to batch the
+ * Item byte strings of a process before they are sent to the service.
+ *
+ * append() may be called concurrently from any number of threads. It does not
+ * lock or allocate, so it may be called from a thread that must not block.
+ * drain() must be called from a single thread at a time.
+ *
+ * Each slot carries a sequence number, which tells an appending thread that the slot
+ * has been drained and the draining thread that the slot has been written
+ * (bounded MPMC queue, D. Vyukov).
+ */
+template <size_t RECORD_SIZE, size_t RECORD_COUNT>
+class RecordRing {
+    static_assert(RECORD_COUNT > 0 && (RECORD_COUNT & (RECORD_COUNT - 1)) == 0,
+            "RECORD_COUNT must be a power of 2");
+
+public:
+    static constexpr size_t kRecordSize = RECORD_SIZE;
+    static constexpr size_t kRecordCount = RECORD_COUNT;
+
+    RecordRing() {
+        for (size_t i = 0; i < RECORD_COUNT; ++i) {
+            mSlots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RecordRing(const RecordRing&) = delete;
+    RecordRing& operator=(const RecordRing&) = delete;
+
+    /**
+     * Copies a record into the ring.
+     *
+     * \return false if the record is larger than RECORD_SIZE or the ring is full,
+     *         in which case the caller should deliver the record by other means.
+     */
+    bool append(const char *record, size_t size) {
+        if (size > RECORD_SIZE) return false;
+        size_t position = mTail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = mSlots[position & (RECORD_COUNT - 1)];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+            if (diff == 0) {
+                if (mTail.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    memcpy(slot.data, record, size);
+                    slot.size = size;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+                // position was reloaded by compare_exchange_weak().
+            } else if (diff < 0) {
+                mOverflows.fetch_add(1, std::memory_order_relaxed);
+                return false; // full: the slot has not been drained yet.
+            } else {
+                position = mTail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Appends the records written so far to buffer, concatenated, and frees their slots.
+     * A record being written by a concurrent append() ends the drain.
+     *
+     * \return the number of records drained.
+     */
+    size_t drain(std::vector<char> *buffer) {
+        size_t count = 0;
+        for (;; ++count, ++mHead) {
+            Slot& slot = mSlots[mHead & (RECORD_COUNT - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != mHead + 1) break;
+            buffer->insert(buffer->end(), slot.data, slot.data + slot.size);
+            slot.sequence.store(mHead + RECORD_COUNT, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Number of records not appended because the ring was full.
+    int64_t getOverflowCount() const {
+        return mOverflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        size_t size = 0;
+        char data[RECORD_SIZE];
+    };
+
+    // mTail is written by the appending threads, mHead only by the draining thread.
+    alignas(64) std::atomic<size_t> mTail{0};
+    alignas(64) size_t mHead = 0;
+    std::atomic<int64_t> mOverflows{0};
+    Slot mSlots[RECORD_COUNT];
+};
+
+} // namespace android::mediametrics
+
+#endif // ANDROID_MEDIA_MEDIAMETRICSRECORDRING_H
@@ -17,10 +17,13 @@
 #define LOG_TAG "NBLog"
 //#define LOG_NDEBUG 0
 
+#include <algorithm>
+#include <functional>
 #include <memory>
-#include <queue>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 #include <vector>
 
 #include <audio_utils/fifo.h>
@@ -59,59 +62,103 @@ void Merger::addReader(const sp<Reader> &reader)
     mReaders.push_back(reader);
 }
 
-// items placed in priority queue during merge
-// composed by a timestamp and the index of the snapshot where the timestamp came from
-struct MergeItem
+static bool hasTimestamp(const EntryIterator &it)
 {
-    int64_t ts;
-    int index;
-    MergeItem(int64_t ts, int index): ts(ts), index(index) {}
-};
+    switch (it->type) {
+    case EVENT_FMT_START:
+    case EVENT_AUDIO_STATE:
+    case EVENT_HISTOGRAM_ENTRY_TS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* static */
+int64_t Merger::nextTimestamp(const Source &source)
+{
+    if (!hasTimestamp(source.next)) {
+        return source.lastTimestamp;
+    }
+    return AbstractEntry::buildEntry(source.next)->timestamp();
+}
 
-bool operator>(const struct MergeItem &i1, const struct MergeItem &i2)
+void Merger::mergeNext(int index, nsecs_t now)
 {
-    return i1.ts > i2.ts || (i1.ts == i2.ts && i1.index > i2.index);
+    Source &source = mSources[index];
+    // The MergeReader forgets the author when the merged FIFO overruns it, so the author
+    // entry is repeated every kAuthorPeriod entries even if the author did not change.
+    if (index != mLastAuthor || mEntriesSinceAuthor >= kAuthorPeriod) {
+        uint8_t authorEntry[Entry::kOverhead + sizeof(index)];
+        authorEntry[offsetof(entry, type)] = EVENT_MERGE_AUTHOR;
+        authorEntry[offsetof(entry, length)] =
+            authorEntry[sizeof(authorEntry) + Entry::kPreviousLengthOffset] = sizeof(index);
+        memcpy(&authorEntry[offsetof(entry, data)], &index, sizeof(index));
+        mFifoWriter->write(authorEntry, sizeof(authorEntry));
+        mLastAuthor = index;
+        mEntriesSinceAuthor = 0;
+    }
+    ++mEntriesSinceAuthor;
+    if (hasTimestamp(source.next)) {
+        std::unique_ptr<AbstractEntry> abstractEntry = AbstractEntry::buildEntry(source.next);
+        source.lastTimestamp = abstractEntry->timestamp();
+        source.next = abstractEntry->copyWithAuthor(mFifoWriter, index);
+        mPendingLagMs.push_back((now - source.lastTimestamp) * 1e-6);
+    } else {
+        source.next.copyTo(mFifoWriter);
+        ++source.next;
+    }
 }
 
 // Merge registered readers, sorted by timestamp, and write data to a single FIFO in local memory
 void Merger::merge()
 {
-    if (true) return; // Merging is not necessary at the moment, so this is to disable it
-                      // and bypass compiler warnings about member variables not being used.
+    const nsecs_t now = systemTime();
     const int nLogs = mReaders.size();
-    std::vector<std::unique_ptr<Snapshot>> snapshots(nLogs);
-    std::vector<EntryIterator> offsets;
-    offsets.reserve(nLogs);
+    if (mSources.size() < (size_t) nLogs) {
+        mSources.resize(nLogs);
+    }
+    // Only take a new snapshot of the readers whose entries have all been merged.
+    // Readers with pending entries are already in the heap.
     for (int i = 0; i < nLogs; ++i) {
-        snapshots[i] = mReaders[i]->getSnapshot();
-        offsets.push_back(snapshots[i]->begin());
+        Source &source = mSources[i];
+        if (source.pending()) {
+            continue;
+        }
+        source.snapshot = mReaders[i]->getSnapshot();
+        source.next = source.snapshot->begin();
+        if (source.pending()) {
+            mHeap.emplace_back(nextTimestamp(source), i);
+            std::push_heap(mHeap.begin(), mHeap.end(), std::greater<MergeItem>());
+        } else {
+            source.snapshot.reset();
+        }
     }
-    // initialize offsets
-    // TODO custom heap implementation could allow to update top, improving performance
-    // for bursty buffers
-    std::priority_queue<MergeItem, std::vector<MergeItem>, std::greater<MergeItem>> timestamps;
-    for (int i = 0; i < nLogs; ++i)
-    {
-        if (offsets[i] != snapshots[i]->end()) {
-            std::unique_ptr<AbstractEntry> abstractEntry = AbstractEntry::buildEntry(offsets[i]);
-            if (abstractEntry == nullptr) {
-                continue;
-            }
-            timestamps.emplace(abstractEntry->timestamp(), i);
+
+    // Entries that are not in a snapshot yet were logged after now - kMergeHoldNs,
+    // so everything before that can be merged in order.
+    const int64_t mergeUntil = now - kMergeHoldNs;
+    while (!mHeap.empty() && mHeap.front().ts <= mergeUntil) {
+        const int index = mHeap.front().index;
+        std::pop_heap(mHeap.begin(), mHeap.end(), std::greater<MergeItem>());
+        mergeNext(index, now);
+        Source &source = mSources[index];
+        if (source.pending()) {
+            mHeap.back().ts = nextTimestamp(source);
+            std::push_heap(mHeap.begin(), mHeap.end(), std::greater<MergeItem>());
+        } else {
+            mHeap.pop_back();
+            source.snapshot.reset();
         }
     }
 
-    while (!timestamps.empty()) {
-        int index = timestamps.top().index;     // find minimum timestamp
-        // copy it to the log, increasing offset
-        offsets[index] = AbstractEntry::buildEntry(offsets[index])->
-            copyWithAuthor(mFifoWriter, index);
-        // update data structures
-        timestamps.pop();
-        if (offsets[index] != snapshots[index]->end()) {
-            int64_t ts = AbstractEntry::buildEntry(offsets[index])->timestamp();
-            timestamps.emplace(ts, index);
+    if (!mPendingLagMs.empty()) {
+        AutoMutex _l(mLagLock);
+        for (const double lagMs : mPendingLagMs) {
+            mLagHist.add(lagMs);
         }
+        mMergedEntries += mPendingLagMs.size();
+        mPendingLagMs.clear();
     }
 }
 
@@ -121,20 +168,47 @@ const std::vector<sp<Reader>>& Merger::getReaders() const
     return mReaders;
 }
 
+void Merger::dump(int fd, int indent) const
+{
+    AutoMutex _l(mLagLock);
+    dprintf(fd, "%*sMerged entries: %lld\n", indent, "", (long long) mMergedEntries);
+    dprintf(fd, "%*sMerge lag (ms): %s\n", indent, "", mLagHist.toString().c_str());
+}
+
+void Merger::sendLagToMediaMetrics()
+{
+    AutoMutex _l(mLagLock);
+    (void)ReportPerformance::sendMergeLagToMediaMetrics(mLagHist);
+    mLagHist.clear();
+}
+
 // ---------------------------------------------------------------------------
 
 MergeReader::MergeReader(const void *shared, size_t size, Merger &merger)
-    : Reader(shared, size, "MergeReader"), mReaders(merger.getReaders())
+    : Reader(shared, size, "MergeReader"), mMerger(merger), mReaders(merger.getReaders())
 {
 }
 
 // Takes raw content of the local merger FIFO, processes log entries, and
 // writes the data to a map of class PerformanceAnalysis, based on their thread ID.
-void MergeReader::processSnapshot(Snapshot &snapshot, int author)
+void MergeReader::processSnapshot(Snapshot &snapshot)
 {
-    ReportPerformance::PerformanceData& data = mThreadPerformanceData[author];
+    if (snapshot.lost() > 0) {
+        // The author of the entries after the lost ones is unknown until the next
+        // EVENT_MERGE_AUTHOR.
+        mAuthor = -1;
+    }
     // We don't do "auto it" because it reduces readability in this case.
     for (EntryIterator it = snapshot.begin(); it != snapshot.end(); ++it) {
+        if (it->type == EVENT_MERGE_AUTHOR) {
+            mAuthor = it.payload<int>();
+            continue;
+        }
+        if (mAuthor < 0) {
+            continue;
+        }
+        const int author = mAuthor;
+        ReportPerformance::PerformanceData& data = mThreadPerformanceData[author];
         switch (it->type) {
         case EVENT_HISTOGRAM_ENTRY_TS: {
             const HistTsEntry payload = it.payload<HistTsEntry>();
@@ -197,18 +271,11 @@ void MergeReader::processSnapshot(Snapshot &snapshot, int author)
 
 void MergeReader::getAndProcessSnapshot()
 {
-    // get a snapshot of each reader and process them
-    // TODO insert lock here
-    const size_t nLogs = mReaders.size();
-    std::vector<std::unique_ptr<Snapshot>> snapshots(nLogs);
-    for (size_t i = 0; i < nLogs; i++) {
-        snapshots[i] = mReaders[i]->getSnapshot();
-    }
-    // TODO unlock lock here
-    for (size_t i = 0; i < nLogs; i++) {
-        if (snapshots[i] != nullptr) {
-            processSnapshot(*(snapshots[i]), i);
-        }
+    // The readers of each thread are consumed by the Merger,
+    // so process what it has merged since the last call.
+    std::unique_ptr<Snapshot> snapshot = getSnapshot();
+    if (snapshot != nullptr) {
+        processSnapshot(*snapshot);
     }
     checkPushToMediaMetrics();
 }
@@ -223,13 +290,17 @@ void MergeReader::checkPushToMediaMetrics()
             data.reset();   // data is persistent per thread
         }
     }
+    if (now - mLastLagPush >= kPeriodicMediaMetricsPush) {
+        mMerger.sendLagToMediaMetrics();
+        mLastLagPush = now;
+    }
 }
 
 void MergeReader::dump(int fd, const Vector<String16>& args)
 {
     // TODO: add a mutex around media.log dump
     // Options for dumpsys
-    bool pa = false, json = false, plots = false, retro = false;
+    bool pa = false, json = false, plots = false, retro = false, merge = false;
     for (const auto &arg : args) {
         if (arg == String16("--pa")) {
             pa = true;
@@ -239,6 +310,8 @@ void MergeReader::dump(int fd, const Vector<String16>& args)
             plots = true;
         } else if (arg == String16("--retro")) {
             retro = true;
+        } else if (arg == String16("--merge")) {
+            merge = true;
         }
     }
     if (pa) {
@@ -253,6 +326,9 @@ void MergeReader::dump(int fd, const Vector<String16>& args)
     if (retro) {
         ReportPerformance::dumpRetro(fd, mThreadPerformanceData);
     }
+    if (merge) {
+        mMerger.dump(fd);
+    }
 }
 
 void MergeReader::handleAuthor(const AbstractEntry &entry, String8 *body)
@@ -289,9 +365,14 @@ bool MergeThread::threadLoop()
     {
         AutoMutex _l(mMutex);
         // If mTimeoutUs is negative, wait on the condition variable until it's positive.
-        // If it's positive, merge. The minimum period between waking the condition variable
+        // If it's positive, merge every kThreadSleepPeriodUs until the timeout expires.
+        // The minimum period between waking the condition variable
         // is handled in AudioFlinger::MediaLogNotifier::threadLoop().
-        mCond.wait(mMutex);
+        if (mTimeoutUs > 0) {
+            mCond.waitRelative(mMutex, us2ns(kThreadSleepPeriodUs));
+        } else {
+            mCond.wait(mMutex);
+        }
         doMerge = mTimeoutUs > 0;
         mTimeoutUs -= kThreadSleepPeriodUs;
     }
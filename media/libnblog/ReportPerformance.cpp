@@ -210,6 +210,18 @@ bool sendToMediaMetrics(const PerformanceData& data)
     return false;
 }
 
+bool sendMergeLagToMediaMetrics(const Histogram& lagHist)
+{
+    static constexpr char kMergeLagHist[] = "android.media.nblog.mergeLagMs.hist";
+
+    if (lagHist.totalCount() == 0) {
+        return false;
+    }
+    std::unique_ptr<mediametrics::Item> item(mediametrics::Item::create("audio.nblog.merger"));
+    item->setCString(kMergeLagHist, lagHist.toString().c_str());
+    return item->selfrecord();
+}
+
 //------------------------------------------------------------------------------
 
 // TODO: use a function like this to extract logic from writeToFile
@@ -69,6 +69,10 @@ enum Event : uint8_t {
     EVENT_WORK_TIME,            // the time a thread takes to do work, e.g. read, write, etc.
     EVENT_THREAD_PARAMS,        // see thread_params_t below
 
+    // Types for merged logs
+    EVENT_MERGE_AUTHOR,         // author index (int) of the entries that follow it in a merged
+                                // log, written by Merger when the author changes
+
     EVENT_UPPER_BOUND,          // to check for invalid events
 };
 
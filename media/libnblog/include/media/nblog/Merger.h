@@ -45,6 +45,12 @@ struct Shared;
 
 // This class is used to read data from each thread's individual FIFO in shared memory
 // and write it to a single FIFO in local memory.
+//
+// The merge is incremental: a reader's FIFO is only read again once all the entries of its
+// previous snapshot have been merged, and the entries are merged with a heap keyed on the
+// timestamp of each reader's next entry, so each entry costs O(log(number of readers)).
+// Whenever the author changes, an EVENT_MERGE_AUTHOR entry is written to the merged FIFO
+// so that entries without an author field can be attributed to their thread.
 class Merger : public RefBase {
 public:
     Merger(const void *shared, size_t size);
@@ -53,12 +59,47 @@ public:
 
     void addReader(const sp<NBLog::Reader> &reader);
     // TODO add removeReader
+
+    // Merge the entries that are old enough to be in order. Newer entries are left
+    // for the next call.
     void merge();
 
     // FIXME This is returning a reference to a shared variable that needs a lock
     const std::vector<sp<Reader>>& getReaders() const;
 
+    // Dump the merge lag, i.e. the time between an entry being logged and merged.
+    void dump(int fd, int indent = 0) const;
+
+    // Send the merge lag to media metrics and clear it.
+    void sendLagToMediaMetrics();
+
 private:
+    // The snapshot of a reader and the next entry of it to merge.
+    struct Source {
+        std::unique_ptr<Snapshot> snapshot;
+        EntryIterator             next;
+        int64_t                   lastTimestamp = 0;  // timestamp of the last merged entry
+
+        bool pending() const { return snapshot != nullptr && next != snapshot->end(); }
+    };
+
+    // Timestamp of the next entry of a Source and the index of the Source.
+    struct MergeItem {
+        int64_t ts;
+        int index;
+        MergeItem(int64_t ts, int index): ts(ts), index(index) {}
+        bool operator>(const MergeItem &other) const {
+            return ts > other.ts || (ts == other.ts && index > other.index);
+        }
+    };
+
+    // Timestamp used to order the next entry of a source. Entries that have no timestamp
+    // are ordered right after the previous entry of the same source.
+    static int64_t nextTimestamp(const Source &source);
+
+    // Copy the next entry of mSources[index] to the merged FIFO.
+    void mergeNext(int index, nsecs_t now);
+
     // vector of the readers the merger is supposed to merge from.
     // every reader reads from a writer's buffer
     // FIXME Needs to be protected by a lock
@@ -67,6 +108,27 @@ private:
     Shared * const mShared; // raw pointer to shared memory
     std::unique_ptr<audio_utils_fifo> mFifo; // FIFO itself
     std::unique_ptr<audio_utils_fifo_writer> mFifoWriter; // used to write to FIFO
+
+    // Only accessed by the merging thread.
+    std::vector<Source>    mSources;          // same indices as mReaders
+    std::vector<MergeItem> mHeap;             // min-heap of the Sources with pending entries
+    int                    mLastAuthor = -1;  // author of the last entry in the merged FIFO
+    int                    mEntriesSinceAuthor = 0;  // entries merged since the author entry
+    std::vector<double>    mPendingLagMs;     // lag of the entries merged by the current call
+
+    // Entries logged less than this before merge() are held back for the next call,
+    // so that a writer which is still logging an older entry can catch up.
+    static constexpr nsecs_t kMergeHoldNs = 10 * 1000 * 1000; // 10 ms
+
+    // Maximum number of entries merged between two author entries. After an overrun,
+    // the MergeReader drops at most this many entries until it reads the author again.
+    static constexpr int kAuthorPeriod = 32;
+
+    static constexpr ReportPerformance::Histogram::Config kLagConfig = { 20., 25, 0.};
+
+    mutable Mutex                  mLagLock;
+    ReportPerformance::Histogram   mLagHist{kLagConfig};  // in ms, guarded by mLagLock
+    int64_t                        mMergedEntries = 0;    // guarded by mLagLock
 };
 
 // This class has a pointer to the FIFO in local memory which stores the merged
@@ -76,10 +138,11 @@ class MergeReader : public Reader {
 public:
     MergeReader(const void *shared, size_t size, Merger &merger);
 
-    // process a particular snapshot of the reader
-    void processSnapshot(Snapshot &snap, int author);
+    // process a snapshot of the merged buffer, where entries are attributed to the author
+    // of the last EVENT_MERGE_AUTHOR entry
+    void processSnapshot(Snapshot &snap);
 
-    // call getSnapshot of the content of the reader's buffer and process the data
+    // call getSnapshot of the content of the merged buffer and process the data
     void getAndProcessSnapshot();
 
     // check for periodic push of performance data to media metrics, and perform
@@ -89,11 +152,19 @@ public:
     void dump(int fd, const Vector<String16>& args);
 
 private:
+    Merger &mMerger;
+
     // FIXME Needs to be protected by a lock,
     //       because even though our use of it is read-only there may be asynchronous updates
     // The object is owned by the Merger class.
     const std::vector<sp<Reader>>& mReaders;
 
+    // author of the entries being processed, -1 until an EVENT_MERGE_AUTHOR is read
+    int mAuthor = -1;
+
+    // when the merge lag was last pushed to media metrics
+    nsecs_t mLastLagPush{systemTime()};
+
     // analyzes, compresses and stores the merged data
     // contains a separate instance for every author (thread), and for every source file
     // location within each author
@@ -112,8 +183,8 @@ private:
 };
 
 // MergeThread is a thread that contains a Merger. It works as a retriggerable one-shot:
-// when triggered, it awakes for a lapse of time, during which it periodically merges; if
-// retriggered, the timeout is reset.
+// when triggered, it awakes for a lapse of time, during which it merges every
+// kThreadSleepPeriodUs; if retriggered, the timeout is reset.
 // The thread is triggered on AudioFlinger binder activity.
 class MergeThread : public Thread {
 public:
@@ -145,7 +216,7 @@ private:
     int          mTimeoutUs;
 
     // merging period when the thread is awake
-    static const int  kThreadSleepPeriodUs = 1000000 /*1s*/;
+    static const int  kThreadSleepPeriodUs = 100000 /*100ms*/;
 
     // initial timeout value when triggered
     static const int  kThreadWakeupPeriodUs = 3000000 /*3s*/;
@@ -24,6 +24,7 @@
 namespace android {
 namespace ReportPerformance {
 
+class Histogram;
 struct PerformanceData;
 
 // Dumps performance data in a JSON format.
@@ -40,6 +41,10 @@ void dumpRetro(int fd, const std::map<int, PerformanceData>& threadDataMap);
 // or an error occurred while writing.
 bool sendToMediaMetrics(const PerformanceData& data);
 
+// Send the histogram of the NBLog merge lag to media metrics, if it is not empty.
+// Return true if data was sent.
+bool sendMergeLagToMediaMetrics(const Histogram& lagHist);
+
 //------------------------------------------------------------------------------
 
 constexpr int kMsPerSec = 1000;
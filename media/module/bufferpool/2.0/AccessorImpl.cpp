@@ -172,7 +172,10 @@ ResultStatus Accessor::Impl::connect(
             ConnectionId id = (int64_t)pid << 32 | sSeqId | kSeqIdVndkBit;
             status = mBufferPool.mObserver.open(id, statusDescPtr);
             if (status == ResultStatus::OK) {
-                newConnection->initialize(accessor, id);
+                std::shared_ptr<ConnectionFreeList> freeList =
+                        std::make_shared<ConnectionFreeList>(mAllocator);
+                mBufferPool.mConnectionFreeLists.insert(std::make_pair(id, freeList));
+                newConnection->initialize(accessor, id, freeList);
                 *connection = newConnection;
                 *pConnectionId = id;
                 *pMsgId = mBufferPool.mInvalidation.mInvalidationId;
@@ -213,6 +216,16 @@ ResultStatus Accessor::Impl::allocate(
         BufferId *bufferId, const native_handle_t** handle) {
     std::unique_lock<std::mutex> lock(mBufferPool.mMutex);
     mBufferPool.processStatusMessages();
+    // The status messages may have parked buffers for the connection, which
+    // still owns them.
+    auto freeList = mBufferPool.mConnectionFreeLists.find(connectionId);
+    if (freeList != mBufferPool.mConnectionFreeLists.end() &&
+            freeList->second->take(params, bufferId, handle)) {
+        ALOGV("recycle a parked buffer %u %p", *bufferId, *handle);
+        mBufferPool.cleanUp();
+        scheduleEvictIfNeeded();
+        return ResultStatus::OK;
+    }
     ResultStatus status = ResultStatus::OK;
     if (!mBufferPool.getFreeBuffer(mAllocator, params, bufferId, handle)) {
         lock.unlock();
@@ -322,6 +335,7 @@ std::atomic<std::uint32_t> Accessor::Impl::BufferPool::Invalidation::sInvSeqId(0
 
 Accessor::Impl::Impl::BufferPool::~BufferPool() {
     std::lock_guard<std::mutex> lock(mMutex);
+    collectParkedRecycles();
     ALOGD("Destruction - bufferpool2 %p "
           "cached: %zu/%zuM, %zu/%d%% in use; "
           "allocs: %zu, %d%% recycled; "
@@ -453,6 +467,15 @@ bool Accessor::Impl::BufferPool::handleOwnBuffer(
 
 bool Accessor::Impl::BufferPool::handleReleaseBuffer(
         ConnectionId connectionId, BufferId bufferId) {
+    if (parkBuffer(connectionId, bufferId)) {
+        ALOGV("park buffer %u", bufferId);
+        return true;
+    }
+    return releaseBuffer(connectionId, bufferId);
+}
+
+bool Accessor::Impl::BufferPool::releaseBuffer(
+        ConnectionId connectionId, BufferId bufferId) {
     bool deleted = erase(&mUsingBuffers, connectionId, bufferId);
     if (deleted) {
         auto iter = mBuffers.find(bufferId);
@@ -475,6 +498,43 @@ bool Accessor::Impl::BufferPool::handleReleaseBuffer(
     return deleted;
 }
 
+bool Accessor::Impl::BufferPool::parkBuffer(
+        ConnectionId connectionId, BufferId bufferId) {
+    auto freeList = mConnectionFreeLists.find(connectionId);
+    if (freeList == mConnectionFreeLists.end() ||
+            !contains(&mUsingBuffers, connectionId, bufferId)) {
+        return false;
+    }
+    auto iter = mBuffers.find(bufferId);
+    if (iter == mBuffers.end() || iter->second->mOwnerCount != 1 ||
+            iter->second->mTransactionCount != 0 || iter->second->mInvalidated) {
+        return false;
+    }
+    // The connection keeps owning the buffer, so that it is neither evicted
+    // nor recycled by another connection while it is parked.
+    return freeList->second->park(bufferId, iter->second->handle(), &iter->second->mConfig);
+}
+
+void Accessor::Impl::BufferPool::reclaimParkedBuffers(ConnectionId connectionId) {
+    std::vector<BufferId> reclaimed;
+    for (auto it = mConnectionFreeLists.begin(); it != mConnectionFreeLists.end(); ++it) {
+        if (connectionId != -1LL && it->first != connectionId) {
+            continue;
+        }
+        reclaimed.clear();
+        it->second->reclaim(&reclaimed);
+        for (BufferId bufferId : reclaimed) {
+            releaseBuffer(it->first, bufferId);
+        }
+    }
+}
+
+void Accessor::Impl::BufferPool::collectParkedRecycles() {
+    for (auto it = mConnectionFreeLists.begin(); it != mConnectionFreeLists.end(); ++it) {
+        mStats.onParkedBuffersRecycled(it->second->collectTaken());
+    }
+}
+
 bool Accessor::Impl::BufferPool::handleTransferTo(const BufferStatusMessage &message) {
     auto completed = mCompletedTransactions.find(
             message.transactionId);
@@ -570,7 +630,7 @@ bool Accessor::Impl::BufferPool::handleTransferResult(const BufferStatusMessage
 }
 
 void Accessor::Impl::BufferPool::processStatusMessages() {
-    std::vector<BufferStatusMessage> messages;
+    std::vector<BufferStatusMessage> &messages = mStatusMessages;
     mObserver.getBufferStatusChanges(messages);
     mTimestampUs = getTimestampNow();
     for (BufferStatusMessage& message: messages) {
@@ -616,6 +676,14 @@ void Accessor::Impl::BufferPool::processStatusMessages() {
 }
 
 bool Accessor::Impl::BufferPool::handleClose(ConnectionId connectionId) {
+    // Cleaning parked buffers
+    auto freeList = mConnectionFreeLists.find(connectionId);
+    if (freeList != mConnectionFreeLists.end()) {
+        reclaimParkedBuffers(connectionId);
+        mStats.onParkedBuffersRecycled(freeList->second->collectTaken());
+        mConnectionFreeLists.erase(freeList);
+    }
+
     // Cleaning buffers
     auto buffers = mUsingBuffers.find(connectionId);
     if (buffers != mUsingBuffers.end()) {
@@ -729,6 +797,10 @@ void Accessor::Impl::BufferPool::cleanUp(bool clearCache) {
     if (clearCache || mTimestampUs > mLastCleanUpUs + kCleanUpDurationUs ||
             mStats.buffersNotInUse() > kMaxUnusedBufferCount) {
         mLastCleanUpUs = mTimestampUs;
+        if (clearCache) {
+            reclaimParkedBuffers();
+        }
+        collectParkedRecycles();
         if (mTimestampUs > mLastLogUs + kLogDurationUs ||
                 mStats.buffersNotInUse() > kMaxUnusedBufferCount) {
             mLastLogUs = mTimestampUs;
@@ -763,6 +835,8 @@ void Accessor::Impl::BufferPool::cleanUp(bool clearCache) {
 void Accessor::Impl::BufferPool::invalidate(
         bool needsAck, BufferId from, BufferId to,
         const std::shared_ptr<Accessor::Impl> &impl) {
+    // Parked buffers are owned, release them to evict them now.
+    reclaimParkedBuffers();
     for (auto freeIt = mFreeBuffers.begin(); freeIt != mFreeBuffers.end();) {
         if (isBufferInRange(from, to, *freeIt)) {
             auto it = mBuffers.find(*freeIt);
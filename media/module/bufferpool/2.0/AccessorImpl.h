@@ -100,6 +100,8 @@ private:
         bool mValid;
         BufferStatusObserver mObserver;
         BufferInvalidationChannel mInvalidationChannel;
+        // Kept across processStatusMessages() calls to avoid reallocation.
+        std::vector<BufferStatusMessage> mStatusMessages;
 
         std::map<ConnectionId, std::set<BufferId>> mUsingBuffers;
         std::map<BufferId, std::set<ConnectionId>> mUsingConnections;
@@ -116,6 +118,9 @@ private:
         std::map<BufferId, std::unique_ptr<InternalBuffer>> mBuffers;
         std::set<BufferId> mFreeBuffers;
         std::set<ConnectionId> mConnectionIds;
+        // Buffers released by each connection and parked for its next
+        // allocations.
+        std::map<ConnectionId, std::shared_ptr<ConnectionFreeList>> mConnectionFreeLists;
 
         struct Invalidation {
             static std::atomic<std::uint32_t> sInvSeqId;
@@ -225,6 +230,12 @@ private:
                 mTotalRecycles++;
             }
 
+            /// Buffers parked for a connection are recycled without the lock.
+            void onParkedBuffersRecycled(size_t count) {
+                mTotalAllocations += count;
+                mTotalRecycles += count;
+            }
+
             /// A buffer is available to be recycled.
             void onBufferUnused(size_t allocSize) {
                 mSizeInUse -= allocSize;
@@ -286,6 +297,41 @@ private:
          */
         bool handleReleaseBuffer(ConnectionId connectionId, BufferId bufferId);
 
+        /**
+         * Releases the ownership of a buffer by a connection, without parking
+         * the buffer for the connection.
+         *
+         * @param connectionId  the id of the buffer owning connection.
+         * @param bufferId      the id of the buffer.
+         *
+         * @return {@code true} when the buffer ownership is released,
+         *         {@code false} otherwise.
+         */
+        bool releaseBuffer(ConnectionId connectionId, BufferId bufferId);
+
+        /**
+         * Parks a buffer released by its last owner for the next allocations
+         * of the owner, which keeps owning it.
+         *
+         * @param connectionId  the id of the buffer owning connection.
+         * @param bufferId      the id of the buffer.
+         *
+         * @return {@code true} when the buffer is parked,
+         *         {@code false} otherwise.
+         */
+        bool parkBuffer(ConnectionId connectionId, BufferId bufferId);
+
+        /**
+         * Releases the buffers parked for a connection, or for all connections
+         * when connectionId is -1.
+         *
+         * @param connectionId  the id of the connection.
+         */
+        void reclaimParkedBuffers(ConnectionId connectionId = -1LL);
+
+        /** Adds the parked buffers recycled without the lock to the stats. */
+        void collectParkedRecycles();
+
         /**
          * Handles a transfer transaction start message from the sender.
          *
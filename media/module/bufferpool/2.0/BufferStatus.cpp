@@ -86,19 +86,23 @@ ResultStatus BufferStatusObserver::close(ConnectionId id) {
 
 void BufferStatusObserver::getBufferStatusChanges(std::vector<BufferStatusMessage> &messages) {
     for (auto it = mBufferStatusQueues.begin(); it != mBufferStatusQueues.end(); ++it) {
-        BufferStatusMessage message;
         size_t avail = it->second->availableToRead();
-        while (avail > 0) {
-            if (!it->second->read(&message, 1)) {
-                // Since avaliable # of reads are already confirmed,
-                // this should not happen.
-                // TODO: error handling (spurious client?)
-                ALOGW("FMQ message cannot be read from %lld", (long long)it->first);
-                return;
-            }
-            message.connectionId = it->first;
-            messages.push_back(message);
-            --avail;
+        if (avail == 0) {
+            continue;
+        }
+        // Take everything the client has posted so far in one read.
+        size_t start = messages.size();
+        messages.resize(start + avail);
+        if (!it->second->read(&messages[start], avail)) {
+            // Since avaliable # of reads are already confirmed,
+            // this should not happen.
+            // TODO: error handling (spurious client?)
+            ALOGW("FMQ message cannot be read from %lld", (long long)it->first);
+            messages.resize(start);
+            return;
+        }
+        for (size_t i = start; i < messages.size(); ++i) {
+            messages[i].connectionId = it->first;
         }
     }
 }
@@ -133,25 +137,33 @@ void BufferStatusChannel::postBufferRelease(
     if (mValid && pending.size() > 0) {
         size_t avail = mBufferStatusQueue->availableToWrite();
         avail = std::min(avail, pending.size());
-        BufferStatusMessage message;
-        for (size_t i = 0 ; i < avail; ++i) {
-            BufferId id = pending.front();
-            message.newStatus = BufferStatus::NOT_USED;
-            message.bufferId = id;
-            message.connectionId = connectionId;
-            if (!mBufferStatusQueue->write(&message, 1)) {
-                // Since avaliable # of writes are already confirmed,
-                // this should not happen.
-                // TODO: error handing?
-                ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
-                return;
-            }
-            pending.pop_front();
-            posted.push_back(id);
+        if (avail == 0) {
+            return;
+        }
+        mMessages.clear();
+        auto it = pending.begin();
+        for (size_t i = 0 ; i < avail; ++i, ++it) {
+            addRelease(connectionId, *it);
+        }
+        if (!mBufferStatusQueue->write(mMessages.data(), mMessages.size())) {
+            // Since avaliable # of writes are already confirmed,
+            // this should not happen.
+            // TODO: error handing?
+            ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
+            return;
         }
+        posted.splice(posted.end(), pending, pending.begin(), it);
     }
 }
 
+void BufferStatusChannel::addRelease(ConnectionId connectionId, BufferId bufferId) {
+    BufferStatusMessage message;
+    message.newStatus = BufferStatus::NOT_USED;
+    message.bufferId = bufferId;
+    message.connectionId = connectionId;
+    mMessages.push_back(message);
+}
+
 void BufferStatusChannel::postBufferInvalidateAck(
         ConnectionId connectionId,
         uint32_t invalidateId,
@@ -183,22 +195,12 @@ bool BufferStatusChannel::postBufferStatusMessage(
         size_t avail = mBufferStatusQueue->availableToWrite();
         size_t numPending = pending.size();
         if (avail >= numPending + 1) {
-            BufferStatusMessage release, message;
-            for (size_t i = 0; i < numPending; ++i) {
-                BufferId id = pending.front();
-                release.newStatus = BufferStatus::NOT_USED;
-                release.bufferId = id;
-                release.connectionId = connectionId;
-                if (!mBufferStatusQueue->write(&release, 1)) {
-                    // Since avaliable # of writes are already confirmed,
-                    // this should not happen.
-                    // TODO: error handling?
-                    ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
-                    return false;
-                }
-                pending.pop_front();
-                posted.push_back(id);
+            // The pending releases and the message are posted in one write.
+            mMessages.clear();
+            for (BufferId id : pending) {
+                addRelease(connectionId, id);
             }
+            BufferStatusMessage message;
             message.transactionId = transactionId;
             message.bufferId = bufferId;
             message.newStatus = status;
@@ -206,12 +208,15 @@ bool BufferStatusChannel::postBufferStatusMessage(
             message.targetConnectionId = targetId;
             // TODO : timesatamp
             message.timestampUs = 0;
-            if (!mBufferStatusQueue->write(&message, 1)) {
+            mMessages.push_back(message);
+            if (!mBufferStatusQueue->write(mMessages.data(), mMessages.size())) {
                 // Since avaliable # of writes are already confirmed,
                 // this should not happen.
+                // TODO: error handling?
                 ALOGW("FMQ message cannot be sent from %lld", (long long)connectionId);
                 return false;
             }
+            posted.splice(posted.end(), pending);
             return true;
         }
     }
@@ -295,6 +300,71 @@ void BufferInvalidationChannel::postInvalidation(
     mBufferInvalidationQueue->write(&message);
 }
 
+ConnectionFreeList::ConnectionFreeList(
+        const std::shared_ptr<BufferPoolAllocator> &allocator)
+        : mAllocator(allocator) {}
+
+bool ConnectionFreeList::park(
+        BufferId bufferId, const native_handle_t *handle,
+        const std::vector<uint8_t> *config) {
+    // Only the buffer pool fills slots, and it does so under its lock, so an
+    // empty slot stays empty until it is filled here.
+    for (Slot &slot : mSlots) {
+        if (slot.mState.load(std::memory_order_acquire) == EMPTY) {
+            slot.mId = bufferId;
+            slot.mHandle = handle;
+            slot.mConfig = config;
+            slot.mState.store(FULL, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ConnectionFreeList::take(
+        const std::vector<uint8_t> &params,
+        BufferId *bufferId, const native_handle_t **handle) {
+    for (Slot &slot : mSlots) {
+        uint32_t state = FULL;
+        if (!slot.mState.compare_exchange_strong(
+                state, TAKING, std::memory_order_acquire, std::memory_order_relaxed)) {
+            continue;
+        }
+        if (mAllocator->compatible(params, *slot.mConfig)) {
+            *bufferId = slot.mId;
+            *handle = slot.mHandle;
+            slot.mState.store(EMPTY, std::memory_order_release);
+            mTaken.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        slot.mState.store(FULL, std::memory_order_release);
+    }
+    return false;
+}
+
+void ConnectionFreeList::reclaim(std::vector<BufferId> *reclaimed) {
+    for (Slot &slot : mSlots) {
+        uint32_t state = FULL;
+        while (!slot.mState.compare_exchange_weak(
+                state, TAKING, std::memory_order_acquire, std::memory_order_relaxed)) {
+            if (state == EMPTY) {
+                break;
+            }
+            // The connection is checking the buffer, which does not take long.
+            state = FULL;
+            std::this_thread::yield();
+        }
+        if (state != EMPTY) {
+            reclaimed->push_back(slot.mId);
+            slot.mState.store(EMPTY, std::memory_order_release);
+        }
+    }
+}
+
+size_t ConnectionFreeList::collectTaken() {
+    return mTaken.exchange(0, std::memory_order_relaxed);
+}
+
 }  // namespace implementation
 }  // namespace V2_0
 }  // namespace bufferpool
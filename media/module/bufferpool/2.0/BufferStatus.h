@@ -22,6 +22,8 @@
 #include <fmq/MessageQueue.h>
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -88,6 +90,10 @@ class BufferStatusChannel {
 private:
     bool mValid;
     std::unique_ptr<BufferStatusQueue> mBufferStatusQueue;
+    // Messages to be posted in one FMQ write.
+    std::vector<BufferStatusMessage> mMessages;
+
+    void addRelease(ConnectionId connectionId, BufferId bufferId);
 
 public:
     /**
@@ -220,6 +226,80 @@ public:
     void postInvalidation(uint32_t msgId, BufferId fromId, BufferId toId);
 };
 
+/**
+ * Buffers released by a connection which the buffer pool keeps owned by the
+ * connection, so that its next allocations take them without the buffer pool
+ * lock. The buffer pool parks and reclaims buffers with its lock held, the
+ * connection takes them without the lock.
+ */
+class ConnectionFreeList {
+private:
+    enum : uint32_t {
+        EMPTY,
+        FULL,
+        // A buffer being checked or taken by the connection.
+        TAKING,
+    };
+
+    struct Slot {
+        std::atomic<uint32_t> mState{EMPTY};
+        BufferId mId;
+        const native_handle_t *mHandle;
+        // Owned by the buffer pool, valid while the buffer is parked.
+        const std::vector<uint8_t> *mConfig;
+    };
+
+    // Bounds the released buffers which a connection keeps from the other
+    // connections and from eviction.
+    static constexpr size_t kNumSlots = 8;
+
+    const std::shared_ptr<BufferPoolAllocator> mAllocator;
+    std::array<Slot, kNumSlots> mSlots;
+    std::atomic<size_t> mTaken{0};
+
+public:
+    ConnectionFreeList(const std::shared_ptr<BufferPoolAllocator> &allocator);
+
+    /**
+     * Parks a buffer released by the connection. Called with the buffer pool
+     * lock held.
+     *
+     * @param bufferId  the id of the buffer.
+     * @param handle    the native handle of the buffer.
+     * @param config    the allocation parameters of the buffer.
+     *
+     * @return {@code true} when the buffer is parked,
+     *         {@code false} when the list is full.
+     */
+    bool park(BufferId bufferId, const native_handle_t *handle,
+              const std::vector<uint8_t> *config);
+
+    /**
+     * Takes a parked buffer which is compatible with the allocation
+     * parameters. Does not lock.
+     *
+     * @param params    the allocation parameters.
+     * @param bufferId  the id of the taken buffer.
+     * @param handle    the native handle of the taken buffer.
+     *
+     * @return {@code true} when a buffer is taken,
+     *         {@code false} otherwise.
+     */
+    bool take(const std::vector<uint8_t> &params,
+              BufferId *bufferId, const native_handle_t **handle);
+
+    /**
+     * Removes all parked buffers, so that the buffer pool can release them.
+     * Called with the buffer pool lock held.
+     *
+     * @param reclaimed the ids of the removed buffers are appended to it.
+     */
+    void reclaim(std::vector<BufferId> *reclaimed);
+
+    /** Returns the # of buffers taken since the last call. */
+    size_t collectTaken();
+};
+
 }  // namespace implementation
 }  // namespace V2_0
 }  // namespace bufferpool
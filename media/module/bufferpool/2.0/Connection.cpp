@@ -60,10 +60,12 @@ Connection::~Connection() {
 }
 
 void Connection::initialize(
-        const sp<Accessor>& accessor, ConnectionId connectionId) {
+        const sp<Accessor>& accessor, ConnectionId connectionId,
+        const std::shared_ptr<ConnectionFreeList> &freeList) {
     if (!mInitialized) {
         mAccessor = accessor;
         mConnectionId = connectionId;
+        mFreeList = freeList;
         mInitialized = true;
     }
 }
@@ -79,6 +81,11 @@ ResultStatus Connection::allocate(
         const std::vector<uint8_t> &params, BufferId *bufferId,
         const native_handle_t **handle) {
     if (mInitialized && mAccessor) {
+        // Buffers released by this connection are parked for it by the buffer
+        // pool, and are taken without the buffer pool lock.
+        if (mFreeList && mFreeList->take(params, bufferId, handle)) {
+            return ResultStatus::OK;
+        }
         return mAccessor->allocate(mConnectionId, params, bufferId, handle);
     }
     return ResultStatus::CRITICAL_ERROR;
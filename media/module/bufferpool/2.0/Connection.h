@@ -85,8 +85,10 @@ struct Connection : public IConnection {
      *
      * @param accessor      the specified buffer pool.
      * @param connectionId  Id.
+     * @param freeList      the buffers parked for the connection.
      */
-    void initialize(const sp<Accessor> &accessor, ConnectionId connectionId);
+    void initialize(const sp<Accessor> &accessor, ConnectionId connectionId,
+                    const std::shared_ptr<ConnectionFreeList> &freeList);
 
     enum : uint32_t {
         SYNC_BUFFERID = UINT32_MAX,
@@ -96,6 +98,7 @@ private:
     bool mInitialized;
     sp<Accessor> mAccessor;
     ConnectionId mConnectionId;
+    std::shared_ptr<ConnectionFreeList> mFreeList;
 };
 
 }  // namespace implementation
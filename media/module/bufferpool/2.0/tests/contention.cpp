@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "bufferpool_contention_benchmark"
+
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "Accessor.h"
+#include "BufferStatus.h"
+#include "Connection.h"
+#include "allocator.h"
+
+using android::sp;
+using android::hardware::media::bufferpool::V2_0::ResultStatus;
+using android::hardware::media::bufferpool::V2_0::implementation::Accessor;
+using android::hardware::media::bufferpool::V2_0::implementation::BufferId;
+using android::hardware::media::bufferpool::V2_0::implementation::BufferStatusChannel;
+using android::hardware::media::bufferpool::V2_0::implementation::Connection;
+using android::hardware::media::bufferpool::V2_0::implementation::ConnectionId;
+using android::hardware::media::bufferpool::V2_0::implementation::InvalidationDescriptor;
+using android::hardware::media::bufferpool::V2_0::implementation::StatusDescriptor;
+
+namespace {
+
+// Number of buffers each client thread holds at a time, like a codec keeping
+// a few frames in flight.
+constexpr static size_t kNumBuffersInFlight = 4;
+
+// One buffer pool shared by all client threads of the benchmark.
+struct SharedPool {
+  sp<Accessor> mAccessor;
+  bool mValid;
+
+  SharedPool() : mValid(false) {
+    mAccessor = new Accessor(std::make_shared<TestBufferPoolAllocator>());
+    mValid = mAccessor && mAccessor->isValid();
+  }
+};
+
+// A local connection of one client thread to the shared pool, as each codec
+// process would have. ClientManager keeps a single connection per pool in a
+// process, so the connection is made through the pool directly. Buffers are
+// released through the connection's own status FMQ, like BufferPoolClient
+// does.
+struct ThreadConnection {
+  sp<Connection> mConnection;
+  ConnectionId mConnectionId;
+  std::unique_ptr<BufferStatusChannel> mStatusChannel;
+  std::list<BufferId> mPendingReleases;
+  std::list<BufferId> mPostedReleases;
+  bool mValid;
+
+  explicit ThreadConnection(const sp<Accessor> &accessor) : mValid(false) {
+    uint32_t msgId;
+    const StatusDescriptor *statusDesc;
+    const InvalidationDescriptor *invDesc;
+    if (accessor->connect(nullptr /* observer */, true /* local */, &mConnection,
+                          &mConnectionId, &msgId, &statusDesc, &invDesc)
+        != ResultStatus::OK) {
+      return;
+    }
+    mAccessor = accessor;
+    mStatusChannel = std::make_unique<BufferStatusChannel>(*statusDesc);
+    mValid = mStatusChannel->isValid();
+  }
+
+  ~ThreadConnection() {
+    if (mAccessor) {
+      mAccessor->close(mConnectionId);
+    }
+  }
+
+  // Queues the release, which the pool processes on the next allocation of
+  // any connection.
+  void release(BufferId bufferId) {
+    mPendingReleases.push_back(bufferId);
+    mStatusChannel->postBufferRelease(mConnectionId, mPendingReleases, mPostedReleases);
+    mPostedReleases.clear();
+  }
+
+ private:
+  sp<Accessor> mAccessor;
+};
+
+// Every benchmark thread allocates buffers from the same pool over its own
+// connection, and releases the oldest one once it holds kNumBuffersInFlight of
+// them. An allocation takes the pool lock only when no released buffer is parked
+// for its connection; under the lock it drains the pending status messages of
+// all connections, parking the buffers they released.
+void BM_ConcurrentAllocate(benchmark::State &state) {
+  static SharedPool sPool;
+  if (!sPool.mValid) {
+    state.SkipWithError("buffer pool creation failed");
+    return;
+  }
+  ThreadConnection connection(sPool.mAccessor);
+  if (!connection.mValid) {
+    state.SkipWithError("connection to the buffer pool failed");
+    return;
+  }
+  std::vector<uint8_t> params;
+  getTestAllocatorParams(&params);
+
+  std::vector<BufferId> buffers;
+  buffers.reserve(kNumBuffersInFlight);
+  size_t next = 0;
+  for (auto _ : state) {
+    if (buffers.size() == kNumBuffersInFlight) {
+      connection.release(buffers[next]);
+    }
+    BufferId bufferId;
+    const native_handle_t *handle = nullptr;
+    ResultStatus status = connection.mConnection->allocate(params, &bufferId, &handle);
+    if (status != ResultStatus::OK) {
+      state.SkipWithError("allocation failed");
+      break;
+    }
+    // The handle belongs to the pool.
+    if (buffers.size() < kNumBuffersInFlight) {
+      buffers.push_back(bufferId);
+    } else {
+      buffers[next] = bufferId;
+    }
+    next = (next + 1) % kNumBuffersInFlight;
+  }
+  for (BufferId bufferId : buffers) {
+    connection.release(bufferId);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ConcurrentAllocate)
+    ->Threads(1)
+    ->ThreadRange(4, 16)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
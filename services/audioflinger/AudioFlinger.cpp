@@ -380,6 +380,11 @@ AudioFlinger::AudioFlinger()
     mDevicesFactoryHal->getHalPids(&halPids);
     mediautils::TimeCheck::setAudioHalPids(halPids);
 
+    // Batch the per-track items logged on track create/start/stop/underrun,
+    // which otherwise cost a binder transaction each.
+    mediametrics::BaseItem::enableBatching(
+            property_get_int32("af.metrics.batch_period_ms", 0 /* default_value */));
+
     // Notify that we have started (also called when audioserver service restarts)
     mediametrics::LogItem(mMetricsId)
         .set(AMEDIAMETRICS_PROP_EVENT, AMEDIAMETRICS_PROP_EVENT_VALUE_CTOR)
@@ -844,6 +849,8 @@ void AudioFlinger::dumpInternals(int fd, const Vector<String16>& args __unused)
     }
     dprintf(fd, "Bluetooth latency modes are %senabled\n",
             mBluetoothLatencyModesEnabled ? "" : "not ");
+    const std::string filterCache = AudioResampler::dumpFilterCache();
+    write(fd, filterCache.c_str(), filterCache.size());
 }
 
 void AudioFlinger::dumpPermissionDenial(int fd, const Vector<String16>& args __unused)
@@ -73,6 +73,8 @@
 #include <media/AudioMixer.h>
 #include <media/DeviceDescriptorBase.h>
 #include <media/ExtendedAudioBufferProvider.h>
+#include <media/RecordConverterGroup.h>
+#include <media/VolumeRamp.h>
 #include <media/VolumeShaper.h>
 #include <mediautils/ServiceUtilities.h>
 #include <mediautils/SharedMemoryAllocator.h>
@@ -93,7 +95,9 @@
 #include "FastCapture.h"
 #include "FastMixer.h"
 #include <media/nbaio/NBAIO.h>
+#include <media/nbaio/SingleStateQueue.h>
 #include "AudioWatchdog.h"
+#include "PublishedState.h"
 #include "AudioStreamOut.h"
 #include "SpdifStreamOut.h"
 #include "AudioHwDevice.h"
@@ -139,6 +143,7 @@ using android::content::AttributionSourceState;
 class AudioFlinger : public AudioFlingerServerAdapter::Delegate
 {
     friend class sp<AudioFlinger>;
+    friend class EffectChainTest;  // for the effect classes, see tests/effect_chain_tests.cpp
 public:
     static void instantiate() ANDROID_API;
 
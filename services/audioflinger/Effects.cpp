@@ -669,12 +669,14 @@ bool AudioFlinger::EffectModule::updateState() {
     return started;
 }
 
-void AudioFlinger::EffectModule::process()
+EffectBufferHalInterface *AudioFlinger::EffectModule::process(
+        EffectBufferHalInterface *int16Input)
 {
     Mutex::Autolock _l(mLock);
 
     if (mState == DESTROYED || mEffectInterface == 0 || mInBuffer == 0 || mOutBuffer == 0) {
-        return;
+        convertInt16Input_l(int16Input);
+        return nullptr;
     }
 
     const uint32_t inChannelCount =
@@ -721,6 +723,20 @@ void AudioFlinger::EffectModule::process()
 #endif
     };
 
+    EffectBufferHalInterface *int16Output = nullptr;
+#ifdef FLOAT_EFFECT_CHAIN
+    // The int16 output of the previous effect is only used as is if this effect processes
+    // int16 without channel adjustment, otherwise it is converted back to float first.
+    const bool int16InputReady = int16Input != nullptr
+            && int16Input == mInConversionBuffer.get()
+            && !mSupportsFloat && !auxType
+            && mInChannelCountRequested == inChannelCount
+            && isProcessEnabled() && isProcessImplemented();
+    if (!int16InputReady) {
+        convertInt16Input_l(int16Input);
+    }
+#endif
+
     if (isProcessEnabled()) {
         int ret;
         if (isProcessImplemented()) {
@@ -784,10 +800,12 @@ void AudioFlinger::EffectModule::process()
                         ALOGW("%s: mInConversionBuffer is null, bypassing", __func__);
                         goto data_bypass;
                     }
-                    memcpy_to_i16_from_float(
-                            mInConversionBuffer->audioBuffer()->s16,
-                            inBuffer->audioBuffer()->f32,
-                            inChannelCount * mConfig.inputCfg.buffer.frameCount);
+                    if (!int16InputReady) {
+                        memcpy_to_i16_from_float(
+                                mInConversionBuffer->audioBuffer()->s16,
+                                inBuffer->audioBuffer()->f32,
+                                inChannelCount * mConfig.inputCfg.buffer.frameCount);
+                    }
                     inBuffer = mInConversionBuffer;
                 }
                 if (mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE) {
@@ -805,7 +823,10 @@ void AudioFlinger::EffectModule::process()
 #endif
             ret = mEffectInterface->process();
 #ifdef FLOAT_EFFECT_CHAIN
-            if (!mSupportsFloat) { // convert output int16_t back to float.
+            if (!mSupportsFloat && mInt16OutputLink != nullptr) {
+                // The next effect reads the int16 output, see linkInt16Output().
+                int16Output = mInt16OutputLink.get();
+            } else if (!mSupportsFloat) { // convert output int16_t back to float.
                 sp<EffectBufferHalInterface> target =
                         mOutChannelCountRequested != outChannelCount
                         ? mOutConversionBuffer : mOutBuffer;
@@ -825,6 +846,9 @@ void AudioFlinger::EffectModule::process()
         } else {
 #ifdef FLOAT_EFFECT_CHAIN
             data_bypass:
+            if (int16InputReady) {
+                convertInt16Input_l(int16Input);
+            }
 #endif
             if (!auxType  /* aux effects do not require data bypass */
                     && mConfig.inputCfg.buffer.raw != mConfig.outputCfg.buffer.raw) {
@@ -867,6 +891,25 @@ void AudioFlinger::EffectModule::process()
             }
         }
     }
+    return int16Output;
+}
+
+// must be called with EffectModule::mLock held
+void AudioFlinger::EffectModule::convertInt16Input_l(EffectBufferHalInterface *int16Input)
+{
+#ifdef FLOAT_EFFECT_CHAIN
+    if (int16Input == nullptr || mInBuffer == nullptr) {
+        return;
+    }
+    // canLinkInt16OutputTo() only links effects with the same channel and frame counts.
+    const size_t sampleCount = std::min(
+            (size_t)mInChannelCountRequested * mConfig.inputCfg.buffer.frameCount,
+            int16Input->getSize() / sizeof(int16_t));
+    memcpy_to_float_from_i16(
+            mInBuffer->audioBuffer()->f32, int16Input->audioBuffer()->s16, sampleCount);
+#else
+    (void)int16Input;
+#endif
 }
 
 void AudioFlinger::EffectModule::reset_l()
@@ -1398,6 +1441,9 @@ void AudioFlinger::EffectModule::setOutBuffer(const sp<EffectBufferHalInterface>
     mEffectInterface->setOutBuffer(buffer);
 
 #ifdef FLOAT_EFFECT_CHAIN
+    // The chain links the output again if needed, see EffectChain::planBuffers_l().
+    mInt16OutputLink.clear();
+
     // Note: Any effect that does not accumulate does not need mOutConversionBuffer and
     // can do in-place conversion from int16_t to float.  We don't optimize here.
     const uint32_t outChannelCount =
@@ -1428,6 +1474,52 @@ void AudioFlinger::EffectModule::setOutBuffer(const sp<EffectBufferHalInterface>
 #endif
 }
 
+#ifdef FLOAT_EFFECT_CHAIN
+bool AudioFlinger::EffectModule::canLinkInt16OutputTo(const EffectModule& next) const
+{
+    const uint32_t outChannelCount =
+            audio_channel_count_from_out_mask(mConfig.outputCfg.channels);
+    const uint32_t nextInChannelCount =
+            audio_channel_count_from_out_mask(next.mConfig.inputCfg.channels);
+    const size_t frameCount = mConfig.outputCfg.buffer.frameCount;
+    return mStatus == NO_ERROR && next.mStatus == NO_ERROR
+            && !mSupportsFloat && !next.mSupportsFloat
+            && (mDescriptor.flags & EFFECT_FLAG_TYPE_MASK) != EFFECT_FLAG_TYPE_AUXILIARY
+            && (next.mDescriptor.flags & EFFECT_FLAG_TYPE_MASK) != EFFECT_FLAG_TYPE_AUXILIARY
+            // the next effect reads the buffer written by this effect, in place.
+            && mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE
+            && mOutBuffer != nullptr && mOutConversionBuffer != nullptr
+            && next.mInConversionBuffer != nullptr
+            && mConfig.outputCfg.buffer.raw == next.mConfig.inputCfg.buffer.raw
+            // no channel adjustment on either side.
+            && mOutChannelCountRequested == outChannelCount
+            && next.mInChannelCountRequested == nextInChannelCount
+            && outChannelCount == nextInChannelCount
+            && frameCount == next.mConfig.inputCfg.buffer.frameCount
+            && next.mInConversionBuffer->getSize() >= outChannelCount * frameCount * sizeof(int16_t);
+}
+#endif
+
+bool AudioFlinger::EffectModule::linkInt16Output(const sp<EffectModule>& next)
+{
+#ifdef FLOAT_EFFECT_CHAIN
+    sp<EffectBufferHalInterface> link;
+    if (next != nullptr && canLinkInt16OutputTo(*next)) {
+        link = next->mInConversionBuffer;
+    }
+    if (link != mInt16OutputLink) {
+        mInt16OutputLink = link;
+        if (mEffectInterface != 0) {
+            mEffectInterface->setOutBuffer(link != nullptr ? link : mOutConversionBuffer);
+        }
+    }
+    return link != nullptr;
+#else
+    (void)next;
+    return false;
+#endif
+}
+
 status_t AudioFlinger::EffectModule::setVolume(uint32_t *left, uint32_t *right, bool controller)
 {
     AutoLockReentrant _l(mLock, mSetVolumeReentrantTid);
@@ -1700,6 +1792,11 @@ NO_THREAD_SAFETY_ANALYSIS  // conditional try lock
             mStatus, mEffectInterface.get());
 
     result.appendFormat("\t\t- data: %s\n", mSupportsFloat ? "float" : "int16");
+#ifdef FLOAT_EFFECT_CHAIN
+    if (mInt16OutputLink != nullptr) {
+        result.append("\t\t- int16 output linked to the next effect\n");
+    }
+#endif
 
     result.append("\t\t- Input configuration:\n");
     result.append("\t\t\tBuffer     Frames  Smp rate Channels Format\n");
@@ -2304,8 +2401,10 @@ void AudioFlinger::EffectChain::process_l()
         if (mInBuffer->audioBuffer()->raw != mOutBuffer->audioBuffer()->raw) {
             mOutBuffer->update();
         }
+        // Adjacent int16 effects hand over their int16 output, see planBuffers_l().
+        EffectBufferHalInterface *int16Buffer = nullptr;
         for (size_t i = 0; i < size; i++) {
-            mEffects[i]->process();
+            int16Buffer = mEffects[i]->process(int16Buffer);
         }
         mInBuffer->commit();
         if (mInBuffer->audioBuffer()->raw != mOutBuffer->audioBuffer()->raw) {
@@ -2427,10 +2526,57 @@ status_t AudioFlinger::EffectChain::addEffect_ll(const sp<EffectModule>& effect)
                 __func__, effect.get(), this, idx_insert);
     }
     effect->configure();
+    planBuffers_l();
 
     return NO_ERROR;
 }
 
+// planBuffers_l() must be called with EffectChain::mLock held, after the effects or their
+// buffers change.
+// All effects but the last one process in place in the chain input buffer, so float effects
+// do not copy. Effects only supporting int16 convert the float input to int16 and their output
+// back to float: when several of them follow each other, each one writes its int16 output
+// directly to the next one, so that the chain only converts once per run of int16 effects.
+void AudioFlinger::EffectChain::planBuffers_l()
+{
+    const size_t linkCount = linkInt16Outputs(mEffects);
+    ALOGV_IF(linkCount != 0, "%s chain %p: %zu int16 effect(s) linked to the next one",
+            __func__, this, linkCount);
+}
+
+/* static */
+size_t AudioFlinger::EffectChain::linkInt16Outputs(const Vector< sp<EffectModule> >& effects)
+{
+    size_t linkCount = 0;
+    for (size_t i = 0; i < effects.size(); i++) {
+        sp<EffectModule> next;
+        if (i + 1 < effects.size()) {
+            next = effects[i + 1];
+        }
+        if (effects[i]->linkInt16Output(next)) {
+            linkCount++;
+        }
+    }
+    return linkCount;
+}
+
+void AudioFlinger::EffectChain::replaceBuffers_l(const sp<EffectBufferHalInterface>& inBuffer,
+                                                 const sp<EffectBufferHalInterface>& outBuffer)
+{
+    Mutex::Autolock _l(mLock);
+    // Each effect reads and writes either the chain input or the chain output buffer,
+    // see addEffect_ll().
+    const void *previousInBuffer = mInBuffer != 0 ? mInBuffer->ptr() : nullptr;
+    for (size_t i = 0; i < mEffects.size(); i++) {
+        const sp<EffectModule>& effect = mEffects[i];
+        effect->setInBuffer(effect->inBuffer() == previousInBuffer ? inBuffer : outBuffer);
+        effect->setOutBuffer(effect->outBuffer() == previousInBuffer ? inBuffer : outBuffer);
+    }
+    mInBuffer = inBuffer;
+    mOutBuffer = outBuffer;
+    planBuffers_l();
+}
+
 ssize_t AudioFlinger::EffectChain::getInsertIndex(const effect_descriptor_t& desc) {
     // Insert effects are inserted at the end of mEffects vector as they are processed
     //  after track and auxiliary effects.
@@ -2533,6 +2679,7 @@ size_t AudioFlinger::EffectChain::removeEffect_l(const sp<EffectModule>& effect,
                 }
             }
             mEffects.removeAt(i);
+            effect->linkInt16Output(nullptr);
 
             // make sure the input buffer configuration for the new first effect in the chain
             // is updated if needed (can switch from HAL channel mask to mixer channel mask)
@@ -2541,6 +2688,7 @@ size_t AudioFlinger::EffectChain::removeEffect_l(const sp<EffectModule>& effect,
                 mEffects[0]->setInBuffer(mInBuffer);
                 mEffects[0]->updateAccessMode();      // reconfig if neeeded.
             }
+            planBuffers_l();
 
             ALOGV("removeEffect_l() effect %p, removed from chain %p at rank %zu", effect.get(),
                     this, i);
@@ -227,7 +227,11 @@ public:
                     audio_port_handle_t deviceId);
     virtual ~EffectModule();
 
-    void process();
+    // Processes one buffer of the chain.
+    // int16Input is the buffer where the previous effect left its int16 output instead of
+    // converting it back to float, see linkInt16Output(). Returns the buffer where this effect
+    // left its own int16 output for the next effect, or nullptr if the output is in float.
+    EffectBufferHalInterface *process(EffectBufferHalInterface *int16Input = nullptr);
     bool updateState();
     status_t command(int32_t cmdCode,
                      const std::vector<uint8_t>& cmdData,
@@ -255,6 +259,13 @@ public:
         return mOutBuffer != 0 ? reinterpret_cast<int16_t*>(mOutBuffer->ptr()) : NULL;
     }
 
+    // When this effect and the next one in the chain only support int16, the effect engine
+    // writes directly into the input conversion buffer of the next effect and process()
+    // skips the conversion to float and back between them.
+    // Clears the link if next is null or cannot be linked. Returns true if linked.
+    // Must be called with EffectChain::mLock held, after the buffers of both effects are set.
+    bool        linkInt16Output(const sp<EffectModule>& next);
+
     // Updates the access mode if it is out of date.  May issue a new effect configure.
     void        updateAccessMode() {
                     if (requiredEffectBufferAccessMode() != mConfig.outputCfg.accessMode) {
@@ -307,6 +318,10 @@ private:
     }
 
     status_t setVolumeInternal(uint32_t *left, uint32_t *right, bool controller);
+#ifdef FLOAT_EFFECT_CHAIN
+    bool canLinkInt16OutputTo(const EffectModule& next) const;
+#endif
+    void convertInt16Input_l(EffectBufferHalInterface *int16Input);
 
 
     effect_config_t     mConfig;    // input and output audio configuration
@@ -329,6 +344,8 @@ private:
     sp<EffectBufferHalInterface> mOutConversionBuffer;
     uint32_t mInChannelCountRequested;
     uint32_t mOutChannelCountRequested;
+    // mInConversionBuffer of the next effect when linked by linkInt16Output().
+    sp<EffectBufferHalInterface> mInt16OutputLink;
 #endif
 
     class AutoLockReentrant {
@@ -474,6 +491,10 @@ public:
                             bool pinned);
     status_t addEffect_l(const sp<EffectModule>& handle);
     status_t addEffect_ll(const sp<EffectModule>& handle);
+    void planBuffers_l();
+    // Links the int16 output of each effect to the next effect when possible and returns
+    // the number of links, see planBuffers_l().
+    static size_t linkInt16Outputs(const Vector< sp<EffectModule> >& effects);
     size_t removeEffect_l(const sp<EffectModule>& handle, bool release = false);
 
     audio_session_t sessionId() const { return mSessionId; }
@@ -503,6 +524,11 @@ public:
     effect_buffer_t *outBuffer() const {
         return mOutBuffer != 0 ? reinterpret_cast<effect_buffer_t*>(mOutBuffer->ptr()) : NULL;
     }
+    // Moves the chain and its effects from the current input and output buffers to new ones,
+    // which must be distinct if the current ones are. Must be called with ThreadBase::mLock
+    // held, while the chain is not processing.
+    void replaceBuffers_l(const sp<EffectBufferHalInterface>& inBuffer,
+                          const sp<EffectBufferHalInterface>& outBuffer);
 
     void incTrackCnt() { android_atomic_inc(&mTrackCnt); }
     void decTrackCnt() { android_atomic_dec(&mTrackCnt); }
@@ -24,6 +24,7 @@
 #include <audio_utils/primitives.h>
 
 #include "AudioFlinger.h"
+#include <cutils/properties.h>
 #include <media/AudioParameter.h>
 #include <media/AudioValidator.h>
 #include <media/DeviceDescriptorBase.h>
@@ -546,9 +547,23 @@ status_t AudioFlinger::PatchPanel::Patch::createConnections(PatchPanel *panel)
         outputFlags = (audio_output_flags_t) (outputFlags & ~AUDIO_OUTPUT_FLAG_FAST);
     }
 
+    // A PCM patch from a device to a playback thread dedicated to it needs no conversion when
+    // the input stream has the playback thread sample rate, channel count and format. Then the
+    // PlaybackThread reads the input stream directly into the buffer shared with the PatchTrack,
+    // as for direct patches, instead of the RecordThread reading it and copying to that buffer.
+    // The FastMixer and FastCapture threads must not be involved as the read blocks.
+    const bool useDirectPcmPatch =
+            property_get_bool("af.patch.direct_pcm", false /* default_value */)
+            && mAudioPatch.num_sources == 1 && mAudioPatch.num_sinks != 0
+            && audio_is_linear_pcm(inputFormat) && inputFormat == format
+            && sampleRate == mRecord.thread()->sampleRate()
+            && inChannelMask == mRecord.thread()->channelMask()
+            && !mRecord.thread()->hasFastCapture()
+            && !mPlayback.thread()->hasFastMixer();
+
     sp<RecordThread::PatchRecord> tempRecordTrack;
-    const bool usePassthruPatchRecord =
-            (inputFlags & AUDIO_INPUT_FLAG_DIRECT) && (outputFlags & AUDIO_OUTPUT_FLAG_DIRECT);
+    const bool usePassthruPatchRecord = useDirectPcmPatch ||
+            ((inputFlags & AUDIO_INPUT_FLAG_DIRECT) && (outputFlags & AUDIO_OUTPUT_FLAG_DIRECT));
     const size_t playbackFrameCount = mPlayback.thread()->frameCount();
     const size_t recordFrameCount = mRecord.thread()->frameCount();
     size_t frameCount = 0;
@@ -556,8 +571,8 @@ status_t AudioFlinger::PatchPanel::Patch::createConnections(PatchPanel *panel)
         // PassthruPatchRecord producesBufferOnDemand, so use
         // maximum of playback and record thread framecounts
         frameCount = std::max(playbackFrameCount, recordFrameCount);
-        ALOGV("%s() playframeCount %zu recordFrameCount %zu frameCount %zu",
-            __func__, playbackFrameCount, recordFrameCount, frameCount);
+        ALOGV("%s() playframeCount %zu recordFrameCount %zu frameCount %zu direct PCM %d",
+            __func__, playbackFrameCount, recordFrameCount, frameCount, useDirectPcmPatch);
         tempRecordTrack = new RecordThread::PassthruPatchRecord(
                                                  mRecord.thread().get(),
                                                  sampleRate,
@@ -712,6 +727,11 @@ String8 AudioFlinger::PatchPanel::Patch::dump(audio_patch_handle_t myHandle) con
     String8 result = String8::format("Patch %d: %s (thread %p => thread %p)",
             myHandle, isSoftware() ? "Software bridge between" : "No software bridge",
             mRecord.const_thread().get(), mPlayback.const_thread().get());
+    if (auto recordTrack = mRecord.const_track();
+            recordTrack != nullptr && recordTrack->producesBufferOnDemand()) {
+        // the playback thread reads the input stream
+        result.append(" direct");
+    }
 
     bool hasSinkDevice =
             mAudioPatch.num_sinks > 0 && mAudioPatch.sinks[0].type == AUDIO_PORT_TYPE_DEVICE;
@@ -160,30 +160,49 @@ public:
     /** Copy the track metadata in the provided iterator. Thread safe. */
     virtual void    copyMetadataTo(MetadataInserter& backInserter) const;
 
+            /** Haptic playback parameters, set by AudioFlinger and the vibrator service
+             *  without the thread lock. The mixer reads a copy polled by pollHapticState(). */
+            struct HapticState {
+                bool            mPlaybackEnabled = false; // haptic playback enabled or not
+                os::HapticScale mIntensity = os::HapticScale::MUTE; // intensity to play haptics
+                float           mMaxAmplitude = NAN; // max amplitude allowed for haptic data
+            };
+
             /** Return haptic playback of the track is enabled or not, used in mixer. */
-            bool    getHapticPlaybackEnabled() const { return mHapticPlaybackEnabled; }
+            bool    getHapticPlaybackEnabled() const { return mHapticState.mPlaybackEnabled; }
             /** Set haptic playback of the track is enabled or not, should be
              *  set after query or get callback from vibrator service */
             void    setHapticPlaybackEnabled(bool hapticPlaybackEnabled) {
-                mHapticPlaybackEnabled = hapticPlaybackEnabled;
+                mPublishedHapticState.update([hapticPlaybackEnabled](HapticState& state) {
+                    state.mPlaybackEnabled = hapticPlaybackEnabled;
+                });
             }
             /** Return at what intensity to play haptics, used in mixer. */
-            os::HapticScale getHapticIntensity() const { return mHapticIntensity; }
+            os::HapticScale getHapticIntensity() const { return mHapticState.mIntensity; }
             /** Return the maximum amplitude allowed for haptics data, used in mixer. */
-            float getHapticMaxAmplitude() const { return mHapticMaxAmplitude; }
+            float getHapticMaxAmplitude() const { return mHapticState.mMaxAmplitude; }
             /** Set intensity of haptic playback, should be set after querying vibrator service. */
             void    setHapticIntensity(os::HapticScale hapticIntensity) {
                 if (os::isValidHapticScale(hapticIntensity)) {
-                    mHapticIntensity = hapticIntensity;
-                    setHapticPlaybackEnabled(mHapticIntensity != os::HapticScale::MUTE);
+                    mPublishedHapticState.update([hapticIntensity](HapticState& state) {
+                        state.mIntensity = hapticIntensity;
+                        state.mPlaybackEnabled = hapticIntensity != os::HapticScale::MUTE;
+                    });
                 }
             }
             /** Set maximum amplitude allowed for haptic data, should be set after querying
              *  vibrator service.
              */
             void    setHapticMaxAmplitude(float maxAmplitude) {
-                mHapticMaxAmplitude = maxAmplitude;
+                mPublishedHapticState.update([maxAmplitude](HapticState& state) {
+                    state.mMaxAmplitude = maxAmplitude;
+                });
             }
+            /** Return the haptic parameters last set, which the mixer may not have polled yet. */
+            HapticState getPublishedHapticState() const { return mPublishedHapticState.get(); }
+            /** Copy the haptic parameters last set to the ones used by the mixer.
+             *  Return true if they changed. Called by the thread loop only. */
+            bool    pollHapticState() { return mPublishedHapticState.poll(mHapticState); }
             sp<os::ExternalVibration> getExternalVibration() const { return mExternalVibration; }
 
             // This function should be called with holding thread lock.
@@ -312,11 +331,9 @@ protected:
 
     sp<OpPlayAudioMonitor>  mOpPlayAudioMonitor;
 
-    bool                mHapticPlaybackEnabled = false; // indicates haptic playback enabled or not
-    // intensity to play haptic data
-    os::HapticScale mHapticIntensity = os::HapticScale::MUTE;
-    // max amplitude allowed for haptic data
-    float mHapticMaxAmplitude = NAN;
+    // haptic parameters as set, and the copy used by the thread loop
+    PublishedState<HapticState> mPublishedHapticState;
+    HapticState         mHapticState;
     class AudioVibrationController : public os::BnExternalVibrationController {
     public:
         explicit AudioVibrationController(Track* track) : mTrack(track) {}
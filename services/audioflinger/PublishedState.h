@@ -0,0 +1,64 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <android-base/thread_annotations.h>
+#include <media/nbaio/SingleStateQueue.h>
+#include <utils/Mutex.h>
+
+namespace android {
+
+// A state T written by binder threads and read by a thread loop that must not block on them.
+//
+// Writers change the state under a lock private to the PublishedState, then publish a copy
+// of it in a SingleStateQueue. The reader never takes that lock. It polls the latest copy,
+// so a state that is published twice before a poll is only seen once.
+template<typename T> class PublishedState {
+public:
+    PublishedState() = default;
+
+    // Applies f(T&) to the state and publishes the result. Called by writers.
+    template<typename F>
+    void update(F f) {
+        Mutex::Autolock _l(mLock);
+        f(mState);
+        mMutator.push(mState);
+    }
+
+    // Returns the last state set by a writer, published or not. Called by writers.
+    T get() const {
+        Mutex::Autolock _l(mLock);
+        return mState;
+    }
+
+    // Copies the latest published state to state and returns true if it changed
+    // since the previous poll. Never blocks. Called by the single reader.
+    bool poll(T& state) {
+        return mObserver.poll(state);
+    }
+
+private:
+    using Queue = SingleStateQueue<T>;
+
+    mutable Mutex           mLock;
+    T                       mState GUARDED_BY(mLock){};
+    typename Queue::Shared  mShared;
+    typename Queue::Mutator mMutator GUARDED_BY(mLock){&mShared};
+    typename Queue::Observer mObserver{&mShared};
+};
+
+}  // namespace android
@@ -119,6 +119,10 @@ private:
 
             // used by the record thread to convert frames to proper destination format
             RecordBufferConverter              *mRecordBufferConverter;
+
+            // non-null if the track reads the data of a ConverterGroup instead of
+            // converting with mRecordBufferConverter, accessed like mResamplerBufferProvider.
+            std::unique_ptr<ConverterGroup::Reader> mConverterGroupReader;
             audio_input_flags_t                mFlags;
 
             bool                               mSilenced;
@@ -190,7 +194,7 @@ public:
     void releaseBuffer(AudioBufferProvider::Buffer* buffer) override;
 
     // PatchProxyBufferProvider interface
-    // This interface is used from DirectOutputThread to acquire data from HAL.
+    // This interface is used from the PlaybackThread of the patch to acquire data from HAL.
     bool producesBufferOnDemand() const override { return true; }
     status_t obtainBuffer(Proxy::Buffer *buffer, const struct timespec *timeOut = nullptr) override;
     void releaseBuffer(Proxy::Buffer *buffer) override;
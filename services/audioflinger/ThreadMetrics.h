@@ -119,6 +119,12 @@ public:
         mDeviceLatencyMs.add(latencyMs);
     }
 
+    // Lateness of a threadLoop wakeup scheduled for an absolute deadline.
+    void logWakeupJitterMs(double jitterMs) {
+        std::lock_guard l(mLock);
+        mWakeupJitterMs.add(jitterMs);
+    }
+
     void logUnderrunFrames(size_t frames) {
         std::lock_guard l(mLock);
         if (mLastUnderrun == false && frames > 0) {
@@ -159,6 +165,9 @@ private:
             if (mDeviceLatencyMs.getN() > 0) {
                 item.set(AMEDIAMETRICS_PROP_DEVICELATENCYMS, mDeviceLatencyMs.getMean());
             }
+            if (mWakeupJitterMs.getN() > 0) {
+                item.set(AMEDIAMETRICS_PROP_WAKEUPJITTERMS, mWakeupJitterMs.getMean());
+            }
             if (mUnderrunCount > 0) {
                 item.set(AMEDIAMETRICS_PROP_UNDERRUN, (int32_t)mUnderrunCount)
                     .set(AMEDIAMETRICS_PROP_UNDERRUNFRAMES, (int64_t)mUnderrunFrames);
@@ -176,6 +185,7 @@ private:
         mDeviceTimeNs = 0;
 
         mDeviceLatencyMs.reset();
+        mWakeupJitterMs.reset();
 
         mLastUnderrun = false;
         mUnderrunCount = 0;
@@ -201,6 +211,9 @@ private:
     // latency and startup for each interval.
     audio_utils::Statistics<double> mDeviceLatencyMs GUARDED_BY(mLock);
 
+    // lateness of the predicted threadLoop wakeups for each interval.
+    audio_utils::Statistics<double> mWakeupJitterMs GUARDED_BY(mLock);
+
     // underrun count and frames
     bool              mLastUnderrun GUARDED_BY(mLock) = false; // checks consecutive underruns
     int64_t           mUnderrunCount GUARDED_BY(mLock) = 0;    // number of consecutive underruns
@@ -23,6 +23,8 @@
 #include "Configuration.h"
 #include <math.h>
 #include <fcntl.h>
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -163,6 +165,8 @@ static const nsecs_t kConfigEventTimeoutNs = seconds(2);
 static const uint32_t kMinThreadSleepTimeUs = 5000;
 // maximum divider applied to the active sleep time in the mixer thread loop
 static const uint32_t kMaxThreadSleepTimeShift = 2;
+// minimum sleep time for the mixer thread loop when the sleep is predicted from the HAL position
+static const uint32_t kMinPredictedSleepTimeUs = 1000;
 
 // minimum normal sink buffer size, expressed in milliseconds rather than frames
 // FIXME This should be based on experimentally observed scheduling jitter
@@ -2168,6 +2172,13 @@ AudioFlinger::PlaybackThread::PlaybackThread(const sp<AudioFlinger>& audioFlinge
     mStreamTypes[AUDIO_STREAM_PATCH].mute = false;
     mStreamTypes[AUDIO_STREAM_CALL_ASSISTANT].volume = 1.0f;
     mStreamTypes[AUDIO_STREAM_CALL_ASSISTANT].mute = false;
+
+    mVolumeState.update([this](VolumeState& state) {
+        state.mMasterVolume = mMasterVolume;
+        state.mMasterMute = mMasterMute;
+        std::copy(std::begin(mStreamTypes), std::end(mStreamTypes),
+                std::begin(state.mStreamTypes));
+    });
 }
 
 AudioFlinger::PlaybackThread::~PlaybackThread()
@@ -2737,14 +2748,12 @@ uint32_t AudioFlinger::PlaybackThread::latency_l() const
 
 void AudioFlinger::PlaybackThread::setMasterVolume(float value)
 {
-    Mutex::Autolock _l(mLock);
     // Don't apply master volume in SW if our HAL can do it for us.
     if (mOutput && mOutput->audioHwDev &&
         mOutput->audioHwDev->canSetMasterVolume()) {
-        mMasterVolume = 1.0;
-    } else {
-        mMasterVolume = value;
+        value = 1.0;
     }
+    mVolumeState.update([value](VolumeState& state) { state.mMasterVolume = value; });
 }
 
 void AudioFlinger::PlaybackThread::setMasterBalance(float balance)
@@ -2757,39 +2766,67 @@ void AudioFlinger::PlaybackThread::setMasterMute(bool muted)
     if (isDuplicating()) {
         return;
     }
-    Mutex::Autolock _l(mLock);
     // Don't apply master mute in SW if our HAL can do it for us.
     if (mOutput && mOutput->audioHwDev &&
         mOutput->audioHwDev->canSetMasterMute()) {
-        mMasterMute = false;
-    } else {
-        mMasterMute = muted;
+        muted = false;
     }
+    mVolumeState.update([muted](VolumeState& state) { state.mMasterMute = muted; });
+}
+
+// setSilentMode_l() must be called with ThreadBase::mLock held
+void AudioFlinger::PlaybackThread::setSilentMode_l()
+{
+    // Kept with the thread loop copies rather than published, so that the thread loop
+    // does not take the PublishedState lock and a later master mute cannot undo it.
+    mSilentMode = true;
+    mMasterMute = true;
 }
 
 void AudioFlinger::PlaybackThread::setStreamVolume(audio_stream_type_t stream, float value)
 {
-    Mutex::Autolock _l(mLock);
-    mStreamTypes[stream].volume = value;
-    broadcast_l();
+    mVolumeState.update([stream, value](VolumeState& state) {
+        state.mStreamTypes[stream].volume = value;
+    });
+    // Mixer threads pick up the new volume on their next cycle. Direct and offload
+    // threads may be waiting on the HAL and set the volume there, so wake them up.
+    if (mType == DIRECT || mType == OFFLOAD) {
+        Mutex::Autolock _l(mLock);
+        broadcast_l();
+    }
 }
 
 void AudioFlinger::PlaybackThread::setStreamMute(audio_stream_type_t stream, bool muted)
 {
-    Mutex::Autolock _l(mLock);
-    mStreamTypes[stream].mute = muted;
-    broadcast_l();
+    mVolumeState.update([stream, muted](VolumeState& state) {
+        state.mStreamTypes[stream].mute = muted;
+    });
+    if (mType == DIRECT || mType == OFFLOAD) {
+        Mutex::Autolock _l(mLock);
+        broadcast_l();
+    }
 }
 
 float AudioFlinger::PlaybackThread::streamVolume(audio_stream_type_t stream) const
 {
-    Mutex::Autolock _l(mLock);
-    return mStreamTypes[stream].volume;
+    return mVolumeState.get().mStreamTypes[stream].volume;
 }
 
-void AudioFlinger::PlaybackThread::setVolumeForOutput_l(float left, float right) const
+// updateVolumes_l() must be called from the thread loop, with ThreadBase::mLock held
+void AudioFlinger::PlaybackThread::updateVolumes_l()
 {
-    mOutput->stream->setVolume(left, right);
+    VolumeState state;
+    if (mVolumeState.poll(state)) {
+        mMasterVolume = state.mMasterVolume;
+        mMasterMute = state.mMasterMute || mSilentMode;
+        std::copy(std::begin(state.mStreamTypes), std::end(state.mStreamTypes),
+                std::begin(mStreamTypes));
+    }
+}
+
+status_t AudioFlinger::PlaybackThread::setVolumeForOutput_l(float left, float right) const
+{
+    return mOutput->stream->setVolume(left, right);
 }
 
 // addTrack_l() must be called with ThreadBase::mLock held
@@ -2849,8 +2886,8 @@ NO_THREAD_SAFETY_ANALYSIS  // release and re-acquire mLock
         if (mHapticChannelMask != AUDIO_CHANNEL_NONE
                 && ((track->channelMask() & AUDIO_CHANNEL_HAPTIC_ALL) != AUDIO_CHANNEL_NONE
                         || (chain != nullptr && chain->containsHapticGeneratingEffect_l()))) {
-            // Unlock due to VibratorService will lock for this call and will
-            // call Tracks.mute/unmute which also require thread's lock.
+            // Do not hold the thread lock across the call to VibratorService, which will
+            // call Tracks.mute/unmute from another thread.
             mLock.unlock();
             const os::HapticScale intensity = AudioFlinger::onExternalVibrationStart(
                     track->getExternalVibration());
@@ -2868,7 +2905,8 @@ NO_THREAD_SAFETY_ANALYSIS  // release and re-acquire mLock
             }
 
             // Haptic playback should be enabled by vibrator service.
-            if (track->getHapticPlaybackEnabled()) {
+            // The mixer has not polled the state just set yet.
+            if (track->getPublishedHapticState().mPlaybackEnabled) {
                 // Disable haptic playback of all active track to ensure only
                 // one track playing haptic if current track should play haptic.
                 for (const auto &t : mActiveTracks) {
@@ -3177,6 +3215,9 @@ void AudioFlinger::PlaybackThread::readOutputParameters_l()
     mThreadThrottleEndMs = 0;
     mHalfBufferMs = mNormalFrameCount * 1000 / (2 * mSampleRate);
 
+    // Check if we want to sleep until the HAL needs data when tracks are not ready
+    mPredictiveSleep = property_get_bool("af.thread.predictive_sleep", false /* default_value */);
+
     // mSinkBuffer is the sink buffer.  Size is always multiple-of-16 frames.
     // Originally this was int16_t[] array, need to remove legacy implications.
     free(mSinkBuffer);
@@ -3415,7 +3456,7 @@ void AudioFlinger::PlaybackThread::checkSilentMode_l()
                 ALOGD("Silence is golden");
                 // The setprop command will not allow a property to be changed after
                 // the first time it is set, so we don't have to worry about un-muting.
-                setMasterMute_l(true);
+                setSilentMode_l();
             }
         }
     }
@@ -4055,6 +4096,8 @@ NO_THREAD_SAFETY_ANALYSIS  // manual locking of AudioFlinger
                     continue;
                 }
             }
+            updateVolumes_l();
+
             // mMixerStatusIgnoringFastTracks is also updated internally
             mMixerStatus = prepareTracks_l(&tracksToRemove);
 
@@ -4205,7 +4248,7 @@ NO_THREAD_SAFETY_ANALYSIS  // manual locking of AudioFlinger
             // only process effects if we're going to write
             if (mSleepTimeUs == 0 && mType != OFFLOAD) {
                 for (size_t i = 0; i < effectChains.size(); i ++) {
-                    effectChains[i]->process_l();
+                    threadLoop_processEffectChain(effectChains[i]);
                     // TODO: Write haptic data directly to sink buffer when mixing.
                     if (activeHapticSessionId != AUDIO_SESSION_NONE
                             && activeHapticSessionId == effectChains[i]->sessionId()) {
@@ -4301,6 +4344,7 @@ NO_THREAD_SAFETY_ANALYSIS  // manual locking of AudioFlinger
         }
 
         // enable changes in effect chain
+        threadLoop_unlockingEffectChains();
         unlockEffectChains(effectChains);
 
         if (!metadataUpdate.playbackMetadataUpdate.empty()) {
@@ -4467,8 +4511,22 @@ NO_THREAD_SAFETY_ANALYSIS  // manual locking of AudioFlinger
                     mSleepTimeUs = deltaNs / 1000;
                 }
                 if (!mSignalPending && mConfigEvents.isEmpty() && !exitPending()) {
-                    mWaitWorkCV.waitRelative(mLock, microseconds((nsecs_t)mSleepTimeUs));
+                    if (mSleepDeadlineNs != 0 && !isSuspended()) {
+                        // Wait on the condition rather than sleeping until the deadline
+                        // so that config events still wake up the thread.
+                        const nsecs_t waitNs = mSleepDeadlineNs - systemTime();
+                        if (waitNs <= 0
+                                || mWaitWorkCV.waitRelative(mLock, waitNs) == TIMED_OUT) {
+                            const double jitterMs =
+                                    (systemTime() - mSleepDeadlineNs) * 1e-6;
+                            mWakeupJitterMs.add(jitterMs);
+                            mThreadMetrics.logWakeupJitterMs(jitterMs);
+                        }
+                    } else {
+                        mWaitWorkCV.waitRelative(mLock, microseconds((nsecs_t)mSleepTimeUs));
+                    }
                 }
+                mSleepDeadlineNs = 0;
                 ATRACE_END();
             }
         }
@@ -4505,6 +4563,11 @@ NO_THREAD_SAFETY_ANALYSIS  // manual locking of AudioFlinger
     return false;
 }
 
+void AudioFlinger::PlaybackThread::threadLoop_processEffectChain(const sp<EffectChain>& chain)
+{
+    chain->process_l();
+}
+
 void AudioFlinger::PlaybackThread::collectTimestamps_l()
 {
     if (mStandby) {
@@ -5285,6 +5348,29 @@ void AudioFlinger::MixerThread::threadLoop_mix()
 
 }
 
+nsecs_t AudioFlinger::MixerThread::predictWriteDeadlineNs() const
+{
+    // mTimestamp is only updated by collectTimestamps_l() on the threadLoop.
+    const nsecs_t kernelTimeNs = mTimestamp.mTimeNs[ExtendedTimestamp::LOCATION_KERNEL];
+    if (mStandby || isSuspended() || kernelTimeNs <= 0) {
+        return 0;
+    }
+    // A position older than two mixer periods no longer describes the HAL buffer,
+    // e.g. if the HAL does not report a presentation position while draining.
+    const nsecs_t periodNs = (nsecs_t)mNormalFrameCount * NANOS_PER_SECOND / mSampleRate;
+    if (systemTime() - kernelTimeNs > 2 * periodNs) {
+        return 0;
+    }
+    // Both positions are monotonic sink frame counts, and include mSuspendedFrames.
+    const int64_t queuedFrames = (int64_t)mFramesWritten
+            - mTimestamp.mPosition[ExtendedTimestamp::LOCATION_KERNEL];
+    if (queuedFrames <= 0) {
+        return 0;
+    }
+    return kernelTimeNs
+            + (queuedFrames - (int64_t)mNormalFrameCount) * NANOS_PER_SECOND / mSampleRate;
+}
+
 void AudioFlinger::MixerThread::threadLoop_sleepTime()
 {
     // If no tracks are ready, sleep once for the duration of an output
@@ -5305,16 +5391,28 @@ void AudioFlinger::MixerThread::threadLoop_sleepTime()
                         pipeFrames, framesLeft, framesDelay);
                 mSleepTimeUs = framesDelay * MICROS_PER_SECOND / mSampleRate;
             } else {
-                mSleepTimeUs = mActiveSleepTimeUs >> sleepTimeShift;
-                if (mSleepTimeUs < kMinThreadSleepTimeUs) {
-                    mSleepTimeUs = kMinThreadSleepTimeUs;
-                }
-                // reduce sleep time in case of consecutive application underruns to avoid
-                // starving the audio HAL. As activeSleepTimeUs() is larger than a buffer
-                // duration we would end up writing less data than needed by the audio HAL if
-                // the condition persists.
-                if (sleepTimeShift < kMaxThreadSleepTimeShift) {
-                    sleepTimeShift++;
+                const nsecs_t deadlineNs = mPredictiveSleep ? predictWriteDeadlineNs() : 0;
+                if (deadlineNs != 0) {
+                    // Retry when the HAL is about to need data rather than after a fraction of
+                    // the buffer period: the sleep is no longer than the legacy one, and a late
+                    // timestamp is caught up by the minimum sleep time before writing zeros.
+                    const nsecs_t nowNs = systemTime();
+                    mSleepDeadlineNs = std::clamp(deadlineNs,
+                            nowNs + microseconds((nsecs_t)kMinPredictedSleepTimeUs),
+                            nowNs + microseconds((nsecs_t)mActiveSleepTimeUs));
+                    mSleepTimeUs = (mSleepDeadlineNs - nowNs) / 1000;
+                } else {
+                    mSleepTimeUs = mActiveSleepTimeUs >> sleepTimeShift;
+                    if (mSleepTimeUs < kMinThreadSleepTimeUs) {
+                        mSleepTimeUs = kMinThreadSleepTimeUs;
+                    }
+                    // reduce sleep time in case of consecutive application underruns to avoid
+                    // starving the audio HAL. As activeSleepTimeUs() is larger than a buffer
+                    // duration we would end up writing less data than needed by the audio HAL
+                    // if the condition persists.
+                    if (sleepTimeShift < kMaxThreadSleepTimeShift) {
+                        sleepTimeShift++;
+                    }
                 }
             }
         } else {
@@ -5434,6 +5532,9 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
         // this const just means the local variable doesn't change
         Track* const track = t.get();
 
+        // haptic parameters set since the previous cycle, without mLock
+        track->pollHapticState();
+
         // process fast tracks
         if (track->isFastTrack()) {
             LOG_ALWAYS_FATAL_IF(mFastMixer.get() == nullptr,
@@ -5934,10 +6035,11 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                 trackId,
                 AudioMixer::TRACK,
                 AudioMixer::HAPTIC_INTENSITY, (void *)(uintptr_t)track->getHapticIntensity());
+            float hapticMaxAmplitude = track->getHapticMaxAmplitude();
             mAudioMixer->setParameter(
                 trackId,
                 AudioMixer::TRACK,
-                AudioMixer::HAPTIC_MAX_AMPLITUDE, (void *)(&(track->mHapticMaxAmplitude)));
+                AudioMixer::HAPTIC_MAX_AMPLITUDE, (void *)&hapticMaxAmplitude);
 
             // reset retry count
             track->mRetryCount = kMaxTrackRetries;
@@ -6281,6 +6383,10 @@ void AudioFlinger::MixerThread::dumpInternals_l(int fd, const Vector<String16>&
 {
     PlaybackThread::dumpInternals_l(fd, args);
     dprintf(fd, "  Thread throttle time (msecs): %u\n", mThreadThrottleTimeMs);
+    dprintf(fd, "  Predictive sleep: %s\n", mPredictiveSleep ? "on" : "off");
+    if (mWakeupJitterMs.getN() > 0) {
+        dprintf(fd, "  Wakeup jitter ms stats: %s\n", mWakeupJitterMs.toString().c_str());
+    }
     dprintf(fd, "  AudioMixer tracks: %s\n", mAudioMixer->trackNames().c_str());
     dprintf(fd, "  Master mono: %s\n", mMasterMono ? "on" : "off");
     dprintf(fd, "  Master balance: %f (%s)\n", mMasterBalance.load(),
@@ -6459,6 +6565,11 @@ void AudioFlinger::DirectOutputThread::dumpInternals_l(int fd, const Vector<Stri
     PlaybackThread::dumpInternals_l(fd, args);
     dprintf(fd, "  Master balance: %f  Left: %f  Right: %f\n",
             mMasterBalance.load(), mMasterBalanceLeft, mMasterBalanceRight);
+    if (mSoftwareVolume != nullptr) {
+        float left, right;
+        mSoftwareVolume->getVolume(&left, &right);
+        dprintf(fd, "  Software volume: Left: %f  Right: %f\n", left, right);
+    }
 }
 
 void AudioFlinger::DirectOutputThread::setMasterBalance(float balance)
@@ -6528,6 +6639,11 @@ void AudioFlinger::DirectOutputThread::processVolume_l(Track *track, bool lastTr
 
     if (lastTrack) {
         track->setFinalVolume(left, right);
+        if (mSoftwareVolume != nullptr && !mEffectChains.isEmpty()) {
+            // An effect chain was added, hand the volume over to it.
+            mSoftwareVolume.reset();
+            mLeftVolFloat = mRightVolFloat = -1.0;
+        }
         if (left != mLeftVolFloat || right != mRightVolFloat) {
             mLeftVolFloat = left;
             mRightVolFloat = right;
@@ -6542,9 +6658,22 @@ void AudioFlinger::DirectOutputThread::processVolume_l(Track *track, bool lastTr
                 uint32_t vr = (uint32_t)(right * (1 << 24));
                 // Direct/Offload effect chains set output volume in setVolume_l().
                 (void)mEffectChains[0]->setVolume_l(&vl, &vr);
+            } else if (setVolumeForOutput_l(left, right) == NO_ERROR
+                    || !audio_is_linear_pcm(mFormat)) {
+                // otherwise we directly set the volume, the HAL applies it.
+                if (mSoftwareVolume != nullptr) {
+                    ALOGD("%s: HAL volume control available, stop using software volume",
+                            __func__);
+                    mSoftwareVolume.reset();
+                }
             } else {
-                // otherwise we directly set the volume.
-                setVolumeForOutput_l(left, right);
+                // or in software if the HAL cannot.
+                if (mSoftwareVolume == nullptr) {
+                    ALOGD("%s: HAL volume control not available, using software volume",
+                            __func__);
+                    mSoftwareVolume = std::make_unique<VolumeRamp>(mFormat, mChannelCount);
+                }
+                mSoftwareVolume->setVolume(left, right);
             }
         }
     }
@@ -6820,6 +6949,10 @@ void AudioFlinger::DirectOutputThread::threadLoop_mix()
         mActiveTrack->releaseBuffer(&buffer);
     }
     mCurrentWriteLength = curBuf - (int8_t *)mSinkBuffer;
+    if (mSoftwareVolume != nullptr) {
+        // volume changes are ramped over the frames written in this period.
+        mSoftwareVolume->process(mSinkBuffer, mCurrentWriteLength / mFrameSize);
+    }
     mSleepTimeUs = 0;
     mStandbyTimeNs = systemTime() + mStandbyDelayNs;
     mActiveTrack.clear();
@@ -7426,17 +7559,170 @@ void AudioFlinger::OffloadThread::invalidateTracks(std::set<audio_port_handle_t>
 
 // ----------------------------------------------------------------------------
 
+AudioFlinger::OutputTrackWriteThread::OutputTrackWriteThread(
+        const sp<PlaybackThread::OutputTrack>& outputTrack, size_t bufferSize)
+    :   Thread(false /*canCallJava*/),
+        mOutputTrack(outputTrack)
+{
+    for (auto& buffer : mQueue) {
+        buffer.mData.resize(bufferSize);
+    }
+}
+
+AudioFlinger::OutputTrackWriteThread::~OutputTrackWriteThread()
+{
+}
+
+void AudioFlinger::OutputTrackWriteThread::onFirstRef()
+{
+    run("OutputTrack Write", ANDROID_PRIORITY_URGENT_AUDIO);
+}
+
+bool AudioFlinger::OutputTrackWriteThread::threadLoop()
+{
+    while (!exitPending()) {
+        {
+            Mutex::Autolock _l(mLock);
+            while (queuedCount() == 0
+                    && !mStopRequested.load(std::memory_order_acquire)
+                    && !exitPending()) {
+                mWorkCV.wait(mLock);
+            }
+            if (exitPending()) {
+                break;
+            }
+        }
+
+        const uint32_t front = mFront.load(std::memory_order_relaxed);
+        if (mStopRequested.load(std::memory_order_acquire)
+                && front == mStopRear.load(std::memory_order_relaxed)) {
+            mStopRequested.store(false, std::memory_order_relaxed);
+            mOutputTrack->stop();
+            continue;
+        }
+        if (queuedCount() == 0) {
+            continue;
+        }
+
+        QueuedBuffer& buffer = mQueue[front & (kQueueSize - 1)];
+        (void)mOutputTrack->write(buffer.mData.data(), buffer.mFrames);
+        const nsecs_t latenessNs = systemTime() - buffer.mDeadlineNs;
+        mFront.store(front + 1, std::memory_order_release);
+
+        Mutex::Autolock _l(mLock);
+        mWrittenCount++;
+        const double latenessMs = std::max(latenessNs, (nsecs_t)0) * 1e-6;
+        size_t bucket = 0;
+        while (bucket < std::size(kLatenessBucketMs) && latenessMs > kLatenessBucketMs[bucket]) {
+            bucket++;
+        }
+        mLatenessHistogram[bucket]++;
+        mLatenessMs.add(latenessMs);
+        mWrittenCV.broadcast();
+    }
+    return false;
+}
+
+void AudioFlinger::OutputTrackWriteThread::exit()
+{
+    {
+        Mutex::Autolock _l(mLock);
+        requestExit();
+        mWorkCV.broadcast();
+        mWrittenCV.broadcast();
+    }
+    // Wait for the write in progress so that the caller can destroy the OutputTrack.
+    requestExitAndWait();
+}
+
+bool AudioFlinger::OutputTrackWriteThread::push(
+        const void *data, uint32_t frames, size_t frameSize, nsecs_t deadlineNs)
+{
+    const uint32_t rear = mRear.load(std::memory_order_relaxed);
+    if (rear - mFront.load(std::memory_order_acquire) == kQueueSize) {
+        mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // The buffer at rear is not read by this thread until mRear is incremented.
+    // It was allocated by the constructor, push() runs on the mixer thread.
+    QueuedBuffer& buffer = mQueue[rear & (kQueueSize - 1)];
+    ALOG_ASSERT(frames * frameSize <= buffer.mData.size(), "%s: %u frames do not fit in %zu bytes",
+            __func__, frames, buffer.mData.size());
+    frames = std::min(frames, (uint32_t)(buffer.mData.size() / frameSize));
+    memcpy(buffer.mData.data(), data, frames * frameSize);
+    buffer.mFrames = frames;
+    buffer.mDeadlineNs = deadlineNs;
+    mRear.store(rear + 1, std::memory_order_release);
+
+    Mutex::Autolock _l(mLock);
+    mWorkCV.signal();
+    return true;
+}
+
+bool AudioFlinger::OutputTrackWriteThread::waitWritten(nsecs_t deadlineNs)
+{
+    Mutex::Autolock _l(mLock);
+    while (queuedCount() != 0 && !exitPending()) {
+        const nsecs_t nowNs = systemTime();
+        if (nowNs >= deadlineNs) {
+            return false;
+        }
+        mWrittenCV.waitRelative(mLock, deadlineNs - nowNs);
+    }
+    return queuedCount() == 0;
+}
+
+void AudioFlinger::OutputTrackWriteThread::requestStop()
+{
+    mStopRear.store(mRear.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    mStopRequested.store(true, std::memory_order_release);
+
+    Mutex::Autolock _l(mLock);
+    mWorkCV.signal();
+}
+
+std::string AudioFlinger::OutputTrackWriteThread::dump() const
+{
+    std::stringstream ss;
+    Mutex::Autolock _l(mLock);
+    ss << "written " << mWrittenCount
+            << " dropped " << mDroppedCount.load(std::memory_order_relaxed)
+            << " queued " << queuedCount() << "\n      lateness histogram ms:";
+    for (size_t i = 0; i < kLatenessBucketCount; i++) {
+        if (i == 0) {
+            ss << " on time: ";
+        } else if (i < std::size(kLatenessBucketMs)) {
+            ss << " <=" << kLatenessBucketMs[i] << ": ";
+        } else {
+            ss << " >" << kLatenessBucketMs[i - 1] << ": ";
+        }
+        ss << mLatenessHistogram[i];
+    }
+    if (mLatenessMs.getN() > 0) {
+        ss << "\n      lateness ms stats: " << mLatenessMs.toString();
+    }
+    return ss.str();
+}
+
+// ----------------------------------------------------------------------------
+
 AudioFlinger::DuplicatingThread::DuplicatingThread(const sp<AudioFlinger>& audioFlinger,
         AudioFlinger::MixerThread* mainThread, audio_io_handle_t id, bool systemReady)
     :   MixerThread(audioFlinger, mainThread->getOutput(), id,
                     systemReady, DUPLICATING),
-        mWaitTimeMs(UINT_MAX)
+        mWaitTimeMs(UINT_MAX),
+        mParallelWrite(property_get_bool("af.duplicating.parallel_write",
+                false /* default_value */))
 {
     addOutputTrack(mainThread);
 }
 
 AudioFlinger::DuplicatingThread::~DuplicatingThread()
 {
+    // Join the writers before destroying the OutputTracks they write to.
+    for (const auto& [outputTrack, writer] : mOutputWriters) {
+        writer->exit();
+    }
     for (size_t i = 0; i < mOutputTracks.size(); i++) {
         mOutputTracks[i]->destroy();
     }
@@ -7482,6 +7768,9 @@ void AudioFlinger::DuplicatingThread::threadLoop_sleepTime()
 
 ssize_t AudioFlinger::DuplicatingThread::threadLoop_write()
 {
+    if (mParallelWrite) {
+        return threadLoop_writeParallel();
+    }
     for (size_t i = 0; i < outputTracks.size(); i++) {
         const ssize_t actualWritten = outputTracks[i]->write(mSinkBuffer, writeFrames);
 
@@ -7508,9 +7797,62 @@ ssize_t AudioFlinger::DuplicatingThread::threadLoop_write()
     return (ssize_t)mSinkBufferSize;
 }
 
+ssize_t AudioFlinger::DuplicatingThread::threadLoop_writeParallel()
+{
+    // Each output is expected to write this buffer before the next one is mixed.
+    const nsecs_t nowNs = systemTime();
+    const nsecs_t writeDeadlineNs = nowNs + (nsecs_t)mNormalFrameCount * NANOS_PER_SECOND
+            / mSampleRate;
+
+    // Outputs which have not written the buffers of the previous cycles yet are late and
+    // are not waited for: their queue absorbs a few buffers before dropping any.
+    mOnTimeWriters.clear();
+    for (size_t i = 0; i < outputWriters.size(); i++) {
+        OutputTrackWriteThread *writer = outputWriters[i].get();
+        const bool onTime = !writer->isBackedUp();
+        const bool queued = writer->push(mSinkBuffer, writeFrames, mFrameSize, writeDeadlineNs);
+        if (onTime) {
+            mOnTimeWriters.push_back(writer);
+        }
+
+        // Consider the first OutputTrack for timestamp and frame counting,
+        // see threadLoop_write().
+        if (i == 0) {
+            const ssize_t actualWritten = queued ? writeFrames : 0;
+            const ssize_t correction = mSinkBufferSize / mFrameSize - actualWritten;
+            ALOGD_IF(correction != 0 && writeFrames != 0,
+                    "%s: writeFrames:%u  actualWritten:%zd  correction:%zd  mFramesWritten:%lld",
+                    __func__, writeFrames, actualWritten, correction, (long long)mFramesWritten);
+            mFramesWritten -= correction;
+        }
+    }
+    // The on time outputs pace the mix like blocking writes do, or the first output
+    // when all are late.
+    if (mOnTimeWriters.empty() && !outputWriters.empty()) {
+        mOnTimeWriters.push_back(outputWriters[0].get());
+    }
+    const nsecs_t waitDeadlineNs = nowNs + (nsecs_t)mWaitTimeMs * NANOS_PER_MILLISECOND;
+    for (OutputTrackWriteThread *writer : mOnTimeWriters) {
+        (void)writer->waitWritten(waitDeadlineNs);
+    }
+
+    if (mStandby) {
+        mThreadMetrics.logBeginInterval();
+        mThreadSnapshot.onBegin();
+        mStandby = false;
+    }
+    return (ssize_t)mSinkBufferSize;
+}
+
 void AudioFlinger::DuplicatingThread::threadLoop_standby()
 {
     // DuplicatingThread implements standby by stopping all tracks
+    if (mParallelWrite) {
+        for (const auto& writer : outputWriters) {
+            writer->requestStop();
+        }
+        return;
+    }
     for (size_t i = 0; i < outputTracks.size(); i++) {
         outputTracks[i]->stop();
     }
@@ -7537,6 +7879,12 @@ void AudioFlinger::DuplicatingThread::dumpInternals_l(int fd, const Vector<Strin
         }
     }
     ss << "\n";
+    if (mParallelWrite) {
+        ss << "  Parallel writes:\n";
+        for (const auto& [outputTrack, writer] : mOutputWriters) {
+            ss << "    OutputTrack " << outputTrack->id() << ": " << writer->dump() << "\n";
+        }
+    }
     std::string result = ss.str();
     write(fd, result.c_str(), result.size());
 }
@@ -7544,11 +7892,20 @@ void AudioFlinger::DuplicatingThread::dumpInternals_l(int fd, const Vector<Strin
 void AudioFlinger::DuplicatingThread::saveOutputTracks()
 {
     outputTracks = mOutputTracks;
+    outputWriters.clear();
+    if (mParallelWrite) {
+        for (size_t i = 0; i < outputTracks.size(); i++) {
+            if (auto it = mOutputWriters.find(outputTracks[i]); it != mOutputWriters.end()) {
+                outputWriters.push_back(it->second);
+            }
+        }
+    }
 }
 
 void AudioFlinger::DuplicatingThread::clearOutputTracks()
 {
     outputTracks.clear();
+    outputWriters.clear();
 }
 
 void AudioFlinger::DuplicatingThread::addOutputTrack(MixerThread *thread)
@@ -7584,25 +7941,48 @@ void AudioFlinger::DuplicatingThread::addOutputTrack(MixerThread *thread)
     }
     thread->setStreamVolume(AUDIO_STREAM_PATCH, 1.0f);
     mOutputTracks.add(outputTrack);
+    if (mParallelWrite) {
+        mOutputWriters.emplace(outputTrack,
+                sp<OutputTrackWriteThread>::make(outputTrack, mSinkBufferSize));
+    }
     ALOGV("addOutputTrack() track %p, on thread %p", outputTrack.get(), thread);
     updateWaitTime_l();
 }
 
 void AudioFlinger::DuplicatingThread::removeOutputTrack(MixerThread *thread)
 {
-    Mutex::Autolock _l(mLock);
-    for (size_t i = 0; i < mOutputTracks.size(); i++) {
-        if (mOutputTracks[i]->thread() == thread) {
-            mOutputTracks[i]->destroy();
-            mOutputTracks.removeAt(i);
-            updateWaitTime_l();
-            if (thread->getOutput() == mOutput) {
-                mOutput = NULL;
+    sp<OutputTrack> outputTrack;
+    sp<OutputTrackWriteThread> writer;
+    {
+        Mutex::Autolock _l(mLock);
+        for (size_t i = 0; i < mOutputTracks.size(); i++) {
+            if (mOutputTracks[i]->thread() == thread) {
+                outputTrack = mOutputTracks[i];
+                if (auto it = mOutputWriters.find(outputTrack); it != mOutputWriters.end()) {
+                    writer = it->second;
+                    mOutputWriters.erase(it);
+                }
+                mOutputTracks.removeAt(i);
+                updateWaitTime_l();
+                if (thread->getOutput() == mOutput) {
+                    mOutput = NULL;
+                }
+                break;
             }
-            return;
         }
     }
-    ALOGV("removeOutputTrack(): unknown thread: %p", thread);
+    if (outputTrack == nullptr) {
+        ALOGV("removeOutputTrack(): unknown thread: %p", thread);
+        return;
+    }
+    // The writer may be writing to the OutputTrack. Join it without holding mLock, so that
+    // the threadLoop keeps mixing for the other outputs, then destroy the OutputTrack.
+    // The threadLoop may still push to the writer until its next saveOutputTracks(),
+    // those buffers are never written.
+    if (writer != nullptr) {
+        writer->exit();
+    }
+    outputTrack->destroy();
 }
 
 // caller must hold mLock
@@ -7663,12 +8043,93 @@ void AudioFlinger::DuplicatingThread::cacheParameters_l()
 
 // ----------------------------------------------------------------------------
 
+AudioFlinger::SpatializerProcessThread::SpatializerProcessThread()
+    :   Thread(false /*canCallJava*/)
+{
+}
+
+void AudioFlinger::SpatializerProcessThread::onFirstRef()
+{
+    run("Spatializer Process", ANDROID_PRIORITY_URGENT_AUDIO);
+}
+
+bool AudioFlinger::SpatializerProcessThread::threadLoop()
+{
+    while (!exitPending()) {
+        sp<EffectChain> chain;
+        {
+            Mutex::Autolock _l(mLock);
+            while (mChain == nullptr && !exitPending()) {
+                mWorkCV.wait(mLock);
+            }
+            if (exitPending()) {
+                break;
+            }
+            chain = mChain;
+        }
+
+        const nsecs_t startNs = systemTime();
+        chain->process_l();
+        const double processTimeMs = (systemTime() - startNs) * 1e-6;
+
+        Mutex::Autolock _l(mLock);
+        mChain.clear();
+        mProcessedCount++;
+        mProcessTimeMs.add(processTimeMs);
+        mDoneCV.broadcast();
+    }
+    return false;
+}
+
+void AudioFlinger::SpatializerProcessThread::exit()
+{
+    Mutex::Autolock _l(mLock);
+    requestExit();
+    mWorkCV.broadcast();
+    mDoneCV.broadcast();
+}
+
+void AudioFlinger::SpatializerProcessThread::start(const sp<EffectChain>& chain)
+{
+    Mutex::Autolock _l(mLock);
+    mChain = chain;
+    mWorkCV.signal();
+}
+
+void AudioFlinger::SpatializerProcessThread::wait()
+{
+    const nsecs_t startNs = systemTime();
+    Mutex::Autolock _l(mLock);
+    while (mChain != nullptr && !exitPending()) {
+        mDoneCV.wait(mLock);
+    }
+    mWaitTimeMs.add((systemTime() - startNs) * 1e-6);
+}
+
+std::string AudioFlinger::SpatializerProcessThread::dump() const
+{
+    std::stringstream ss;
+    Mutex::Autolock _l(mLock);
+    ss << "processed " << mProcessedCount;
+    if (mProcessTimeMs.getN() > 0) {
+        ss << "\n    process time ms stats: " << mProcessTimeMs.toString();
+    }
+    if (mWaitTimeMs.getN() > 0) {
+        ss << "\n    wait time ms stats: " << mWaitTimeMs.toString();
+    }
+    return ss.str();
+}
+
+// ----------------------------------------------------------------------------
+
 AudioFlinger::SpatializerThread::SpatializerThread(const sp<AudioFlinger>& audioFlinger,
                                                              AudioStreamOut* output,
                                                              audio_io_handle_t id,
                                                              bool systemReady,
                                                              audio_config_base_t *mixerConfig)
-    : MixerThread(audioFlinger, output, id, systemReady, SPATIALIZER, mixerConfig)
+    : MixerThread(audioFlinger, output, id, systemReady, SPATIALIZER, mixerConfig),
+      mPipelineRequested(property_get_bool("af.spatializer.pipelined",
+              false /* default_value */))
 {
 }
 
@@ -7685,6 +8146,205 @@ void AudioFlinger::SpatializerThread::onFirstRef() {
             stream()->setHalThreadPriority(priorityBoost);
         }
     }
+
+    // The process thread idles until the pipelined mode is requested, so that it can be
+    // enabled at any time with the same priority as this thread.
+    mProcessThread = new SpatializerProcessThread();
+    const pid_t processTid = mProcessThread->getTid();
+    if (processTid == -1) {
+        ALOGW("%s: Cannot update Spatializer process thread priority, not running", __func__);
+    } else {
+        (void)requestSpatializerPriority(getpid(), processTid);
+    }
+}
+
+bool AudioFlinger::SpatializerThread::checkForNewParameter_l(const String8& keyValuePair,
+                                                            status_t& status)
+{
+    static const String8 kPipelinedKey("spatializer_pipelined");
+    AudioParameter param = AudioParameter(keyValuePair);
+    String8 value;
+    if (param.get(kPipelinedKey, value) != NO_ERROR) {
+        return MixerThread::checkForNewParameter_l(keyValuePair, status);
+    }
+    // The pipeline is updated by the next prepareTracks_l().
+    mPipelineRequested = value == AudioParameter::valueTrue;
+    ALOGD("%s: thread(%d) pipelined processing %s", __func__, mId,
+            mPipelineRequested ? "requested" : "disabled");
+    param.remove(kPipelinedKey);
+    if (param.size() == 0) {
+        status = NO_ERROR;
+        return false;
+    }
+    return MixerThread::checkForNewParameter_l(param.toString(), status);
+}
+
+void AudioFlinger::SpatializerThread::dumpInternals_l(int fd, const Vector<String16>& args)
+{
+    MixerThread::dumpInternals_l(fd, args);
+    dprintf(fd, "  Pipelined processing: %s%s\n", mPipelineChain != nullptr ? "on" : "off",
+            mPipelineRequested && mPipelineChain == nullptr ? " (requested)" : "");
+    if (mProcessThread != nullptr) {
+        dprintf(fd, "  Spatializer process thread: %s\n", mProcessThread->dump().c_str());
+    }
+}
+
+AudioFlinger::PlaybackThread::mixer_state AudioFlinger::SpatializerThread::prepareTracks_l(
+        Vector<sp<Track>> *tracksToRemove)
+{
+    updatePipeline_l();
+    return MixerThread::prepareTracks_l(tracksToRemove);
+}
+
+void AudioFlinger::SpatializerThread::updatePipeline_l()
+{
+    // The period started by threadLoop_mix() is collected by threadLoop_processEffectChain()
+    // or threadLoop_unlockingEffectChains() in the same loop, while the effect chains are locked.
+    if (mPipelineStarted) {
+        ALOGW("%s: thread(%d) spatializer period not collected", __func__, mId);
+        mProcessThread->wait();
+        mPipelineStarted = false;
+    }
+
+    // Haptic channels are copied from mEffectBuffer after effects processing,
+    // they would not be delayed with the spatialized channels.
+    sp<EffectChain> chain;
+    if (mPipelineRequested && mProcessThread != nullptr && mHapticChannelCount == 0
+            && mEffectBufferFormat == AUDIO_FORMAT_PCM_FLOAT) {
+        chain = getEffectChain_l(AUDIO_SESSION_OUTPUT_STAGE);
+    }
+    // The chain leaves the pipeline buffers if it is removed or moved, including by
+    // readOutputParameters_l() when the buffers are reallocated.
+    const bool chainInPipeline = mPipelineChain != nullptr && mPipelineInBuffer != nullptr
+            && mPipelineChain->inBuffer() == mPipelineInBuffer->ptr();
+    if (chain != nullptr && chain == mPipelineChain && chainInPipeline) {
+        return;
+    }
+
+    if (mPipelineChain != nullptr) {
+        if (chainInPipeline && mPipelineChain == getEffectChain_l(AUDIO_SESSION_OUTPUT_STAGE)) {
+            // Back to the buffers set by addEffectChain_l(), the period in the pipeline is lost.
+            sp<EffectBufferHalInterface> halInBuffer, halOutBuffer;
+            status_t result = mAudioFlinger->mEffectsFactoryHal->mirrorBuffer(
+                    mEffectBuffer, mEffectBufferSize, &halInBuffer);
+            if (result == OK) {
+                result = mAudioFlinger->mEffectsFactoryHal->mirrorBuffer(
+                        mPostSpatializerBuffer, mPostSpatializerBufferSize, &halOutBuffer);
+            }
+            if (result != OK) {
+                // Keep processing in the pipeline buffers, without the process thread.
+                ALOGW("%s: cannot restore spatializer chain buffers: %d", __func__, result);
+                return;
+            }
+            mPipelineChain->replaceBuffers_l(halInBuffer, halOutBuffer);
+        }
+        mPipelineChain.clear();
+        ALOGD("%s: thread(%d) pipelined processing off", __func__, mId);
+    }
+    if (chain == nullptr) {
+        return;
+    }
+
+    if (mPipelineInBuffer == nullptr || mPipelineInBuffer->getSize() != mEffectBufferSize
+            || mPipelineOutBuffer->getSize() != mPostSpatializerBufferSize) {
+        mPipelineInBuffer.clear();
+        mPipelineOutBuffer.clear();
+        status_t result = mAudioFlinger->mEffectsFactoryHal->allocateBuffer(
+                mEffectBufferSize, &mPipelineInBuffer);
+        if (result == OK) {
+            result = mAudioFlinger->mEffectsFactoryHal->allocateBuffer(
+                    mPostSpatializerBufferSize, &mPipelineOutBuffer);
+        }
+        if (result != OK) {
+            ALOGW("%s: cannot allocate spatializer pipeline buffers: %d", __func__, result);
+            mPipelineInBuffer.clear();
+            mPipelineOutBuffer.clear();
+            return;
+        }
+    }
+    mDelayedPostSpatializerBuffer.resize(mNormalFrameCount * mChannelCount);
+    clearPipeline();
+    chain->replaceBuffers_l(mPipelineInBuffer, mPipelineOutBuffer);
+    mPipelineChain = chain;
+    ALOGD("%s: thread(%d) pipelined processing on", __func__, mId);
+}
+
+void AudioFlinger::SpatializerThread::clearPipeline()
+{
+    if (mPipelineInBuffer == nullptr) {
+        return;
+    }
+    memset(mPipelineInBuffer->audioBuffer()->raw, 0, mPipelineInBuffer->getSize());
+    memset(mPipelineOutBuffer->audioBuffer()->raw, 0, mPipelineOutBuffer->getSize());
+    std::fill(mDelayedPostSpatializerBuffer.begin(), mDelayedPostSpatializerBuffer.end(), 0.f);
+}
+
+void AudioFlinger::SpatializerThread::threadLoop_mix()
+{
+    // Process the previous period while mixing this one, unless this period is discarded
+    // without processing effects, see PlaybackThread::threadLoop().
+    if (mPipelineChain != nullptr && !isSuspended()) {
+        mProcessThread->start(mPipelineChain);
+        mPipelineStarted = true;
+    }
+    MixerThread::threadLoop_mix();
+}
+
+void AudioFlinger::SpatializerThread::threadLoop_unlockingEffectChains()
+{
+    // threadLoop_processEffectChain() was skipped, e.g. because the thread was suspended
+    // after threadLoop_mix() started the period: the chain must not be processed once
+    // unlocked. The period is discarded, as is the output of a suspended thread.
+    if (mPipelineStarted) {
+        mProcessThread->wait();
+        mPipelineStarted = false;
+        clearPipeline();
+    }
+}
+
+void AudioFlinger::SpatializerThread::threadLoop_standby()
+{
+    MixerThread::threadLoop_standby();
+    // Do not play the last period before standby when resuming.
+    clearPipeline();
+}
+
+void AudioFlinger::SpatializerThread::threadLoop_exit()
+{
+    if (mProcessThread != nullptr) {
+        mProcessThread->exit();
+        mProcessThread->requestExitAndWait();
+    }
+    MixerThread::threadLoop_exit();
+}
+
+void AudioFlinger::SpatializerThread::threadLoop_processEffectChain(
+        const sp<EffectChain>& chain)
+{
+    if (chain != mPipelineChain) {
+        MixerThread::threadLoop_processEffectChain(chain);
+        return;
+    }
+    if (mPipelineStarted) {
+        mProcessThread->wait();
+        mPipelineStarted = false;
+    } else {
+        // No track was mixed, keep the pipeline going.
+        chain->process_l();
+    }
+
+    // Output the previous period: its spatialized channels accumulated by the chain and its
+    // channels that are not spatialized. Then queue this period for the next loop.
+    float *postSpatializer = static_cast<float *>(mPostSpatializerBuffer);
+    float *delayed = mDelayedPostSpatializerBuffer.data();
+    float *spatialized = mPipelineOutBuffer->audioBuffer()->f32;
+    for (size_t i = 0; i < mDelayedPostSpatializerBuffer.size(); i++) {
+        const float current = postSpatializer[i];
+        postSpatializer[i] = delayed[i] + spatialized[i];
+        delayed[i] = current;
+    }
+    memset(spatialized, 0, mPipelineOutBuffer->getSize());
+    memcpy(mPipelineInBuffer->audioBuffer()->raw, mEffectBuffer, mEffectBufferSize);
 }
 
 void AudioFlinger::SpatializerThread::setHalLatencyMode_l() {
@@ -7814,6 +8474,8 @@ AudioFlinger::RecordThread::RecordThread(const sp<AudioFlinger>& audioFlinger,
     // mFastCaptureNBLogWriter
     , mFastTrackAvail(false)
     , mBtNrecSuspended(false)
+    , mConverterGroupsEnabled(property_get_bool("af.record.converter_groups",
+            false /* default_value */))
 {
     snprintf(mThreadName, kThreadNameLength, "AudioIn_%X", id);
     mNBLogWriter = audioFlinger->newWriter_l(kLogSize, mThreadName);
@@ -8076,6 +8738,8 @@ reacquire_wakelock:
                 case TrackBase::PAUSING:
                     mActiveTracks.remove(activeTrack);
                     activeTrack->mState = TrackBase::PAUSED;
+                    // leave the ConverterGroup, so that it can be dissolved
+                    activeTrack->mConverterGroupReader.reset();
                     doBroadcast = true;
                     size--;
                     continue;
@@ -8384,6 +9048,10 @@ reacquire_wakelock:
         }
         mRsmpInRear = audio_utils::safe_add_overflow(mRsmpInRear, (int32_t)framesRead);
 
+        if (mConverterGroupsEnabled) {
+            processConverterGroups(activeTracks);
+        }
+
         size = activeTracks.size();
 
         // loop over each active track
@@ -8404,6 +9072,13 @@ reacquire_wakelock:
                 OVERRUN_FALSE
             } overrun = OVERRUN_UNKNOWN;
 
+            // A track in a ConverterGroup reads the data already converted by the group.
+            ResamplerBufferProvider * const provider =
+                    activeTrack->mConverterGroupReader != nullptr ?
+                            activeTrack->mConverterGroupReader.get() :
+                            activeTrack->mResamplerBufferProvider;
+            const bool converted = provider != activeTrack->mResamplerBufferProvider;
+
             // loop over getNextBuffer to handle circular sink
             for (;;) {
 
@@ -8416,7 +9091,7 @@ reacquire_wakelock:
                 // if the record track isn't draining fast enough.
                 bool hasOverrun;
                 size_t framesIn;
-                activeTrack->mResamplerBufferProvider->sync(&framesIn, &hasOverrun);
+                provider->sync(&framesIn, &hasOverrun);
                 if (hasOverrun) {
                     overrun = OVERRUN_TRUE;
                 }
@@ -8428,24 +9103,26 @@ reacquire_wakelock:
                 // from framesIn.
                 // This isn't strictly necessary but helps limit buffer resizing in
                 // RecordBufferConverter.  TODO: remove when no longer needed.
-                framesOut = min(framesOut,
+                framesOut = min(framesOut, converted ? framesIn :
                         destinationFramesPossible(
                                 framesIn, mSampleRate, activeTrack->mSampleRate));
 
-                if (activeTrack->isDirect()) {
+                if (activeTrack->isDirect() || converted) {
                     // No RecordBufferConverter used for direct streams. Pass
                     // straight from RecordThread buffer to RecordTrack buffer.
+                    // Likewise from the ConverterGroup buffer.
                     AudioBufferProvider::Buffer buffer;
                     buffer.frameCount = framesOut;
-                    const status_t getNextBufferStatus =
-                            activeTrack->mResamplerBufferProvider->getNextBuffer(&buffer);
+                    const status_t getNextBufferStatus = provider->getNextBuffer(&buffer);
                     if (getNextBufferStatus == OK && buffer.frameCount != 0) {
                         ALOGV_IF(buffer.frameCount != framesOut,
                                 "%s() read less than expected (%zu vs %zu)",
                                 __func__, buffer.frameCount, framesOut);
                         framesOut = buffer.frameCount;
-                        memcpy(activeTrack->mSink.raw, buffer.raw, buffer.frameCount * mFrameSize);
-                        activeTrack->mResamplerBufferProvider->releaseBuffer(&buffer);
+                        memcpy(activeTrack->mSink.raw, buffer.raw,
+                                buffer.frameCount * (converted ? activeTrack->frameSize()
+                                                               : mFrameSize));
+                        provider->releaseBuffer(&buffer);
                     } else {
                         framesOut = 0;
                         ALOGE("%s() cannot fill request, status: %d, frameCount: %zu",
@@ -8915,6 +9592,8 @@ status_t AudioFlinger::RecordThread::start(RecordThread::RecordTrack* recordTrac
         if (!recordTrack->isDirect()) {
             // clear any converter state as new data will be discontinuous
             recordTrack->mRecordBufferConverter->reset();
+            // the track may join a ConverterGroup again in the thread loop
+            recordTrack->mConverterGroupReader.reset();
         }
         recordTrack->mState = TrackBase::STARTING_2;
         // signal thread to start
@@ -9140,6 +9819,9 @@ void AudioFlinger::RecordThread::dumpInternals_l(int fd, const Vector<String16>&
 
     dprintf(fd, "  Fast capture thread: %s\n", hasFastCapture() ? "yes" : "no");
     dprintf(fd, "  Fast track available: %s\n", mFastTrackAvail ? "yes" : "no");
+    if (mConverterGroupsEnabled) {
+        dprintf(fd, "  Converter groups: %zu\n", mConverterGroupCount.load());
+    }
 
     // Make a non-atomic copy of fast capture dump state so it won't change underneath us
     // while we are dumping it.  It may be inconsistent, but it won't mutate!
@@ -9319,6 +10001,35 @@ void AudioFlinger::RecordThread::ResamplerBufferProvider::releaseBuffer(
     buffer->frameCount = 0;
 }
 
+AudioFlinger::RecordThread::ConverterGroup::ConverterGroup(
+        RecordThread *recordThread, const sp<RecordTrack>& recordTrack, int32_t front)
+    : RecordConverterGroup({recordThread->mRsmpInBuffer, recordThread->mRsmpInFrames,
+                    recordThread->mRsmpInFramesP2, recordThread->mFrameSize,
+                    recordThread->mChannelMask, recordThread->mFormat,
+                    recordThread->mSampleRate},
+            recordTrack->mChannelMask, recordTrack->mFormat, recordTrack->mSampleRate, front)
+    , mRecordThread(recordThread)
+{
+}
+
+bool AudioFlinger::RecordThread::ConverterGroup::matches(
+        const sp<RecordTrack>& recordTrack, int32_t front) const
+{
+    return RecordConverterGroup::matches(
+            recordTrack->mChannelMask, recordTrack->mFormat, recordTrack->mSampleRate, front);
+}
+
+void AudioFlinger::RecordThread::ConverterGroup::exchangeConverter(RecordTrack *recordTrack)
+{
+    recordTrack->mRecordBufferConverter =
+            RecordConverterGroup::exchangeConverter(recordTrack->mRecordBufferConverter);
+}
+
+void AudioFlinger::RecordThread::ConverterGroup::convert()
+{
+    RecordConverterGroup::convert(mRecordThread->mRsmpInRear);
+}
+
 void AudioFlinger::RecordThread::checkBtNrec()
 {
     Mutex::Autolock _l(mLock);
@@ -9696,8 +10407,94 @@ void AudioFlinger::RecordThread::updateFronts_l(int32_t offset)
     }
 }
 
+void AudioFlinger::RecordThread::processConverterGroups(
+        const Vector<sp<RecordTrack>>& activeTracks)
+{
+    std::vector<std::shared_ptr<ConverterGroup>> groups;
+    std::vector<sp<RecordTrack>> candidates;
+    for (const sp<RecordTrack>& track : activeTracks) {
+        if (track->isFastTrack() || track->isDirect()) {
+            continue;
+        }
+        auto& reader = track->mConverterGroupReader;
+        if (reader != nullptr) {
+            const std::shared_ptr<ConverterGroup>& group = reader->group();
+            if (group.use_count() > 1 || !reader->isCaughtUp()) {
+                if (std::find(groups.begin(), groups.end(), group) == groups.end()) {
+                    groups.push_back(group);
+                }
+                continue;
+            }
+            // Last track of the group: take over its converter to convert on its own.
+            ALOGV("%s: track %d leaves converter group", __func__, track->id());
+            group->exchangeConverter(track.get());
+            reader.reset();
+        }
+        candidates.push_back(track);
+    }
+
+    // Tracks reading the same data at the same configuration join a group.
+    // A new group continues with the converter of the first track,
+    // which is the track that has been active the longest.
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+        const sp<RecordTrack>& track = *it;
+        if (track->mConverterGroupReader != nullptr) {
+            continue; // joined a group created for a previous candidate
+        }
+        const int32_t front = track->mResamplerBufferProvider->getFront();
+        std::shared_ptr<ConverterGroup> group;
+        for (const auto& candidateGroup : groups) {
+            if (candidateGroup->matches(track, front)) {
+                group = candidateGroup;
+                break;
+            }
+        }
+        if (group == nullptr) {
+            group = std::make_shared<ConverterGroup>(this, track, front);
+            if (group->initCheck() != NO_ERROR
+                    || std::none_of(it + 1, candidates.end(), [&](const sp<RecordTrack>& t) {
+                        return t->mConverterGroupReader == nullptr
+                                && group->matches(t, t->mResamplerBufferProvider->getFront());
+                    })) {
+                continue;
+            }
+            group->exchangeConverter(track.get());
+            groups.push_back(group);
+        }
+        ALOGV("%s: track %d joins converter group", __func__, track->id());
+        track->mConverterGroupReader = std::make_unique<ConverterGroup::Reader>(track.get(), group);
+    }
+
+    for (const auto& group : groups) {
+        group->convert();
+    }
+    // The RecordThread position of a track in a group is that of the group,
+    // for getOldestFront_l() and for when the track leaves the group.
+    for (const sp<RecordTrack>& track : activeTracks) {
+        if (track->mConverterGroupReader != nullptr) {
+            track->mResamplerBufferProvider->setFront(
+                    track->mConverterGroupReader->group()->getFront());
+        }
+    }
+    mConverterGroupCount = groups.size();
+}
+
+void AudioFlinger::RecordThread::clearConverterGroups_l()
+{
+    // Called on the thread loop: the tracks continue with their own converter
+    // at the RecordThread position of their group, dropping the data of the group
+    // not yet read.
+    for (size_t i = 0; i < mTracks.size(); i++) {
+        mTracks[i]->mConverterGroupReader.reset();
+    }
+    mConverterGroupCount = 0;
+}
+
 void AudioFlinger::RecordThread::resizeInputBuffer_l(int32_t maxSharedAudioHistoryMs)
 {
+    // The ConverterGroups are sized from the buffer and convert from the thread configuration.
+    clearConverterGroups_l();
+
     // This is the formula for calculating the temporary buffer size.
     // With 7 HAL buffers, we can guarantee ability to down-sample the input by ratio of 6:1 to
     // 1 full output buffer, regardless of the alignment of the available input.
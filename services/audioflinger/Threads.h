@@ -329,7 +329,9 @@ public:
     virtual     size_t      frameCount() const = 0;
     virtual     audio_channel_mask_t hapticChannelMask() const { return AUDIO_CHANNEL_NONE; }
     virtual     uint32_t    latency_l() const { return 0; }
-    virtual     void        setVolumeForOutput_l(float left __unused, float right __unused) const {}
+    virtual     status_t    setVolumeForOutput_l(float left __unused, float right __unused) const {
+                                return INVALID_OPERATION;
+                            }
 
                 // Return's the HAL's frame count i.e. fast mixer buffer size.
                 size_t      frameCountHAL() const { return mFrameCount; }
@@ -913,6 +915,10 @@ protected:
     virtual     void        threadLoop_standby();
     virtual     void        threadLoop_exit();
     virtual     void        threadLoop_removeTracks(const Vector< sp<Track> >& tracksToRemove);
+    // Processes one period in an effect chain. Called with the effect chains locked.
+    virtual     void        threadLoop_processEffectChain(const sp<EffectChain>& chain);
+    // Called before the effect chains are unlocked, whether or not they were processed.
+    virtual     void        threadLoop_unlockingEffectChains() {}
 
                 // prepareTracks_l reads and writes mActiveTracks, and returns
                 // the pending set of tracks to remove via Vector 'tracksToRemove'.  The caller
@@ -973,7 +979,7 @@ public:
     virtual     void        setStreamMute(audio_stream_type_t stream, bool muted);
     virtual     float       streamVolume(audio_stream_type_t stream) const;
 
-                void        setVolumeForOutput_l(float left, float right) const override;
+                status_t    setVolumeForOutput_l(float left, float right) const override;
 
                 sp<Track>   createTrack_l(
                                 const sp<AudioFlinger::Client>& client,
@@ -1150,6 +1156,7 @@ protected:
     uint32_t                        mThreadThrottleTimeMs; // throttle time for MIXER threads
     uint32_t                        mThreadThrottleEndMs;  // notify once per throttling
     uint32_t                        mHalfBufferMs;       // half the buffer size in milliseconds
+    bool                            mPredictiveSleep;    // sleep until the predicted HAL deadline
 
     void*                           mSinkBuffer;         // frame size aligned sink buffer
 
@@ -1248,7 +1255,9 @@ private:
     // PlaybackThread needs to find out if master-muted, it checks it's local
     // copy rather than the one in AudioFlinger.  This optimization saves a lock.
     bool                            mMasterMute;
-                void        setMasterMute_l(bool muted) { mMasterMute = muted; }
+    // set by checkSilentMode_l() when ro.audio.silent mutes the thread for good
+    bool                            mSilentMode = false;
+                void        setSilentMode_l();
 
                 auto discontinuityForStandbyOrFlush() const { // call on threadLoop or with lock.
                     return ((mType == DIRECT && !audio_is_linear_pcm(mFormat))
@@ -1371,6 +1380,20 @@ private:
     float                           mMasterVolume;
     std::atomic<float>              mMasterBalance{};
     audio_utils::Balance            mBalance;
+
+    // Master and stream volumes set by binder threads. The thread loop does not take
+    // ThreadBase::mLock or the PublishedState lock for them: it copies the latest
+    // published values to mMasterVolume, mMasterMute and mStreamTypes in updateVolumes_l().
+    struct VolumeState {
+        float                       mMasterVolume;
+        bool                        mMasterMute;
+        stream_type_t               mStreamTypes[AUDIO_STREAM_CNT];
+    };
+
+                void        updateVolumes_l();
+
+    PublishedState<VolumeState>     mVolumeState;
+
     int                             mNumWrites;
     int                             mNumDelayedWrites;
     bool                            mInWrite;
@@ -1394,6 +1417,10 @@ private:
     // FIXME move these declarations into the specific sub-class that needs them
     // MIXER only
     uint32_t                        sleepTimeShift;
+    // MIXER only, end of the current sleep when predicted from the HAL position, otherwise 0
+    nsecs_t                         mSleepDeadlineNs = 0;
+    // MIXER only, lateness of the wakeups at mSleepDeadlineNs
+    audio_utils::Statistics<double> mWakeupJitterMs{0.995 /* alpha */};
 
     // same as AudioFlinger::mStandbyTimeInNsecs except for DIRECT which uses a shorter value
     nsecs_t                         mStandbyDelayNs;
@@ -1554,6 +1581,10 @@ protected:
     virtual     void        threadLoop_sleepTime();
     virtual     uint32_t    correctLatency_l(uint32_t latency) const;
 
+                // Returns the time at which the HAL will have only one mixer period left
+                // to play, based on the last kernel timestamp, or 0 if it cannot be predicted.
+                nsecs_t     predictWriteDeadlineNs() const;
+
     virtual     status_t    createAudioPatch_l(const struct audio_patch *patch,
                                    audio_patch_handle_t *handle);
     virtual     status_t    releaseAudioPatch_l(const audio_patch_handle_t handle);
@@ -1690,6 +1721,9 @@ protected:
     float                   mMasterBalanceLeft = 1.f;
     float                   mMasterBalanceRight = 1.f;
 
+    // Applies the volume to PCM data in threadLoop_mix() if the HAL has no volume control.
+    std::unique_ptr<VolumeRamp> mSoftwareVolume;
+
 public:
     virtual     bool        hasFastMixer() const { return false; }
 
@@ -1775,6 +1809,84 @@ private:
     bool                       mAsyncError;
 };
 
+// Writes the mixed buffers of a DuplicatingThread to one of its OutputTracks, so that an output
+// whose buffer is full (e.g. Bluetooth A2DP) does not delay the other outputs.
+// The DuplicatingThread is the single producer of a lock-free queue of copies of its sink buffer,
+// and this thread the single consumer. The locks are only used for waiting.
+class OutputTrackWriteThread : public Thread {
+public:
+
+    OutputTrackWriteThread(const sp<PlaybackThread::OutputTrack>& outputTrack,
+                           size_t bufferSize);
+
+    virtual             ~OutputTrackWriteThread();
+
+    // Thread virtuals
+    bool                threadLoop() override;
+
+    // RefBase
+    void                onFirstRef() override;
+
+    // Stops the thread and waits until it exits, after the write in progress if any.
+    // Must not be called by this thread.
+            void        exit();
+
+    // The following methods are only called by the DuplicatingThread.
+
+    // Queues a copy of the frames to be written to the OutputTrack by deadlineNs. Does not
+    // allocate: at most the bufferSize passed to the constructor is copied.
+    // Returns false if the queue is full, in which case the frames are dropped.
+            bool        push(const void *data, uint32_t frames, size_t frameSize,
+                             nsecs_t deadlineNs);
+    // Waits until all the queued buffers are written, or until deadlineNs.
+    // Returns true if all the queued buffers are written.
+            bool        waitWritten(nsecs_t deadlineNs);
+    // Returns true if buffers queued by previous calls to push() are not written yet.
+            bool        isBackedUp() const { return queuedCount() != 0; }
+    // Stops the OutputTrack once the buffers already queued are written.
+    // A stop still pending is postponed after the buffers queued since it was requested.
+            void        requestStop();
+
+    const sp<PlaybackThread::OutputTrack>& outputTrack() const { return mOutputTrack; }
+
+            std::string dump() const;
+
+private:
+    // Must be a power of 2.
+    static constexpr uint32_t kQueueSize = 4;
+    // Upper bounds of the lateness histogram buckets, the last bucket has no upper bound.
+    static constexpr int32_t kLatenessBucketMs[] = { 0, 1, 2, 5, 10, 20, 50 };
+    static constexpr size_t kLatenessBucketCount = std::size(kLatenessBucketMs) + 1;
+
+    struct QueuedBuffer {
+        std::vector<uint8_t> mData;
+        uint32_t mFrames = 0;
+        nsecs_t mDeadlineNs = 0;
+    };
+
+            uint32_t    queuedCount() const {
+                            return mRear.load(std::memory_order_acquire)
+                                    - mFront.load(std::memory_order_acquire);
+                        }
+
+    const sp<PlaybackThread::OutputTrack> mOutputTrack;
+    QueuedBuffer                mQueue[kQueueSize];
+    std::atomic<uint32_t>       mFront = 0;         // only incremented by this thread
+    std::atomic<uint32_t>       mRear = 0;          // only incremented by the DuplicatingThread
+    // Set by requestStop(), the OutputTrack is stopped when mFront reaches mStopRear.
+    std::atomic<bool>           mStopRequested = false;
+    std::atomic<uint32_t>       mStopRear = 0;
+    std::atomic<uint64_t>       mDroppedCount = 0;
+
+    mutable Mutex               mLock;
+    Condition                   mWorkCV;            // signaled by push(), requestStop() and exit()
+    Condition                   mWrittenCV;         // signaled when a buffer is written
+    uint64_t                    mWrittenCount = 0;  // guarded by mLock
+    // How late each buffer was written, guarded by mLock.
+    uint64_t                    mLatenessHistogram[kLatenessBucketCount] = {};
+    audio_utils::Statistics<double> mLatenessMs{0.999 /* alpha */};
+};
+
 class DuplicatingThread : public MixerThread {
 public:
     DuplicatingThread(const sp<AudioFlinger>& audioFlinger, MixerThread* mainThread,
@@ -1794,6 +1906,7 @@ protected:
 
 private:
                 bool        outputsReady();
+                ssize_t     threadLoop_writeParallel();
 protected:
     // threadLoop snippets
     virtual     void        threadLoop_mix();
@@ -1813,6 +1926,14 @@ private:
                 uint32_t    mWaitTimeMs;
     SortedVector < sp<OutputTrack> >  outputTracks;
     SortedVector < sp<OutputTrack> >  mOutputTracks;
+
+    // When true, each OutputTrack is written by its own OutputTrackWriteThread and a slow
+    // output only delays the others when its queue is full. Set by af.duplicating.parallel_write.
+    const       bool        mParallelWrite;
+    std::map<sp<OutputTrack>, sp<OutputTrackWriteThread>> mOutputWriters;  // guarded by mLock
+    // The writers of outputTracks, in the same order. Only used by the threadLoop.
+    std::vector<sp<OutputTrackWriteThread>> outputWriters;
+    std::vector<OutputTrackWriteThread *> mOnTimeWriters;  // only used by the threadLoop
 public:
     virtual     bool        hasFastMixer() const { return false; }
                 status_t    threadloop_getHalTimestamp_l(
@@ -1833,6 +1954,41 @@ public:
     }
 };
 
+// Processes the spatializer effect chain of a SpatializerThread in pipelined mode,
+// so that the effect processes a period while the SpatializerThread mixes the next one.
+class SpatializerProcessThread : public Thread {
+public:
+
+    SpatializerProcessThread();
+
+    // Thread virtuals
+    bool                threadLoop() override;
+
+    // RefBase
+    void                onFirstRef() override;
+
+            void        exit();
+
+    // The following methods are only called by the SpatializerThread, with the chain locked.
+
+    // Starts processing one period in the chain. The chain and its buffers must not be
+    // accessed until wait() returns.
+            void        start(const sp<EffectChain>& chain);
+    // Waits until the period started by start() is processed.
+            void        wait();
+
+            std::string dump() const;
+
+private:
+    mutable Mutex               mLock;
+    Condition                   mWorkCV;            // signaled by start() and exit()
+    Condition                   mDoneCV;            // signaled when a period is processed
+    sp<EffectChain>             mChain;             // guarded by mLock, set while processing
+    uint64_t                    mProcessedCount = 0;                  // guarded by mLock
+    audio_utils::Statistics<double> mProcessTimeMs{0.995 /* alpha */}; // guarded by mLock
+    audio_utils::Statistics<double> mWaitTimeMs{0.995 /* alpha */};    // guarded by mLock
+};
+
 class SpatializerThread : public MixerThread {
 public:
     SpatializerThread(const sp<AudioFlinger>& audioFlinger,
@@ -1849,15 +2005,50 @@ public:
 
             status_t setRequestedLatencyMode(audio_latency_mode_t mode) override;
 
+            bool        checkForNewParameter_l(const String8& keyValuePair,
+                                               status_t& status) override;
+
 protected:
             void checkOutputStageEffects() override;
             void setHalLatencyMode_l() override;
 
+            void        dumpInternals_l(int fd, const Vector<String16>& args) override;
+
+            mixer_state prepareTracks_l(Vector<sp<Track>> *tracksToRemove) override;
+
+    // threadLoop snippets
+            void        threadLoop_mix() override;
+            void        threadLoop_standby() override;
+            void        threadLoop_exit() override;
+            void        threadLoop_processEffectChain(const sp<EffectChain>& chain) override;
+            void        threadLoop_unlockingEffectChains() override;
+
 private:
+            // Moves the output stage chain to or from the pipeline buffers as requested.
+            void        updatePipeline_l();
+            // Clears the period held in the pipeline.
+            void        clearPipeline();
+
             // Do not request a specific mode by default
             audio_latency_mode_t mRequestedLatencyMode = AUDIO_LATENCY_MODE_FREE;
 
             sp<EffectHandle> mFinalDownMixer;
+
+            // Pipelined mode: the output stage chain processes period N on
+            // mProcessThread while the thread loop mixes period N+1, which adds one period
+            // of latency. The chain then reads and writes the pipeline buffers instead of
+            // mEffectBuffer and mPostSpatializerBuffer, and the thread loop exchanges their
+            // content with the current period when the chain would otherwise be processed.
+            // Set with the "spatializer_pipelined" parameter, guarded by mLock.
+            bool                 mPipelineRequested;
+            // The following are only accessed by the thread loop.
+            sp<EffectChain>      mPipelineChain;     // output stage chain when pipelined
+            sp<EffectBufferHalInterface> mPipelineInBuffer;
+            sp<EffectBufferHalInterface> mPipelineOutBuffer;
+            // Stereo mix of the tracks that are not spatialized, delayed by one period.
+            std::vector<float>   mDelayedPostSpatializerBuffer;
+            bool                 mPipelineStarted = false;  // mProcessThread has a period
+            sp<SpatializerProcessThread> mProcessThread;
 };
 
 // record thread
@@ -1911,6 +2102,57 @@ public:
                                             // rolling counter that is never cleared
     };
 
+    /* The ConverterGroup is the RecordConverterGroup of RecordTracks of this RecordThread.
+     * A ConverterGroup is only accessed by the RecordThread loop, and is freed
+     * when its last RecordTrack leaves it.
+     */
+    class ConverterGroup : public RecordConverterGroup
+    {
+    public:
+        // The group starts converting the RecordThread data at front.
+        ConverterGroup(RecordThread *recordThread, const sp<RecordTrack>& recordTrack,
+                int32_t front);
+
+        // true if recordTrack, at RecordThread position front, can read the data of the group.
+        bool        matches(const sp<RecordTrack>& recordTrack, int32_t front) const;
+
+        // Swaps the converter of the group with that of recordTrack.
+        void        exchangeConverter(RecordTrack *recordTrack);
+
+        // Converts all the RecordThread data available since the last call.
+        void        convert();
+
+        // The Reader is the ResamplerBufferProvider of a RecordTrack in a group:
+        // it provides the converted data of the group instead of the RecordThread data.
+        class Reader : public ResamplerBufferProvider
+        {
+        public:
+            Reader(RecordTrack* recordTrack, const std::shared_ptr<ConverterGroup>& group)
+                : ResamplerBufferProvider(recordTrack), mGroup(group), mReader(group.get()) { }
+
+            const std::shared_ptr<ConverterGroup>& group() const { return mGroup; }
+            bool    isCaughtUp() const { return mReader.isCaughtUp(); }
+
+            // ResamplerBufferProvider interface
+            void        reset() override { mReader.reset(); }
+            void        sync(size_t *framesAvailable = NULL, bool *hasOverrun = NULL) override {
+                mReader.sync(framesAvailable, hasOverrun);
+            }
+            status_t    getNextBuffer(AudioBufferProvider::Buffer* buffer) override {
+                return mReader.getNextBuffer(buffer);
+            }
+            void        releaseBuffer(AudioBufferProvider::Buffer* buffer) override {
+                mReader.releaseBuffer(buffer);
+            }
+        private:
+            const std::shared_ptr<ConverterGroup> mGroup;
+            RecordConverterGroup::Reader mReader;
+        };
+
+    private:
+        RecordThread * const mRecordThread;
+    };
+
 #include "RecordTracks.h"
 
             RecordThread(const sp<AudioFlinger>& audioFlinger,
@@ -2063,6 +2305,12 @@ private:
             int32_t getOldestFront_l();
             void    updateFronts_l(int32_t offset);
 
+            // Updates the ConverterGroups of the active tracks and converts their data.
+            void    processConverterGroups(const Vector<sp<RecordTrack>>& activeTracks);
+            // Makes all the RecordTracks convert their data on their own, when the RecordThread
+            // buffer is reconfigured.
+            void    clearConverterGroups_l();
+
             AudioStreamIn                       *mInput;
             Source                              *mSource;
             SortedVector < sp<RecordTrack> >    mTracks;
@@ -2133,6 +2381,11 @@ private:
             std::string                         mSharedAudioPackageName = {};
             int32_t                             mSharedAudioStartFrames = -1;
             audio_session_t                     mSharedAudioSessionId = AUDIO_SESSION_NONE;
+
+            // Set by the "af.record.converter_groups" property.
+            const bool                          mConverterGroupsEnabled;
+            // Number of ConverterGroups at the last threadLoop() cycle, for dumpsys.
+            std::atomic<size_t>                 mConverterGroupCount{};
 };
 
 class MmapThread : public ThreadBase
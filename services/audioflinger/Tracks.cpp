@@ -1969,11 +1969,10 @@ void AudioFlinger::PlaybackThread::Track::updateTrackFrameInfo(
 bool AudioFlinger::PlaybackThread::Track::AudioVibrationController::setMute(bool muted) {
     sp<ThreadBase> thread = mTrack->mThread.promote();
     if (thread != 0) {
-        // Lock for updating mHapticPlaybackEnabled.
-        Mutex::Autolock _l(thread->mLock);
+        // No thread lock: the haptic state is published to the mixer, see pollHapticState().
         PlaybackThread *playbackThread = (PlaybackThread *)thread.get();
         if ((mTrack->channelMask() & AUDIO_CHANNEL_HAPTIC_ALL) != AUDIO_CHANNEL_NONE
-                && playbackThread->mHapticChannelCount > 0) {
+                && playbackThread->supportsHapticPlayback()) {
             ALOGD("%s, haptic playback was %s for track %d",
                     __func__, muted ? "muted" : "unmuted", mTrack->id());
             mTrack->setHapticPlaybackEnabled(!muted);
@@ -2994,7 +2993,7 @@ sp<StreamInHalInterface> AudioFlinger::RecordThread::PassthruPatchRecord::obtain
     return recordThread->mInput ? recordThread->mInput->stream : nullptr;
 }
 
-// PatchProxyBufferProvider methods are called on DirectOutputThread
+// PatchProxyBufferProvider methods are called on the PlaybackThread of the patch
 status_t AudioFlinger::RecordThread::PassthruPatchRecord::obtainBuffer(
         Proxy::Buffer* buffer, const struct timespec* timeOut)
 {
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Replays the buffer handling of EffectModule::process() for the effect chain
+ * configurations below, as reported by the "- data: float/int16" line of the effect dump.
+ *
+ * A gain stands in for the effect engines so that the benchmark measures the copies and
+ * format conversions around them. With linked=1, adjacent int16 effects hand over their
+ * int16 output as planned by EffectChain::planBuffers_l().
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <audio_utils/primitives.h>
+#include <benchmark/benchmark.h>
+
+static constexpr size_t kFrameCount = 960;  // 20 ms at 48 kHz
+static constexpr size_t kChannelCount = 2;
+static constexpr size_t kSampleCount = kFrameCount * kChannelCount;
+
+struct ChainEffect {
+    const char *name;
+    bool supportsFloat;
+};
+
+struct ChainConfig {
+    const char *name;
+    std::vector<ChainEffect> effects;
+};
+
+static const std::vector<ChainConfig> kChains = {
+    {"eq+bb+virt+loudness int16", {
+        {"Equalizer", false}, {"Bass Boost", false},
+        {"Virtualizer", false}, {"Loudness Enhancer", false}}},
+    {"eq+bb+virt int16, loudness float", {
+        {"Equalizer", false}, {"Bass Boost", false},
+        {"Virtualizer", false}, {"Loudness Enhancer", true}}},
+    {"eq float, bb+virt int16, loudness float", {
+        {"Equalizer", true}, {"Bass Boost", false},
+        {"Virtualizer", false}, {"Loudness Enhancer", true}}},
+    {"eq+bb+virt+loudness float", {
+        {"Equalizer", true}, {"Bass Boost", true},
+        {"Virtualizer", true}, {"Loudness Enhancer", true}}},
+};
+
+static void gain_i16(int16_t *dst, const int16_t *src, size_t count, bool accumulate) {
+    for (size_t i = 0; i < count; i++) {
+        const int32_t sample = (src[i] * 29491) >> 15;  // about -0.9 dB
+        dst[i] = accumulate ? clamp16(dst[i] + sample) : (int16_t)sample;
+    }
+}
+
+static void gain_float(float *dst, const float *src, size_t count, bool accumulate) {
+    for (size_t i = 0; i < count; i++) {
+        const float sample = src[i] * 0.9f;
+        dst[i] = accumulate ? dst[i] + sample : sample;
+    }
+}
+
+/*
+ * Processes one period in the chain: every effect but the last one processes in place
+ * in the chain input buffer, the last one accumulates into the chain output buffer.
+ */
+static void processChain(const ChainConfig& chain, bool linked, float *chainIn, float *chainOut,
+        std::vector<std::vector<int16_t>>& inConversion,
+        std::vector<std::vector<int16_t>>& outConversion) {
+    const size_t effectCount = chain.effects.size();
+    bool int16InputReady = false;
+    for (size_t i = 0; i < effectCount; i++) {
+        const bool last = i + 1 == effectCount;
+        if (chain.effects[i].supportsFloat) {
+            gain_float(last ? chainOut : chainIn, chainIn, kSampleCount, last /* accumulate */);
+            int16InputReady = false;
+            continue;
+        }
+        if (!int16InputReady) {
+            memcpy_to_i16_from_float(inConversion[i].data(), chainIn, kSampleCount);
+        }
+        if (last) {
+            memcpy_to_i16_from_float(outConversion[i].data(), chainOut, kSampleCount);
+            gain_i16(outConversion[i].data(), inConversion[i].data(), kSampleCount,
+                    true /* accumulate */);
+            memcpy_to_float_from_i16(chainOut, outConversion[i].data(), kSampleCount);
+            break;
+        }
+        int16InputReady = linked && !chain.effects[i + 1].supportsFloat;
+        if (int16InputReady) {
+            gain_i16(inConversion[i + 1].data(), inConversion[i].data(), kSampleCount,
+                    false /* accumulate */);
+        } else {
+            gain_i16(outConversion[i].data(), inConversion[i].data(), kSampleCount,
+                    false /* accumulate */);
+            memcpy_to_float_from_i16(chainIn, outConversion[i].data(), kSampleCount);
+        }
+    }
+}
+
+static void BM_EffectChain(benchmark::State& state) {
+    const ChainConfig& chain = kChains[state.range(0)];
+    const bool linked = state.range(1) != 0;
+
+    std::vector<float> input(kSampleCount);
+    for (size_t i = 0; i < kSampleCount; i++) {
+        input[i] = (float)((i * 7919) % 2000) / 1000.f - 1.f;
+    }
+    std::vector<float> chainIn(kSampleCount);
+    std::vector<float> chainOut(kSampleCount);
+    std::vector<std::vector<int16_t>> inConversion(
+            chain.effects.size(), std::vector<int16_t>(kSampleCount));
+    std::vector<std::vector<int16_t>> outConversion(
+            chain.effects.size(), std::vector<int16_t>(kSampleCount));
+
+    for (auto _ : state) {
+        // The mixer writes the chain input and the thread clears the output every period.
+        std::copy(input.begin(), input.end(), chainIn.begin());
+        std::fill(chainOut.begin(), chainOut.end(), 0.f);
+        processChain(chain, linked, chainIn.data(), chainOut.data(),
+                inConversion, outConversion);
+        benchmark::DoNotOptimize(chainOut.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kFrameCount);
+    state.SetLabel(chain.name);
+}
+
+static void EffectChainArgs(benchmark::internal::Benchmark* b) {
+    for (size_t chain = 0; chain < kChains.size(); chain++) {
+        for (int linked : {0, 1}) {
+            b->Args({(int64_t)chain, linked});
+        }
+    }
+    b->ArgNames({"chain", "linked"});
+}
+
+BENCHMARK(BM_EffectChain)->Apply(EffectChainArgs);
+
+BENCHMARK_MAIN();
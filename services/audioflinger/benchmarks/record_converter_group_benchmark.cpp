@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Replays one RecordThread cycle for clients capturing at 16 kHz mono from a 48 kHz stereo
+ * input, as hotword, voice recognition and an app recording do together.
+ *
+ * With grouped=0 each client converts the input with its own RecordBufferConverter.
+ * With grouped=1 the input is converted once, as by a RecordThread::ConverterGroup,
+ * and copied to each client.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <media/AudioBufferProvider.h>
+#include <media/RecordBufferConverter.h>
+
+using namespace android;
+
+static constexpr size_t kInFrameCount = 960;  // 20 ms at 48 kHz
+static constexpr uint32_t kInSampleRate = 48000;
+static constexpr uint32_t kOutSampleRate = 16000;
+static constexpr size_t kOutFrameCount = kInFrameCount * kOutSampleRate / kInSampleRate;
+
+// Provides the same input period on every cycle, as ResamplerBufferProvider does
+// for the RecordThread buffer.
+class PeriodProvider : public AudioBufferProvider {
+public:
+    explicit PeriodProvider(const std::vector<int16_t>& period) : mPeriod(period) { }
+
+    void rewind() { mFront = 0; }
+
+    status_t getNextBuffer(Buffer* buffer) override {
+        const size_t frames = std::min(buffer->frameCount, kInFrameCount - mFront);
+        buffer->frameCount = frames;
+        buffer->raw = frames == 0 ? nullptr : (void *)&mPeriod[mFront * 2];
+        return frames == 0 ? NOT_ENOUGH_DATA : NO_ERROR;
+    }
+
+    void releaseBuffer(Buffer* buffer) override {
+        mFront += buffer->frameCount;
+        buffer->frameCount = 0;
+        buffer->raw = nullptr;
+    }
+
+private:
+    const std::vector<int16_t>& mPeriod;
+    size_t mFront = 0;
+};
+
+static std::unique_ptr<RecordBufferConverter> makeConverter() {
+    return std::make_unique<RecordBufferConverter>(
+            AUDIO_CHANNEL_IN_STEREO, AUDIO_FORMAT_PCM_16_BIT, kInSampleRate,
+            AUDIO_CHANNEL_IN_MONO, AUDIO_FORMAT_PCM_16_BIT, kOutSampleRate);
+}
+
+static void BM_RecordConverterGroup(benchmark::State& state) {
+    const size_t clients = state.range(0);
+    const bool grouped = state.range(1) != 0;
+
+    std::vector<int16_t> period(kInFrameCount * 2);
+    for (size_t i = 0; i < period.size(); i++) {
+        period[i] = 16384 * sinf(i * 0.01f);
+    }
+    PeriodProvider provider(period);
+
+    std::vector<std::unique_ptr<RecordBufferConverter>> converters;
+    for (size_t i = 0; i < (grouped ? 1 : clients); i++) {
+        converters.push_back(makeConverter());
+        if (converters.back()->initCheck() != NO_ERROR) {
+            state.SkipWithError("cannot create converter");
+            return;
+        }
+    }
+    std::vector<int16_t> groupBuffer(kOutFrameCount);
+    std::vector<std::vector<int16_t>> sinks(clients, std::vector<int16_t>(kOutFrameCount));
+
+    for (auto _ : state) {
+        if (grouped) {
+            provider.rewind();
+            const size_t frames =
+                    converters[0]->convert(groupBuffer.data(), &provider, kOutFrameCount);
+            for (auto& sink : sinks) {
+                memcpy(sink.data(), groupBuffer.data(), frames * sizeof(int16_t));
+            }
+        } else {
+            for (size_t i = 0; i < clients; i++) {
+                provider.rewind();
+                converters[i]->convert(sinks[i].data(), &provider, kOutFrameCount);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kInFrameCount);
+}
+
+BENCHMARK(BM_RecordConverterGroup)
+    ->ArgsProduct({{1, 2, 3}, {0, 1}})
+    ->ArgNames({"clients", "grouped"});
+
+BENCHMARK_MAIN();
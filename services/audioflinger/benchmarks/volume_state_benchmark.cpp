@@ -0,0 +1,227 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the mix cycle of a PlaybackThread while a binder thread keeps changing
+ * stream volumes, as during a volume key press or a volume slider drag.
+ *
+ * In both modes the mix cycle takes the thread lock, as the thread loop holds
+ * ThreadBase::mLock around updateVolumes_l() and prepareTracks_l().
+ * With snapshot=0 the binder thread updates the volumes under the thread lock too,
+ * as PlaybackThread::setStreamVolume() did before PublishedState.
+ * With snapshot=1 the binder thread updates the PublishedState used by PlaybackThread,
+ * and the mix cycle polls it as updateVolumes_l() does.
+ *
+ * BM_TrackStateContention does the same with the haptic state of each track, set by the
+ * vibrator service, which the mix cycle polls per track as prepareTracks_l() does.
+ *
+ * holdUs is how long the binder thread holds its lock per update, standing in for the
+ * binder thread being descheduled while holding it.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "PublishedState.h"
+
+using namespace android;
+
+static constexpr size_t kFrameCount = 960;  // 20 ms at 48 kHz
+static constexpr size_t kChannelCount = 2;
+static constexpr size_t kTrackCount = 8;
+static constexpr size_t kStreamCount = 16;
+
+struct VolumeState {
+    float masterVolume;
+    float streamVolumes[kStreamCount];
+};
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Mixes kTrackCount tracks with the master and stream volumes, as prepareTracks_l() and
+// threadLoop_mix() would.
+static void mix(const VolumeState& volumes, const std::vector<std::vector<float>>& tracks,
+        std::vector<float>& out) {
+    std::fill(out.begin(), out.end(), 0.f);
+    for (size_t i = 0; i < tracks.size(); i++) {
+        const float volume = volumes.masterVolume * volumes.streamVolumes[i % kStreamCount];
+        for (size_t j = 0; j < out.size(); j++) {
+            out[j] += tracks[i][j] * volume;
+        }
+    }
+}
+
+static void BM_VolumeUpdateContention(benchmark::State& state) {
+    const bool snapshot = state.range(0) != 0;
+    const int64_t holdUs = state.range(1);
+
+    std::vector<std::vector<float>> tracks(
+            kTrackCount, std::vector<float>(kFrameCount * kChannelCount));
+    for (size_t i = 0; i < kTrackCount; i++) {
+        for (size_t j = 0; j < tracks[i].size(); j++) {
+            tracks[i][j] = sinf((i + 1) * j * 0.001f);
+        }
+    }
+    std::vector<float> out(kFrameCount * kChannelCount);
+
+    std::mutex threadLock;          // ThreadBase::mLock
+    VolumeState lockedVolumes{};    // guarded by threadLock
+    PublishedState<VolumeState> publishedVolumes; // PlaybackThread::mVolumeState
+    VolumeState mixerVolumes{};     // thread loop copy
+
+    std::atomic<bool> done = false;
+    std::thread binder([&] {
+        for (int update = 0; !done; update++) {
+            const float volume = (update % 100) / 100.f;
+            if (snapshot) {
+                publishedVolumes.update([&](VolumeState& volumes) {
+                    volumes.masterVolume = 1.f;
+                    volumes.streamVolumes[update % kStreamCount] = volume;
+                    std::this_thread::sleep_for(std::chrono::microseconds(holdUs));
+                });
+            } else {
+                std::lock_guard _l(threadLock);
+                lockedVolumes.masterVolume = 1.f;
+                lockedVolumes.streamVolumes[update % kStreamCount] = volume;
+                std::this_thread::sleep_for(std::chrono::microseconds(holdUs));
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    });
+
+    int64_t maxCycleNs = 0;
+    for (auto _ : state) {
+        const int64_t startNs = nowNs();
+        {
+            std::lock_guard _l(threadLock);
+            if (snapshot) {
+                publishedVolumes.poll(mixerVolumes);
+            } else {
+                mixerVolumes = lockedVolumes;
+            }
+            mix(mixerVolumes, tracks, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+        maxCycleNs = std::max(maxCycleNs, nowNs() - startNs);
+    }
+    done = true;
+    binder.join();
+
+    state.counters["maxCycleUs"] = maxCycleNs / 1000.;
+    state.SetItemsProcessed(state.iterations() * kFrameCount);
+}
+
+// The part of Track::HapticState that the mix below uses.
+struct TrackState {
+    bool enabled = true;
+    float intensity = 1.f;
+};
+
+static void BM_TrackStateContention(benchmark::State& state) {
+    const bool snapshot = state.range(0) != 0;
+    const int64_t holdUs = state.range(1);
+
+    std::vector<std::vector<float>> tracks(
+            kTrackCount, std::vector<float>(kFrameCount * kChannelCount));
+    for (size_t i = 0; i < kTrackCount; i++) {
+        for (size_t j = 0; j < tracks[i].size(); j++) {
+            tracks[i][j] = sinf((i + 1) * j * 0.001f);
+        }
+    }
+    std::vector<float> out(kFrameCount * kChannelCount);
+
+    std::mutex threadLock;                          // ThreadBase::mLock
+    std::vector<TrackState> lockedStates(kTrackCount); // guarded by threadLock
+    std::vector<PublishedState<TrackState>> publishedStates(kTrackCount);
+                                                    // Track::mPublishedHapticState
+    std::vector<TrackState> mixerStates(kTrackCount); // Track::mHapticState
+
+    std::atomic<bool> done = false;
+    std::thread binder([&] {
+        for (int update = 0; !done; update++) {
+            const size_t i = update % kTrackCount;
+            const bool enabled = (update / kTrackCount) % 2 == 0;
+            if (snapshot) {
+                publishedStates[i].update([&](TrackState& trackState) {
+                    trackState.enabled = enabled;
+                    std::this_thread::sleep_for(std::chrono::microseconds(holdUs));
+                });
+            } else {
+                std::lock_guard _l(threadLock);
+                lockedStates[i].enabled = enabled;
+                std::this_thread::sleep_for(std::chrono::microseconds(holdUs));
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    });
+
+    int64_t maxCycleNs = 0;
+    for (auto _ : state) {
+        const int64_t startNs = nowNs();
+        {
+            std::lock_guard _l(threadLock);
+            std::fill(out.begin(), out.end(), 0.f);
+            for (size_t i = 0; i < kTrackCount; i++) {
+                if (snapshot) {
+                    publishedStates[i].poll(mixerStates[i]);
+                } else {
+                    mixerStates[i] = lockedStates[i];
+                }
+                const float volume = mixerStates[i].enabled ? mixerStates[i].intensity : 0.f;
+                for (size_t j = 0; j < out.size(); j++) {
+                    out[j] += tracks[i][j] * volume;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+        maxCycleNs = std::max(maxCycleNs, nowNs() - startNs);
+    }
+    done = true;
+    binder.join();
+
+    state.counters["maxCycleUs"] = maxCycleNs / 1000.;
+    state.SetItemsProcessed(state.iterations() * kFrameCount);
+}
+
+static void VolumeUpdateContentionArgs(benchmark::internal::Benchmark* b) {
+    for (int holdUs : {0, 100, 1000}) {
+        for (int snapshot : {0, 1}) {
+            b->Args({snapshot, holdUs});
+        }
+    }
+    b->ArgNames({"snapshot", "holdUs"});
+}
+
+BENCHMARK(BM_VolumeUpdateContention)->Apply(VolumeUpdateContentionArgs)->UseRealTime();
+BENCHMARK(BM_TrackStateContention)->Apply(VolumeUpdateContentionArgs)->UseRealTime();
+
+BENCHMARK_MAIN();
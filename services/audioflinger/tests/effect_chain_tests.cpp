@@ -0,0 +1,430 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "effect_chain_tests"
+
+#include <algorithm>
+#include <vector>
+
+#include <audio_utils/primitives.h>
+#include <gtest/gtest.h>
+#include <utils/Log.h>
+
+#include "Configuration.h"
+#include "AudioFlinger.h"
+#include "EffectConfiguration.h"
+
+namespace android {
+
+namespace {
+
+constexpr size_t kFrameCount = 240;
+constexpr uint32_t kSampleRate = 48000;
+constexpr audio_channel_mask_t kChannelMask = AUDIO_CHANNEL_OUT_STEREO;
+constexpr size_t kSampleCount = kFrameCount * FCC_2;
+constexpr size_t kProcessCount = 8;
+constexpr audio_session_t kSessionId = static_cast<audio_session_t>(9);
+
+// How an effect of the test chain processes.
+struct EffectConfig {
+    bool supportsFloat;
+    int16_t offset;     // added to each sample after a 3/4 gain, so that effects differ
+};
+
+std::vector<float> createInput(size_t process) {
+    std::vector<float> input(kSampleCount);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = float((i * 7919 + process * 104729) % 2001) / 2000.f - 0.5f;
+    }
+    return input;
+}
+
+}  // namespace
+
+// Drives EffectModules with fake effect engines the way EffectChain::process_l() does,
+// once with the int16 outputs linked by EffectChain::linkInt16Outputs() and once without,
+// so that the output of the linked chain can be compared with the one of the original
+// float conversions.
+class EffectChainTest : public ::testing::Test {
+protected:
+    using EffectBase = AudioFlinger::EffectBase;
+    using EffectChain = AudioFlinger::EffectChain;
+    using EffectHandle = AudioFlinger::EffectHandle;
+    using EffectModule = AudioFlinger::EffectModule;
+
+    // A buffer allocated by the test, never mirroring external data.
+    class TestBuffer : public EffectBufferHalInterface {
+    public:
+        explicit TestBuffer(size_t size) : mData(size) {
+            mBuffer.frameCount = 0;
+            mBuffer.raw = mData.data();
+        }
+
+        audio_buffer_t* audioBuffer() override { return &mBuffer; }
+        void* externalData() const override { return nullptr; }
+        size_t getSize() const override { return mData.size(); }
+        void setExternalData(void* /* external */) override {}
+        void setFrameCount(size_t frameCount) override { mBuffer.frameCount = frameCount; }
+        bool checkFrameCountChange() override { return false; }
+        void update() override {}
+        void commit() override {}
+        void update(size_t /* size */) override {}
+        void commit(size_t /* size */) override {}
+
+    private:
+        std::vector<uint8_t> mData;
+        audio_buffer_t mBuffer;
+    };
+
+    // An effect engine applying a gain and an offset, in float or, if it does not support
+    // float, only in int16 as older HIDL effects.
+    class TestEffectHal : public EffectHalInterface {
+    public:
+        explicit TestEffectHal(const EffectConfig& config) : mEffectConfig(config) {}
+
+        status_t setInBuffer(const sp<EffectBufferHalInterface>& buffer) override {
+            mInBuffer = buffer;
+            return OK;
+        }
+        status_t setOutBuffer(const sp<EffectBufferHalInterface>& buffer) override {
+            mOutBuffer = buffer;
+            return OK;
+        }
+
+        // Once disabled, passes the input through and reports that the effect tail is over.
+        status_t process() override {
+            if (mInBuffer == nullptr || mOutBuffer == nullptr) {
+                return NO_INIT;
+            }
+            const bool accumulate =
+                    mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE;
+            const size_t sampleCount = mConfig.inputCfg.buffer.frameCount
+                    * audio_channel_count_from_out_mask(mConfig.inputCfg.channels);
+            if (mConfig.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT) {
+                const float *in = mInBuffer->audioBuffer()->f32;
+                float *out = mOutBuffer->audioBuffer()->f32;
+                for (size_t i = 0; i < sampleCount; ++i) {
+                    const float sample = mEnabled
+                            ? in[i] * 0.75f + mEffectConfig.offset / 32768.f : in[i];
+                    out[i] = accumulate ? out[i] + sample : sample;
+                }
+            } else {
+                const int16_t *in = mInBuffer->audioBuffer()->s16;
+                int16_t *out = mOutBuffer->audioBuffer()->s16;
+                for (size_t i = 0; i < sampleCount; ++i) {
+                    const int32_t sample = mEnabled ? in[i] * 3 / 4 + mEffectConfig.offset : in[i];
+                    out[i] = clamp16(accumulate ? out[i] + sample : sample);
+                }
+            }
+            return mEnabled ? OK : -ENODATA;
+        }
+        status_t processReverse() override { return INVALID_OPERATION; }
+
+        status_t command(uint32_t cmdCode, uint32_t cmdSize, void *pCmdData,
+                uint32_t *replySize, void *pReplyData) override {
+            int32_t reply = 0;
+            switch (cmdCode) {
+            case EFFECT_CMD_SET_CONFIG: {
+                if (cmdSize != sizeof(effect_config_t) || pCmdData == nullptr) {
+                    return BAD_VALUE;
+                }
+                const effect_config_t *config = static_cast<const effect_config_t *>(pCmdData);
+                if (config->inputCfg.format == AUDIO_FORMAT_PCM_FLOAT
+                        && !mEffectConfig.supportsFloat) {
+                    reply = -EINVAL;
+                } else {
+                    mConfig = *config;
+                }
+            } break;
+            case EFFECT_CMD_ENABLE:
+                mEnabled = true;
+                break;
+            case EFFECT_CMD_DISABLE:
+                mEnabled = false;
+                break;
+            default:
+                break;
+            }
+            if (replySize != nullptr && *replySize >= sizeof(reply) && pReplyData != nullptr) {
+                *static_cast<int32_t *>(pReplyData) = reply;
+            }
+            return OK;
+        }
+
+        status_t getDescriptor(effect_descriptor_t * /* pDescriptor */) override {
+            return INVALID_OPERATION;
+        }
+        status_t close() override { return OK; }
+        bool isLocal() const override { return true; }
+        status_t dump(int /* fd */) override { return OK; }
+        uint64_t effectId() const override { return 0; }
+
+    private:
+        const EffectConfig mEffectConfig;
+        effect_config_t mConfig{};
+        bool mEnabled = false;
+        sp<EffectBufferHalInterface> mInBuffer;
+        sp<EffectBufferHalInterface> mOutBuffer;
+    };
+
+    // Stands for the EffectChain and its stereo playback thread.
+    // The time_low field of the effect uuid selects the configuration of the effect engine.
+    class TestCallback : public AudioFlinger::EffectCallbackInterface {
+    public:
+        explicit TestCallback(const std::vector<EffectConfig>& configs) : mConfigs(configs) {}
+
+        audio_io_handle_t io() const override { return AUDIO_IO_HANDLE_NONE; }
+        bool isOutput() const override { return true; }
+        bool isOffload() const override { return false; }
+        bool isOffloadOrDirect() const override { return false; }
+        bool isOffloadOrMmap() const override { return false; }
+        bool isSpatializer() const override { return false; }
+        uint32_t sampleRate() const override { return kSampleRate; }
+        audio_channel_mask_t inChannelMask(int /* id */) const override { return kChannelMask; }
+        uint32_t inChannelCount(int /* id */) const override { return FCC_2; }
+        audio_channel_mask_t outChannelMask() const override { return kChannelMask; }
+        uint32_t outChannelCount() const override { return FCC_2; }
+        audio_channel_mask_t hapticChannelMask() const override { return AUDIO_CHANNEL_NONE; }
+        size_t frameCount() const override { return kFrameCount; }
+
+        status_t addEffectToHal(const sp<EffectHalInterface>& /* effect */) override {
+            return OK;
+        }
+        status_t removeEffectFromHal(const sp<EffectHalInterface>& /* effect */) override {
+            return OK;
+        }
+        void setVolumeForOutput(float /* left */, float /* right */) const override {}
+        bool disconnectEffectHandle(EffectHandle * /* handle */,
+                bool /* unpinIfLast */) override {
+            return false;
+        }
+        void checkSuspendOnEffectEnabled(const sp<EffectBase>& /* effect */,
+                bool /* enabled */, bool /* threadLocked */) override {}
+        void onEffectEnable(const sp<EffectBase>& /* effect */) override {}
+        void onEffectDisable(const sp<EffectBase>& /* effect */) override {}
+
+        status_t createEffectHal(const effect_uuid_t *pEffectUuid, int32_t /* sessionId */,
+                int32_t /* deviceId */, sp<EffectHalInterface> *effect) override {
+            if (pEffectUuid->timeLow >= mConfigs.size()) {
+                return NAME_NOT_FOUND;
+            }
+            *effect = new TestEffectHal(mConfigs[pEffectUuid->timeLow]);
+            return OK;
+        }
+        status_t allocateHalBuffer(size_t size, sp<EffectBufferHalInterface>* buffer) override {
+            *buffer = new TestBuffer(size);
+            return OK;
+        }
+        bool updateOrphanEffectChains(const sp<EffectBase>& /* effect */) override {
+            return false;
+        }
+
+        product_strategy_t strategy() const override { return PRODUCT_STRATEGY_NONE; }
+        int32_t activeTrackCnt() const override { return 1; }
+        void resetVolume() override {}
+
+        wp<EffectChain> chain() const override { return wp<EffectChain>(); }
+
+        bool isAudioPolicyReady() const override { return true; }
+
+    private:
+        const std::vector<EffectConfig> mConfigs;
+    };
+
+    // The effects of a session chain, set up as EffectChain::addEffect_ll() does:
+    // all effects process in place in the chain input buffer, but the last one which
+    // accumulates into the chain output buffer.
+    struct Chain {
+        bool linked;
+        sp<TestCallback> callback;
+        sp<EffectBufferHalInterface> inBuffer;
+        sp<EffectBufferHalInterface> outBuffer;
+        Vector< sp<EffectModule> > effects;
+    };
+
+    void SetUp() override {
+        // Only HIDL effects fall back to int16, see EffectModule::configure().
+        if (!audioflinger::EffectConfiguration::isHidl()) {
+            GTEST_SKIP() << "int16 effects are not supported by the effect HAL";
+        }
+    }
+
+    static void createChain(Chain& chain, const std::vector<EffectConfig>& configs,
+            bool linked) {
+        chain.linked = linked;
+        chain.callback = new TestCallback(configs);
+        chain.inBuffer = new TestBuffer(kSampleCount * sizeof(float));
+        chain.outBuffer = new TestBuffer(kSampleCount * sizeof(float));
+        for (size_t i = 0; i < configs.size(); ++i) {
+            effect_descriptor_t desc{};
+            desc.uuid.timeLow = i;
+            desc.flags = EFFECT_FLAG_TYPE_INSERT;
+            sp<EffectModule> effect = new EffectModule(chain.callback, &desc, i /* id */,
+                    kSessionId, false /* pinned */, AUDIO_PORT_HANDLE_NONE);
+            ASSERT_EQ(OK, effect->configure());
+            effect->setInBuffer(chain.inBuffer);
+            if (!chain.effects.isEmpty()) {
+                chain.effects.top()->configure();
+                chain.effects.top()->setOutBuffer(chain.inBuffer);
+                chain.effects.top()->updateAccessMode();
+            }
+            effect->setOutBuffer(chain.outBuffer);
+            ASSERT_EQ(OK, effect->configure());
+            chain.effects.push(effect);
+        }
+        for (const sp<EffectModule>& effect : chain.effects) {
+            ASSERT_EQ(OK, effect->setEnabled(true, false /* fromHandle */));
+            effect->updateState();
+            ASSERT_EQ(EffectModule::ACTIVE, effect->state());
+        }
+        planBuffers(chain);
+    }
+
+    static size_t planBuffers(Chain& chain) {
+        return chain.linked ? EffectChain::linkInt16Outputs(chain.effects) : 0;
+    }
+
+    // Removes an effect as EffectChain::removeEffect_l() does.
+    static void removeEffect(Chain& chain, size_t index) {
+        const sp<EffectModule> effect = chain.effects[index];
+        if (effect->state() == EffectModule::ACTIVE
+                || effect->state() == EffectModule::STOPPING) {
+            effect->stop();
+        }
+        effect->release_l();
+        const size_t size = chain.effects.size();
+        if (index == size - 1 && index != 0) {
+            chain.effects[index - 1]->configure();
+            chain.effects[index - 1]->setOutBuffer(chain.outBuffer);
+            chain.effects[index - 1]->updateAccessMode();
+        }
+        chain.effects.removeAt(index);
+        effect->linkInt16Output(nullptr);
+        if (index == 0 && size > 1) {
+            chain.effects[0]->configure();
+            chain.effects[0]->setInBuffer(chain.inBuffer);
+            chain.effects[0]->updateAccessMode();
+        }
+        planBuffers(chain);
+    }
+
+    static void releaseChain(Chain& chain) {
+        for (const sp<EffectModule>& effect : chain.effects) {
+            effect->release_l();
+        }
+        chain.effects.clear();
+    }
+
+    // Processes the chain once as EffectChain::process_l() does and returns its output.
+    static std::vector<float> process(Chain& chain, size_t n) {
+        const std::vector<float> input = createInput(n);
+        std::copy(input.begin(), input.end(), chain.inBuffer->audioBuffer()->f32);
+        std::fill_n(chain.outBuffer->audioBuffer()->f32, kSampleCount, 0.f);
+        EffectBufferHalInterface *int16Buffer = nullptr;
+        for (size_t i = 0; i < chain.effects.size(); i++) {
+            int16Buffer = chain.effects[i]->process(int16Buffer);
+        }
+        for (size_t i = 0; i < chain.effects.size(); i++) {
+            chain.effects[i]->updateState();
+        }
+        const float *output = chain.outBuffer->audioBuffer()->f32;
+        return std::vector<float>(output, output + kSampleCount);
+    }
+
+    // int16 effects, some of them following each other, around a float effect.
+    const std::vector<EffectConfig> mConfigs{
+        {false /* supportsFloat */, 100},
+        {false /* supportsFloat */, -300},
+        {false /* supportsFloat */, 500},
+        {true /* supportsFloat */, 700},
+        {false /* supportsFloat */, -900},
+        {false /* supportsFloat */, 1100},
+    };
+};
+
+TEST_F(EffectChainTest, LinkedOutputMatchesUnlinkedOutput) {
+    Chain unlinked, linked;
+    ASSERT_NO_FATAL_FAILURE(createChain(unlinked, mConfigs, false /* linked */));
+    ASSERT_NO_FATAL_FAILURE(createChain(linked, mConfigs, true /* linked */));
+    // 0 -> 1 -> 2 and 4 -> 5, the float effect 3 is never linked.
+    EXPECT_EQ(3u, planBuffers(linked));
+
+    for (size_t n = 0; n < kProcessCount; ++n) {
+        ASSERT_EQ(process(unlinked, n), process(linked, n)) << "process " << n;
+    }
+    releaseChain(unlinked);
+    releaseChain(linked);
+}
+
+TEST_F(EffectChainTest, LinkedOutputMatchesUnlinkedOutputWhenDisabled) {
+    Chain unlinked, linked;
+    ASSERT_NO_FATAL_FAILURE(createChain(unlinked, mConfigs, false /* linked */));
+    ASSERT_NO_FATAL_FAILURE(createChain(linked, mConfigs, true /* linked */));
+
+    // Disabling an effect does not plan the buffers again: the linked effects 0 and 1 stay
+    // linked while 1 stops, and is idle, then restarts.
+    for (size_t n = 0; n < kProcessCount * 2; ++n) {
+        if (n == 2 || n == kProcessCount) {
+            const bool enabled = n != 2;
+            ASSERT_EQ(OK, unlinked.effects[1]->setEnabled(enabled, false /* fromHandle */));
+            ASSERT_EQ(OK, linked.effects[1]->setEnabled(enabled, false /* fromHandle */));
+        }
+        ASSERT_EQ(process(unlinked, n), process(linked, n)) << "process " << n;
+        if (n == kProcessCount - 1) {
+            ASSERT_EQ(EffectModule::IDLE, linked.effects[1]->state());
+        }
+    }
+    ASSERT_EQ(EffectModule::ACTIVE, linked.effects[1]->state());
+    releaseChain(unlinked);
+    releaseChain(linked);
+}
+
+TEST_F(EffectChainTest, LinkedOutputMatchesUnlinkedOutputWhenRemoved) {
+    Chain unlinked, linked;
+    ASSERT_NO_FATAL_FAILURE(createChain(unlinked, mConfigs, false /* linked */));
+    ASSERT_NO_FATAL_FAILURE(createChain(linked, mConfigs, true /* linked */));
+
+    size_t n = 0;
+    for (; n < 2; ++n) {
+        ASSERT_EQ(process(unlinked, n), process(linked, n)) << "process " << n;
+    }
+    // Remove a linked effect in the middle: 0 -> 2 and 4 -> 5.
+    removeEffect(unlinked, 1);
+    removeEffect(linked, 1);
+    EXPECT_EQ(2u, planBuffers(linked));
+    for (; n < 4; ++n) {
+        ASSERT_EQ(process(unlinked, n), process(linked, n)) << "process " << n;
+    }
+    // Remove the last effect, linked from the previous one which becomes the last: 0 -> 2.
+    removeEffect(unlinked, unlinked.effects.size() - 1);
+    removeEffect(linked, linked.effects.size() - 1);
+    EXPECT_EQ(1u, planBuffers(linked));
+    for (; n < 6; ++n) {
+        ASSERT_EQ(process(unlinked, n), process(linked, n)) << "process " << n;
+    }
+    // Remove the first effect, linked to the next one: no more links.
+    removeEffect(unlinked, 0);
+    removeEffect(linked, 0);
+    EXPECT_EQ(0u, planBuffers(linked));
+    for (; n < kProcessCount; ++n) {
+        ASSERT_EQ(process(unlinked, n), process(linked, n)) << "process " << n;
+    }
+    releaseChain(unlinked);
+    releaseChain(linked);
+}
+
+}  // namespace android
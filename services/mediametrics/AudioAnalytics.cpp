@@ -339,8 +339,10 @@ std::pair<int, std::string> sendToStatsd(const char * const (& fields)[N], Types
     return { result, ss.str() };
 }
 
-AudioAnalytics::AudioAnalytics(const std::shared_ptr<StatsdLog>& statsdLog)
+AudioAnalytics::AudioAnalytics(const std::shared_ptr<StatsdLog>& statsdLog,
+        TimeMachine::Backend backend, const std::string& spillPath)
     : mDeliverStatistics(property_get_bool(PROP_AUDIO_ANALYTICS_CLOUD_ENABLED, true))
+    , mAnalyticsState(backend, spillPath)
     , mStatsdLog(statsdLog)
     , mAudioPowerUsage(this, statsdLog)
 {
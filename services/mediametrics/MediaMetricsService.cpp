@@ -62,6 +62,11 @@ static constexpr size_t kMaxExpiredAtOnce = 50;
 
 // TODO: need to look at tuning kMaxRecords and friends for low-memory devices
 
+// TimeMachine backend for the audio analytics state, "map" (default) or "columnar".
+#define PROP_TIME_MACHINE_BACKEND "persist.mediametrics.timemachine.backend"
+// File for the columnar TimeMachine to spill evicted keys, unset to discard them.
+#define PROP_TIME_MACHINE_SPILL_PATH "persist.mediametrics.timemachine.spill_path"
+
 /* static */
 nsecs_t MediaMetricsService::roundTime(nsecs_t timeNs)
 {
@@ -105,6 +110,28 @@ MediaMetricsService::getSanitizedPackageNameAndVersionCode(uid_t uid) {
     }
 }
 
+/* static */
+mediametrics::TimeMachine::Backend MediaMetricsService::getTimeMachineBackend()
+{
+    char value[PROPERTY_VALUE_MAX];
+    property_get(PROP_TIME_MACHINE_BACKEND, value, "map");
+    if (strcmp(value, "columnar") == 0) {
+        return mediametrics::TimeMachine::Backend::COLUMNAR;
+    }
+    if (strcmp(value, "map") != 0) {
+        ALOGW("%s: unknown %s \"%s\", using map", __func__, PROP_TIME_MACHINE_BACKEND, value);
+    }
+    return mediametrics::TimeMachine::Backend::MAP;
+}
+
+/* static */
+std::string MediaMetricsService::getTimeMachineSpillPath()
+{
+    char value[PROPERTY_VALUE_MAX];
+    property_get(PROP_TIME_MACHINE_SPILL_PATH, value, "");
+    return value;
+}
+
 MediaMetricsService::MediaMetricsService()
         : mMaxRecords(kMaxRecords),
           mMaxRecordAgeNs(kMaxRecordAgeNs),
@@ -14,7 +14,15 @@
  * limitations under the License.
  */
 
+#include <malloc.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <media/MediaMetricsItem.h>
+#include <media/MediaMetricsRecordRing.h>
 #include <benchmark/benchmark.h>
 
 class MyItem : public android::mediametrics::BaseItem {
@@ -44,4 +52,117 @@ static void BM_SubmitBuffer(benchmark::State& state)
 
 BENCHMARK(BM_SubmitBuffer)->Iterations(4000);   // Adjust magic number until test runs
 
+// An item similar to those sent by AudioFlinger for every AudioTrack create/start/stop.
+static android::mediametrics::Item makeAudioTrackItem(int i) {
+    android::mediametrics::Item item("audio.track." + std::to_string(i));
+    item.set("event#", "start")
+        .set("channelMask", (int32_t)3)
+        .set("contentType", "AUDIO_CONTENT_TYPE_MUSIC")
+        .set("encoding", "AUDIO_FORMAT_PCM_16_BIT")
+        .set("frameCount", (int32_t)3840)
+        .set("logSessionId", "0123456789abcdef")
+        .set("outputDevices", "AUDIO_DEVICE_OUT_SPEAKER")
+        .set("playbackSpeed", 1.)
+        .set("sampleRate", (int32_t)48000)
+        .set("sessionId", (int32_t)(1000 + i))
+        .set("streamType", "AUDIO_STREAM_MUSIC")
+        .set("thread", (int32_t)13)
+        .set("underrun", (int64_t)0)
+        .set("usage", "AUDIO_USAGE_MEDIA")
+        .setPid(1000)
+        .setUid(1041);
+    return item;
+}
+
+/*
+ * Measures the service side ingestion of a submitted byte string:
+ * MediaMetricsService::submitBuffer() deserializes it into a new Item
+ * which is shared with the TimeMachine, the TransactionLog and the item queue.
+ *
+ * Reports the items ingested per second and the heap bytes retained per item.
+ */
+static void BM_ItemIngestion(benchmark::State& state)
+{
+    char *buffer;
+    size_t length;
+    if (makeAudioTrackItem(0).writeToByteString(&buffer, &length) != android::NO_ERROR) {
+        state.SkipWithError("cannot serialize item");
+        return;
+    }
+    constexpr size_t kRetainedItems = 2000; // as kMaxRecords in MediaMetricsService.cpp.
+    std::vector<std::shared_ptr<const android::mediametrics::Item>> items;
+    items.reserve(kRetainedItems);
+    auto ingest = [&]() {
+        auto item = std::make_shared<android::mediametrics::Item>();
+        if (item->readFromByteString(buffer, length) != android::NO_ERROR) return false;
+        items.push_back(std::move(item));
+        return true;
+    };
+
+    // Heap retained by the items queued in the service, measured outside of the timed loop.
+    const size_t heapBefore = mallinfo().uordblks;
+    for (size_t i = 0; i < kRetainedItems; ++i) {
+        if (!ingest()) {
+            state.SkipWithError("cannot deserialize item");
+            free(buffer);
+            return;
+        }
+    }
+    const double bytesPerItem = (double)(mallinfo().uordblks - heapBefore) / kRetainedItems;
+
+    for (auto _ : state) {
+        if (items.size() == kRetainedItems) {
+            state.PauseTiming();
+            items.clear();
+            state.ResumeTiming();
+        }
+        (void)ingest();
+    }
+    free(buffer);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["bytes/item"] = bytesPerItem;
+}
+
+BENCHMARK(BM_ItemIngestion);
+
+/*
+ * Measures the client side cost of a batched item, to compare with BM_SubmitBuffer:
+ * the byte string is appended to a RecordRing sized as in BaseItem::enableBatching(),
+ * from one or more threads, and drained when full.
+ */
+static void BM_RecordRingAppend(benchmark::State& state)
+{
+    using Ring = android::mediametrics::RecordRing<1024, 128>;
+    static Ring *ring;
+    static std::mutex drainLock;  // drain() is single consumer
+    static std::vector<char> buffers;
+    if (state.thread_index() == 0) {
+        ring = new Ring();
+        buffers.reserve(Ring::kRecordSize * Ring::kRecordCount);
+    }
+
+    char *buffer;
+    size_t length;
+    if (makeAudioTrackItem(state.thread_index()).writeToByteString(&buffer, &length)
+            != android::NO_ERROR) {
+        state.SkipWithError("cannot serialize item");
+        return;
+    }
+    for (auto _ : state) {
+        while (!ring->append(buffer, length)) {
+            std::lock_guard l(drainLock);
+            buffers.clear();
+            ring->drain(&buffers);
+        }
+    }
+    free(buffer);
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete ring;
+    }
+}
+
+BENCHMARK(BM_RecordRingAppend)->ThreadRange(1, 4);
+
 BENCHMARK_MAIN();
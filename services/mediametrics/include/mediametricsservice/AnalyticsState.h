@@ -35,6 +35,15 @@ namespace android::mediametrics {
  */
 class AnalyticsState {
 public:
+    AnalyticsState() = default;
+
+    /**
+     * \param backend the TimeMachine storage.
+     * \param spillPath the TimeMachine spill file for TimeMachine::Backend::COLUMNAR.
+     */
+    explicit AnalyticsState(TimeMachine::Backend backend, const std::string& spillPath = {})
+        : mTimeMachine(backend, spillPath) {}
+
     /**
      * Returns success if AnalyticsState accepts the item.
      *
@@ -102,7 +111,8 @@ public:
             ll -= l;
         }
         if (ll > 0) {
-            ss << "TimeMachine: gc(" << mTimeMachine.getGarbageCollectionCount() << ")\n";
+            ss << "TimeMachine: gc(" << mTimeMachine.getGarbageCollectionCount() << ") "
+                    << mTimeMachine.getBackendSummary() << "\n";
             --ll;
         }
         if (ll > 0) {
@@ -33,7 +33,14 @@ class AudioAnalytics
     friend AudioPowerUsage;
 
 public:
-    explicit AudioAnalytics(const std::shared_ptr<StatsdLog>& statsdLog);
+    /**
+     * \param statsdLog the log of the atoms sent to statsd.
+     * \param backend the TimeMachine storage of the analytics state.
+     * \param spillPath the TimeMachine spill file for TimeMachine::Backend::COLUMNAR.
+     */
+    explicit AudioAnalytics(const std::shared_ptr<StatsdLog>& statsdLog,
+            TimeMachine::Backend backend = TimeMachine::Backend::MAP,
+            const std::string& spillPath = {});
     ~AudioAnalytics();
 
     /**
@@ -0,0 +1,1101 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <android-base/thread_annotations.h>
+#include <media/MediaMetricsItem.h>
+#include <utils/Timers.h>
+
+namespace android::mediametrics {
+
+/**
+ * The ColumnarTimeMachine is an alternative storage for the TimeMachine
+ * with the same semantics and interface.
+ *
+ * Instead of a std::map of variants per property, the time sequence of each property
+ * is a ring of fixed size segments, holding the times and the values in separate columns.
+ * Integers and doubles are stored inline, strings and rates are interned so that the
+ * repeated values of the audio keys (device names, formats, ...) are only stored once.
+ * Segments are recycled through a free list, so a steady churn of keys does not allocate.
+ *
+ * When the number of keys exceeds the high water mark, the least recently modified keys
+ * are serialized into a memory mapped spill file, if one is configured, rather than
+ * discarded. The spill file is a circular log of fixed size, so history is retained
+ * much longer for the same resident memory: the kernel may write back and reclaim the
+ * pages of the spilled keys. Spilled keys remain visible to get() and dump()
+ * but are read only. The spill file does not persist across restarts.
+ *
+ * The ColumnarTimeMachine is thread safe, it is protected by a single lock.
+ */
+class ColumnarTimeMachine final {
+    // These must match TimeMachine.
+    static inline constexpr size_t kTimeSequenceMaxElements = 50;
+    static inline constexpr size_t kKeyMaxProperties = 128;
+    static inline constexpr size_t kKeyLowWaterMark = 400;
+    static inline constexpr size_t kKeyHighWaterMark = 500;
+
+public:
+    static inline constexpr size_t kDefaultSpillBytes = 8 * 1024 * 1024;
+
+    ColumnarTimeMachine() = default;
+
+    /**
+     * \param keyLowWaterMark the number of keys kept in memory after garbage collection.
+     * \param keyHighWaterMark the number of keys in memory that triggers garbage collection.
+     * \param spillPath the file for keys evicted by garbage collection, empty for none.
+     * \param spillBytes the size of the spill file.
+     */
+    ColumnarTimeMachine(size_t keyLowWaterMark, size_t keyHighWaterMark,
+            const std::string &spillPath = {}, size_t spillBytes = kDefaultSpillBytes)
+        : mKeyLowWaterMark(keyLowWaterMark)
+        , mKeyHighWaterMark(keyHighWaterMark) {
+        LOG_ALWAYS_FATAL_IF(keyHighWaterMark <= keyLowWaterMark,
+              "%s: required that keyHighWaterMark:%zu > keyLowWaterMark:%zu",
+                  __func__, keyHighWaterMark, keyLowWaterMark);
+        if (!spillPath.empty()) {
+            auto spill = std::make_unique<SpillFile>(spillPath, spillBytes);
+            if (spill->isValid()) mSpill = std::move(spill);
+        }
+    }
+
+    // The copy holds the keys in memory but not the spilled keys,
+    // as the spill file is owned by a single ColumnarTimeMachine.
+    ColumnarTimeMachine(const ColumnarTimeMachine& other)
+        : mKeyLowWaterMark(other.mKeyLowWaterMark)
+        , mKeyHighWaterMark(other.mKeyHighWaterMark) {
+        std::lock_guard lock(other.mLock);
+        mStrings = other.mStrings;
+        mRates = other.mRates;
+        mFreeRates = other.mFreeRates;
+        mSegments = other.mSegments;
+        mFreeSegments = other.mFreeSegments;
+        mHistory = other.mHistory;
+        mGarbageCollectionCount = other.mGarbageCollectionCount.load();
+    }
+    ColumnarTimeMachine& operator=(const ColumnarTimeMachine&) = delete;
+
+    /**
+     * Put all the properties from an item, see TimeMachine::put().
+     */
+    status_t put(const std::shared_ptr<const mediametrics::Item>& item, bool isTrusted = false) {
+        const int64_t time = item->getTimestamp();
+        const std::string &key = item->getKey();
+
+        std::lock_guard lock(mLock);
+        auto it = mHistory.find(key);
+        if (it == mHistory.end()) {
+            if (!isTrusted) return PERMISSION_DENIED;
+
+            (void)gc_l();
+
+            // We set the allowUid for client access on key creation.
+            int32_t allowUid = -1;
+            (void)item->get(AMEDIAMETRICS_PROP_ALLOWUID, &allowUid);
+            it = mHistory.try_emplace(key, (uid_t)allowUid, time).first;
+            if (allowUid != -1) {
+                putValue_l(it->second, AMEDIAMETRICS_PROP_ALLOWUID, (int32_t)allowUid, time);
+            }
+        } else if (!isTrusted) {
+            status_t status = checkPermission(it->second, item->getUid());
+            if (status != NO_ERROR) return status;
+        }
+
+        for (const auto &prop : *item) {
+            const std::string &name = prop.getName();
+            if (name.size() == 0 || name[0] == '_') continue;
+
+            // Cross key settings are with [key]property
+            if (name[0] == '[') {
+                if (!isTrusted) continue;
+                const size_t end = name.find_first_of(']');
+                if (end == std::string::npos) continue;
+                const std::string remoteKey = name.substr(1, end - 1);
+                const std::string remoteName = name.substr(end + 1);
+                if (remoteKey.size() == 0 || remoteName.size() == 0) continue;
+                auto remoteIt = mHistory.find(remoteKey);
+                if (remoteIt == mHistory.end()) continue;
+                putProp_l(remoteIt->second, remoteName, prop, time);
+            } else {
+                putProp_l(it->second, name, prop, time);
+            }
+        }
+        return NO_ERROR;
+    }
+
+    template <typename T>
+    status_t get(const std::string &key, const std::string &property,
+            T* value, int32_t uidCheck = -1, int64_t time = 0) const {
+        if (time == 0) time = systemTime(SYSTEM_TIME_REALTIME);
+        std::lock_guard lock(mLock);
+        const auto it = mHistory.find(key);
+        if (it != mHistory.end()) {
+            return checkPermission(it->second, uidCheck)
+                    ?: getValue_l(it->second, property, value, time);
+        }
+        if (mSpill != nullptr) {
+            const std::string_view record = mSpill->find(key);
+            if (!record.empty()) return getSpilledValue(record, property, value, uidCheck, time);
+        }
+        return BAD_VALUE;
+    }
+
+    /**
+     * Individual property put, see TimeMachine::put().
+     */
+    template <typename T>
+    status_t put(const std::string &url, T &&e, int64_t time = 0) {
+        if (time == 0) time = systemTime(SYSTEM_TIME_REALTIME);
+        std::lock_guard lock(mLock);
+        const auto it = findKeyFromUrl(url, mHistory);
+        if (it == mHistory.end()) return BAD_VALUE;
+        putValue_l(it->second, url.substr(it->first.size() + 1), std::forward<T>(e), time);
+        return NO_ERROR;
+    }
+
+    /**
+     * Individual property get
+     */
+    template <typename T>
+    status_t get(const std::string &url, T* value, int32_t uidCheck, int64_t time = 0) const {
+        std::string key;
+        {
+            std::lock_guard lock(mLock);
+            const auto it = findKeyFromUrl(url, mHistory);
+            if (it != mHistory.end()) {
+                key = it->first;
+            } else if (mSpill != nullptr) {
+                const auto spillIt = findKeyFromUrl(url, mSpill->index());
+                if (spillIt == mSpill->index().end()) return BAD_VALUE;
+                key = spillIt->first;
+            } else {
+                return BAD_VALUE;
+            }
+        }
+        return get(key, url.substr(key.size() + 1), value, uidCheck, time);
+    }
+
+    /**
+     * Individual property get with default
+     */
+    template <typename T>
+    T get(const std::string &url, const T &defaultValue, int32_t uidCheck,
+            int64_t time = 0) const {
+        T value;
+        return get(url, &value, uidCheck, time) == NO_ERROR
+                ? value : defaultValue;
+    }
+
+    /**
+     *  Returns number of keys in memory, the spilled keys are not counted.
+     */
+    size_t size() const {
+        std::lock_guard lock(mLock);
+        return mHistory.size();
+    }
+
+    /**
+     *  Returns number of keys in the spill file.
+     */
+    size_t spilledSize() const {
+        std::lock_guard lock(mLock);
+        return mSpill != nullptr ? mSpill->index().size() : 0;
+    }
+
+    /**
+     * Clears all properties, including the spilled keys.
+     */
+    void clear() {
+        std::lock_guard lock(mLock);
+        mHistory.clear();
+        mStrings.clear();
+        mRates.clear();
+        mFreeRates.clear();
+        mSegments.clear();
+        mFreeSegments.clear();
+        if (mSpill != nullptr) mSpill->clear();
+        mGarbageCollectionCount = 0;
+    }
+
+    /**
+     * Returns the state as a string and the number of lines in the string,
+     * in the same format as TimeMachine::dump().
+     *
+     * Keys and properties with no change since sinceNs are skipped without being visited.
+     *
+     * \param lines the maximum number of lines in the string returned.
+     * \param sinceNs the nanoseconds since Unix epoch to start dump (0 shows all)
+     * \param prefix the desired key prefix to match (nullptr shows all)
+     */
+    std::pair<std::string, int32_t> dump(
+            int32_t lines = INT32_MAX, int64_t sinceNs = 0, const char *prefix = nullptr) const {
+        std::lock_guard lock(mLock);
+        std::stringstream ss;
+        int32_t ll = lines;
+
+        // Merge the keys in memory with the spilled keys, both sorted by key.
+        // A key in memory takes precedence over an older spilled copy.
+        auto it = prefix != nullptr ? mHistory.lower_bound(prefix) : mHistory.begin();
+        auto spillIt = mSpill == nullptr ? SpillFile::Index::const_iterator{}
+                : prefix != nullptr ? mSpill->index().lower_bound(prefix)
+                : mSpill->index().begin();
+        const auto spillEnd = mSpill == nullptr ? spillIt : mSpill->index().end();
+        auto matches = [prefix](const std::string& key) {
+            return prefix == nullptr || startsWith(key, prefix);
+        };
+        while (ll > 0) {
+            const bool memory = it != mHistory.end() && matches(it->first);
+            const bool spilled = spillIt != spillEnd && matches(spillIt->first);
+            if (!memory && !spilled) break;
+            if (memory && (!spilled || it->first <= spillIt->first)) {
+                if (spilled && it->first == spillIt->first) ++spillIt;
+                if (it->second.newestTime >= sinceNs) {
+                    ll -= dumpKey_l(ss, it->first, it->second, ll, sinceNs);
+                }
+                ++it;
+            } else {
+                if (spillIt->second.newestTime >= sinceNs) {
+                    ll -= dumpSpilledKey(ss, mSpill->recordAt(spillIt->second), ll, sinceNs);
+                }
+                ++spillIt;
+            }
+        }
+        return { ss.str(), lines - ll };
+    }
+
+    size_t getGarbageCollectionCount() const {
+        return mGarbageCollectionCount;
+    }
+
+private:
+    /**
+     * StringPool interns the property names and the string values.
+     * Strings are reference counted and their id is reused once released.
+     */
+    class StringPool {
+    public:
+        // Returns the id of s, acquiring a reference.
+        uint32_t intern(const std::string &s) {
+            const auto [it, inserted] = mIds.emplace(s, 0);
+            if (!inserted) {
+                ++mEntries[it->second].refs;
+                return it->second;
+            }
+            uint32_t id;
+            if (mFree.empty()) {
+                id = mEntries.size();
+                mEntries.emplace_back();
+            } else {
+                id = mFree.back();
+                mFree.pop_back();
+            }
+            it->second = id;
+            mEntries[id] = { &it->first, 1 };
+            return id;
+        }
+
+        // Returns the id of s without acquiring a reference, or -1 if s is not interned.
+        int64_t find(const std::string &s) const {
+            const auto it = mIds.find(s);
+            return it == mIds.end() ? -1 : it->second;
+        }
+
+        void release(uint32_t id) {
+            Entry &entry = mEntries[id];
+            if (--entry.refs == 0) {
+                mIds.erase(*entry.value);
+                entry.value = nullptr;
+                mFree.push_back(id);
+            }
+        }
+
+        const std::string &get(uint32_t id) const { return *mEntries[id].value; }
+
+        void clear() {
+            mIds.clear();
+            mEntries.clear();
+            mFree.clear();
+        }
+
+        StringPool() = default;
+        StringPool(const StringPool &other) { *this = other; }
+        StringPool &operator=(const StringPool &other) {
+            // mEntries points into mIds, so it must be rebuilt.
+            mIds = other.mIds;
+            mEntries = other.mEntries;
+            mFree = other.mFree;
+            for (auto &[s, id] : mIds) mEntries[id].value = &s;
+            return *this;
+        }
+
+    private:
+        struct Entry {
+            const std::string *value; // the key of mIds
+            uint32_t refs;
+        };
+        std::map<std::string, uint32_t> mIds; // node based, so mEntries may point to keys.
+        std::vector<Entry> mEntries;
+        std::vector<uint32_t> mFree;
+    };
+
+    // A Segment holds kSlots consecutive elements of a time sequence.
+    struct Segment {
+        static inline constexpr size_t kSlots = 8;
+        int64_t times[kSlots];
+        int64_t values[kSlots]; // int32, int64 or double bits, or string or rate id.
+        uint8_t types[kSlots];  // mediametrics::Type
+    };
+    static inline constexpr size_t kSegmentsPerColumn =
+            (kTimeSequenceMaxElements + Segment::kSlots - 1) / Segment::kSlots;
+
+    // A Column is the time sequence of one property, as a ring of
+    // kTimeSequenceMaxElements elements sorted by time.
+    // Segments are allocated as the ring grows.
+    struct Column {
+        uint32_t name; // StringPool id
+        uint8_t head = 0;
+        uint8_t count = 0;
+        uint8_t segmentCount = 0;
+        std::array<uint32_t, kSegmentsPerColumn> segments{};
+    };
+
+    struct KeyColumns {
+        KeyColumns(uid_t allowUid_, int64_t time)
+            : allowUid(allowUid_)
+            , lastModificationTime(time) {}
+
+        uid_t allowUid;
+        int64_t lastModificationTime;
+        int64_t newestTime = INT64_MIN; // to skip the key when dumping a time range.
+        unsigned int rejectedPropertiesCount = 0;
+        std::vector<Column> columns; // sorted by property name.
+    };
+
+    using History = std::map<std::string /* key */, KeyColumns>;
+
+    // A reference to a value of a time sequence, in memory or spilled.
+    struct Value {
+        uint8_t type = kTypeNone;
+        int64_t raw = 0;                 // kTypeInt32, kTypeInt64 and kTypeDouble bits.
+        std::string_view str;            // kTypeCString
+        std::pair<int64_t, int64_t> rate; // kTypeRate
+
+        template <typename T>
+        status_t to(T *value) const {
+            if constexpr (std::is_same_v<T, int32_t>) {
+                if (type != kTypeInt32) return BAD_VALUE;
+                *value = (int32_t)raw;
+            } else if constexpr (std::is_same_v<T, int64_t>) {
+                if (type != kTypeInt64) return BAD_VALUE;
+                *value = raw;
+            } else if constexpr (std::is_same_v<T, double>) {
+                if (type != kTypeDouble) return BAD_VALUE;
+                memcpy(value, &raw, sizeof(*value));
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                if (type != kTypeCString) return BAD_VALUE;
+                *value = str;
+            } else if constexpr (std::is_same_v<T, std::pair<int64_t, int64_t>>) {
+                if (type != kTypeRate) return BAD_VALUE;
+                *value = rate;
+            } else {
+                static_assert(std::is_same_v<T, std::monostate>, "unsupported value type");
+                if (type != kTypeNone) return BAD_VALUE;
+            }
+            return NO_ERROR;
+        }
+
+        // Same format as operator<<(std::ostream&, const Item::Prop::Elem&).
+        friend std::ostream &operator<<(std::ostream &s, const Value &v) {
+            switch (v.type) {
+            case kTypeInt32:
+            case kTypeInt64:
+                return s << v.raw;
+            case kTypeDouble: {
+                double d;
+                memcpy(&d, &v.raw, sizeof(d));
+                return s << d;
+            }
+            case kTypeCString:
+                return s << v.str;
+            case kTypeRate:
+                return s << "{ " << v.rate.first << ", " << v.rate.second << " }";
+            default:
+                return s << "none_item";
+            }
+        }
+    };
+
+    /**
+     * SpillFile is a fixed size memory mapped file written as a circular log
+     * of serialized KeyColumns records. Writing a record overwrites the oldest records.
+     */
+    class SpillFile {
+    public:
+        struct Entry {
+            size_t offset;
+            size_t length;
+            int64_t newestTime;
+        };
+        using Index = std::map<std::string /* key */, Entry>;
+
+        SpillFile(const std::string &path, size_t bytes) {
+            const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (fd < 0) {
+                ALOGW("%s: cannot open %s: %s", __func__, path.c_str(), strerror(errno));
+                return;
+            }
+            if (ftruncate(fd, bytes) == 0) {
+                void *data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (data != MAP_FAILED) {
+                    mData = static_cast<uint8_t *>(data);
+                    mBytes = bytes;
+                }
+            }
+            if (mData == nullptr) {
+                ALOGW("%s: cannot map %zu bytes of %s: %s",
+                        __func__, bytes, path.c_str(), strerror(errno));
+            }
+            close(fd); // the mapping keeps the file.
+        }
+
+        ~SpillFile() {
+            if (mData != nullptr) munmap(mData, mBytes);
+        }
+
+        SpillFile(const SpillFile&) = delete;
+        SpillFile& operator=(const SpillFile&) = delete;
+
+        bool isValid() const { return mData != nullptr; }
+
+        // Appends the record for key, which replaces any previous record for key.
+        bool append(const std::string &key, int64_t newestTime, const std::string &record) {
+            const size_t length = record.size();
+            if (length > mBytes) return false;
+            if (mWriteOffset + length > mBytes) {
+                // Wrap around, the records left from the previous lap are lost.
+                while (!mRecords.empty() && mRecords.front().lap < mLap) popOldest();
+                ++mLap;
+                mWriteOffset = 0;
+            }
+            while (!mRecords.empty() && mRecords.front().lap < mLap
+                    && mRecords.front().offset < mWriteOffset + length) {
+                popOldest();
+            }
+            memcpy(mData + mWriteOffset, record.data(), length);
+            mRecords.push_back({mWriteOffset, mLap, key});
+            mIndex[key] = { mWriteOffset, length, newestTime };
+            mWriteOffset += length;
+            return true;
+        }
+
+        std::string_view find(const std::string &key) const {
+            const auto it = mIndex.find(key);
+            return it == mIndex.end() ? std::string_view{} : recordAt(it->second);
+        }
+
+        std::string_view recordAt(const Entry &entry) const {
+            return { reinterpret_cast<const char *>(mData + entry.offset), entry.length };
+        }
+
+        const Index &index() const { return mIndex; }
+
+        void clear() {
+            mIndex.clear();
+            mRecords.clear();
+            mWriteOffset = 0;
+            mLap = 0;
+        }
+
+    private:
+        void popOldest() {
+            const Record &record = mRecords.front();
+            const auto it = mIndex.find(record.key);
+            // The key may have been spilled again more recently.
+            if (it != mIndex.end() && it->second.offset == record.offset) mIndex.erase(it);
+            mRecords.pop_front();
+        }
+
+        struct Record {
+            size_t offset;
+            uint64_t lap;
+            std::string key;
+        };
+
+        uint8_t *mData = nullptr;
+        size_t mBytes = 0;
+        size_t mWriteOffset = 0;
+        uint64_t mLap = 0;
+        std::deque<Record> mRecords; // in write order
+        Index mIndex;
+    };
+
+    // Reads the spill record format written by spill_l().
+    class Reader {
+    public:
+        explicit Reader(std::string_view data) : mData(data) {}
+
+        template <typename T>
+        bool read(T *value) {
+            if (mData.size() < sizeof(T)) return fail();
+            memcpy(value, mData.data(), sizeof(T));
+            mData.remove_prefix(sizeof(T));
+            return true;
+        }
+
+        bool read(std::string_view *value) {
+            uint32_t length;
+            if (!read(&length) || mData.size() < length) return fail();
+            *value = mData.substr(0, length);
+            mData.remove_prefix(length);
+            return true;
+        }
+
+        bool read(Value *value) {
+            if (!read(&value->type)) return false;
+            switch (value->type) {
+            case kTypeInt32:
+            case kTypeInt64:
+            case kTypeDouble:
+                return read(&value->raw);
+            case kTypeCString:
+                return read(&value->str);
+            case kTypeRate:
+                return read(&value->rate.first) && read(&value->rate.second);
+            default:
+                return true;
+            }
+        }
+
+        bool ok() const { return mOk; }
+
+    private:
+        bool fail() {
+            mOk = false;
+            return false;
+        }
+
+        std::string_view mData;
+        bool mOk = true;
+    };
+
+    template <typename T>
+    static void write(std::string &out, const T &value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    static void write(std::string &out, std::string_view value) {
+        write(out, (uint32_t)value.size());
+        out.append(value);
+    }
+
+    // Return NO_ERROR only if the passed in uidCheck is -1 or matches the allowUid.
+    static status_t checkPermission(const KeyColumns &keyColumns, uid_t uidCheck) {
+        return uidCheck != (uid_t)-1 && uidCheck != keyColumns.allowUid
+                ? PERMISSION_DENIED : NO_ERROR;
+    }
+
+    // Finds the key of a URL in a map sorted by key.
+    template <typename Map>
+    static typename Map::const_iterator findKeyFromUrl(const std::string &url, const Map &map) {
+        auto it = map.upper_bound(url);
+        if (it == map.begin()) return map.end();
+        --it;  // go to the actual key, if it exists.
+        const std::string &key = it->first;
+        if (key.size() >= url.size() || strncmp(key.c_str(), url.c_str(), key.size())) {
+            return map.end();
+        }
+        return it;
+    }
+    template <typename Map>
+    static typename Map::iterator findKeyFromUrl(const std::string &url, Map &map) {
+        const auto it = findKeyFromUrl(url, static_cast<const Map &>(map));
+        return it == map.cend() ? map.end() : map.find(it->first);
+    }
+
+    // Position of an element of a column.
+    struct Slot {
+        Segment *segment;
+        size_t index;
+    };
+
+    Slot slot_l(const Column &column, size_t i) REQUIRES(mLock) {
+        const size_t position = (column.head + i) % kTimeSequenceMaxElements;
+        return { &mSegments[column.segments[position / Segment::kSlots]],
+                position % Segment::kSlots };
+    }
+    const Segment &segment_l(const Column &column, size_t i, size_t *index) const
+            REQUIRES(mLock) {
+        const size_t position = (column.head + i) % kTimeSequenceMaxElements;
+        *index = position % Segment::kSlots;
+        return mSegments[column.segments[position / Segment::kSlots]];
+    }
+    int64_t timeAt_l(const Column &column, size_t i) const REQUIRES(mLock) {
+        size_t index;
+        return segment_l(column, i, &index).times[index];
+    }
+    Value valueAt_l(const Column &column, size_t i) const REQUIRES(mLock) {
+        size_t index;
+        const Segment &segment = segment_l(column, i, &index);
+        Value value;
+        value.type = segment.types[index];
+        value.raw = segment.values[index];
+        if (value.type == kTypeCString) {
+            value.str = mStrings.get(value.raw);
+        } else if (value.type == kTypeRate) {
+            value.rate = mRates[value.raw];
+        }
+        return value;
+    }
+
+    uint32_t allocateSegment_l() REQUIRES(mLock) {
+        if (!mFreeSegments.empty()) {
+            const uint32_t id = mFreeSegments.back();
+            mFreeSegments.pop_back();
+            return id;
+        }
+        mSegments.emplace_back();
+        return mSegments.size() - 1;
+    }
+
+    // Releases the string or rate referenced by a raw value.
+    void releaseValue_l(uint8_t type, int64_t raw) REQUIRES(mLock) {
+        if (type == kTypeCString) {
+            mStrings.release(raw);
+        } else if (type == kTypeRate) {
+            mFreeRates.push_back(raw);
+        }
+    }
+
+    void releaseColumn_l(const Column &column) REQUIRES(mLock) {
+        for (size_t i = 0; i < column.count; ++i) {
+            const Slot s = slot_l(column, i);
+            releaseValue_l(s.segment->types[s.index], s.segment->values[s.index]);
+        }
+        for (size_t i = 0; i < column.segmentCount; ++i) {
+            mFreeSegments.push_back(column.segments[i]);
+        }
+        mStrings.release(column.name);
+    }
+
+    void releaseKey_l(const KeyColumns &keyColumns) REQUIRES(mLock) {
+        for (const Column &column : keyColumns.columns) releaseColumn_l(column);
+    }
+
+    // Returns the column for property, or nullptr.
+    const Column *findColumn_l(const KeyColumns &keyColumns, const std::string &property) const
+            REQUIRES(mLock) {
+        const int64_t name = mStrings.find(property);
+        if (name < 0) return nullptr;
+        for (const Column &column : keyColumns.columns) {
+            if (column.name == name) return &column;
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    status_t getValue_l(const KeyColumns &keyColumns, const std::string &property,
+            T* value, int64_t time) const REQUIRES(mLock) {
+        const Column *column = findColumn_l(keyColumns, property);
+        if (column == nullptr) return BAD_VALUE;
+        // Find the last element no later than time.
+        size_t low = 0;
+        size_t high = column->count;
+        while (low < high) {
+            const size_t mid = (low + high) / 2;
+            if (timeAt_l(*column, mid) <= time) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low == 0) return BAD_VALUE;
+        return valueAt_l(*column, low - 1).to(value);
+    }
+
+    template <typename T>
+    static status_t getSpilledValue(std::string_view record, const std::string &property,
+            T* value, int32_t uidCheck, int64_t time) {
+        status_t status = BAD_VALUE;
+        Value found;
+        auto visitor = [&](std::string_view name, int64_t elementTime, const Value &element) {
+            if (name != property || elementTime > time) return;
+            found = element;
+            status = NO_ERROR;
+        };
+        uid_t allowUid;
+        if (!readRecord(record, &allowUid, nullptr, visitor)) return BAD_VALUE;
+        if (uidCheck != -1 && (uid_t)uidCheck != allowUid) return PERMISSION_DENIED;
+        return status ?: found.to(value);
+    }
+
+    void putProp_l(KeyColumns &keyColumns, const std::string &name,
+            const mediametrics::Item::Prop &prop, int64_t time) REQUIRES(mLock) {
+        const auto &elem = prop.get();
+        if (const auto *i32 = std::get_if<int32_t>(&elem)) {
+            putValue_l(keyColumns, name, *i32, time);
+        } else if (const auto *i64 = std::get_if<int64_t>(&elem)) {
+            putValue_l(keyColumns, name, *i64, time);
+        } else if (const auto *d = std::get_if<double>(&elem)) {
+            putValue_l(keyColumns, name, *d, time);
+        } else if (const auto *str = std::get_if<std::string>(&elem)) {
+            putValue_l(keyColumns, name, *str, time);
+        } else if (const auto *rate = std::get_if<std::pair<int64_t, int64_t>>(&elem)) {
+            putValue_l(keyColumns, name, *rate, time);
+        } else {
+            putValue_l(keyColumns, name, std::monostate{}, time);
+        }
+    }
+
+    template <typename T>
+    void putValue_l(KeyColumns &keyColumns, const std::string &property, const T &e,
+            int64_t time) REQUIRES(mLock) {
+        using V = std::decay_t<T>;
+        uint8_t type;
+        int64_t raw = 0;
+        // Strings are looked up before interning so that unchanged values
+        // do not change the reference count.
+        int64_t existingId = -1;
+        if constexpr (std::is_same_v<V, int32_t>) {
+            type = kTypeInt32;
+            raw = e;
+        } else if constexpr (std::is_same_v<V, int64_t>) {
+            type = kTypeInt64;
+            raw = e;
+        } else if constexpr (std::is_same_v<V, double>) {
+            type = kTypeDouble;
+            memcpy(&raw, &e, sizeof(raw));
+        } else if constexpr (std::is_convertible_v<const V&, std::string>) {
+            type = kTypeCString;
+            existingId = mStrings.find(e);
+        } else if constexpr (std::is_same_v<V, std::pair<int64_t, int64_t>>) {
+            type = kTypeRate;
+        } else {
+            static_assert(std::is_same_v<V, std::monostate>, "unsupported value type");
+            type = kTypeNone;
+        }
+
+        keyColumns.lastModificationTime = time;
+
+        // Columns are sorted by property name, as TimeMachine dumps them.
+        size_t low = 0;
+        size_t high = keyColumns.columns.size();
+        while (low < high) {
+            const size_t mid = (low + high) / 2;
+            if (mStrings.get(keyColumns.columns[mid].name) < property) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        auto it = keyColumns.columns.begin() + low;
+        if (it == keyColumns.columns.end() || mStrings.get(it->name) != property) {
+            if (keyColumns.columns.size() >= kKeyMaxProperties) {
+                ALOGV("%s: too many properties, rejecting %s", __func__, property.c_str());
+                keyColumns.rejectedPropertiesCount++;
+                return;
+            }
+            it = keyColumns.columns.insert(it, Column{mStrings.intern(property)});
+        }
+        Column &column = *it;
+
+        if (column.count > 0
+                && property.back() != AMEDIAMETRICS_PROP_SUFFIX_CHAR_DUPLICATES_ALLOWED) {
+            const Slot last = slot_l(column, column.count - 1);
+            if (last.segment->types[last.index] == type) {
+                const int64_t lastRaw = last.segment->values[last.index];
+                bool same;
+                if constexpr (std::is_same_v<V, double>) {
+                    double d;
+                    memcpy(&d, &lastRaw, sizeof(d));
+                    same = d == e;
+                } else if constexpr (std::is_convertible_v<const V&, std::string>) {
+                    same = lastRaw == existingId;
+                } else if constexpr (std::is_same_v<V, std::pair<int64_t, int64_t>>) {
+                    same = mRates[lastRaw] == e;
+                } else {
+                    same = lastRaw == raw;
+                }
+                if (same) return; // value unchanged.
+            }
+        }
+
+        if (column.count == kTimeSequenceMaxElements) {
+            // As TimeMachine, insert then discard the oldest, which may be this element.
+            if (time < timeAt_l(column, 0)) return;
+            ALOGV("%s: restricting maximum elements (discarding oldest) for %s",
+                    __func__, property.c_str());
+            const Slot oldest = slot_l(column, 0);
+            releaseValue_l(oldest.segment->types[oldest.index],
+                    oldest.segment->values[oldest.index]);
+            column.head = (column.head + 1) % kTimeSequenceMaxElements;
+            --column.count;
+        } else if (column.count == column.segmentCount * Segment::kSlots) {
+            // The ring has not wrapped yet, so it grows at the end.
+            column.segments[column.segmentCount++] = allocateSegment_l();
+        }
+
+        if constexpr (std::is_convertible_v<const V&, std::string>) {
+            raw = mStrings.intern(e);
+        } else if constexpr (std::is_same_v<V, std::pair<int64_t, int64_t>>) {
+            if (mFreeRates.empty()) {
+                raw = mRates.size();
+                mRates.push_back(e);
+            } else {
+                raw = mFreeRates.back();
+                mFreeRates.pop_back();
+                mRates[raw] = e;
+            }
+        }
+
+        // Append, then move back into time order if needed (rare).
+        size_t i = column.count++;
+        for (; i > 0 && timeAt_l(column, i - 1) > time; --i) {
+            const Slot to = slot_l(column, i);
+            const Slot from = slot_l(column, i - 1);
+            to.segment->times[to.index] = from.segment->times[from.index];
+            to.segment->values[to.index] = from.segment->values[from.index];
+            to.segment->types[to.index] = from.segment->types[from.index];
+        }
+        const Slot s = slot_l(column, i);
+        s.segment->times[s.index] = time;
+        s.segment->values[s.index] = raw;
+        s.segment->types[s.index] = type;
+        keyColumns.newestTime = std::max(keyColumns.newestTime, time);
+    }
+
+    // Serializes a key for the spill file.
+    std::string spill_l(const std::string &key, const KeyColumns &keyColumns) const
+            REQUIRES(mLock) {
+        std::string out;
+        write(out, std::string_view(key));
+        write(out, (uint32_t)keyColumns.allowUid);
+        write(out, keyColumns.rejectedPropertiesCount);
+        write(out, (uint32_t)keyColumns.columns.size());
+        for (const Column &column : keyColumns.columns) {
+            write(out, std::string_view(mStrings.get(column.name)));
+            write(out, (uint32_t)column.count);
+            for (size_t i = 0; i < column.count; ++i) {
+                const Value value = valueAt_l(column, i);
+                write(out, timeAt_l(column, i));
+                write(out, value.type);
+                switch (value.type) {
+                case kTypeInt32:
+                case kTypeInt64:
+                case kTypeDouble:
+                    write(out, value.raw);
+                    break;
+                case kTypeCString:
+                    write(out, value.str);
+                    break;
+                case kTypeRate:
+                    write(out, value.rate.first);
+                    write(out, value.rate.second);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+        return out;
+    }
+
+    // Reads a spill record, calling visitor(name, time, value) for each element
+    // in property then time order. Returns false if the record is corrupt.
+    template <typename F>
+    static bool readRecord(std::string_view record, uid_t *allowUid,
+            unsigned int *rejectedPropertiesCount, F visitor) {
+        Reader reader(record);
+        std::string_view key;
+        uint32_t uid;
+        unsigned int rejected;
+        uint32_t columns;
+        if (!reader.read(&key) || !reader.read(&uid) || !reader.read(&rejected)
+                || !reader.read(&columns)) {
+            return false;
+        }
+        if (allowUid != nullptr) *allowUid = uid;
+        if (rejectedPropertiesCount != nullptr) *rejectedPropertiesCount = rejected;
+        for (uint32_t c = 0; c < columns; ++c) {
+            std::string_view name;
+            uint32_t count;
+            if (!reader.read(&name) || !reader.read(&count)) return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                int64_t time;
+                Value value;
+                if (!reader.read(&time) || !reader.read(&value)) return false;
+                visitor(name, time, value);
+            }
+        }
+        return reader.ok();
+    }
+
+    using Elements = std::vector<std::pair<int64_t /* time */, Value>>;
+
+    // Dumps the elements of a property no earlier than sinceNs, as TimeMachine.
+    static bool dumpProperty(std::stringstream &ss, std::string_view key, std::string_view name,
+            const Elements &elements, int64_t sinceNs) {
+        // Elements are sorted by time.
+        auto it = std::lower_bound(elements.begin(), elements.end(), sinceNs,
+                [](const auto &element, int64_t time) { return element.first < time; });
+        if (it == elements.end()) return false;
+        ss << key << "." << name << "={";
+        time_string_t last_timestring{}; // last timestring used.
+        while (true) {
+            const time_string_t timestring = mediametrics::timeStringFromNs(it->first);
+            // find common prefix offset.
+            const size_t offset = commonTimePrefixPosition(timestring.time,
+                    last_timestring.time);
+            last_timestring = timestring;
+            ss << "(" << (offset == 0 ? "" : "~") << &timestring.time[offset]
+                << ") " << it->second;
+            if (++it == elements.end()) break;
+            ss << ", ";
+        }
+        ss << "};\n";
+        return true;
+    }
+
+    int32_t dumpKey_l(std::stringstream &ss, const std::string &key,
+            const KeyColumns &keyColumns, int32_t lines, int64_t sinceNs) const REQUIRES(mLock) {
+        int32_t ll = lines;
+        Elements elements;
+        for (const Column &column : keyColumns.columns) {
+            if (ll <= 0) break;
+            // Skip the properties unchanged since sinceNs without reading their values.
+            if (column.count == 0 || timeAt_l(column, column.count - 1) < sinceNs) continue;
+            elements.clear();
+            for (size_t i = 0; i < column.count; ++i) {
+                elements.emplace_back(timeAt_l(column, i), valueAt_l(column, i));
+            }
+            if (dumpProperty(ss, key, mStrings.get(column.name), elements, sinceNs)) --ll;
+        }
+        if (ll > 0 && keyColumns.rejectedPropertiesCount > 0) {
+            ss << "Rejected properties: " << keyColumns.rejectedPropertiesCount << "\n";
+            ll--;
+        }
+        return lines - ll;
+    }
+
+    static int32_t dumpSpilledKey(std::stringstream &ss, std::string_view record,
+            int32_t lines, int64_t sinceNs) {
+        std::string_view key;
+        Reader(record).read(&key);
+        // The record is read sequentially, so the elements of each property
+        // are collected before dumping it.
+        std::string_view currentName;
+        Elements elements;
+        int32_t ll = lines;
+        auto flush = [&]() {
+            if (ll > 0 && !elements.empty()
+                    && dumpProperty(ss, key, currentName, elements, sinceNs)) {
+                --ll;
+            }
+            elements.clear();
+        };
+        unsigned int rejected = 0;
+        (void)readRecord(record, nullptr, &rejected,
+                [&](std::string_view name, int64_t time, const Value &value) {
+                    if (name != currentName) {
+                        flush();
+                        currentName = name;
+                    }
+                    elements.emplace_back(time, value);
+                });
+        flush();
+        if (ll > 0 && rejected > 0) {
+            ss << "Rejected properties: " << rejected << "\n";
+            ll--;
+        }
+        return lines - ll;
+    }
+
+    /**
+     * Garbage collects if the number of keys exceeds the high water mark,
+     * see TimeMachine::gc(). Evicted keys are written to the spill file if there is one.
+     *
+     * \return true if garbage collection was done.
+     */
+    bool gc_l() REQUIRES(mLock) {
+        if (mHistory.size() < mKeyHighWaterMark) return false;
+
+        // erase everything explicitly expired.
+        std::multimap<int64_t, History::iterator> accessList;
+        for (auto it = mHistory.begin(); it != mHistory.end();) {
+            int32_t expireTime;
+            if (getValue_l(it->second, "_expire", &expireTime, INT64_MAX) == NO_ERROR) {
+                releaseKey_l(it->second);
+                it = mHistory.erase(it);
+            } else {
+                accessList.emplace(it->second.lastModificationTime, it);
+                ++it;
+            }
+        }
+
+        if (mHistory.size() > mKeyLowWaterMark) {
+            const size_t toDelete = mHistory.size() - mKeyLowWaterMark;
+            auto it = accessList.begin();
+            for (size_t i = 0; i < toDelete; ++i, ++it) {
+                const auto &[key, keyColumns] = *it->second;
+                if (mSpill != nullptr) {
+                    (void)mSpill->append(key, keyColumns.newestTime, spill_l(key, keyColumns));
+                }
+                releaseKey_l(keyColumns);
+                mHistory.erase(it->second);
+            }
+        }
+
+        ALOGD("%s(%zu, %zu): key size:%zu spilled:%zu",
+                __func__, mKeyLowWaterMark, mKeyHighWaterMark,
+                mHistory.size(), mSpill != nullptr ? mSpill->index().size() : 0);
+
+        ++mGarbageCollectionCount;
+        return true;
+    }
+
+    const size_t mKeyLowWaterMark = kKeyLowWaterMark;
+    const size_t mKeyHighWaterMark = kKeyHighWaterMark;
+
+    std::atomic<size_t> mGarbageCollectionCount{};
+
+    mutable std::mutex mLock;
+    StringPool mStrings GUARDED_BY(mLock);
+    std::vector<std::pair<int64_t, int64_t>> mRates GUARDED_BY(mLock);
+    std::vector<uint32_t> mFreeRates GUARDED_BY(mLock);
+    std::vector<Segment> mSegments GUARDED_BY(mLock);
+    std::vector<uint32_t> mFreeSegments GUARDED_BY(mLock);
+    History mHistory GUARDED_BY(mLock);
+    std::unique_ptr<SpillFile> mSpill GUARDED_BY(mLock); // nullptr if there is no spill file.
+};
+
+} // namespace android::mediametrics
@@ -45,6 +45,11 @@ public:
         return binder::Status::fromStatusT(status);
     }
 
+    binder::Status submitBuffers(const std::vector<uint8_t>& buffers) override {
+        status_t status = submitBuffers((char *)buffers.data(), buffers.size());
+        return binder::Status::fromStatusT(status);
+    }
+
     /**
      * Submits the indicated record to the mediaanalytics service.
      *
@@ -62,6 +67,28 @@ public:
                 ?: submitInternal(item, true /* release */);
     }
 
+    /**
+     * Submits the items of a batch from mediametrics::BaseItem::submitBuffers().
+     * Each byte string starts with its total size, which delimits it from the next.
+     *
+     * \return the status of the first item that failed, or BAD_VALUE
+     *         if the batch is truncated, in which case the remaining items are dropped.
+     */
+    status_t submitBuffers(const char *buffers, size_t length) {
+        status_t status = NO_ERROR;
+        while (length > 0) {
+            uint32_t size;
+            if (length < sizeof(size)) return BAD_VALUE;
+            memcpy(&size, buffers, sizeof(size));
+            if (size < sizeof(size) || size > length) return BAD_VALUE;
+            const status_t itemStatus = submitBuffer(buffers, size);
+            if (status == NO_ERROR) status = itemStatus;
+            buffers += size;
+            length -= size;
+        }
+        return status;
+    }
+
     status_t dump(int fd, const Vector<String16>& args) override;
 
     static constexpr const char * const kServiceName = "media.metrics";
@@ -84,6 +111,18 @@ public:
      */
     static std::pair<std::string, int64_t> getSanitizedPackageNameAndVersionCode(uid_t uid);
 
+    /**
+     * Returns the TimeMachine backend for the audio analytics, selected by
+     * the system property persist.mediametrics.timemachine.backend ("map" or "columnar").
+     */
+    static mediametrics::TimeMachine::Backend getTimeMachineBackend();
+
+    /**
+     * Returns the file where the columnar TimeMachine spills evicted keys, selected by
+     * the system property persist.mediametrics.timemachine.spill_path (empty for none).
+     */
+    static std::string getTimeMachineSpillPath();
+
 protected:
 
     // Internal call where release is true if ownership of item is transferred
@@ -131,7 +170,8 @@ private:
             std::make_shared<mediametrics::StatsdLog>(STATSD_LOG_LINES_MAX)};
 
     // mAudioAnalytics is locked internally.
-    mediametrics::AudioAnalytics mAudioAnalytics{mStatsdLog};
+    mediametrics::AudioAnalytics mAudioAnalytics{
+            mStatsdLog, getTimeMachineBackend(), getTimeMachineSpillPath()};
 
     std::mutex mLock;
     // statistics about our analytics
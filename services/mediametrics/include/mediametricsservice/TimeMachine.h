@@ -28,6 +28,8 @@
 #include <media/MediaMetricsItem.h>
 #include <utils/Timers.h>
 
+#include "ColumnarTimeMachine.h"
+
 namespace android::mediametrics {
 
 // define a way of printing the monostate
@@ -61,6 +63,10 @@ std::ostream & operator<< (std::ostream& s,
  * Any URL that ends with '#' (AMEDIAMETRICS_PROP_SUFFIX_CHAR_DUPLICATES_ALLOWED)
  * will have a time sequence that keeps duplicates.
  *
+ * The history is kept by default in a std::map per property (Backend::MAP).
+ * Backend::COLUMNAR forwards to a ColumnarTimeMachine instead, which stores the
+ * history in columns and may spill the evicted keys to a file, see ColumnarTimeMachine.h.
+ *
  * The TimeMachine is NOT thread safe.
  */
 class TimeMachine final { // made final as we have copy constructor instead of dup() override.
@@ -68,6 +74,11 @@ public:
     using Elem = Item::Prop::Elem;  // use the Item property element.
     using PropertyHistory = std::multimap<int64_t /* time */, Elem>;
 
+    enum class Backend {
+        MAP,
+        COLUMNAR,
+    };
+
 private:
 
     // KeyHistory contains no lock.
@@ -244,6 +255,18 @@ public:
                   __func__, keyHighWaterMark, keyLowWaterMark);
     }
 
+    /**
+     * \param backend the storage of the history.
+     * \param spillPath for Backend::COLUMNAR, the file to spill the evicted keys,
+     *        empty for none.
+     */
+    explicit TimeMachine(Backend backend, const std::string& spillPath = {}) {
+        if (backend == Backend::COLUMNAR) {
+            mColumnar = std::make_unique<ColumnarTimeMachine>(
+                    mKeyLowWaterMark, mKeyHighWaterMark, spillPath);
+        }
+    }
+
     // The TimeMachine copy constructor/assignment uses a deep copy,
     // though the snapshot is not instantaneous nor isochronous.
     //
@@ -257,6 +280,8 @@ public:
     TimeMachine& operator=(const TimeMachine& other) {
         std::lock_guard lock(mLock);
         mHistory.clear();
+        mColumnar = other.mColumnar
+                ? std::make_unique<ColumnarTimeMachine>(*other.mColumnar) : nullptr;
 
         {
             std::lock_guard lock2(other.mLock);
@@ -277,6 +302,7 @@ public:
      * Put all the properties from an item into the Time Machine log.
      */
     status_t put(const std::shared_ptr<const mediametrics::Item>& item, bool isTrusted = false) {
+        if (mColumnar) return mColumnar->put(item, isTrusted);
         const int64_t time = item->getTimestamp();
         const std::string &key = item->getKey();
 
@@ -356,6 +382,7 @@ public:
     template <typename T>
     status_t get(const std::string &key, const std::string &property,
             T* value, int32_t uidCheck = -1, int64_t time = 0) const {
+        if (mColumnar) return mColumnar->get(key, property, value, uidCheck, time);
         std::shared_ptr<KeyHistory> keyHistory;
         {
             std::lock_guard lock(mLock);
@@ -375,6 +402,7 @@ public:
      */
     template <typename T>
     status_t put(const std::string &url, T &&e, int64_t time = 0) {
+        if (mColumnar) return mColumnar->put(url, std::forward<T>(e), time);
         std::string key;
         std::string prop;
         std::shared_ptr<KeyHistory> keyHistory =
@@ -391,6 +419,7 @@ public:
      */
     template <typename T>
     status_t get(const std::string &url, T* value, int32_t uidCheck, int64_t time = 0) const {
+        if (mColumnar) return mColumnar->get(url, value, uidCheck, time);
         std::string key;
         std::string prop;
         std::shared_ptr<KeyHistory> keyHistory =
@@ -417,6 +446,7 @@ public:
      *  Returns number of keys in the Time Machine.
      */
     size_t size() const {
+        if (mColumnar) return mColumnar->size();
         std::lock_guard lock(mLock);
         return mHistory.size();
     }
@@ -425,6 +455,7 @@ public:
      * Clears all properties from the Time Machine.
      */
     void clear() {
+        if (mColumnar) return mColumnar->clear();
         std::lock_guard lock(mLock);
         mHistory.clear();
         mGarbageCollectionCount = 0;
@@ -444,6 +475,7 @@ public:
      */
     std::pair<std::string, int32_t> dump(
             int32_t lines = INT32_MAX, int64_t sinceNs = 0, const char *prefix = nullptr) const {
+        if (mColumnar) return mColumnar->dump(lines, sinceNs, prefix);
         std::lock_guard lock(mLock);
         std::stringstream ss;
         int32_t ll = lines;
@@ -462,9 +494,18 @@ public:
     }
 
     size_t getGarbageCollectionCount() const {
+        if (mColumnar) return mColumnar->getGarbageCollectionCount();
         return mGarbageCollectionCount;
     }
 
+    /**
+     * Returns a short description of the backend for dumpsys.
+     */
+    std::string getBackendSummary() const {
+        if (!mColumnar) return "map";
+        return "columnar spilled(" + std::to_string(mColumnar->spilledSize()) + ")";
+    }
+
 private:
 
     // Obtains the lock for a KeyHistory.
@@ -554,6 +595,10 @@ private:
 
     std::atomic<size_t> mGarbageCollectionCount{};
 
+    // Set for Backend::COLUMNAR, then the members below are unused.
+    // Only changed by construction or assignment.
+    std::unique_ptr<ColumnarTimeMachine> mColumnar;
+
     /**
      * Locking Strategy
      *
@@ -18,12 +18,16 @@
 #include <utils/Log.h>
 
 #include <stdio.h>
+#include <unistd.h>
+#include <atomic>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
 #include <gtest/gtest.h>
 #include <media/MediaMetricsItem.h>
+#include <media/MediaMetricsRecordRing.h>
 #include <mediametricsservice/AudioTypes.h>
 #include <mediametricsservice/MediaMetricsService.h>
 #include <mediametricsservice/StringUtils.h>
@@ -469,6 +473,94 @@ TEST(mediametrics_tests, item_byteserialization) {
   free(data);
 }
 
+TEST(mediametrics_tests, record_ring) {
+  mediametrics::RecordRing<8 /* RECORD_SIZE */, 4 /* RECORD_COUNT */> ring;
+  std::vector<char> buffer;
+  ASSERT_EQ((size_t)0, ring.drain(&buffer));
+
+  ASSERT_FALSE(ring.append("123456789", 9));  // too large
+  ASSERT_TRUE(ring.append("a", 1));
+  ASSERT_TRUE(ring.append("bc", 2));
+  ASSERT_TRUE(ring.append("def", 3));
+  ASSERT_TRUE(ring.append("ghij", 4));
+  ASSERT_FALSE(ring.append("k", 1));          // full
+  ASSERT_EQ(1, ring.getOverflowCount());
+
+  ASSERT_EQ((size_t)4, ring.drain(&buffer));
+  ASSERT_EQ("abcdefghij", std::string(buffer.begin(), buffer.end()));
+
+  // the slots are reused after the drain.
+  buffer.clear();
+  ASSERT_TRUE(ring.append("12345678", 8));
+  ASSERT_EQ((size_t)1, ring.drain(&buffer));
+  ASSERT_EQ("12345678", std::string(buffer.begin(), buffer.end()));
+}
+
+TEST(mediametrics_tests, record_ring_multithread) {
+  constexpr size_t kThreads = 4;
+  constexpr size_t kRecordsPerThread = 10000;
+  mediametrics::RecordRing<sizeof(uint32_t), 64> ring;
+
+  std::atomic<size_t> appended{};
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (uint32_t j = 0; j < kRecordsPerThread; ++j) {
+        const uint32_t record = i * kRecordsPerThread + j;
+        while (!ring.append((const char *)&record, sizeof(record))) {
+          std::this_thread::yield();
+        }
+        ++appended;
+      }
+    });
+  }
+
+  // every record is drained exactly once, and those of a thread in order.
+  std::vector<char> buffer;
+  std::vector<uint32_t> next(kThreads);
+  size_t drained = 0;
+  while (drained < kThreads * kRecordsPerThread) {
+    buffer.clear();
+    drained += ring.drain(&buffer);
+    for (size_t pos = 0; pos < buffer.size(); pos += sizeof(uint32_t)) {
+      uint32_t record;
+      memcpy(&record, &buffer[pos], sizeof(record));
+      const size_t thread = record / kRecordsPerThread;
+      if (thread >= kThreads) {
+        ADD_FAILURE() << "unexpected record " << record;
+        continue;
+      }
+      EXPECT_EQ(thread * kRecordsPerThread + next[thread], record);
+      ++next[thread];
+    }
+  }
+  for (auto& thread : threads) thread.join();
+  ASSERT_EQ(kThreads * kRecordsPerThread, appended.load());
+  buffer.clear();
+  ASSERT_EQ((size_t)0, ring.drain(&buffer));
+}
+
+TEST(mediametrics_tests, submit_buffers) {
+  sp mediaMetrics = new MediaMetricsService();
+
+  std::vector<char> buffers;
+  for (int32_t i = 0; i < 3; ++i) {
+    mediametrics::Item item("audiotrack");
+    item.addInt32("foo", i);
+    char *data;
+    size_t length;
+    ASSERT_EQ(NO_ERROR, item.writeToByteString(&data, &length));
+    buffers.insert(buffers.end(), data, data + length);
+    free(data);
+  }
+  ASSERT_EQ(NO_ERROR, mediaMetrics->submitBuffers(buffers.data(), buffers.size()));
+  ASSERT_EQ(NO_ERROR, mediaMetrics->submitBuffers(nullptr, 0));
+
+  // a truncated batch is rejected at the truncated item.
+  ASSERT_EQ(BAD_VALUE, mediaMetrics->submitBuffers(buffers.data(), buffers.size() - 1));
+  ASSERT_EQ(BAD_VALUE, mediaMetrics->submitBuffers(buffers.data(), 2));
+}
+
 TEST(mediametrics_tests, item_iteration) {
   mediametrics::Item item;
   item.setInt32("i32", 1)
@@ -741,6 +833,178 @@ TEST(mediametrics_tests, time_machine_gc) {
   printf("After\n%s\n", timeMachine.dump().first.c_str());
 }
 
+TEST(mediametrics_tests, columnar_time_machine_storage) {
+  auto item = std::make_shared<mediametrics::Item>("Key");
+  (*item).set("i32", (int32_t)1)
+      .set("i64", (int64_t)2)
+      .set("double", (double)3.125)
+      .set("string", "abcdefghijklmnopqrstuvwxyz")
+      .set("rate", std::pair<int64_t, int64_t>(11, 12));
+
+  android::mediametrics::TimeMachine timeMachine(
+          android::mediametrics::TimeMachine::Backend::COLUMNAR);
+  ASSERT_EQ(NO_ERROR, timeMachine.put(item, true));
+
+  int32_t i32;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key", "i32", &i32, -1));
+  ASSERT_EQ(1, i32);
+
+  int64_t i64;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key", "i64", &i64, -1));
+  ASSERT_EQ(2, i64);
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key", "i32", &i64, -1)); // type must match.
+
+  double d;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key.double", &d, -1));
+  ASSERT_EQ(3.125, d);
+
+  std::string s;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key.string", &s, -1));
+  ASSERT_EQ("abcdefghijklmnopqrstuvwxyz", s);
+
+  std::pair<int64_t, int64_t> rate;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key.rate", &rate, -1));
+  ASSERT_EQ(std::make_pair((int64_t)11, (int64_t)12), rate);
+
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key.none", &i32, -1));
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key", &i32, -1));
+}
+
+TEST(mediametrics_tests, columnar_time_machine_remote_key) {
+  auto item = std::make_shared<mediametrics::Item>("Key1");
+  (*item).set("one", (int32_t)1)
+         .set("two", (int32_t)2);
+
+  android::mediametrics::TimeMachine timeMachine(
+          android::mediametrics::TimeMachine::Backend::COLUMNAR);
+  ASSERT_EQ(NO_ERROR, timeMachine.put(item, true));
+
+  auto item2 = std::make_shared<mediametrics::Item>("Key2");
+  (*item2).set("three", (int32_t)3)
+         .set("[Key1]four", (int32_t)4);   // affects Key1
+  ASSERT_EQ(NO_ERROR, timeMachine.put(item2, true));
+
+  auto item3 = std::make_shared<mediametrics::Item>("Key2");
+  (*item3).set("six", (int32_t)6)
+         .set("[Key1]seven", (int32_t)7);   // affects Key1
+  ASSERT_EQ(NO_ERROR, timeMachine.put(item3, false)); // remote keys not allowed.
+
+  int32_t i32;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key1.four", &i32, -1));
+  ASSERT_EQ(4, i32);
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key2.four", &i32, -1));
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key2.six", &i32, -1));
+  ASSERT_EQ(6, i32);
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key1.seven", &i32, -1));
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key2.seven", &i32, -1));
+}
+
+TEST(mediametrics_tests, columnar_time_machine_history) {
+  android::mediametrics::TimeMachine timeMachine(
+          android::mediametrics::TimeMachine::Backend::COLUMNAR);
+  auto item = std::make_shared<mediametrics::Item>("Key");
+  (*item).set("state", "idle").setTimestamp(10);
+  ASSERT_EQ(NO_ERROR, timeMachine.put(item, true));
+
+  // Values are kept in time order, even when put out of order.
+  for (int64_t time = 100; time < 200; time += 2) {
+    ASSERT_EQ(NO_ERROR, timeMachine.put("Key.count", time, time));
+    ASSERT_EQ(NO_ERROR, timeMachine.put("Key.state", std::string("active"), time));
+  }
+  ASSERT_EQ(NO_ERROR, timeMachine.put("Key.count", (int64_t)155, 155));
+
+  int64_t count;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key", "count", &count, -1, 155));
+  ASSERT_EQ(155, count);
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key", "count", &count, -1, 157));
+  ASSERT_EQ(156, count);
+
+  // Only the newest 50 changes are kept.
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key", "count", &count, -1, 103));
+  ASSERT_EQ(102, count);
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key", "count", &count, -1, 101));
+
+  // An unchanged value is not recorded again.
+  std::string state;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key", "state", &state, -1, 99));
+  ASSERT_EQ("idle", state);
+  const auto [dump, lines] = timeMachine.dump(INT32_MAX, 101 /* sinceNs */);
+  ASSERT_EQ(1, lines); // only count has changed since 101.
+  ASSERT_EQ(std::string::npos, dump.find("Key.state"));
+}
+
+TEST(mediametrics_tests, columnar_time_machine_dump) {
+  // The columnar backend dumps the same history as the map backend.
+  android::mediametrics::TimeMachine mapTimeMachine;
+  android::mediametrics::TimeMachine columnarTimeMachine(
+          android::mediametrics::TimeMachine::Backend::COLUMNAR);
+  for (int i = 0; i < 10; ++i) {
+    auto item = std::make_shared<mediametrics::Item>("audio.track." + std::to_string(i % 3));
+    (*item).set("i32", (int32_t)(i / 2))
+           .set("event#", "start")
+           .set("double", (double)i * 0.5)
+           .set("device", i % 2 ? "speaker" : "headset")
+           .set("rate", std::pair<int64_t, int64_t>(i, 1))
+           .setTimestamp(1000 + i);
+    ASSERT_EQ(NO_ERROR, mapTimeMachine.put(item, true));
+    ASSERT_EQ(NO_ERROR, columnarTimeMachine.put(item, true));
+  }
+  ASSERT_EQ(mapTimeMachine.size(), columnarTimeMachine.size());
+  ASSERT_EQ(mapTimeMachine.dump(), columnarTimeMachine.dump());
+  ASSERT_EQ(mapTimeMachine.dump(4, 1005, "audio.track.1"),
+          columnarTimeMachine.dump(4, 1005, "audio.track.1"));
+
+  // A copy is independent.
+  android::mediametrics::TimeMachine copy(columnarTimeMachine);
+  columnarTimeMachine.clear();
+  ASSERT_EQ((size_t)0, columnarTimeMachine.size());
+  ASSERT_EQ(mapTimeMachine.dump(), copy.dump());
+}
+
+TEST(mediametrics_tests, columnar_time_machine_spill) {
+  const std::string spillPath =
+          "/data/local/tmp/columnar_time_machine_spill." + std::to_string(getpid());
+  android::mediametrics::ColumnarTimeMachine timeMachine(1, 2, spillPath);
+  unlink(spillPath.c_str()); // the mapping keeps the file.
+
+  for (int i = 0; i < 3; ++i) {
+    auto item = std::make_shared<mediametrics::Item>("Key" + std::to_string(i));
+    (*item).set("value", (int32_t)i)
+           .set("name", "name" + std::to_string(i))
+           .set(AMEDIAMETRICS_PROP_ALLOWUID, (int32_t)1000)
+           .setTimestamp(10 + i);
+    ASSERT_EQ(NO_ERROR, timeMachine.put(item, true));
+  }
+  ASSERT_EQ((size_t)2, timeMachine.size());
+  ASSERT_EQ((size_t)1, timeMachine.spilledSize());
+  ASSERT_EQ((size_t)1, timeMachine.getGarbageCollectionCount());
+
+  // Key0 was spilled and can still be read, with the same permissions.
+  int32_t i32;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key0.value", &i32, -1));
+  ASSERT_EQ(0, i32);
+  std::string s;
+  ASSERT_EQ(NO_ERROR, timeMachine.get("Key0", "name", &s, 1000));
+  ASSERT_EQ("name0", s);
+  ASSERT_EQ(PERMISSION_DENIED, timeMachine.get("Key0", "name", &s, 1001));
+  ASSERT_EQ(BAD_VALUE, timeMachine.get("Key0", "value", &i32, -1, 9));
+  ASSERT_EQ(BAD_VALUE, timeMachine.put("Key0.value", (int32_t)5)); // spilled keys are read only.
+
+  const auto [dump, lines] = timeMachine.dump();
+  ASSERT_EQ(9, lines); // 3 properties for each key.
+  ASSERT_NE(std::string::npos, dump.find("Key0.name={"));
+
+  // Without a spill file, the evicted keys are lost.
+  android::mediametrics::ColumnarTimeMachine noSpill(1, 2);
+  for (int i = 0; i < 3; ++i) {
+    auto item = std::make_shared<mediametrics::Item>("Key" + std::to_string(i));
+    (*item).set("value", (int32_t)i).setTimestamp(10 + i);
+    ASSERT_EQ(NO_ERROR, noSpill.put(item, true));
+  }
+  ASSERT_EQ((size_t)0, noSpill.spilledSize());
+  ASSERT_EQ(BAD_VALUE, noSpill.get("Key0.value", &i32, -1));
+}
+
 TEST(mediametrics_tests, transaction_log_gc) {
   auto item = std::make_shared<mediametrics::Item>("Key1");
   (*item).set("one", (int32_t)1)
@@ -20,6 +20,7 @@
 
 #define ATRACE_TAG ATRACE_TAG_AUDIO
 
+#include <algorithm>
 #include <cstring>
 #include <utils/Trace.h>
 
@@ -29,6 +30,19 @@
 #define AAUDIO_MIXER_ATRACE_ENABLED    1
 #endif
 
+#if defined(__aarch64__) || defined(__ARM_NEON__)
+#define AAUDIO_MIXER_USE_NEON    1
+#include <arm_neon.h>
+#elif defined(__SSE__)
+#define AAUDIO_MIXER_USE_SSE     1
+#include <xmmintrin.h>
+#endif
+
+// Number of streams that we reserve room for so that the mixer does not normally allocate.
+static constexpr int32_t kReservedStreams = 16;
+// A gain ramp is approximated by a step function that changes every this many frames.
+static constexpr int32_t kFramesPerRampStep = 8;
+
 using android::WrappingBuffer;
 using android::FifoBuffer;
 using android::fifo_frames_t;
@@ -39,6 +53,10 @@ void AAudioMixer::allocate(int32_t samplesPerFrame, int32_t framesPerBurst) {
     int32_t samplesPerBuffer = samplesPerFrame * framesPerBurst;
     mOutputBuffer = std::make_unique<float[]>(samplesPerBuffer);
     mBufferSizeInBytes = samplesPerBuffer * sizeof(float);
+    mQueuedSources.reserve(kReservedStreams);
+    mSegmentEdges.reserve(2 * kReservedStreams + 1);
+    mSegmentSources.reserve(kReservedStreams);
+    mSegmentGains.reserve(kReservedStreams);
 }
 
 void AAudioMixer::clear() {
@@ -47,12 +65,14 @@ void AAudioMixer::clear() {
 
 int32_t AAudioMixer::mix(
         int streamIndex, const std::shared_ptr<FifoBuffer>& fifo, bool allowUnderflow) {
-    WrappingBuffer wrappingBuffer;
-    float *destination = mOutputBuffer.get();
+    int32_t framesRead = queue(streamIndex, fifo, allowUnderflow);
+    mixQueued();
+    return framesRead;
+}
 
-#if AAUDIO_MIXER_ATRACE_ENABLED
-    ATRACE_BEGIN("aaMix");
-#endif /* AAUDIO_MIXER_ATRACE_ENABLED */
+int32_t AAudioMixer::queue(int streamIndex, const std::shared_ptr<FifoBuffer>& fifo,
+                           bool allowUnderflow, float startGain, float endGain) {
+    WrappingBuffer wrappingBuffer;
 
     // Gather the data from the client. May be in two parts.
     fifo_frames_t fullFrames = fifo->getFullDataAvailable(&wrappingBuffer);
@@ -64,7 +84,7 @@ int32_t AAudioMixer::mix(
         ATRACE_INT(rdyText, fullFrames);
     }
 #else /* MIXER_ATRACE_ENABLED */
-    (void) trackIndex;
+    (void) streamIndex;
 #endif /* AAUDIO_MIXER_ATRACE_ENABLED */
 
     // If allowUnderflow then always advance by one burst even if we do not have the data.
@@ -78,38 +98,136 @@ int32_t AAudioMixer::mix(
         framesDesired = fullFrames; // just use what is available then stop
     }
 
-    // Mix data in one or two parts.
-    int partIndex = 0;
+    // Describe the data in one or two parts. It is read later by mixQueued().
+    QueuedSource source;
+    source.fifo = fifo;
+    source.framesToAdvance = framesDesired;
+    source.startGain = startGain;
+    source.endGain = endGain;
     int32_t framesLeft = framesDesired;
-    while (framesLeft > 0 && partIndex < WrappingBuffer::SIZE) {
-        fifo_frames_t framesToMixFromPart = framesLeft;
+    int32_t framesInParts[WrappingBuffer::SIZE] = {};
+    for (int partIndex = 0; partIndex < WrappingBuffer::SIZE; partIndex++) {
+        source.data[partIndex] = static_cast<const float *>(wrappingBuffer.data[partIndex]);
         fifo_frames_t framesAvailableFromPart = wrappingBuffer.numFrames[partIndex];
-        if (framesAvailableFromPart > 0) {
-            if (framesToMixFromPart > framesAvailableFromPart) {
-                framesToMixFromPart = framesAvailableFromPart;
-            }
-            mixPart(destination, (float *)wrappingBuffer.data[partIndex],
-                    framesToMixFromPart);
-
-            destination += framesToMixFromPart * mSamplesPerFrame;
-            framesLeft -= framesToMixFromPart;
+        if (framesLeft > 0 && framesAvailableFromPart > 0) {
+            framesInParts[partIndex] = std::min(framesLeft, framesAvailableFromPart);
+            framesLeft -= framesInParts[partIndex];
         }
-        partIndex++;
     }
-    fifo->advanceReadIndex(framesDesired);
+    source.framesInFirstPart = framesInParts[0];
+    source.framesToRead = framesDesired - framesLeft;
+    // Skip the first part if it is empty so that mixSegment() only has to handle one wrap.
+    if (source.framesInFirstPart == 0) {
+        source.data[0] = source.data[1];
+        source.framesInFirstPart = source.framesToRead;
+    }
+    mQueuedSources.push_back(std::move(source));
+
+    return framesDesired - framesLeft; // framesRead
+}
+
+void AAudioMixer::mixQueued() {
+    if (mQueuedSources.empty()) {
+        return;
+    }
+#if AAUDIO_MIXER_ATRACE_ENABLED
+    ATRACE_BEGIN("aaMix");
+#endif /* AAUDIO_MIXER_ATRACE_ENABLED */
+
+    // Split the burst at every frame where any source wraps around or runs out of data.
+    // Within each segment every source is then contiguous so it can be mixed in one pass.
+    mSegmentEdges.clear();
+    mSegmentEdges.push_back(0);
+    for (const auto& source : mQueuedSources) {
+        mSegmentEdges.push_back(source.framesInFirstPart);
+        mSegmentEdges.push_back(source.framesToRead);
+    }
+    std::sort(mSegmentEdges.begin(), mSegmentEdges.end());
+    mSegmentEdges.erase(std::unique(mSegmentEdges.begin(), mSegmentEdges.end()),
+                        mSegmentEdges.end());
+    for (size_t i = 1; i < mSegmentEdges.size(); i++) {
+        mixSegment(mSegmentEdges[i - 1], mSegmentEdges[i]);
+    }
+
+    for (const auto& source : mQueuedSources) {
+        source.fifo->advanceReadIndex(source.framesToAdvance);
+    }
+    mQueuedSources.clear();
 
 #if AAUDIO_MIXER_ATRACE_ENABLED
     ATRACE_END();
 #endif /* AAUDIO_MIXER_ATRACE_ENABLED */
+}
 
-    return (framesDesired - framesLeft); // framesRead
+void AAudioMixer::mixSegment(int32_t startFrame, int32_t endFrame) {
+    mSegmentSources.clear();
+    bool ramping = false;
+    for (const auto& source : mQueuedSources) {
+        const float *data;
+        if (startFrame < source.framesInFirstPart) {
+            data = source.data[0] + startFrame * mSamplesPerFrame;
+        } else if (startFrame < source.framesToRead) {
+            data = source.data[1] + (startFrame - source.framesInFirstPart) * mSamplesPerFrame;
+        } else {
+            continue; // this source has no more data
+        }
+        mSegmentSources.push_back(data);
+        ramping |= source.startGain != source.endGain;
+    }
+    const auto numSources = static_cast<int32_t>(mSegmentSources.size());
+    if (numSources == 0) {
+        return;
+    }
+
+    const int32_t framesPerStep = ramping ? kFramesPerRampStep : endFrame - startFrame;
+    for (int32_t frame = startFrame; frame < endFrame; frame += framesPerStep) {
+        const int32_t framesThisStep = std::min(framesPerStep, endFrame - frame);
+        // Evaluate ramps in the middle of the step.
+        const float rampFraction = (frame + 0.5f * framesThisStep) / mFramesPerBurst;
+        mSegmentGains.clear();
+        for (const auto& source : mQueuedSources) {
+            if (startFrame < source.framesToRead) {
+                mSegmentGains.push_back(source.startGain
+                        + (source.endGain - source.startGain) * rampFraction);
+            }
+        }
+        if (frame != startFrame) {
+            for (auto& data : mSegmentSources) {
+                data += framesPerStep * mSamplesPerFrame;
+            }
+        }
+        mixSources(mOutputBuffer.get() + frame * mSamplesPerFrame, mSegmentSources.data(),
+                   mSegmentGains.data(), numSources, framesThisStep * mSamplesPerFrame);
+    }
 }
 
-void AAudioMixer::mixPart(float *destination, float *source, int32_t numFrames) {
-    int32_t numSamples = numFrames * mSamplesPerFrame;
-    // TODO maybe optimize using SIMD
-    for (int sampleIndex = 0; sampleIndex < numSamples; sampleIndex++) {
-        *destination++ += *source++;
+void AAudioMixer::mixSources(float *destination, const float * const *sources,
+                             const float *gains, int32_t numSources, int32_t numSamples) {
+    int32_t sampleIndex = 0;
+#if defined(AAUDIO_MIXER_USE_NEON)
+    for (; sampleIndex + 4 <= numSamples; sampleIndex += 4) {
+        float32x4_t sum = vld1q_f32(destination + sampleIndex);
+        for (int32_t i = 0; i < numSources; i++) {
+            sum = vmlaq_n_f32(sum, vld1q_f32(sources[i] + sampleIndex), gains[i]);
+        }
+        vst1q_f32(destination + sampleIndex, sum);
+    }
+#elif defined(AAUDIO_MIXER_USE_SSE)
+    for (; sampleIndex + 4 <= numSamples; sampleIndex += 4) {
+        __m128 sum = _mm_loadu_ps(destination + sampleIndex);
+        for (int32_t i = 0; i < numSources; i++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(sources[i] + sampleIndex),
+                                             _mm_set1_ps(gains[i])));
+        }
+        _mm_storeu_ps(destination + sampleIndex, sum);
+    }
+#endif
+    for (; sampleIndex < numSamples; sampleIndex++) {
+        float sum = destination[sampleIndex];
+        for (int32_t i = 0; i < numSources; i++) {
+            sum += sources[i][sampleIndex] * gains[i];
+        }
+        destination[sampleIndex] = sum;
     }
 }
 
@@ -18,6 +18,8 @@
 #define AAUDIO_AAUDIO_MIXER_H
 
 #include <stdint.h>
+#include <memory>
+#include <vector>
 
 #include <aaudio/AAudio.h>
 #include <fifo/FifoBuffer.h>
@@ -41,17 +43,77 @@ public:
                 const std::shared_ptr<android::FifoBuffer>& fifo,
                 bool allowUnderflow);
 
+    /**
+     * Queue this FIFO to be mixed by the next call to mixQueued().
+     *
+     * The FIFO is not read and its read index is not advanced until mixQueued() is called,
+     * so the caller must keep the memory behind the FIFO alive until then.
+     *
+     * The gain is ramped linearly from startGain to endGain across one burst.
+     *
+     * @param streamIndex for marking stream variables in systrace
+     * @param fifo to read from
+     * @param allowUnderflow if true then allow mixer to advance read index past the write index
+     * @param startGain gain applied at the start of the burst
+     * @param endGain gain applied at the end of the burst
+     * @return frames that will be read from this stream
+     */
+    int32_t queue(int streamIndex,
+                  const std::shared_ptr<android::FifoBuffer>& fifo,
+                  bool allowUnderflow,
+                  float startGain = 1.0f,
+                  float endGain = 1.0f);
+
+    /**
+     * Add all of the queued FIFOs into the output buffer in a single pass
+     * and then advance their read indices.
+     */
+    void mixQueued();
+
     float *getOutputBuffer();
 
     int32_t getFramesPerBurst() const { return mFramesPerBurst; }
 
+    /**
+     * Add numSources scaled sources to the destination.
+     * The destination is loaded and stored only once per vector of samples.
+     *
+     * @param destination buffer to accumulate into
+     * @param sources array of numSources pointers, each to numSamples samples
+     * @param gains array of numSources gains
+     * @param numSources number of sources to add
+     * @param numSamples number of samples to add from each source
+     */
+    static void mixSources(float *destination,
+                           const float * const *sources,
+                           const float *gains,
+                           int32_t numSources,
+                           int32_t numSamples);
+
 private:
-    void mixPart(float *destination, float *source, int32_t numFrames);
+    // A FIFO that has been queued and has not been mixed yet.
+    struct QueuedSource {
+        std::shared_ptr<android::FifoBuffer> fifo;
+        const float *data[android::WrappingBuffer::SIZE];
+        int32_t      framesInFirstPart; // frames to read before wrapping
+        int32_t      framesToRead;      // total frames to read from the FIFO
+        int32_t      framesToAdvance;   // may be more than framesToRead if underflowing
+        float        startGain;
+        float        endGain;
+    };
+
+    void mixSegment(int32_t startFrame, int32_t endFrame);
 
     std::unique_ptr<float[]> mOutputBuffer;
     int32_t  mSamplesPerFrame = 0;
     int32_t  mFramesPerBurst = 0;
     int32_t  mBufferSizeInBytes = 0;
+
+    // Scratch space that is reserved in allocate() so that mixing does not normally allocate.
+    std::vector<QueuedSource> mQueuedSources;
+    std::vector<int32_t>      mSegmentEdges;
+    std::vector<const float*> mSegmentSources;
+    std::vector<float>        mSegmentGains;
 };
 
 #endif //AAUDIO_AAUDIO_MIXER_H
@@ -109,6 +109,14 @@ public:
 
     int32_t getRequestedDeviceId() const { return mRequestedDeviceId; }
 
+    /**
+     * @return data queue written once for all of the streams sharing this endpoint,
+     *         or nullptr if each stream has its own
+     */
+    virtual std::shared_ptr<SharedRingBuffer> getSharedDataQueue() const {
+        return nullptr;
+    }
+
     bool matches(const AAudioStreamConfiguration& configuration);
 
     // This should only be called from the AAudioEndpointManager under a mutex.
@@ -27,10 +27,12 @@
 #include "AAudioServiceEndpoint.h"
 
 #include "core/AudioStreamBuilder.h"
+#include "utility/AAudioUtilities.h"
 #include "AAudioServiceEndpoint.h"
 #include "AAudioServiceStreamShared.h"
 #include "AAudioServiceEndpointCapture.h"
 #include "AAudioServiceEndpointShared.h"
+#include "SharedRingBuffer.h"
 
 using namespace android;  // TODO just import names needed
 using namespace aaudio;   // TODO just import names needed
@@ -47,9 +49,36 @@ aaudio_result_t AAudioServiceEndpointCapture::open(const aaudio::AAudioStreamReq
                                           * getStreamInternal()->getBytesPerFrame();
         mDistributionBuffer = std::make_unique<uint8_t[]>(distributionBufferSizeBytes);
     }
+    if (result == AAUDIO_OK && AAudioProperty_isSharedCaptureRingEnabled()) {
+        // A whole number of bursts so that a burst never wraps around the end.
+        const int32_t capacityInFrames = AAudioServiceStreamShared::calculateBufferCapacity(
+                AAUDIO_UNSPECIFIED, getFramesPerBurst());
+        auto sharedDataQueue = std::make_shared<SharedRingBuffer>();
+        if (capacityInFrames > 0
+                && sharedDataQueue->allocate(getStreamInternal()->getBytesPerFrame(),
+                                             capacityInFrames) == AAUDIO_OK) {
+            mSharedDataQueue = std::move(sharedDataQueue);
+        } else {
+            ALOGW("%s() could not allocate shared data queue, copy to each stream", __func__);
+        }
+    }
     return result;
 }
 
+// Where to read the next burst from the shared MMAP stream.
+void *AAudioServiceEndpointCapture::getDistributionAddress() {
+    if (mSharedDataQueue == nullptr) {
+        return mDistributionBuffer.get();
+    }
+    // The clients have their own read counters so the whole queue is free for writing.
+    // Clients that are more than a buffer behind will detect an overrun.
+    std::shared_ptr<FifoBuffer> fifo = mSharedDataQueue->getFifoBuffer();
+    fifo->setReadCounter(fifo->getWriteCounter());
+    WrappingBuffer wrappingBuffer;
+    fifo->getEmptyRoomAvailable(&wrappingBuffer);
+    return wrappingBuffer.data[0];
+}
+
 // Read data from the shared MMAP stream and then distribute it to the client streams.
 void *AAudioServiceEndpointCapture::callbackLoop() {
     ALOGD("callbackLoop() entering");
@@ -62,7 +91,7 @@ void *AAudioServiceEndpointCapture::callbackLoop() {
         int64_t mmapFramesRead = getStreamInternal()->getFramesRead();
 
         // Read audio data from stream using a blocking read.
-        result = getStreamInternal()->read(mDistributionBuffer.get(),
+        result = getStreamInternal()->read(getDistributionAddress(),
                 getFramesPerBurst(), timeoutNanos);
         if (result == AAUDIO_ERROR_DISCONNECTED) {
             ALOGD("%s() read() returned AAUDIO_ERROR_DISCONNECTED", __func__);
@@ -74,6 +103,10 @@ void *AAudioServiceEndpointCapture::callbackLoop() {
             break;
         }
 
+        if (mSharedDataQueue != nullptr) {
+            mSharedDataQueue->getFifoBuffer()->advanceWriteIndex(getFramesPerBurst());
+        }
+
         // Distribute data to each active stream.
         { // brackets are for lock_guard
             std::lock_guard <std::mutex> lock(mLockStreams);
@@ -81,9 +114,14 @@ void *AAudioServiceEndpointCapture::callbackLoop() {
                 if (clientStream->isRunning() && !clientStream->isSuspended()) {
                     sp<AAudioServiceStreamShared> streamShared =
                             static_cast<AAudioServiceStreamShared *>(clientStream.get());
-                    streamShared->writeDataIfRoom(mmapFramesRead,
-                                                  mDistributionBuffer.get(),
-                                                  getFramesPerBurst());
+                    if (mSharedDataQueue != nullptr) {
+                        streamShared->markSharedDataWritten(mmapFramesRead,
+                                                            getFramesPerBurst());
+                    } else {
+                        streamShared->writeDataIfRoom(mmapFramesRead,
+                                                      mDistributionBuffer.get(),
+                                                      getFramesPerBurst());
+                    }
                 }
             }
         }
@@ -24,6 +24,7 @@
 
 #include "AAudioServiceEndpointShared.h"
 #include "AAudioServiceStreamShared.h"
+#include "SharedRingBuffer.h"
 
 namespace aaudio {
 
@@ -36,8 +37,16 @@ public:
 
     void *callbackLoop() override;
 
+    std::shared_ptr<SharedRingBuffer> getSharedDataQueue() const override {
+        return mSharedDataQueue;
+    }
+
 private:
+    void *getDistributionAddress();
+
     std::unique_ptr<uint8_t[]>  mDistributionBuffer;
+    // If set, bursts are read directly into this queue, which all client streams read.
+    std::shared_ptr<SharedRingBuffer> mSharedDataQueue;
 };
 
 } /* namespace aaudio */
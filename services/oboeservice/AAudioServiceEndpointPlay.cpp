@@ -80,7 +80,6 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
 
             std::lock_guard <std::mutex> lock(mLockStreams);
             for (const auto& clientStream : mRegisteredStreams) {
-                int64_t clientFramesRead = 0;
                 bool allowUnderflow = true;
 
                 if (clientStream->isSuspended()) {
@@ -107,12 +106,13 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
 
                         // Determine offset between framePosition in client's stream
                         // vs the underlying MMAP stream.
-                        clientFramesRead = fifo->getReadCounter();
+                        int64_t clientFramesRead = fifo->getReadCounter();
                         // These two indices refer to the same frame.
                         int64_t positionOffset = mmapFramesWritten - clientFramesRead;
                         streamShared->setTimestampPositionOffset(positionOffset);
 
-                        int32_t framesMixed = mMixer.mix(index, fifo, allowUnderflow);
+                        // The data is mixed below, together with the other streams.
+                        int32_t framesMixed = mMixer.queue(index, fifo, allowUnderflow);
 
                         if (streamShared->isFlowing()) {
                             // Consider it an underflow if we got less than a burst
@@ -126,22 +126,31 @@ void *AAudioServiceEndpointPlay::callbackLoop() {
                             // Mark beginning of data flow after a start.
                             streamShared->setFlowing(true);
                         }
-                        clientFramesRead = fifo->getReadCounter();
+                        // Hold the queue so that its memory stays mapped until it is mixed,
+                        // even if the stream is closed after we release the lock.
+                        mMixedStreams.push_back({streamShared, std::move(audioDataQueue), fifo});
                     }
                 }
 
-                if (clientFramesRead > 0) {
-                    // This timestamp represents the completion of data being read out of the
-                    // client buffer. It is sent to the client and used in the timing model
-                    // to decide when the client has room to write more data.
-                    Timestamp timestamp(clientFramesRead, AudioClock::getNanoseconds());
-                    streamShared->markTransferTime(timestamp);
-                }
-
                 index++; // just used for labelling tracks in systrace
             }
         }
 
+        // Mix all of the streams in one pass then advance their read indices.
+        mMixer.mixQueued();
+
+        for (auto& mixedStream : mMixedStreams) {
+            int64_t clientFramesRead = mixedStream.fifo->getReadCounter();
+            if (clientFramesRead > 0) {
+                // This timestamp represents the completion of data being read out of the
+                // client buffer. It is sent to the client and used in the timing model
+                // to decide when the client has room to write more data.
+                Timestamp timestamp(clientFramesRead, AudioClock::getNanoseconds());
+                mixedStream.stream->markTransferTime(timestamp);
+            }
+        }
+        mMixedStreams.clear();
+
         // Write mixer output to stream using a blocking write.
         result = getStreamInternal()->write(mMixer.getOutputBuffer(),
                                             getFramesPerBurst(), timeoutNanos);
@@ -45,8 +45,16 @@ public:
     void *callbackLoop() override;
 
 private:
+    // A client stream whose FIFO has been queued in the mixer during this burst.
+    struct MixedStream {
+        android::sp<AAudioServiceStreamShared>   stream;
+        std::shared_ptr<SharedRingBuffer>        audioDataQueue; // keeps the FIFO mapped
+        std::shared_ptr<android::FifoBuffer>     fifo;
+    };
+
     bool                     mLatencyTuningEnabled = false; // TODO implement tuning
     AAudioMixer              mMixer;    //
+    std::vector<MixedStream> mMixedStreams; // only used by callbackLoop()
 };
 
 } /* namespace aaudio */
@@ -174,19 +174,27 @@ aaudio_result_t AAudioServiceStreamShared::open(const aaudio::AAudioStreamReques
         goto error;
     }
 
-    setBufferCapacity(calculateBufferCapacity(configurationInput.getBufferCapacity(),
-                                     mFramesPerBurst));
-    if (getBufferCapacity() < 0) {
-        result = getBufferCapacity(); // negative error code
-        setBufferCapacity(0);
-        goto error;
-    }
-
     {
+        std::shared_ptr<SharedRingBuffer> sharedDataQueue = endpoint->getSharedDataQueue();
+        if (sharedDataQueue != nullptr) {
+            // Every stream reads the same data so they all have the same capacity.
+            setBufferCapacity(sharedDataQueue->getFifoBuffer()->getBufferCapacityInFrames());
+        } else {
+            setBufferCapacity(calculateBufferCapacity(configurationInput.getBufferCapacity(),
+                                                      mFramesPerBurst));
+        }
+        if (getBufferCapacity() < 0) {
+            result = getBufferCapacity(); // negative error code
+            setBufferCapacity(0);
+            goto error;
+        }
+
         std::lock_guard<std::mutex> lock(audioDataQueueLock);
         // Create audio data shared memory buffer for client.
         mAudioDataQueue = std::make_shared<SharedRingBuffer>();
-        result = mAudioDataQueue->allocate(calculateBytesPerFrame(), getBufferCapacity());
+        result = (sharedDataQueue != nullptr)
+                ? mAudioDataQueue->allocateReader(sharedDataQueue)
+                : mAudioDataQueue->allocate(calculateBytesPerFrame(), getBufferCapacity());
         if (result != AAUDIO_OK) {
             ALOGE("%s() could not allocate FIFO with %d frames",
                   __func__, getBufferCapacity());
@@ -267,6 +275,26 @@ aaudio_result_t AAudioServiceStreamShared::getHardwareTimestamp_l(int64_t *posit
     return result;
 }
 
+void AAudioServiceStreamShared::markSharedDataWritten(int64_t mmapFramesRead,
+                                                      int32_t numFrames) {
+    int64_t clientFramesWritten = 0;
+
+    // Lock the AudioFifo to protect against close.
+    std::lock_guard <std::mutex> lock(audioDataQueueLock);
+
+    if (mAudioDataQueue != nullptr) {
+        // The endpoint has already written the frames to the data queue that we share.
+        // The client detects its own overruns so there is nothing else to update.
+        clientFramesWritten = mAudioDataQueue->getFifoBuffer()->getWriteCounter();
+        setTimestampPositionOffset(mmapFramesRead - (clientFramesWritten - numFrames));
+    }
+
+    if (clientFramesWritten > 0) {
+        Timestamp timestamp(clientFramesWritten, AudioClock::getNanoseconds());
+        markTransferTime(timestamp);
+    }
+}
+
 void AAudioServiceStreamShared::writeDataIfRoom(int64_t mmapFramesRead,
                                                 const void *buffer, int32_t numFrames) {
     int64_t clientFramesWritten = 0;
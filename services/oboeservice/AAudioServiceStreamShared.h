@@ -54,6 +54,12 @@ public:
 
     void writeDataIfRoom(int64_t mmapFramesRead, const void *buffer, int32_t numFrames);
 
+    /**
+     * Update the timestamps after the endpoint wrote to the data queue returned by
+     * AAudioServiceEndpoint::getSharedDataQueue(), which this stream reads.
+     */
+    void markSharedDataWritten(int64_t mmapFramesRead, int32_t numFrames);
+
     /**
      * This must only be called under getAudioDataQueueLock().
      * @return
@@ -82,6 +88,14 @@ public:
 
     const char *getTypeText() const override { return "Shared"; }
 
+    /**
+     * @param requestedCapacityFrames
+     * @param framesPerBurst
+     * @return capacity or negative error
+     */
+    static int32_t calculateBufferCapacity(int32_t requestedCapacityFrames,
+                                            int32_t framesPerBurst);
+
     // This is public so that the thread safety annotation, GUARDED_BY(),
     // Can work when another object takes the lock.
     mutable std::mutex   audioDataQueueLock;
@@ -97,14 +111,6 @@ protected:
     aaudio_result_t getHardwareTimestamp_l(
             int64_t *positionFrames, int64_t *timeNanos) REQUIRES(mLock) override;
 
-    /**
-     * @param requestedCapacityFrames
-     * @param framesPerBurst
-     * @return capacity or negative error
-     */
-    static int32_t calculateBufferCapacity(int32_t requestedCapacityFrames,
-                                            int32_t framesPerBurst);
-
 private:
 
     std::shared_ptr<SharedRingBuffer> mAudioDataQueue GUARDED_BY(audioDataQueueLock);
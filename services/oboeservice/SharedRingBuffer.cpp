@@ -39,14 +39,9 @@ SharedRingBuffer::~SharedRingBuffer()
     }
 }
 
-aaudio_result_t SharedRingBuffer::allocate(fifo_frames_t   bytesPerFrame,
-                                         fifo_frames_t   capacityInFrames) {
-    mCapacityInFrames = capacityInFrames;
-
-    // Create shared memory large enough to hold the data and the read and write counters.
-    mDataMemorySizeInBytes = bytesPerFrame * capacityInFrames;
-    mSharedMemorySizeInBytes = mDataMemorySizeInBytes + (2 * (sizeof(fifo_counter_t)));
-    mFileDescriptor.reset(ashmem_create_region("AAudioSharedRingBuffer", mSharedMemorySizeInBytes));
+aaudio_result_t SharedRingBuffer::createSharedMemory(const char *name, int32_t sizeInBytes) {
+    mSharedMemorySizeInBytes = sizeInBytes;
+    mFileDescriptor.reset(ashmem_create_region(name, mSharedMemorySizeInBytes));
     if (mFileDescriptor.get() == -1) {
         ALOGE("allocate() ashmem_create_region() failed %d", errno);
         return AAUDIO_ERROR_INTERNAL;
@@ -72,6 +67,20 @@ aaudio_result_t SharedRingBuffer::allocate(fifo_frames_t   bytesPerFrame,
         return AAUDIO_ERROR_INTERNAL; // TODO convert errno to a better AAUDIO_ERROR;
     }
     mSharedMemory = tmpPtr;
+    return AAUDIO_OK;
+}
+
+aaudio_result_t SharedRingBuffer::allocate(fifo_frames_t   bytesPerFrame,
+                                         fifo_frames_t   capacityInFrames) {
+    mCapacityInFrames = capacityInFrames;
+
+    // Create shared memory large enough to hold the data and the read and write counters.
+    mDataMemorySizeInBytes = bytesPerFrame * capacityInFrames;
+    aaudio_result_t result = createSharedMemory("AAudioSharedRingBuffer",
+            mDataMemorySizeInBytes + (2 * (sizeof(fifo_counter_t))));
+    if (result != AAUDIO_OK) {
+        return result;
+    }
 
     // Get addresses for our counters and data from the shared memory.
     auto readCounterAddress = (fifo_counter_t *) &mSharedMemory[SHARED_RINGBUFFER_READ_OFFSET];
@@ -83,15 +92,59 @@ aaudio_result_t SharedRingBuffer::allocate(fifo_frames_t   bytesPerFrame,
     return AAUDIO_OK;
 }
 
+aaudio_result_t SharedRingBuffer::allocateReader(const std::shared_ptr<SharedRingBuffer>& writer) {
+    // Mappings that already exist, such as the writer's own, keep their protection.
+    if (ashmem_set_prot_region(writer->mFileDescriptor.get(), PROT_READ) < 0) {
+        ALOGE("allocateReader() ashmem_set_prot_region() failed %d", errno);
+        return AAUDIO_ERROR_INTERNAL;
+    }
+
+    // Only the read counter is in memory owned by this reader.
+    aaudio_result_t result = createSharedMemory("AAudioSharedRingBufferReader",
+                                                sizeof(fifo_counter_t));
+    if (result != AAUDIO_OK) {
+        return result;
+    }
+    mWriter = writer;
+    mCapacityInFrames = writer->mCapacityInFrames;
+    mDataMemorySizeInBytes = writer->mDataMemorySizeInBytes;
+
+    auto readCounterAddress = (fifo_counter_t *) &mSharedMemory[0];
+    auto writeCounterAddress =
+            (fifo_counter_t *) &writer->mSharedMemory[SHARED_RINGBUFFER_WRITE_OFFSET];
+    uint8_t *dataAddress = &writer->mSharedMemory[SHARED_RINGBUFFER_DATA_OFFSET];
+
+    // Start reading at the newest data. The writer may already be running
+    // so its write counter must not be reset.
+    mFifoBuffer = std::make_shared<FifoBufferIndirect>(
+            writer->mFifoBuffer->getBytesPerFrame(), mCapacityInFrames,
+            readCounterAddress, writeCounterAddress, dataAddress,
+            true /* sharedReader */);
+    return AAUDIO_OK;
+}
+
 void SharedRingBuffer::fillParcelable(AudioEndpointParcelable* endpointParcelable,
                     RingBufferParcelable &ringBufferParcelable) {
-    int fdIndex = endpointParcelable->addFileDescriptor(mFileDescriptor, mSharedMemorySizeInBytes);
-    ringBufferParcelable.setupMemory(fdIndex,
-                                     SHARED_RINGBUFFER_DATA_OFFSET,
-                                     mDataMemorySizeInBytes,
-                                     SHARED_RINGBUFFER_READ_OFFSET,
-                                     SHARED_RINGBUFFER_WRITE_OFFSET,
-                                     sizeof(fifo_counter_t));
+    if (mWriter != nullptr) {
+        int dataFdIndex = endpointParcelable->addFileDescriptor(
+                mWriter->mFileDescriptor, mWriter->mSharedMemorySizeInBytes);
+        int readFdIndex = endpointParcelable->addFileDescriptor(
+                mFileDescriptor, mSharedMemorySizeInBytes);
+        ringBufferParcelable.setupMemory(
+                {dataFdIndex, SHARED_RINGBUFFER_DATA_OFFSET, mDataMemorySizeInBytes},
+                {readFdIndex, 0, sizeof(fifo_counter_t)},
+                {dataFdIndex, SHARED_RINGBUFFER_WRITE_OFFSET, sizeof(fifo_counter_t)});
+        ringBufferParcelable.setFlags(RingbufferFlags::SHARED_DATA);
+    } else {
+        int fdIndex = endpointParcelable->addFileDescriptor(mFileDescriptor,
+                                                            mSharedMemorySizeInBytes);
+        ringBufferParcelable.setupMemory(fdIndex,
+                                         SHARED_RINGBUFFER_DATA_OFFSET,
+                                         mDataMemorySizeInBytes,
+                                         SHARED_RINGBUFFER_READ_OFFSET,
+                                         SHARED_RINGBUFFER_WRITE_OFFSET,
+                                         sizeof(fifo_counter_t));
+    }
     ringBufferParcelable.setBytesPerFrame(mFifoBuffer->getBytesPerFrame());
     ringBufferParcelable.setFramesPerBurst(1);
     ringBufferParcelable.setCapacityInFrames(mCapacityInFrames);
@@ -19,6 +19,7 @@
 
 #include <android-base/unique_fd.h>
 #include <cutils/ashmem.h>
+#include <memory>
 #include <stdint.h>
 #include <string>
 #include <sys/mman.h>
@@ -45,6 +46,16 @@ public:
 
     aaudio_result_t allocate(android::fifo_frames_t bytesPerFrame, android::fifo_frames_t capacityInFrames);
 
+    /**
+     * Allocate a read counter for one of several readers of the writer's data.
+     * The data and write counter stay in the writer's memory, which the service
+     * shares read-only, so the readers cannot modify each other's data.
+     * The writer does not wait for readers so they must detect their own overruns.
+     *
+     * @param writer ring buffer allocated with allocate()
+     */
+    aaudio_result_t allocateReader(const std::shared_ptr<SharedRingBuffer>& writer);
+
     void fillParcelable(AudioEndpointParcelable* endpointParcelable,
                         RingBufferParcelable &ringBufferParcelable);
 
@@ -62,6 +73,8 @@ public:
     }
 
 private:
+    aaudio_result_t createSharedMemory(const char *name, int32_t sizeInBytes);
+
     android::base::unique_fd  mFileDescriptor;
     std::shared_ptr<android::FifoBufferIndirect>  mFifoBuffer;
     uint8_t                  *mSharedMemory = nullptr; // mmap
@@ -69,6 +82,8 @@ private:
     // size of memory used for data vs counters
     int32_t                   mDataMemorySizeInBytes = 0;
     android::fifo_frames_t    mCapacityInFrames = 0;
+    // set if this is a reader of another ring buffer's data
+    std::shared_ptr<SharedRingBuffer> mWriter;
 };
 
 } /* namespace aaudio */
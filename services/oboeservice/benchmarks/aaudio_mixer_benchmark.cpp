@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <fifo/FifoBuffer.h>
+
+#include "AAudioMixer.h"
+
+using android::FifoBuffer;
+using android::FifoBufferAllocated;
+
+static constexpr int32_t kFramesPerBurst = 192;
+// Not a multiple of the burst so that reads regularly wrap around the end of the FIFO.
+static constexpr int32_t kFifoCapacityInFrames = 3 * kFramesPerBurst + 37;
+
+/*
+ * Mix numStreams client FIFOs into one burst, the way AAudioServiceEndpointPlay does.
+ * The FIFOs are refilled with one burst before each mix.
+ * If fused is true then all the streams are queued and mixed in a single pass,
+ * otherwise each stream is mixed separately.
+ */
+static void mixStreams(benchmark::State& state, bool fused, float endGain) {
+    const auto numStreams = static_cast<int32_t>(state.range(0));
+    const auto channelCount = static_cast<int32_t>(state.range(1));
+    const int32_t bytesPerFrame = channelCount * sizeof(float);
+
+    std::vector<float> burst(kFramesPerBurst * channelCount, 0.25f);
+    std::vector<std::shared_ptr<FifoBuffer>> fifos;
+    for (int32_t i = 0; i < numStreams; i++) {
+        fifos.push_back(std::make_shared<FifoBufferAllocated>(bytesPerFrame,
+                                                              kFifoCapacityInFrames));
+    }
+
+    AAudioMixer mixer;
+    mixer.allocate(channelCount, kFramesPerBurst);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (const auto& fifo : fifos) {
+            fifo->write(burst.data(), kFramesPerBurst);
+        }
+        state.ResumeTiming();
+
+        mixer.clear();
+        for (int32_t i = 0; i < numStreams; i++) {
+            if (fused) {
+                mixer.queue(i, fifos[i], true /* allowUnderflow */, 1.0f, endGain);
+            } else {
+                mixer.mix(i, fifos[i], true /* allowUnderflow */);
+            }
+        }
+        if (fused) {
+            mixer.mixQueued();
+        }
+        benchmark::DoNotOptimize(mixer.getOutputBuffer());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * numStreams * kFramesPerBurst);
+}
+
+static void BM_AAudioMixer_PerStream(benchmark::State& state) {
+    mixStreams(state, false /* fused */, 1.0f);
+}
+
+static void BM_AAudioMixer_Fused(benchmark::State& state) {
+    mixStreams(state, true /* fused */, 1.0f);
+}
+
+static void BM_AAudioMixer_FusedGainRamp(benchmark::State& state) {
+    mixStreams(state, true /* fused */, 0.5f);
+}
+
+static void MixerArgs(benchmark::internal::Benchmark* b) {
+    for (int channelCount : {1, 2, 8}) {
+        for (int numStreams : {1, 2, 4, 8, 16}) {
+            b->Args({numStreams, channelCount});
+        }
+    }
+}
+
+BENCHMARK(BM_AAudioMixer_PerStream)->Apply(MixerArgs);
+BENCHMARK(BM_AAudioMixer_Fused)->Apply(MixerArgs);
+BENCHMARK(BM_AAudioMixer_FusedGainRamp)->Apply(MixerArgs);
+
+BENCHMARK_MAIN();
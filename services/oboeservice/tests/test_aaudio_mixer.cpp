@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Test that mixing queued streams in one pass gives the same result as
+ * mixing each stream separately.
+ */
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <fifo/FifoBuffer.h>
+
+#include "AAudioMixer.h"
+
+using android::FifoBuffer;
+using android::FifoBufferAllocated;
+using android::fifo_counter_t;
+using android::fifo_frames_t;
+
+static constexpr int32_t kFramesPerBurst = 96;
+// Not a multiple of the burst so that reads wrap around the end of the FIFO.
+static constexpr int32_t kFifoCapacityInFrames = 2 * kFramesPerBurst + 29;
+// Frames of data in each stream at the start of a burst.
+// Some streams have less than a burst and one is empty.
+static constexpr int32_t kFramesAvailable[] = {
+        kFramesPerBurst, 2 * kFramesPerBurst, kFramesPerBurst - 1, 37, 0, 1,
+        kFramesPerBurst + 5};
+static constexpr int32_t kNumStreams = sizeof(kFramesAvailable) / sizeof(kFramesAvailable[0]);
+static constexpr int32_t kNumBursts = 9;
+
+static float sampleValue(int32_t stream, int64_t sample) {
+    return 0.01f * static_cast<float>(((stream + 1) * 7919 + sample * 31) % 201 - 100);
+}
+
+// A set of client FIFOs and the samples that were written into each of them.
+class Streams {
+public:
+    Streams(int32_t channelCount, fifo_counter_t startCounter)
+            : mChannelCount(channelCount), mStartCounter(startCounter) {
+        for (int32_t i = 0; i < kNumStreams; i++) {
+            auto fifo = std::make_shared<FifoBufferAllocated>(
+                    channelCount * static_cast<int32_t>(sizeof(float)),
+                    kFifoCapacityInFrames);
+            // Start near the end of the FIFO so that the first reads wrap.
+            fifo->setReadCounter(startCounter + i * 13);
+            fifo->setWriteCounter(startCounter + i * 13);
+            mFifos.push_back(fifo);
+            mWritten.emplace_back();
+        }
+    }
+
+    // Top up every FIFO to its kFramesAvailable.
+    void fill() {
+        for (int32_t i = 0; i < kNumStreams; i++) {
+            const std::shared_ptr<FifoBuffer>& fifo = mFifos[i];
+            fifo_frames_t framesToWrite = kFramesAvailable[i] - fifo->getFullFramesAvailable();
+            if (framesToWrite <= 0) {
+                continue;
+            }
+            std::vector<float> data(framesToWrite * mChannelCount);
+            for (size_t s = 0; s < data.size(); s++) {
+                data[s] = sampleValue(i, mWritten[i].size());
+                mWritten[i].push_back(data[s]);
+            }
+            ASSERT_EQ(framesToWrite, fifo->write(data.data(), framesToWrite));
+        }
+    }
+
+    // Return the sample written at this frame counter, or zero if it was never written.
+    float sampleAt(int32_t stream, fifo_counter_t counter, int32_t channel) const {
+        const fifo_counter_t firstCounter = mStartCounter + stream * 13;
+        const size_t index = (counter - firstCounter) * mChannelCount + channel;
+        return index < mWritten[stream].size() ? mWritten[stream][index] : 0.0f;
+    }
+
+    const std::shared_ptr<FifoBuffer>& fifo(int32_t stream) const { return mFifos[stream]; }
+
+private:
+    const int32_t mChannelCount;
+    const fifo_counter_t mStartCounter;
+    std::vector<std::shared_ptr<FifoBuffer>> mFifos;
+    std::vector<std::vector<float>> mWritten;
+};
+
+class AAudioMixerTest : public ::testing::TestWithParam<int32_t /* channelCount */> {
+protected:
+    static constexpr fifo_counter_t kStartCounter = kFifoCapacityInFrames - 50;
+
+    void SetUp() override {
+        mChannelCount = GetParam();
+        mPerStream.allocate(mChannelCount, kFramesPerBurst);
+        mFused.allocate(mChannelCount, kFramesPerBurst);
+        mPerStreamInput = std::make_unique<Streams>(mChannelCount, kStartCounter);
+        mFusedInput = std::make_unique<Streams>(mChannelCount, kStartCounter);
+    }
+
+    int32_t numSamples() const { return kFramesPerBurst * mChannelCount; }
+
+    int32_t mChannelCount = 0;
+    AAudioMixer mPerStream;
+    AAudioMixer mFused;
+    std::unique_ptr<Streams> mPerStreamInput;
+    std::unique_ptr<Streams> mFusedInput;
+};
+
+TEST_P(AAudioMixerTest, FusedMatchesPerStream) {
+    for (bool allowUnderflow : {true, false}) {
+        SCOPED_TRACE(allowUnderflow ? "allowUnderflow" : "no underflow");
+        for (int32_t burst = 0; burst < kNumBursts; burst++) {
+            SCOPED_TRACE("burst " + std::to_string(burst));
+            ASSERT_NO_FATAL_FAILURE(mPerStreamInput->fill());
+            ASSERT_NO_FATAL_FAILURE(mFusedInput->fill());
+            mPerStream.clear();
+            mFused.clear();
+            for (int32_t i = 0; i < kNumStreams; i++) {
+                int32_t framesMixed = mPerStream.mix(i, mPerStreamInput->fifo(i),
+                                                     allowUnderflow);
+                int32_t framesQueued = mFused.queue(i, mFusedInput->fifo(i), allowUnderflow);
+                EXPECT_EQ(framesMixed, framesQueued) << "stream " << i;
+            }
+            mFused.mixQueued();
+
+            const float *expected = mPerStream.getOutputBuffer();
+            const float *actual = mFused.getOutputBuffer();
+            for (int32_t s = 0; s < numSamples(); s++) {
+                ASSERT_FLOAT_EQ(expected[s], actual[s]) << "sample " << s;
+            }
+            for (int32_t i = 0; i < kNumStreams; i++) {
+                EXPECT_EQ(mPerStreamInput->fifo(i)->getReadCounter(),
+                          mFusedInput->fifo(i)->getReadCounter()) << "stream " << i;
+            }
+        }
+    }
+}
+
+TEST_P(AAudioMixerTest, PerStreamGain) {
+    std::vector<float> expected(numSamples());
+    for (int32_t burst = 0; burst < kNumBursts; burst++) {
+        SCOPED_TRACE("burst " + std::to_string(burst));
+        ASSERT_NO_FATAL_FAILURE(mFusedInput->fill());
+        std::fill(expected.begin(), expected.end(), 0.0f);
+        mFused.clear();
+        for (int32_t i = 0; i < kNumStreams; i++) {
+            const float gain = 0.25f * (i + 1);
+            const std::shared_ptr<FifoBuffer>& fifo = mFusedInput->fifo(i);
+            const fifo_counter_t readCounter = fifo->getReadCounter();
+            const int32_t framesRead = mFused.queue(i, fifo, true /* allowUnderflow */,
+                                                    gain, gain);
+            for (int32_t frame = 0; frame < framesRead; frame++) {
+                for (int32_t channel = 0; channel < mChannelCount; channel++) {
+                    expected[frame * mChannelCount + channel] += gain
+                            * mFusedInput->sampleAt(i, readCounter + frame, channel);
+                }
+            }
+        }
+        mFused.mixQueued();
+
+        const float *actual = mFused.getOutputBuffer();
+        for (int32_t s = 0; s < numSamples(); s++) {
+            ASSERT_NEAR(expected[s], actual[s], 1e-5f) << "sample " << s;
+        }
+    }
+}
+
+TEST_P(AAudioMixerTest, PerStreamGainRamp) {
+    std::vector<float> expected(numSamples());
+    std::vector<float> maxError(numSamples());
+    for (int32_t burst = 0; burst < kNumBursts; burst++) {
+        SCOPED_TRACE("burst " + std::to_string(burst));
+        ASSERT_NO_FATAL_FAILURE(mFusedInput->fill());
+        std::fill(expected.begin(), expected.end(), 0.0f);
+        std::fill(maxError.begin(), maxError.end(), 1e-5f);
+        mFused.clear();
+        for (int32_t i = 0; i < kNumStreams; i++) {
+            // Alternate between ramping up, ramping down and a constant gain.
+            const float startGain = (i % 3 == 0) ? 0.0f : 1.0f;
+            const float endGain = (i % 3 == 1) ? 0.0f : 1.0f;
+            const std::shared_ptr<FifoBuffer>& fifo = mFusedInput->fifo(i);
+            const fifo_counter_t readCounter = fifo->getReadCounter();
+            const int32_t framesRead = mFused.queue(i, fifo, true /* allowUnderflow */,
+                                                    startGain, endGain);
+            // The ramp is a step function, so the gain may be off by the change over one step.
+            const float stepError = std::abs(endGain - startGain) * 8 / kFramesPerBurst;
+            for (int32_t frame = 0; frame < framesRead; frame++) {
+                const float gain = startGain
+                        + (endGain - startGain) * (frame + 0.5f) / kFramesPerBurst;
+                for (int32_t channel = 0; channel < mChannelCount; channel++) {
+                    const float sample = mFusedInput->sampleAt(i, readCounter + frame, channel);
+                    expected[frame * mChannelCount + channel] += gain * sample;
+                    maxError[frame * mChannelCount + channel] += stepError * std::abs(sample);
+                }
+            }
+        }
+        mFused.mixQueued();
+
+        const float *actual = mFused.getOutputBuffer();
+        for (int32_t s = 0; s < numSamples(); s++) {
+            ASSERT_NEAR(expected[s], actual[s], maxError[s]) << "sample " << s;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(ChannelCounts, AAudioMixerTest, ::testing::Values(1, 2, 3, 8));